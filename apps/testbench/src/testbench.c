@@ -363,6 +363,24 @@ TEST_SUITE_DECL(testbench_mempool);
 TEST_SUITE_DECL(testbench_mutex);
 TEST_SUITE_DECL(testbench_sem);
 TEST_SUITE_DECL(testbench_json);
+TEST_SUITE_DECL(testbench_sched);
+TEST_SUITE_DECL(testbench_crc);
+TEST_SUITE_DECL(testbench_timer);
+#if MYNEWT_VAL(TESTBENCH_CALLOUT_CNT)
+TEST_SUITE_DECL(testbench_callout);
+#endif
+#if MYNEWT_VAL(LOG_DEFERRED_FMT)
+TEST_SUITE_DECL(testbench_log);
+#endif
+#if MYNEWT_VAL(OS_MBUF_CLONE)
+TEST_SUITE_DECL(testbench_mbuf);
+#endif
+#if MYNEWT_VAL(TESTBENCH_OIC_DISPATCH)
+TEST_SUITE_DECL(testbench_oic);
+#endif
+#if MYNEWT_VAL(TESTBENCH_FATFS)
+TEST_SUITE_DECL(testbench_fatfs);
+#endif
 
 static void
 omgr_app_init(void)
@@ -409,6 +427,24 @@ main(int argc, char **argv)
     TEST_SUITE_REGISTER(testbench_mutex);
     TEST_SUITE_REGISTER(testbench_sem);
     TEST_SUITE_REGISTER(testbench_json);
+    TEST_SUITE_REGISTER(testbench_sched);
+    TEST_SUITE_REGISTER(testbench_crc);
+    TEST_SUITE_REGISTER(testbench_timer);
+#if MYNEWT_VAL(TESTBENCH_CALLOUT_CNT)
+    TEST_SUITE_REGISTER(testbench_callout);
+#endif
+#if MYNEWT_VAL(LOG_DEFERRED_FMT)
+    TEST_SUITE_REGISTER(testbench_log);
+#endif
+#if MYNEWT_VAL(OS_MBUF_CLONE)
+    TEST_SUITE_REGISTER(testbench_mbuf);
+#endif
+#if MYNEWT_VAL(TESTBENCH_OIC_DISPATCH)
+    TEST_SUITE_REGISTER(testbench_oic);
+#endif
+#if MYNEWT_VAL(TESTBENCH_FATFS)
+    TEST_SUITE_REGISTER(testbench_fatfs);
+#endif
 
     rc = init_tasks();
 
@@ -0,0 +1,119 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include <stdio.h>
+#include <string.h>
+#include "os/mynewt.h"
+#include "testutil/testutil.h"
+
+#include "testbench.h"
+
+#if MYNEWT_VAL(TESTBENCH_CALLOUT_CNT)
+
+/*
+ * Callout benchmark. TESTBENCH_CALLOUT_CNT callouts are armed at scattered
+ * expiry times a second or more out, re-armed at different ones and then
+ * stopped; the time each pass takes is reported. None of them fire; their
+ * event queue is never run.
+ */
+#define CALLOUT_BENCH_CNT       MYNEWT_VAL(TESTBENCH_CALLOUT_CNT)
+
+static struct os_callout callout_bench[CALLOUT_BENCH_CNT];
+static struct os_eventq callout_bench_evq;
+
+void
+testbench_callout_init(void *arg)
+{
+    LOG_DEBUG(&testlog, LOG_MODULE_TEST, "%s testbench_callout suite init",
+              buildID);
+
+    tu_suite_set_pass_cb(testbench_ts_pass, NULL);
+    tu_suite_set_fail_cb(testbench_ts_fail, NULL);
+}
+
+static void
+callout_bench_cb(struct os_event *ev)
+{
+}
+
+TEST_CASE(os_callout_test_bench)
+{
+    uint32_t start;
+    uint32_t arm;
+    uint32_t reset;
+    uint32_t stop;
+    int rc;
+    int k;
+
+    os_eventq_init(&callout_bench_evq);
+    for (k = 0; k < CALLOUT_BENCH_CNT; k++) {
+        os_callout_init(&callout_bench[k], &callout_bench_evq,
+                        callout_bench_cb, NULL);
+    }
+
+    start = os_cputime_get32();
+    for (k = 0; k < CALLOUT_BENCH_CNT; k++) {
+        rc = os_callout_reset(&callout_bench[k],
+                              OS_TICKS_PER_SEC + (k * 7919) % 1000);
+        TEST_ASSERT_FATAL(rc == 0);
+    }
+    arm = os_cputime_get32() - start;
+
+    start = os_cputime_get32();
+    for (k = 0; k < CALLOUT_BENCH_CNT; k++) {
+        rc = os_callout_reset(&callout_bench[k],
+                              OS_TICKS_PER_SEC + (k * 104729) % 1000);
+        TEST_ASSERT_FATAL(rc == 0);
+    }
+    reset = os_cputime_get32() - start;
+
+    start = os_cputime_get32();
+    for (k = 0; k < CALLOUT_BENCH_CNT; k++) {
+        os_callout_stop(&callout_bench[k]);
+    }
+    stop = os_cputime_get32() - start;
+
+    for (k = 0; k < CALLOUT_BENCH_CNT; k++) {
+        TEST_ASSERT(!os_callout_queued(&callout_bench[k]));
+    }
+
+    LOG_INFO(&testlog, LOG_MODULE_TEST,
+             "%s callout wheel=%d callouts=%d arm %lu us reset %lu us "
+             "stop %lu us",
+             buildID, MYNEWT_VAL(OS_CALLOUT_WHEEL_SLOTS), CALLOUT_BENCH_CNT,
+             (unsigned long)os_cputime_ticks_to_usecs(arm),
+             (unsigned long)os_cputime_ticks_to_usecs(reset),
+             (unsigned long)os_cputime_ticks_to_usecs(stop));
+}
+
+TEST_SUITE(testbench_callout_suite)
+{
+    os_callout_test_bench();
+}
+
+int
+testbench_callout()
+{
+    tu_suite_set_init_cb(testbench_callout_init, NULL);
+    LOG_DEBUG(&testlog, LOG_MODULE_TEST, "%s testbench_callout", buildID);
+    testbench_callout_suite();
+
+    return tu_any_failed;
+}
+
+#endif
@@ -0,0 +1,144 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include <stdio.h>
+#include <string.h>
+#include "os/mynewt.h"
+#include "testutil/testutil.h"
+#include "crc/crc8.h"
+#include "crc/crc16.h"
+#include "crc/crc32.h"
+
+#include "testbench.h"
+
+/*
+ * CRC throughput benchmark. Each CRC is run over the same buffer a number of
+ * times, and the rate reported along with the CRC*_SLICE settings it was
+ * built with. The buffer starts at an odd address so that unaligned loads
+ * are included in the cost.
+ */
+#define CRC_BENCH_BUF_SZ        1024
+#define CRC_BENCH_ITERATIONS    16
+
+static uint8_t crc_bench_buf[CRC_BENCH_BUF_SZ + 1];
+
+enum crc_bench_type {
+    CRC_BENCH_8,
+    CRC_BENCH_16,
+    CRC_BENCH_32,
+    CRC_BENCH_32C,
+    CRC_BENCH_CNT
+};
+
+static const char *crc_bench_names[CRC_BENCH_CNT] = {
+    [CRC_BENCH_8] = "crc8",
+    [CRC_BENCH_16] = "crc16",
+    [CRC_BENCH_32] = "crc32",
+    [CRC_BENCH_32C] = "crc32c",
+};
+
+void
+testbench_crc_init(void *arg)
+{
+    int i;
+
+    LOG_DEBUG(&testlog, LOG_MODULE_TEST, "%s testbench_crc suite init",
+              buildID);
+
+    tu_suite_set_pass_cb(testbench_ts_pass, NULL);
+    tu_suite_set_fail_cb(testbench_ts_fail, NULL);
+
+    for (i = 0; i < sizeof(crc_bench_buf); i++) {
+        crc_bench_buf[i] = i * 2654435761U >> 24;
+    }
+}
+
+static uint32_t
+crc_bench_run(enum crc_bench_type type, uint32_t *out_crc)
+{
+    const uint8_t *buf;
+    uint32_t start;
+    uint32_t ticks;
+    uint32_t crc;
+    int i;
+
+    buf = crc_bench_buf + 1;
+    crc = 0;
+
+    start = os_cputime_get32();
+    for (i = 0; i < CRC_BENCH_ITERATIONS; i++) {
+        switch (type) {
+        case CRC_BENCH_8:
+            crc = crc8_calc(crc, (void *)buf, CRC_BENCH_BUF_SZ);
+            break;
+        case CRC_BENCH_16:
+            crc = crc16_ccitt(crc, buf, CRC_BENCH_BUF_SZ);
+            break;
+        case CRC_BENCH_32:
+            crc = crc32_calc(crc, buf, CRC_BENCH_BUF_SZ);
+            break;
+        case CRC_BENCH_32C:
+            crc = crc32c_calc(crc, buf, CRC_BENCH_BUF_SZ);
+            break;
+        default:
+            break;
+        }
+    }
+    ticks = os_cputime_get32() - start;
+
+    *out_crc = crc;
+
+    return os_cputime_ticks_to_usecs(ticks);
+}
+
+TEST_CASE(crc_test_throughput)
+{
+    uint32_t usecs;
+    uint32_t crc;
+    int i;
+
+    for (i = 0; i < CRC_BENCH_CNT; i++) {
+        usecs = crc_bench_run(i, &crc);
+        if (usecs == 0) {
+            usecs = 1;
+        }
+        LOG_INFO(&testlog, LOG_MODULE_TEST,
+                 "%s %s slice=%d/%d/%d hal=%d %lu kB/s crc=0x%08lx",
+                 buildID, crc_bench_names[i], MYNEWT_VAL(CRC8_SLICE),
+                 MYNEWT_VAL(CRC16_SLICE), MYNEWT_VAL(CRC32_SLICE),
+                 MYNEWT_VAL(CRC_HAL),
+                 (unsigned long)((uint64_t)CRC_BENCH_BUF_SZ *
+                                 CRC_BENCH_ITERATIONS * 1000 / usecs),
+                 (unsigned long)crc);
+    }
+}
+
+TEST_SUITE(testbench_crc_suite)
+{
+    crc_test_throughput();
+}
+
+int
+testbench_crc()
+{
+    tu_suite_set_init_cb(testbench_crc_init, NULL);
+    LOG_DEBUG(&testlog, LOG_MODULE_TEST, "%s testbench_crc", buildID);
+    testbench_crc_suite();
+
+    return tu_any_failed;
+}
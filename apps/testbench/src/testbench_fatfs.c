@@ -0,0 +1,164 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include <stdio.h>
+#include <string.h>
+#include "os/mynewt.h"
+#include "testutil/testutil.h"
+#include "flash_map/flash_map.h"
+#include "fatfs_test.h"
+
+#include "testbench.h"
+
+#if MYNEWT_VAL(TESTBENCH_FATFS)
+
+/*
+ * FatFs disk traffic benchmark. Typical small system use: a few files
+ * written and read back in small chunks, and a log file which gets appended
+ * to and closed after every record. The reads, writes and erases reaching
+ * the disk are reported for each phase, along with the FATFS_CACHE_*
+ * settings the app was built with. The disk is the one from the FatFs unit
+ * test, on TESTBENCH_FATFS_FLASH_AREA.
+ */
+#define FATFS_BENCH_FILE_CNT        4
+#define FATFS_BENCH_FILE_SZ         (8 * 1024)
+#define FATFS_BENCH_CHUNK_SZ        128
+#define FATFS_BENCH_LOG_CNT         32
+#define FATFS_BENCH_LOG_REC_SZ      48
+
+void
+testbench_fatfs_init(void *arg)
+{
+    const struct flash_area *fa;
+    int rc;
+
+    LOG_DEBUG(&testlog, LOG_MODULE_TEST, "%s testbench_fatfs suite init",
+              buildID);
+
+    tu_suite_set_pass_cb(testbench_ts_pass, NULL);
+    tu_suite_set_fail_cb(testbench_ts_fail, NULL);
+
+    rc = flash_area_open(MYNEWT_VAL(TESTBENCH_FATFS_FLASH_AREA), &fa);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT_FATAL(fa->fa_size >=
+                      FATFS_TEST_SECTOR_CNT * FATFS_TEST_SECTOR_SZ);
+
+    rc = fatfs_test_disk_init(fa->fa_device_id, fa->fa_off);
+    TEST_ASSERT_FATAL(rc == 0);
+    flash_area_close(fa);
+}
+
+static uint8_t
+fatfs_bench_pattern(int file, uint32_t off)
+{
+    return (uint8_t)(file * 31 + off * 7 + (off >> 8));
+}
+
+static void
+fatfs_bench_report(const char *phase, uint32_t ticks)
+{
+    LOG_INFO(&testlog, LOG_MODULE_TEST,
+             "%s fatfs %s cache=%d/%d/%d %lu reads %lu writes %lu erases "
+             "%lu bytes in %lu bytes out %lu us",
+             buildID, phase, MYNEWT_VAL(FATFS_CACHE_SECTORS),
+             MYNEWT_VAL(FATFS_CACHE_XFER_SECTORS),
+             MYNEWT_VAL(FATFS_CACHE_WRITE_BACK),
+             (unsigned long)fatfs_test_disk_stats.reads,
+             (unsigned long)fatfs_test_disk_stats.writes,
+             (unsigned long)fatfs_test_disk_stats.erases,
+             (unsigned long)fatfs_test_disk_stats.bytes_read,
+             (unsigned long)fatfs_test_disk_stats.bytes_written,
+             (unsigned long)os_cputime_ticks_to_usecs(ticks));
+    memset(&fatfs_test_disk_stats, 0, sizeof(fatfs_test_disk_stats));
+}
+
+TEST_CASE(fatfs_test_traffic)
+{
+    struct fs_file *file;
+    uint8_t buf[FATFS_BENCH_CHUNK_SZ];
+    char name[32];
+    uint32_t start;
+    uint32_t off;
+    uint32_t len;
+    int rc;
+    int i;
+    int j;
+
+    fatfs_test_format();
+
+    start = os_cputime_get32();
+    for (i = 0; i < FATFS_BENCH_FILE_CNT; i++) {
+        snprintf(name, sizeof(name), FATFS_TEST_DISK ":/file%d.bin", i);
+        rc = fs_open(name, FS_ACCESS_WRITE | FS_ACCESS_TRUNCATE, &file);
+        TEST_ASSERT_FATAL(rc == 0);
+        for (off = 0; off < FATFS_BENCH_FILE_SZ; off += sizeof(buf)) {
+            for (j = 0; j < sizeof(buf); j++) {
+                buf[j] = fatfs_bench_pattern(i, off + j);
+            }
+            rc = fs_write(file, buf, sizeof(buf));
+            TEST_ASSERT_FATAL(rc == 0);
+        }
+        rc = fs_close(file);
+        TEST_ASSERT_FATAL(rc == 0);
+    }
+    fatfs_bench_report("write", os_cputime_get32() - start);
+
+    start = os_cputime_get32();
+    for (i = 0; i < FATFS_BENCH_FILE_CNT; i++) {
+        snprintf(name, sizeof(name), FATFS_TEST_DISK ":/file%d.bin", i);
+        rc = fs_open(name, FS_ACCESS_READ, &file);
+        TEST_ASSERT_FATAL(rc == 0);
+        for (off = 0; off < FATFS_BENCH_FILE_SZ; off += sizeof(buf)) {
+            rc = fs_read(file, sizeof(buf), buf, &len);
+            TEST_ASSERT_FATAL(rc == 0 && len == sizeof(buf));
+        }
+        rc = fs_close(file);
+        TEST_ASSERT_FATAL(rc == 0);
+    }
+    fatfs_bench_report("read", os_cputime_get32() - start);
+
+    start = os_cputime_get32();
+    for (i = 0; i < FATFS_BENCH_LOG_CNT; i++) {
+        rc = fs_open(FATFS_TEST_DISK ":/log.txt",
+                     FS_ACCESS_WRITE | FS_ACCESS_APPEND, &file);
+        TEST_ASSERT_FATAL(rc == 0);
+        memset(buf, 'a' + i % 26, FATFS_BENCH_LOG_REC_SZ);
+        rc = fs_write(file, buf, FATFS_BENCH_LOG_REC_SZ);
+        TEST_ASSERT_FATAL(rc == 0);
+        rc = fs_close(file);
+        TEST_ASSERT_FATAL(rc == 0);
+    }
+    fatfs_bench_report("append", os_cputime_get32() - start);
+}
+
+TEST_SUITE(testbench_fatfs_suite)
+{
+    fatfs_test_traffic();
+}
+
+int
+testbench_fatfs()
+{
+    tu_suite_set_init_cb(testbench_fatfs_init, NULL);
+    LOG_DEBUG(&testlog, LOG_MODULE_TEST, "%s testbench_fatfs", buildID);
+    testbench_fatfs_suite();
+
+    return tu_any_failed;
+}
+
+#endif
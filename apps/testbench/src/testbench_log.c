@@ -0,0 +1,145 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include <stdio.h>
+#include <string.h>
+#include "os/mynewt.h"
+#include "testutil/testutil.h"
+
+#include "testbench.h"
+
+#if MYNEWT_VAL(LOG_DEFERRED_FMT)
+
+/*
+ * Log formatting benchmark. The same message is written with log_printf()
+ * and with log_printf_deferred() to a scratch cbmem log, measuring the time
+ * per call and the number of bytes each entry takes up.
+ */
+#define LOG_BENCH_ITERATIONS    32
+#define LOG_BENCH_BUF_SZ        4096
+
+static uint32_t log_bench_buf[LOG_BENCH_BUF_SZ / sizeof(uint32_t)];
+static struct cbmem log_bench_cbmem;
+static struct log log_bench_log;
+
+static int
+log_bench_walk(struct log *log, struct log_offset *log_offset, void *dptr,
+               uint16_t len)
+{
+    uint32_t *bytes;
+
+    bytes = log_offset->lo_arg;
+    *bytes += len;
+
+    return 0;
+}
+
+static uint32_t
+log_bench_run(int deferred, uint32_t *out_bytes)
+{
+    struct log_offset log_offset = { 0 };
+    uint32_t start;
+    uint32_t ticks;
+    uint32_t bytes;
+    int i;
+
+    log_flush(&log_bench_log);
+
+    start = os_cputime_get32();
+    for (i = 0; i < LOG_BENCH_ITERATIONS; i++) {
+        if (deferred) {
+            log_printf_deferred(&log_bench_log, LOG_MODULE_TEST,
+                                LOG_LEVEL_INFO,
+                                "%s seq=%d val=0x%08x up=%lu", "sensor", i,
+                                (unsigned int)(i * 2654435761U),
+                                (unsigned long)start);
+        } else {
+            log_printf(&log_bench_log, LOG_MODULE_TEST, LOG_LEVEL_INFO,
+                       "%s seq=%d val=0x%08x up=%lu", "sensor", i,
+                       (unsigned int)(i * 2654435761U),
+                       (unsigned long)start);
+        }
+    }
+    ticks = os_cputime_get32() - start;
+
+    bytes = 0;
+    log_offset.lo_arg = &bytes;
+    log_walk(&log_bench_log, log_bench_walk, &log_offset);
+    *out_bytes = bytes;
+
+    return os_cputime_ticks_to_usecs(ticks);
+}
+
+void
+testbench_log_init(void *arg)
+{
+    LOG_DEBUG(&testlog, LOG_MODULE_TEST, "%s testbench_log suite init",
+              buildID);
+
+    tu_suite_set_pass_cb(testbench_ts_pass, NULL);
+    tu_suite_set_fail_cb(testbench_ts_fail, NULL);
+
+    cbmem_init(&log_bench_cbmem, log_bench_buf, sizeof(log_bench_buf));
+
+    /*
+     * Not registered, log_register() is only allowed before anything has
+     * been written to a persistent log.
+     */
+    log_bench_log.l_name = "log_bench";
+    log_bench_log.l_log = &log_cbmem_handler;
+    log_bench_log.l_arg = &log_bench_cbmem;
+    log_bench_log.l_level = LOG_LEVEL_DEBUG;
+}
+
+TEST_CASE(log_test_deferred_cost)
+{
+    uint32_t usecs[2];
+    uint32_t bytes[2];
+    int i;
+
+    for (i = 0; i < 2; i++) {
+        usecs[i] = log_bench_run(i, &bytes[i]);
+        TEST_ASSERT(bytes[i] > 0);
+    }
+    TEST_ASSERT(bytes[1] < bytes[0]);
+
+    LOG_INFO(&testlog, LOG_MODULE_TEST,
+             "%s log_printf %lu ns %lu bytes, deferred %lu ns %lu bytes",
+             buildID,
+             (unsigned long)(usecs[0] * 1000 / LOG_BENCH_ITERATIONS),
+             (unsigned long)(bytes[0] / LOG_BENCH_ITERATIONS),
+             (unsigned long)(usecs[1] * 1000 / LOG_BENCH_ITERATIONS),
+             (unsigned long)(bytes[1] / LOG_BENCH_ITERATIONS));
+}
+
+TEST_SUITE(testbench_log_suite)
+{
+    log_test_deferred_cost();
+}
+
+int
+testbench_log()
+{
+    tu_suite_set_init_cb(testbench_log_init, NULL);
+    LOG_DEBUG(&testlog, LOG_MODULE_TEST, "%s testbench_log", buildID);
+    testbench_log_suite();
+
+    return tu_any_failed;
+}
+
+#endif
@@ -0,0 +1,185 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include <stdio.h>
+#include <string.h>
+#include "os/mynewt.h"
+#include "testutil/testutil.h"
+
+#include "testbench.h"
+
+#if MYNEWT_VAL(OS_MBUF_CLONE)
+
+/*
+ * Mbuf fan-out benchmark. A packet is sent to a number of interfaces, each
+ * getting its own copy made with os_mbuf_dup() or os_mbuf_clone(). The
+ * number of bytes of mbuf blocks taken by the copies and the time it takes
+ * to make them are reported per copy. The packet is made of blocks of the
+ * size of the default msys pool, the clone headers come out of a pool of
+ * small blocks. The suite is only built when the target enables
+ * OS_MBUF_CLONE; the testbench itself runs with the default mbuf layout.
+ */
+#define MBUF_BENCH_BLOCK_SIZE       292
+#define MBUF_BENCH_BLOCK_COUNT      16
+#define MBUF_BENCH_HDR_SIZE         64
+#define MBUF_BENCH_HDR_COUNT        16
+#define MBUF_BENCH_USRHDR_LEN       24
+#define MBUF_BENCH_PKT_LEN          512
+#define MBUF_BENCH_FANOUT           3
+#define MBUF_BENCH_ITERATIONS       32
+
+static os_membuf_t mbuf_bench_data[OS_MEMPOOL_SIZE(MBUF_BENCH_BLOCK_COUNT,
+                                                   MBUF_BENCH_BLOCK_SIZE)];
+static struct os_mempool mbuf_bench_mempool;
+static struct os_mbuf_pool mbuf_bench_pool;
+
+static os_membuf_t mbuf_bench_hdr_data[OS_MEMPOOL_SIZE(MBUF_BENCH_HDR_COUNT,
+                                                       MBUF_BENCH_HDR_SIZE)];
+static struct os_mempool mbuf_bench_hdr_mempool;
+static struct os_mbuf_pool mbuf_bench_hdr_pool;
+
+static uint8_t mbuf_bench_buf[MBUF_BENCH_PKT_LEN];
+
+void
+testbench_mbuf_init(void *arg)
+{
+    int rc;
+    int i;
+
+    LOG_DEBUG(&testlog, LOG_MODULE_TEST, "%s testbench_mbuf suite init",
+              buildID);
+
+    tu_suite_set_pass_cb(testbench_ts_pass, NULL);
+    tu_suite_set_fail_cb(testbench_ts_fail, NULL);
+
+    rc = os_mempool_init(&mbuf_bench_mempool, MBUF_BENCH_BLOCK_COUNT,
+                         MBUF_BENCH_BLOCK_SIZE, mbuf_bench_data, "mbuf_bench");
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = os_mbuf_pool_init(&mbuf_bench_pool, &mbuf_bench_mempool,
+                           MBUF_BENCH_BLOCK_SIZE, MBUF_BENCH_BLOCK_COUNT);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    rc = os_mempool_init(&mbuf_bench_hdr_mempool, MBUF_BENCH_HDR_COUNT,
+                         MBUF_BENCH_HDR_SIZE, mbuf_bench_hdr_data,
+                         "mbuf_bench_hdr");
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = os_mbuf_pool_init(&mbuf_bench_hdr_pool, &mbuf_bench_hdr_mempool,
+                           MBUF_BENCH_HDR_SIZE, MBUF_BENCH_HDR_COUNT);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    for (i = 0; i < sizeof(mbuf_bench_buf); i++) {
+        mbuf_bench_buf[i] = i;
+    }
+}
+
+/*
+ * Makes MBUF_BENCH_FANOUT copies of om, checks them and frees them again.
+ * Returns the time taken to make the copies, in usecs, and the number of
+ * bytes of mbuf blocks they took.
+ */
+static uint32_t
+mbuf_bench_run(struct os_mbuf *om, int clone, uint32_t *out_bytes)
+{
+    struct os_mbuf *copies[MBUF_BENCH_FANOUT];
+    uint32_t start;
+    uint32_t ticks;
+    uint32_t bytes;
+    int i;
+    int j;
+
+    ticks = 0;
+    bytes = 0;
+    for (i = 0; i < MBUF_BENCH_ITERATIONS; i++) {
+        start = os_cputime_get32();
+        for (j = 0; j < MBUF_BENCH_FANOUT; j++) {
+            if (clone) {
+                copies[j] = os_mbuf_clone(&mbuf_bench_hdr_pool, om);
+            } else {
+                copies[j] = os_mbuf_dup(om);
+            }
+        }
+        ticks += os_cputime_get32() - start;
+
+        bytes = (mbuf_bench_mempool.mp_num_blocks -
+                 mbuf_bench_mempool.mp_num_free) * MBUF_BENCH_BLOCK_SIZE +
+                (mbuf_bench_hdr_mempool.mp_num_blocks -
+                 mbuf_bench_hdr_mempool.mp_num_free) * MBUF_BENCH_HDR_SIZE;
+
+        for (j = 0; j < MBUF_BENCH_FANOUT; j++) {
+            TEST_ASSERT_FATAL(copies[j] != NULL);
+            TEST_ASSERT(OS_MBUF_PKTLEN(copies[j]) == MBUF_BENCH_PKT_LEN);
+            TEST_ASSERT(os_mbuf_cmpf(copies[j], 0, mbuf_bench_buf,
+                                     MBUF_BENCH_PKT_LEN) == 0);
+            os_mbuf_free_chain(copies[j]);
+        }
+    }
+
+    *out_bytes = bytes;
+    return os_cputime_ticks_to_usecs(ticks);
+}
+
+TEST_CASE(mbuf_test_fanout)
+{
+    static const char *names[] = { "dup", "clone" };
+    struct os_mbuf *om;
+    uint32_t src_bytes;
+    uint32_t usecs;
+    uint32_t bytes;
+    int clone;
+    int rc;
+
+    om = os_mbuf_get_pkthdr(&mbuf_bench_pool, MBUF_BENCH_USRHDR_LEN);
+    TEST_ASSERT_FATAL(om != NULL);
+    rc = os_mbuf_append(om, mbuf_bench_buf, MBUF_BENCH_PKT_LEN);
+    TEST_ASSERT_FATAL(rc == 0);
+    src_bytes = (mbuf_bench_mempool.mp_num_blocks -
+                 mbuf_bench_mempool.mp_num_free) * MBUF_BENCH_BLOCK_SIZE;
+
+    for (clone = 0; clone < 2; clone++) {
+        usecs = mbuf_bench_run(om, clone, &bytes);
+        LOG_INFO(&testlog, LOG_MODULE_TEST,
+                 "%s mbuf %s pkt=%d fanout=%d %lu bytes %lu ns per copy",
+                 buildID, names[clone], MBUF_BENCH_PKT_LEN, MBUF_BENCH_FANOUT,
+                 (unsigned long)((bytes - src_bytes) / MBUF_BENCH_FANOUT),
+                 (unsigned long)((uint64_t)usecs * 1000 /
+                                 (MBUF_BENCH_ITERATIONS * MBUF_BENCH_FANOUT)));
+    }
+
+    os_mbuf_free_chain(om);
+    TEST_ASSERT(mbuf_bench_mempool.mp_num_free ==
+                mbuf_bench_mempool.mp_num_blocks);
+    TEST_ASSERT(mbuf_bench_hdr_mempool.mp_num_free ==
+                mbuf_bench_hdr_mempool.mp_num_blocks);
+}
+
+TEST_SUITE(testbench_mbuf_suite)
+{
+    mbuf_test_fanout();
+}
+
+int
+testbench_mbuf()
+{
+    tu_suite_set_init_cb(testbench_mbuf_init, NULL);
+    LOG_DEBUG(&testlog, LOG_MODULE_TEST, "%s testbench_mbuf", buildID);
+    testbench_mbuf_suite();
+
+    return tu_any_failed;
+}
+
+#endif
@@ -0,0 +1,158 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include <stdio.h>
+#include <string.h>
+#include "os/mynewt.h"
+#include "testutil/testutil.h"
+#include <oic/oc_api.h>
+#include <oic/port/oc_connectivity.h>
+#include <oic/messaging/coap/coap.h>
+
+#include "testbench.h"
+
+#if MYNEWT_VAL(TESTBENCH_OIC_DISPATCH)
+
+/*
+ * OIC request dispatch benchmark. Registers TESTBENCH_OIC_DISPATCH
+ * application resources, and measures the time it takes
+ * oc_ri_invoke_coap_entity_handler() to get a GET request to the handler of
+ * its resource and the response back, averaged over all of them.
+ */
+#define OIC_BENCH_RESOURCES     MYNEWT_VAL(TESTBENCH_OIC_DISPATCH)
+#define OIC_BENCH_ITERATIONS    8
+#define OIC_BENCH_URI_LEN       16
+
+static struct oc_resource *oic_bench_res[OIC_BENCH_RESOURCES];
+static char oic_bench_uri[OIC_BENCH_RESOURCES][OIC_BENCH_URI_LEN];
+static struct oc_resource *oic_bench_hit;
+static oc_endpoint_t oic_bench_ep;
+
+void
+testbench_oic_init(void *arg)
+{
+    LOG_DEBUG(&testlog, LOG_MODULE_TEST, "%s testbench_oic suite init",
+              buildID);
+
+    tu_suite_set_pass_cb(testbench_ts_pass, NULL);
+    tu_suite_set_fail_cb(testbench_ts_fail, NULL);
+}
+
+static void
+oic_bench_get(struct oc_request *request, oc_interface_mask_t interface)
+{
+    oic_bench_hit = request->resource;
+    oc_send_response(request, OC_STATUS_OK);
+}
+
+/*
+ * Runs a GET for resource idx through the request dispatch, as the CoAP
+ * engine would once it has parsed the request. Returns the time it took.
+ */
+static uint32_t
+oic_bench_request(struct coap_packet_rx *req, int idx)
+{
+    coap_packet_t rsp;
+    const char *uri;
+    int32_t offset;
+    uint32_t start;
+    uint32_t ticks;
+    bool found;
+
+    uri = oic_bench_uri[idx] + 1;
+    req->uri_path_len = strlen(uri);
+    TEST_ASSERT_FATAL(os_mbuf_copyinto(req->m, 0, uri,
+                                       req->uri_path_len) == 0);
+    coap_init_message(&rsp, COAP_TYPE_ACK, CONTENT_2_05, 0);
+    offset = 0;
+    oic_bench_hit = NULL;
+
+    start = os_cputime_get32();
+    found = oc_ri_invoke_coap_entity_handler(req, &rsp, &offset,
+                                             &oic_bench_ep);
+    ticks = os_cputime_get32() - start;
+
+    TEST_ASSERT(found);
+    TEST_ASSERT(rsp.code == CONTENT_2_05);
+    TEST_ASSERT(oic_bench_hit == oic_bench_res[idx]);
+    if (rsp.payload_m) {
+        os_mbuf_free_chain(rsp.payload_m);
+    }
+
+    return ticks;
+}
+
+TEST_CASE(oic_test_dispatch)
+{
+    struct coap_packet_rx req;
+    uint32_t ticks;
+    int i;
+    int j;
+
+    for (i = 0; i < OIC_BENCH_RESOURCES; i++) {
+        snprintf(oic_bench_uri[i], OIC_BENCH_URI_LEN, "/bench/res%d", i);
+        oic_bench_res[i] = oc_new_resource(oic_bench_uri[i], 1, 0);
+        TEST_ASSERT_FATAL(oic_bench_res[i] != NULL);
+        oc_resource_set_request_handler(oic_bench_res[i], OC_GET,
+                                        oic_bench_get);
+        TEST_ASSERT_FATAL(oc_add_resource(oic_bench_res[i]));
+    }
+
+    memset(&req, 0, sizeof(req));
+    req.code = COAP_GET;
+    req.m = os_msys_get_pkthdr(OIC_BENCH_URI_LEN, 0);
+    TEST_ASSERT_FATAL(req.m != NULL);
+    req.uri_path_off = 0;
+    SET_OPTION(&req, COAP_OPTION_URI_PATH);
+
+    ticks = 0;
+    for (j = 0; j < OIC_BENCH_ITERATIONS; j++) {
+        for (i = 0; i < OIC_BENCH_RESOURCES; i++) {
+            ticks += oic_bench_request(&req, i);
+        }
+    }
+    os_mbuf_free_chain(req.m);
+
+    LOG_INFO(&testlog, LOG_MODULE_TEST,
+             "%s oic hash=%d resources=%d dispatch %lu ns",
+             buildID, MYNEWT_VAL(OC_APP_RES_HASH_SIZE), OIC_BENCH_RESOURCES,
+             (unsigned long)((uint64_t)os_cputime_ticks_to_usecs(ticks) *
+                             1000 / (OIC_BENCH_ITERATIONS *
+                                     OIC_BENCH_RESOURCES)));
+
+    for (i = 0; i < OIC_BENCH_RESOURCES; i++) {
+        oc_delete_resource(oic_bench_res[i]);
+    }
+}
+
+TEST_SUITE(testbench_oic_suite)
+{
+    oic_test_dispatch();
+}
+
+int
+testbench_oic()
+{
+    tu_suite_set_init_cb(testbench_oic_init, NULL);
+    LOG_DEBUG(&testlog, LOG_MODULE_TEST, "%s testbench_oic", buildID);
+    testbench_oic_suite();
+
+    return tu_any_failed;
+}
+
+#endif
@@ -0,0 +1,124 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include <stdio.h>
+#include <string.h>
+#include "os/mynewt.h"
+#include "testutil/testutil.h"
+
+#include "testbench.h"
+
+/*
+ * Scheduler latency benchmark. Dummy task structures are put on the run
+ * list (they never get to run, all of this happens with interrupts
+ * disabled), and the time it takes to put the lowest priority one to sleep,
+ * wake it up and pick the next task to run is measured.
+ */
+#define SCHED_BENCH_MAX_TASKS   32
+#define SCHED_BENCH_BASE_PRIO   200
+#define SCHED_BENCH_ITERATIONS  64
+
+static struct os_task sched_bench_tasks[SCHED_BENCH_MAX_TASKS];
+
+void
+testbench_sched_init(void *arg)
+{
+    LOG_DEBUG(&testlog, LOG_MODULE_TEST, "%s testbench_sched suite init",
+              buildID);
+
+    tu_suite_set_pass_cb(testbench_ts_pass, NULL);
+    tu_suite_set_fail_cb(testbench_ts_fail, NULL);
+}
+
+static uint32_t
+sched_bench_run(int ntasks, int *ok)
+{
+    struct os_task *cur;
+    struct os_task *t;
+    uint32_t start;
+    uint32_t ticks;
+    os_sr_t sr;
+    int i;
+
+    memset(sched_bench_tasks, 0, sizeof(sched_bench_tasks));
+
+    OS_ENTER_CRITICAL(sr);
+
+    cur = os_sched_next_task();
+    for (i = 0; i < ntasks; i++) {
+        t = &sched_bench_tasks[i];
+        t->t_name = "sched_bench";
+        t->t_prio = SCHED_BENCH_BASE_PRIO + i;
+        t->t_state = OS_TASK_READY;
+        os_sched_insert(t);
+    }
+
+    /* Worst case for a sorted run list; the last priority slot */
+    t = &sched_bench_tasks[ntasks - 1];
+    start = os_cputime_get32();
+    for (i = 0; i < SCHED_BENCH_ITERATIONS; i++) {
+        os_sched_sleep(t, OS_TIMEOUT_NEVER);
+        os_sched_wakeup(t);
+        if (os_sched_next_task() != cur) {
+            *ok = 0;
+        }
+    }
+    ticks = os_cputime_get32() - start;
+
+    for (i = 0; i < ntasks; i++) {
+        t = &sched_bench_tasks[i];
+        os_sched_sleep(t, OS_TIMEOUT_NEVER);
+        TAILQ_REMOVE(&g_os_sleep_list, t, t_os_list);
+    }
+
+    OS_EXIT_CRITICAL(sr);
+
+    return os_cputime_ticks_to_usecs(ticks);
+}
+
+TEST_CASE(os_sched_test_latency)
+{
+    uint32_t usecs;
+    int ntasks;
+    int ok;
+
+    for (ntasks = 1; ntasks <= SCHED_BENCH_MAX_TASKS; ntasks *= 2) {
+        ok = 1;
+        usecs = sched_bench_run(ntasks, &ok);
+        TEST_ASSERT(ok);
+        LOG_INFO(&testlog, LOG_MODULE_TEST,
+                 "%s sched bitmap=%d tasks=%d sleep+wakeup %lu ns",
+                 buildID, MYNEWT_VAL(OS_SCHED_BITMAP), ntasks,
+                 (unsigned long)(usecs * 1000 / SCHED_BENCH_ITERATIONS));
+    }
+}
+
+TEST_SUITE(testbench_sched_suite)
+{
+    os_sched_test_latency();
+}
+
+int
+testbench_sched()
+{
+    tu_suite_set_init_cb(testbench_sched_init, NULL);
+    LOG_DEBUG(&testlog, LOG_MODULE_TEST, "%s testbench_sched", buildID);
+    testbench_sched_suite();
+
+    return tu_any_failed;
+}
@@ -0,0 +1,133 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include <stdio.h>
+#include <string.h>
+#include "os/mynewt.h"
+#include "testutil/testutil.h"
+
+#include "testbench.h"
+
+/*
+ * Timer lateness benchmark. A batch of os_cputime timers is started to
+ * expire 1ms apart, and each callback notes how long after its expiry it
+ * got to run. The count, mean and worst case are reported in
+ * microseconds.
+ */
+#define TIMER_BENCH_CNT         16
+#define TIMER_BENCH_ROUNDS      8
+#define TIMER_BENCH_SPACING_US  1000
+
+static struct hal_timer timer_bench_timers[TIMER_BENCH_CNT];
+static volatile uint32_t timer_bench_fired;
+static uint32_t timer_bench_early;
+static uint32_t timer_bench_sum;
+static uint32_t timer_bench_max;
+
+void
+testbench_timer_init(void *arg)
+{
+    LOG_DEBUG(&testlog, LOG_MODULE_TEST, "%s testbench_timer suite init",
+              buildID);
+
+    tu_suite_set_pass_cb(testbench_ts_pass, NULL);
+    tu_suite_set_fail_cb(testbench_ts_fail, NULL);
+}
+
+static void
+timer_bench_cb(void *arg)
+{
+    struct hal_timer *timer;
+    int32_t late;
+
+    timer = arg;
+    late = os_cputime_get32() - timer->expiry;
+    if (late < 0) {
+        timer_bench_early++;
+        late = 0;
+    }
+    timer_bench_sum += late;
+    if (late > timer_bench_max) {
+        timer_bench_max = late;
+    }
+    timer_bench_fired++;
+}
+
+TEST_CASE(os_cputime_test_lateness)
+{
+    uint32_t cnt;
+    os_sr_t sr;
+    int rc;
+    int i;
+    int j;
+
+    for (i = 0; i < TIMER_BENCH_CNT; i++) {
+        os_cputime_timer_init(&timer_bench_timers[i], timer_bench_cb,
+                              &timer_bench_timers[i]);
+    }
+    timer_bench_fired = 0;
+    timer_bench_early = 0;
+    timer_bench_sum = 0;
+    timer_bench_max = 0;
+
+    for (i = 0; i < TIMER_BENCH_ROUNDS; i++) {
+        /* Started last to first, so every start changes the head. */
+        for (j = TIMER_BENCH_CNT - 1; j >= 0; j--) {
+            rc = os_cputime_timer_relative(&timer_bench_timers[j],
+                                           (j + 1) * TIMER_BENCH_SPACING_US);
+            TEST_ASSERT_FATAL(rc == 0);
+        }
+        os_time_delay(os_time_ms_to_ticks32(
+                (TIMER_BENCH_CNT + 1) * TIMER_BENCH_SPACING_US / 1000) + 1);
+    }
+
+    for (i = 0; i < TIMER_BENCH_CNT; i++) {
+        os_cputime_timer_stop(&timer_bench_timers[i]);
+    }
+
+    OS_ENTER_CRITICAL(sr);
+    cnt = timer_bench_fired;
+    OS_EXIT_CRITICAL(sr);
+
+    TEST_ASSERT(cnt == TIMER_BENCH_CNT * TIMER_BENCH_ROUNDS);
+    TEST_ASSERT(timer_bench_early == 0);
+    if (cnt == 0) {
+        return;
+    }
+
+    LOG_INFO(&testlog, LOG_MODULE_TEST,
+             "%s cputime timers=%lu late mean %lu us max %lu us",
+             buildID, (unsigned long)cnt,
+             (unsigned long)os_cputime_ticks_to_usecs(timer_bench_sum / cnt),
+             (unsigned long)os_cputime_ticks_to_usecs(timer_bench_max));
+}
+
+TEST_SUITE(testbench_timer_suite)
+{
+    os_cputime_test_lateness();
+}
+
+int
+testbench_timer()
+{
+    tu_suite_set_init_cb(testbench_timer_init, NULL);
+    LOG_DEBUG(&testlog, LOG_MODULE_TEST, "%s testbench_timer", buildID);
+    testbench_timer_suite();
+
+    return tu_any_failed;
+}
@@ -38,6 +38,7 @@ struct flash_area;
 #define BOOT_EBADARGS   7
 
 #define BOOT_TMPBUF_SZ  256
+#define BOOT_BUF_SZ     MYNEWT_VAL(BOOTUTIL_BUF_SZ)
 
 /*
  * Maintain state of copy progress.
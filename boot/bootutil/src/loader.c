@@ -50,6 +50,9 @@ static struct {
     struct flash_area scratch_sector;
 
     uint8_t write_sz;
+
+    /* Buffer for image validation and sector copies. */
+    uint8_t *buf;
 } boot_data;
 
 struct boot_status_table {
@@ -506,15 +509,7 @@ done:
 static int
 boot_image_check(struct image_header *hdr, const struct flash_area *fap)
 {
-    static void *tmpbuf;
-
-    if (!tmpbuf) {
-        tmpbuf = malloc(BOOT_TMPBUF_SZ);
-        if (!tmpbuf) {
-            return BOOT_ENOMEM;
-        }
-    }
-    if (bootutil_img_validate(hdr, fap, tmpbuf, BOOT_TMPBUF_SZ,
+    if (bootutil_img_validate(hdr, fap, boot_data.buf, BOOT_BUF_SZ,
                               NULL, 0, NULL)) {
         return BOOT_EBADIMAGE;
     }
@@ -690,9 +685,28 @@ done:
     return rc;
 }
 
+/**
+ * Indicates whether a buffer contains only erased (0xff) bytes.
+ */
+static int
+boot_data_is_erased(const uint8_t *buf, int len)
+{
+    int i;
+
+    for (i = 0; i < len; i++) {
+        if (buf[i] != 0xff) {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
 /**
  * Copies the contents of one flash region to another.  You must erase the
- * destination region prior to calling this function.
+ * destination region prior to calling this function.  Chunks which are still
+ * erased in the source are not written; image slots are mostly empty, and
+ * programming flash takes much longer than reading it.
  *
  * @param flash_area_id_src     The ID of the source flash area.
  * @param flash_area_id_dst     The ID of the destination flash area.
@@ -711,13 +725,13 @@ boot_copy_sector(int flash_area_id_src, int flash_area_id_dst,
     const struct flash_area *fap_src;
     const struct flash_area *fap_dst;
     uint32_t bytes_copied;
+    uint8_t *buf;
     int chunk_sz;
     int rc;
 
-    static uint8_t buf[1024];
-
     fap_src = NULL;
     fap_dst = NULL;
+    buf = boot_data.buf;
 
     rc = flash_area_open(flash_area_id_src, &fap_src);
     if (rc != 0) {
@@ -733,8 +747,8 @@ boot_copy_sector(int flash_area_id_src, int flash_area_id_dst,
 
     bytes_copied = 0;
     while (bytes_copied < sz) {
-        if (sz - bytes_copied > sizeof buf) {
-            chunk_sz = sizeof buf;
+        if (sz - bytes_copied > BOOT_BUF_SZ) {
+            chunk_sz = BOOT_BUF_SZ;
         } else {
             chunk_sz = sz - bytes_copied;
         }
@@ -745,10 +759,13 @@ boot_copy_sector(int flash_area_id_src, int flash_area_id_dst,
             goto done;
         }
 
-        rc = flash_area_write(fap_dst, off_dst + bytes_copied, buf, chunk_sz);
-        if (rc != 0) {
-            rc = BOOT_EFLASH;
-            goto done;
+        if (!boot_data_is_erased(buf, chunk_sz)) {
+            rc = flash_area_write(fap_dst, off_dst + bytes_copied, buf,
+                                  chunk_sz);
+            if (rc != 0) {
+                rc = BOOT_EFLASH;
+                goto done;
+            }
         }
 
         bytes_copied += chunk_sz;
@@ -1013,15 +1030,18 @@ boot_go(struct boot_rsp *rsp)
     int slot;
     int rc;
 
-    /* The array of slot sectors are defined here (as opposed to file scope) so
-     * that they don't get allocated for non-boot-loader apps.  This is
-     * necessary because the gcc option "-fdata-sections" doesn't seem to have
-     * any effect in older gcc versions (e.g., 4.8.4).
+    /* The array of slot sectors and the copy buffer are defined here (as
+     * opposed to file scope) so that they don't get allocated for
+     * non-boot-loader apps.  This is necessary because the gcc option
+     * "-fdata-sections" doesn't seem to have any effect in older gcc versions
+     * (e.g., 4.8.4).
      */
     static struct flash_area slot0_sectors[BOOT_MAX_IMG_SECTORS];
     static struct flash_area slot1_sectors[BOOT_MAX_IMG_SECTORS];
+    static uint8_t buf[BOOT_BUF_SZ];
     boot_data.imgs[0].sectors = slot0_sectors;
     boot_data.imgs[1].sectors = slot1_sectors;
+    boot_data.buf = buf;
 
     /* Determine the sector layout of the image slots and scratch area. */
     rc = boot_read_sectors();
@@ -52,6 +52,7 @@ TEST_CASE_DECL(boot_test_revert)
 TEST_CASE_DECL(boot_test_revert_continue)
 TEST_CASE_DECL(boot_test_permanent)
 TEST_CASE_DECL(boot_test_permanent_continue)
+TEST_CASE_DECL(boot_test_erased_chunk)
 
 TEST_SUITE(boot_test_main)
 {
@@ -74,6 +75,7 @@ TEST_SUITE(boot_test_main)
     boot_test_revert_continue();
     boot_test_permanent();
     boot_test_permanent_continue();
+    boot_test_erased_chunk();
 }
 
 int
@@ -0,0 +1,108 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "boot_test.h"
+
+/*
+ * Erased chunks in the image are skipped when swapping; make sure they still
+ * come out erased, and the data around them intact.
+ */
+TEST_CASE(boot_test_erased_chunk)
+{
+    struct boot_rsp rsp;
+    uint8_t buf[256];
+    uint32_t hole_off;
+    uint32_t hole_sz;
+    uint32_t addr;
+    uint32_t off;
+    int rc;
+    int i;
+
+    struct image_header hdr0 = {
+        .ih_magic = IMAGE_MAGIC,
+        .ih_tlv_size = 4 + 32,
+        .ih_hdr_size = BOOT_TEST_HEADER_SIZE,
+        .ih_img_size = 12 * 1024,
+        .ih_flags = IMAGE_F_SHA256,
+        .ih_ver = { 0, 2, 3, 4 },
+    };
+
+    struct image_header hdr1 = {
+        .ih_magic = IMAGE_MAGIC,
+        .ih_tlv_size = 4 + 32,
+        .ih_hdr_size = BOOT_TEST_HEADER_SIZE,
+        .ih_img_size = 150 * 1024,
+        .ih_flags = IMAGE_F_SHA256,
+        .ih_ver = { 1, 2, 3, 432 },
+    };
+
+    /* Not aligned to the copy buffer size. */
+    hole_off = 64 * 1024 + 100;
+    hole_sz = 8 * 1024;
+
+    boot_test_util_init_flash();
+    boot_test_util_write_image(&hdr0, 0);
+    boot_test_util_write_hash(&hdr0, 0);
+
+    /* Image in slot 1 with a hole punched in it. */
+    addr = boot_test_img_addrs[1].address;
+    rc = hal_flash_write(boot_test_img_addrs[1].flash_id, addr, &hdr1,
+                         sizeof hdr1);
+    TEST_ASSERT_FATAL(rc == 0);
+    addr += hdr1.ih_hdr_size;
+    for (off = 0; off < hdr1.ih_img_size; off += sizeof buf) {
+        for (i = 0; i < sizeof buf; i++) {
+            if (off + i >= hole_off && off + i < hole_off + hole_sz) {
+                buf[i] = 0xff;
+            } else {
+                buf[i] = boot_test_util_byte_at(1, off + i);
+            }
+        }
+        rc = hal_flash_write(boot_test_img_addrs[1].flash_id, addr + off,
+                             buf, sizeof buf);
+        TEST_ASSERT_FATAL(rc == 0);
+    }
+    boot_test_util_write_hash(&hdr1, 1);
+
+    rc = boot_set_pending(0);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    rc = boot_go(&rsp);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(memcmp(rsp.br_hdr, &hdr1, sizeof hdr1) == 0);
+
+    addr = boot_test_img_addrs[0].address + hdr1.ih_hdr_size;
+    for (off = 0; off < hdr1.ih_img_size; off += sizeof buf) {
+        rc = hal_flash_read(boot_test_img_addrs[0].flash_id, addr + off, buf,
+                            sizeof buf);
+        TEST_ASSERT_FATAL(rc == 0);
+        for (i = 0; i < sizeof buf && off + i < hdr1.ih_img_size; i++) {
+            if (off + i >= hole_off && off + i < hole_off + hole_sz) {
+                TEST_ASSERT_FATAL(buf[i] == 0xff, "off %d", (int)(off + i));
+            } else {
+                TEST_ASSERT_FATAL(buf[i] ==
+                                  boot_test_util_byte_at(1, off + i),
+                                  "off %d", (int)(off + i));
+            }
+        }
+    }
+
+    /* The old image went to slot 1 unchanged. */
+    boot_test_util_verify_area(boot_test_area_descs + 3, &hdr0,
+                               boot_test_img_addrs[1].address, 0);
+}
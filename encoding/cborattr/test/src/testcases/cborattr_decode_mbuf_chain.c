@@ -0,0 +1,202 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include <sys/time.h>
+#include "test_cborattr.h"
+#include "tinycbor/cbor_mbuf_writer.h"
+
+/*
+ * Decodes the same payload split over chains of 1, 8 and 64 mbufs, and
+ * reports decode throughput for each.
+ */
+#define MBUF_CHAIN_ARR_CNT      64
+#define MBUF_CHAIN_MAX_MBUFS    64
+#define MBUF_CHAIN_BUF_SZ       512
+#define MBUF_CHAIN_ITERATIONS   100
+
+#define MBUF_CHAIN_MEMBLOCK_SZ                                  \
+    (MBUF_CHAIN_BUF_SZ + sizeof(struct os_mbuf) +               \
+     sizeof(struct os_mbuf_pkthdr))
+#define MBUF_CHAIN_MBUF_CNT     (MBUF_CHAIN_MAX_MBUFS + 1)
+
+static os_membuf_t mbuf_chain_mem[
+    OS_MEMPOOL_SIZE(MBUF_CHAIN_MBUF_CNT, MBUF_CHAIN_MEMBLOCK_SZ)];
+static struct os_mempool mbuf_chain_mempool;
+static struct os_mbuf_pool mbuf_chain_mbuf_pool;
+
+static uint8_t mbuf_chain_flat[MBUF_CHAIN_BUF_SZ];
+static int mbuf_chain_flat_len;
+
+static int
+mbuf_chain_wr(struct cbor_encoder_writer *cew, const char *data, int len)
+{
+    assert(mbuf_chain_flat_len + len <= sizeof(mbuf_chain_flat));
+    memcpy(mbuf_chain_flat + mbuf_chain_flat_len, data, len);
+    mbuf_chain_flat_len += len;
+    return 0;
+}
+
+static void
+mbuf_chain_encode(void)
+{
+    struct cbor_encoder_writer writer = {
+        .write = mbuf_chain_wr
+    };
+    CborEncoder encoder;
+    CborEncoder data;
+    CborEncoder array;
+    int i;
+
+    mbuf_chain_flat_len = 0;
+    cbor_encoder_init(&encoder, &writer, 0);
+    cbor_encoder_create_map(&encoder, &data, CborIndefiniteLength);
+
+    cbor_encode_text_stringz(&data, "a");
+    cbor_encoder_create_array(&data, &array, CborIndefiniteLength);
+    for (i = 0; i < MBUF_CHAIN_ARR_CNT; i++) {
+        cbor_encode_int(&array, i * 1000);
+    }
+    cbor_encoder_close_container(&data, &array);
+
+    cbor_encoder_close_container(&encoder, &data);
+}
+
+/*
+ * Builds a chain of 'cnt' mbufs holding the encoded payload.
+ */
+static struct os_mbuf *
+mbuf_chain_build(int cnt)
+{
+    struct os_mbuf *head;
+    struct os_mbuf *m;
+    int off;
+    int len;
+    int rc;
+    int i;
+
+    TEST_ASSERT_FATAL(mbuf_chain_flat_len >= cnt);
+
+    head = os_mbuf_get_pkthdr(&mbuf_chain_mbuf_pool, 0);
+    TEST_ASSERT_FATAL(head != NULL);
+
+    for (i = 0; i < cnt; i++) {
+        off = mbuf_chain_flat_len * i / cnt;
+        len = mbuf_chain_flat_len * (i + 1) / cnt - off;
+        if (i == 0) {
+            m = head;
+        } else {
+            m = os_mbuf_get(&mbuf_chain_mbuf_pool, 0);
+            TEST_ASSERT_FATAL(m != NULL);
+        }
+        memcpy(m->om_data, mbuf_chain_flat + off, len);
+        m->om_len = len;
+        if (m != head) {
+            os_mbuf_concat(head, m);
+        }
+    }
+    OS_MBUF_PKTHDR(head)->omp_len = mbuf_chain_flat_len;
+
+    rc = 0;
+    for (m = head; m != NULL; m = SLIST_NEXT(m, om_next)) {
+        rc++;
+    }
+    TEST_ASSERT(rc == cnt);
+
+    return head;
+}
+
+/*
+ * Returns decode throughput in kB/s.
+ */
+static uint32_t
+mbuf_chain_decode(int cnt)
+{
+    int64_t arr_data[MBUF_CHAIN_ARR_CNT];
+    struct timeval start;
+    struct timeval end;
+    struct os_mbuf *m;
+    uint32_t usecs;
+    int arr_cnt;
+    int rc;
+    int i;
+    int j;
+    struct cbor_attr_t test_attrs[] = {
+        [0] = {
+            .attribute = "a",
+            .type = CborAttrArrayType,
+            .addr.array.element_type = CborAttrIntegerType,
+            .addr.array.arr.integers.store = arr_data,
+            .addr.array.count = &arr_cnt,
+            .addr.array.maxlen = MBUF_CHAIN_ARR_CNT,
+            .nodefault = true
+        },
+        [1] = {
+            .attribute = NULL
+        }
+    };
+
+    m = mbuf_chain_build(cnt);
+
+    gettimeofday(&start, NULL);
+    for (i = 0; i < MBUF_CHAIN_ITERATIONS; i++) {
+        arr_cnt = 0;
+        rc = cbor_read_mbuf_attrs(m, 0, mbuf_chain_flat_len, test_attrs);
+        TEST_ASSERT(rc == 0);
+        TEST_ASSERT(arr_cnt == MBUF_CHAIN_ARR_CNT);
+    }
+    gettimeofday(&end, NULL);
+
+    for (j = 0; j < MBUF_CHAIN_ARR_CNT; j++) {
+        TEST_ASSERT(arr_data[j] == j * 1000);
+    }
+
+    usecs = (end.tv_sec - start.tv_sec) * 1000000 +
+            (end.tv_usec - start.tv_usec);
+    if (usecs == 0) {
+        usecs = 1;
+    }
+
+    os_mbuf_free_chain(m);
+
+    return (uint64_t)mbuf_chain_flat_len * MBUF_CHAIN_ITERATIONS * 1000000 /
+           usecs / 1024;
+}
+
+TEST_CASE(test_cborattr_decode_mbuf_chain)
+{
+    uint32_t kbps[3];
+    int rc;
+
+    rc = os_mempool_init(&mbuf_chain_mempool, MBUF_CHAIN_MBUF_CNT,
+                         MBUF_CHAIN_MEMBLOCK_SZ, mbuf_chain_mem, "cbor_mbuf");
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = os_mbuf_pool_init(&mbuf_chain_mbuf_pool, &mbuf_chain_mempool,
+                           MBUF_CHAIN_MEMBLOCK_SZ, MBUF_CHAIN_MBUF_CNT);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    mbuf_chain_encode();
+
+    kbps[0] = mbuf_chain_decode(1);
+    kbps[1] = mbuf_chain_decode(8);
+    kbps[2] = mbuf_chain_decode(MBUF_CHAIN_MAX_MBUFS);
+
+    TEST_PASS("%d byte payload decode: 1 mbuf %u kB/s, 8 mbufs %u kB/s, "
+              "%d mbufs %u kB/s", mbuf_chain_flat_len,
+              (unsigned int)kbps[0], (unsigned int)kbps[1],
+              MBUF_CHAIN_MAX_MBUFS, (unsigned int)kbps[2]);
+}
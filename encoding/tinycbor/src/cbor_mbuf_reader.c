@@ -17,18 +17,128 @@
  * under the License.
  */
 
+#include <string.h>
 #include "os/mynewt.h"
 #include <tinycbor/cbor_mbuf_reader.h>
 #include <tinycbor/compilersupport_p.h>
 
+/*
+ * Returns the mbuf containing offset 'off' of the chain, and the offset of
+ * that data within the mbuf in 'moff'. The decoder mostly reads forward, so
+ * the search is started from the mbuf found last time whenever possible,
+ * instead of from the head of the chain.
+ */
+static struct os_mbuf *
+cbor_mbuf_reader_seek(struct cbor_mbuf_reader *cb, int off, int *moff)
+{
+    struct os_mbuf *m;
+    int start;
+
+    if (cb->cur_m != NULL && off >= cb->cur_off) {
+        m = cb->cur_m;
+        start = cb->cur_off;
+    } else {
+        m = cb->m;
+        start = 0;
+    }
+
+    while (m != NULL && off >= start + m->om_len) {
+        start += m->om_len;
+        m = SLIST_NEXT(m, om_next);
+    }
+
+    if (m != NULL) {
+        cb->cur_m = m;
+        cb->cur_off = start;
+        *moff = off - start;
+    }
+    return m;
+}
+
+/*
+ * Returns a pointer to 'len' bytes of data at 'offset', if they are stored
+ * contiguously within one mbuf. Otherwise returns NULL.
+ */
+static const uint8_t *
+cbor_mbuf_reader_ptr(struct cbor_mbuf_reader *cb, int offset, int len)
+{
+    struct os_mbuf *m;
+    int moff;
+
+    m = cbor_mbuf_reader_seek(cb, offset + cb->init_off, &moff);
+    if (m == NULL || moff + len > m->om_len) {
+        return NULL;
+    }
+    return m->om_data + moff;
+}
+
+/*
+ * Copies (or compares, if 'cmp' is set) 'len' bytes at 'offset' into/with
+ * 'buf'. Returns 0 on success/match.
+ */
+static int
+cbor_mbuf_reader_access(struct cbor_mbuf_reader *cb, uint8_t *buf,
+                        int offset, size_t len, int cmp)
+{
+    struct os_mbuf *m;
+    size_t chunk;
+    int moff;
+    int rc;
+
+    m = cbor_mbuf_reader_seek(cb, offset + cb->init_off, &moff);
+    while (len > 0) {
+        if (m == NULL) {
+            return -1;
+        }
+        chunk = m->om_len - moff;
+        if (chunk > len) {
+            chunk = len;
+        }
+        if (cmp) {
+            rc = memcmp(m->om_data + moff, buf, chunk);
+            if (rc != 0) {
+                return rc;
+            }
+        } else {
+            memcpy(buf, m->om_data + moff, chunk);
+        }
+        buf += chunk;
+        len -= chunk;
+        if (len > 0) {
+            cb->cur_off += m->om_len;
+            m = SLIST_NEXT(m, om_next);
+            cb->cur_m = m;
+            moff = 0;
+        }
+    }
+    return 0;
+}
+
+static void
+cbor_mbuf_reader_read(struct cbor_mbuf_reader *cb, void *dst, int offset,
+                      int len)
+{
+    const uint8_t *ptr;
+
+    ptr = cbor_mbuf_reader_ptr(cb, offset, len);
+    if (ptr != NULL) {
+        memcpy(dst, ptr, len);
+    } else {
+        cbor_mbuf_reader_access(cb, dst, offset, len, 0);
+    }
+}
+
 static uint8_t
 cbor_mbuf_reader_get8(struct cbor_decoder_reader *d, int offset)
 {
-    uint8_t val;
+    const uint8_t *ptr;
     struct cbor_mbuf_reader *cb = (struct cbor_mbuf_reader *) d;
 
-    os_mbuf_copydata(cb->m, offset + cb->init_off, sizeof(val), &val);
-    return val;
+    ptr = cbor_mbuf_reader_ptr(cb, offset, sizeof(uint8_t));
+    if (ptr == NULL) {
+        return 0;
+    }
+    return *ptr;
 }
 
 static uint16_t
@@ -37,7 +147,7 @@ cbor_mbuf_reader_get16(struct cbor_decoder_reader *d, int offset)
     uint16_t val;
     struct cbor_mbuf_reader *cb = (struct cbor_mbuf_reader *) d;
 
-    os_mbuf_copydata(cb->m, offset + cb->init_off, sizeof(val), &val);
+    cbor_mbuf_reader_read(cb, &val, offset, sizeof(val));
     return cbor_ntohs(val);
 }
 
@@ -47,7 +157,7 @@ cbor_mbuf_reader_get32(struct cbor_decoder_reader *d, int offset)
     uint32_t val;
     struct cbor_mbuf_reader *cb = (struct cbor_mbuf_reader *) d;
 
-    os_mbuf_copydata(cb->m, offset + cb->init_off, sizeof(val), &val);
+    cbor_mbuf_reader_read(cb, &val, offset, sizeof(val));
     return cbor_ntohl(val);
 }
 
@@ -57,7 +167,7 @@ cbor_mbuf_reader_get64(struct cbor_decoder_reader *d, int offset)
     uint64_t val;
     struct cbor_mbuf_reader *cb = (struct cbor_mbuf_reader *) d;
 
-    os_mbuf_copydata(cb->m, offset + cb->init_off, sizeof(val), &val);
+    cbor_mbuf_reader_read(cb, &val, offset, sizeof(val));
     return cbor_ntohll(val);
 }
 
@@ -66,7 +176,8 @@ cbor_mbuf_reader_cmp(struct cbor_decoder_reader *d, char *buf, int offset,
                      size_t len)
 {
     struct cbor_mbuf_reader *cb = (struct cbor_mbuf_reader *) d;
-    return os_mbuf_cmpf(cb->m, offset + cb->init_off, buf, len) == 0;
+
+    return cbor_mbuf_reader_access(cb, (uint8_t *)buf, offset, len, 1) == 0;
 }
 
 static uintptr_t
@@ -76,7 +187,7 @@ cbor_mbuf_reader_cpy(struct cbor_decoder_reader *d, char *dst, int offset,
     int rc;
     struct cbor_mbuf_reader *cb = (struct cbor_mbuf_reader *) d;
 
-    rc = os_mbuf_copydata(cb->m, offset + cb->init_off, len, dst);
+    rc = cbor_mbuf_reader_access(cb, (uint8_t *)dst, offset, len, 0);
     if (rc == 0) {
         return true;
     }
@@ -100,5 +211,7 @@ cbor_mbuf_reader_init(struct cbor_mbuf_reader *cb, struct os_mbuf *m,
     hdr = OS_MBUF_PKTHDR(m);
     cb->m = m;
     cb->init_off = initial_offset;
+    cb->cur_m = NULL;
+    cb->cur_off = 0;
     cb->r.message_size = hdr->omp_len - initial_offset;
 }
@@ -31,6 +31,7 @@
 
 #include <fs/fs.h>
 #include <fs/fs_if.h>
+#include <stats/stats.h>
 
 static int fatfs_open(const char *path, uint8_t access_flags,
   struct fs_file **out_file);
@@ -74,6 +75,28 @@ struct fatfs_dirent {
  */
 static struct fatfs_dirent dirent;
 
+STATS_SECT_START(fatfs_stats)
+    STATS_SECT_ENTRY(disk_rd)
+    STATS_SECT_ENTRY(disk_wr)
+    STATS_SECT_ENTRY(cache_hit)
+    STATS_SECT_ENTRY(cache_miss)
+    STATS_SECT_ENTRY(cache_ra)
+    STATS_SECT_ENTRY(cache_ra_hit)
+    STATS_SECT_ENTRY(cache_wr_defer)
+    STATS_SECT_ENTRY(cache_wb)
+STATS_SECT_END
+static STATS_SECT_DECL(fatfs_stats) fatfs_stats;
+STATS_NAME_START(fatfs_stats)
+    STATS_NAME(fatfs_stats, disk_rd)
+    STATS_NAME(fatfs_stats, disk_wr)
+    STATS_NAME(fatfs_stats, cache_hit)
+    STATS_NAME(fatfs_stats, cache_miss)
+    STATS_NAME(fatfs_stats, cache_ra)
+    STATS_NAME(fatfs_stats, cache_ra_hit)
+    STATS_NAME(fatfs_stats, cache_wr_defer)
+    STATS_NAME(fatfs_stats, cache_wb)
+STATS_NAME_END(fatfs_stats)
+
 static struct fs_ops fatfs_ops = {
     .f_open = fatfs_open,
     .f_close = fatfs_close,
@@ -508,8 +531,8 @@ static struct disk_ops *dops_from_handle(BYTE pdrv)
     return NULL;
 }
 
-DRESULT
-disk_read(BYTE pdrv, BYTE* buff, DWORD sector, UINT count)
+static DRESULT
+fatfs_disk_read(BYTE pdrv, BYTE* buff, DWORD sector, UINT count)
 {
     int rc;
     uint32_t address;
@@ -525,6 +548,7 @@ disk_read(BYTE pdrv, BYTE* buff, DWORD sector, UINT count)
         return STA_NOINIT;
     }
 
+    STATS_INC(fatfs_stats, disk_rd);
     rc = dops->read(pdrv, address, (void *) buff, num_bytes);
     if (rc < 0) {
         return STA_NOINIT;
@@ -533,8 +557,8 @@ disk_read(BYTE pdrv, BYTE* buff, DWORD sector, UINT count)
     return RES_OK;
 }
 
-DRESULT
-disk_write(BYTE pdrv, const BYTE* buff, DWORD sector, UINT count)
+static DRESULT
+fatfs_disk_write(BYTE pdrv, const BYTE* buff, DWORD sector, UINT count)
 {
     int rc;
     uint32_t address;
@@ -550,6 +574,7 @@ disk_write(BYTE pdrv, const BYTE* buff, DWORD sector, UINT count)
         return STA_NOINIT;
     }
 
+    STATS_INC(fatfs_stats, disk_wr);
     rc = dops->write(pdrv, address, (const void *) buff, num_bytes);
     if (rc < 0) {
         return STA_NOINIT;
@@ -558,10 +583,414 @@ disk_write(BYTE pdrv, const BYTE* buff, DWORD sector, UINT count)
     return RES_OK;
 }
 
+#if MYNEWT_VAL(FATFS_CACHE_SECTORS) > 0
+
+/*
+ * Sector cache between FatFs and the disk driver.
+ *
+ * Single sector accesses, which is what FatFs does for FAT, directory and
+ * partial file data, go through an LRU list of cached sectors. With
+ * FATFS_CACHE_WRITE_BACK, writes to them are held in the cache until
+ * CTRL_SYNC (f_sync(), f_close() etc.) or eviction; the write-back is done
+ * in sector order, with runs of consecutive sectors merged into one
+ * transfer. Multi-sector requests are passed to the driver as they are.
+ *
+ * When single sector reads are sequential, the following sectors are read
+ * in the same transfer into the transfer buffer, and served from there.
+ * That buffer is also used for merging writes, which discards readahead
+ * data.
+ */
+#define FATFS_SECTOR_SZ             512
+#define FATFS_CACHE_XFER_CNT        MYNEWT_VAL(FATFS_CACHE_XFER_SECTORS)
+
+#define FATFS_CACHE_F_VALID         0x01
+#define FATFS_CACHE_F_DIRTY         0x02
+
+struct fatfs_cache_ent {
+    TAILQ_ENTRY(fatfs_cache_ent) fce_lru;
+    DWORD fce_sector;
+    BYTE fce_pdrv;
+    uint8_t fce_flags;
+};
+
+static struct fatfs_cache_ent fatfs_cache_ents[MYNEWT_VAL(FATFS_CACHE_SECTORS)];
+static uint8_t fatfs_cache_data[MYNEWT_VAL(FATFS_CACHE_SECTORS)]
+                               [FATFS_SECTOR_SZ];
+
+/* Most recently used first. Invalid entries are at the tail. */
+static TAILQ_HEAD(fatfs_cache_ent_list, fatfs_cache_ent) fatfs_cache_lru =
+    TAILQ_HEAD_INITIALIZER(fatfs_cache_lru);
+
+#define FATFS_CACHE_DATA(ent)   fatfs_cache_data[(ent) - fatfs_cache_ents]
+
+#if FATFS_CACHE_XFER_CNT > 1
+static uint8_t fatfs_cache_xfer[FATFS_CACHE_XFER_CNT][FATFS_SECTOR_SZ];
+
+/* What readahead data there is in fatfs_cache_xfer. */
+static BYTE fatfs_cache_ra_pdrv;
+static DWORD fatfs_cache_ra_sector;
+static UINT fatfs_cache_ra_cnt;
+
+/* Where the next single sector read is, if reading sequentially. */
+static BYTE fatfs_cache_seq_pdrv;
+static DWORD fatfs_cache_seq_sector;
+#endif
+
+static void
+fatfs_cache_init(void)
+{
+    int i;
+
+    for (i = 0; i < MYNEWT_VAL(FATFS_CACHE_SECTORS); i++) {
+        TAILQ_INSERT_TAIL(&fatfs_cache_lru, &fatfs_cache_ents[i], fce_lru);
+    }
+}
+
+static struct fatfs_cache_ent *
+fatfs_cache_find(BYTE pdrv, DWORD sector)
+{
+    struct fatfs_cache_ent *ent;
+
+    TAILQ_FOREACH(ent, &fatfs_cache_lru, fce_lru) {
+        if (!(ent->fce_flags & FATFS_CACHE_F_VALID)) {
+            break;
+        }
+        if (ent->fce_sector == sector && ent->fce_pdrv == pdrv) {
+            return ent;
+        }
+    }
+    return NULL;
+}
+
+static void
+fatfs_cache_touch(struct fatfs_cache_ent *ent)
+{
+    if (TAILQ_FIRST(&fatfs_cache_lru) != ent) {
+        TAILQ_REMOVE(&fatfs_cache_lru, ent, fce_lru);
+        TAILQ_INSERT_HEAD(&fatfs_cache_lru, ent, fce_lru);
+    }
+}
+
+static void
+fatfs_cache_inval(struct fatfs_cache_ent *ent)
+{
+    ent->fce_flags = 0;
+    TAILQ_REMOVE(&fatfs_cache_lru, ent, fce_lru);
+    TAILQ_INSERT_TAIL(&fatfs_cache_lru, ent, fce_lru);
+}
+
+static void
+fatfs_cache_ra_inval(BYTE pdrv, DWORD sector, UINT count)
+{
+#if FATFS_CACHE_XFER_CNT > 1
+    if (fatfs_cache_ra_cnt && fatfs_cache_ra_pdrv == pdrv &&
+        sector < fatfs_cache_ra_sector + fatfs_cache_ra_cnt &&
+        fatfs_cache_ra_sector < sector + count) {
+        fatfs_cache_ra_cnt = 0;
+    }
+#endif
+}
+
+/*
+ * Lowest numbered dirty sector of the drive, NULL if there are none.
+ */
+static struct fatfs_cache_ent *
+fatfs_cache_first_dirty(BYTE pdrv)
+{
+    struct fatfs_cache_ent *ent;
+    struct fatfs_cache_ent *first;
+    int i;
+
+    first = NULL;
+    for (i = 0; i < MYNEWT_VAL(FATFS_CACHE_SECTORS); i++) {
+        ent = &fatfs_cache_ents[i];
+        if ((ent->fce_flags & FATFS_CACHE_F_DIRTY) && ent->fce_pdrv == pdrv &&
+            (!first || ent->fce_sector < first->fce_sector)) {
+            first = ent;
+        }
+    }
+    return first;
+}
+
+/*
+ * Writes a dirty sector, along with the dirty sectors which follow it if
+ * there is room in the transfer buffer.
+ */
+static DRESULT
+fatfs_cache_write_back(struct fatfs_cache_ent *ent)
+{
+#if FATFS_CACHE_XFER_CNT > 1
+    struct fatfs_cache_ent *run[FATFS_CACHE_XFER_CNT];
+    struct fatfs_cache_ent *next;
+    DRESULT res;
+    UINT cnt;
+    UINT i;
+
+    run[0] = ent;
+    for (cnt = 1; cnt < FATFS_CACHE_XFER_CNT; cnt++) {
+        next = fatfs_cache_find(ent->fce_pdrv, ent->fce_sector + cnt);
+        if (!next || !(next->fce_flags & FATFS_CACHE_F_DIRTY)) {
+            break;
+        }
+        run[cnt] = next;
+    }
+    if (cnt == 1) {
+        res = fatfs_disk_write(ent->fce_pdrv, FATFS_CACHE_DATA(ent),
+                               ent->fce_sector, 1);
+    } else {
+        fatfs_cache_ra_cnt = 0;
+        for (i = 0; i < cnt; i++) {
+            memcpy(fatfs_cache_xfer[i], FATFS_CACHE_DATA(run[i]),
+                   FATFS_SECTOR_SZ);
+        }
+        res = fatfs_disk_write(ent->fce_pdrv, fatfs_cache_xfer[0],
+                               ent->fce_sector, cnt);
+    }
+    if (res != RES_OK) {
+        return res;
+    }
+    for (i = 0; i < cnt; i++) {
+        run[i]->fce_flags &= ~FATFS_CACHE_F_DIRTY;
+    }
+    STATS_INCN(fatfs_stats, cache_wb, cnt);
+    return RES_OK;
+#else
+    DRESULT res;
+
+    res = fatfs_disk_write(ent->fce_pdrv, FATFS_CACHE_DATA(ent),
+                           ent->fce_sector, 1);
+    if (res != RES_OK) {
+        return res;
+    }
+    ent->fce_flags &= ~FATFS_CACHE_F_DIRTY;
+    STATS_INC(fatfs_stats, cache_wb);
+    return RES_OK;
+#endif
+}
+
+static DRESULT
+fatfs_cache_sync(BYTE pdrv)
+{
+    struct fatfs_cache_ent *ent;
+    DRESULT res;
+
+    while ((ent = fatfs_cache_first_dirty(pdrv))) {
+        res = fatfs_cache_write_back(ent);
+        if (res != RES_OK) {
+            return res;
+        }
+    }
+    return RES_OK;
+}
+
+/*
+ * Takes the least recently used entry for a new sector, writing it back
+ * first if needed. The entry is not valid until its data is filled in.
+ */
+static struct fatfs_cache_ent *
+fatfs_cache_alloc(void)
+{
+    struct fatfs_cache_ent *ent;
+
+    ent = TAILQ_LAST(&fatfs_cache_lru, fatfs_cache_ent_list);
+    if (ent->fce_flags & FATFS_CACHE_F_DIRTY) {
+        if (fatfs_cache_write_back(ent) != RES_OK) {
+            return NULL;
+        }
+    }
+    ent->fce_flags = 0;
+    return ent;
+}
+
+static void
+fatfs_cache_fill(struct fatfs_cache_ent *ent, BYTE pdrv, DWORD sector,
+                 const BYTE *buff, uint8_t flags)
+{
+    memcpy(FATFS_CACHE_DATA(ent), buff, FATFS_SECTOR_SZ);
+    ent->fce_pdrv = pdrv;
+    ent->fce_sector = sector;
+    ent->fce_flags = FATFS_CACHE_F_VALID | flags;
+    fatfs_cache_touch(ent);
+}
+
+/*
+ * Reads sector into buff from readahead data, reading ahead first if the
+ * access is sequential. Returns 0 if this was done.
+ */
+static int
+fatfs_cache_ra_read(BYTE pdrv, BYTE *buff, DWORD sector)
+{
+#if FATFS_CACHE_XFER_CNT > 1
+    int seq;
+
+    seq = (fatfs_cache_seq_pdrv == pdrv && fatfs_cache_seq_sector == sector);
+    fatfs_cache_seq_pdrv = pdrv;
+    fatfs_cache_seq_sector = sector + 1;
+
+    if (!fatfs_cache_ra_cnt || fatfs_cache_ra_pdrv != pdrv ||
+        sector < fatfs_cache_ra_sector ||
+        sector >= fatfs_cache_ra_sector + fatfs_cache_ra_cnt) {
+        if (!seq) {
+            return -1;
+        }
+        /*
+         * Read the following sectors along with this one. Sectors which
+         * are dirty in the cache get read too, but cache is looked at
+         * before readahead data.
+         */
+        fatfs_cache_ra_cnt = 0;
+        if (fatfs_disk_read(pdrv, fatfs_cache_xfer[0], sector,
+                            FATFS_CACHE_XFER_CNT) != RES_OK) {
+            return -1;
+        }
+        STATS_INC(fatfs_stats, cache_ra);
+        fatfs_cache_ra_pdrv = pdrv;
+        fatfs_cache_ra_sector = sector;
+        fatfs_cache_ra_cnt = FATFS_CACHE_XFER_CNT;
+    } else {
+        STATS_INC(fatfs_stats, cache_ra_hit);
+    }
+    memcpy(buff, fatfs_cache_xfer[sector - fatfs_cache_ra_sector],
+           FATFS_SECTOR_SZ);
+    return 0;
+#else
+    return -1;
+#endif
+}
+
+static DRESULT
+fatfs_cache_read(BYTE pdrv, BYTE *buff, DWORD sector, UINT count)
+{
+    struct fatfs_cache_ent *ent;
+    DRESULT res;
+    int i;
+
+    if (count > 1) {
+        res = fatfs_disk_read(pdrv, buff, sector, count);
+        if (res != RES_OK) {
+            return res;
+        }
+        /* Data not written back yet is newer than what's on disk. */
+        for (i = 0; i < MYNEWT_VAL(FATFS_CACHE_SECTORS); i++) {
+            ent = &fatfs_cache_ents[i];
+            if ((ent->fce_flags & FATFS_CACHE_F_DIRTY) &&
+                ent->fce_pdrv == pdrv && ent->fce_sector >= sector &&
+                ent->fce_sector < sector + count) {
+                memcpy(buff + (ent->fce_sector - sector) * FATFS_SECTOR_SZ,
+                       FATFS_CACHE_DATA(ent), FATFS_SECTOR_SZ);
+            }
+        }
+        return RES_OK;
+    }
+
+    ent = fatfs_cache_find(pdrv, sector);
+    if (ent) {
+        STATS_INC(fatfs_stats, cache_hit);
+        memcpy(buff, FATFS_CACHE_DATA(ent), FATFS_SECTOR_SZ);
+        fatfs_cache_touch(ent);
+        return RES_OK;
+    }
+    STATS_INC(fatfs_stats, cache_miss);
+
+    /* Streaming data is not put to cache, so it won't push out metadata. */
+    if (!fatfs_cache_ra_read(pdrv, buff, sector)) {
+        return RES_OK;
+    }
+
+    res = fatfs_disk_read(pdrv, buff, sector, 1);
+    if (res != RES_OK) {
+        return res;
+    }
+    ent = fatfs_cache_alloc();
+    if (ent) {
+        fatfs_cache_fill(ent, pdrv, sector, buff, 0);
+    }
+    return RES_OK;
+}
+
+static DRESULT
+fatfs_cache_write(BYTE pdrv, const BYTE *buff, DWORD sector, UINT count)
+{
+    struct fatfs_cache_ent *ent;
+    DRESULT res;
+    UINT i;
+
+    fatfs_cache_ra_inval(pdrv, sector, count);
+
+    if (count > 1) {
+        res = fatfs_disk_write(pdrv, buff, sector, count);
+        if (res != RES_OK) {
+            return res;
+        }
+        for (i = 0; i < count; i++) {
+            ent = fatfs_cache_find(pdrv, sector + i);
+            if (ent) {
+                fatfs_cache_fill(ent, pdrv, sector + i,
+                                 buff + i * FATFS_SECTOR_SZ, 0);
+            }
+        }
+        return RES_OK;
+    }
+
+    ent = fatfs_cache_find(pdrv, sector);
+    if (!ent) {
+        ent = fatfs_cache_alloc();
+    }
+#if MYNEWT_VAL(FATFS_CACHE_WRITE_BACK)
+    if (ent) {
+        STATS_INC(fatfs_stats, cache_wr_defer);
+        fatfs_cache_fill(ent, pdrv, sector, buff, FATFS_CACHE_F_DIRTY);
+        return RES_OK;
+    }
+#endif
+    res = fatfs_disk_write(pdrv, buff, sector, 1);
+    if (res != RES_OK) {
+        if (ent) {
+            fatfs_cache_inval(ent);
+        }
+        return res;
+    }
+    if (ent) {
+        fatfs_cache_fill(ent, pdrv, sector, buff, 0);
+    }
+    return RES_OK;
+}
+
+#endif /* MYNEWT_VAL(FATFS_CACHE_SECTORS) > 0 */
+
+DRESULT
+disk_read(BYTE pdrv, BYTE* buff, DWORD sector, UINT count)
+{
+#if MYNEWT_VAL(FATFS_CACHE_SECTORS) > 0
+    return fatfs_cache_read(pdrv, buff, sector, count);
+#else
+    return fatfs_disk_read(pdrv, buff, sector, count);
+#endif
+}
+
+DRESULT
+disk_write(BYTE pdrv, const BYTE* buff, DWORD sector, UINT count)
+{
+#if MYNEWT_VAL(FATFS_CACHE_SECTORS) > 0
+    return fatfs_cache_write(pdrv, buff, sector, count);
+#else
+    return fatfs_disk_write(pdrv, buff, sector, count);
+#endif
+}
+
 DRESULT
 disk_ioctl(BYTE pdrv, BYTE cmd, void* buff)
 {
-    return RES_OK;
+    switch (cmd) {
+    case CTRL_SYNC:
+#if MYNEWT_VAL(FATFS_CACHE_SECTORS) > 0
+        return fatfs_cache_sync(pdrv);
+#else
+        return RES_OK;
+#endif
+    default:
+        return RES_OK;
+    }
 }
 
 /* FIXME: _FS_NORTC=1 because there is not hal_rtc interface */
@@ -574,8 +1003,19 @@ get_fattime(void)
 void
 fatfs_pkg_init(void)
 {
+    int rc;
+
     /* Ensure this function only gets called by sysinit. */
     SYSINIT_ASSERT_ACTIVE();
 
+    rc = stats_init_and_reg(STATS_HDR(fatfs_stats),
+      STATS_SIZE_INIT_PARMS(fatfs_stats, STATS_SIZE_32),
+      STATS_NAME_INIT_PARMS(fatfs_stats), "fatfs");
+    SYSINIT_PANIC_ASSERT(rc == 0);
+
+#if MYNEWT_VAL(FATFS_CACHE_SECTORS) > 0
+    fatfs_cache_init();
+#endif
+
     fs_register(&fatfs_ops);
 }
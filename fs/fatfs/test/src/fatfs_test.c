@@ -0,0 +1,216 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <assert.h>
+#include "os/mynewt.h"
+#include <hal/hal_flash.h>
+#include <disk/disk.h>
+#include "fatfs_test.h"
+
+struct fatfs_test_disk_stats fatfs_test_disk_stats;
+
+static uint8_t fatfs_test_erase_buf[FATFS_TEST_ERASE_SZ];
+
+/* Where the disk sits in flash. */
+static uint8_t fatfs_test_flash_id;
+static uint32_t fatfs_test_flash_off;
+
+static int
+fatfs_test_disk_read(uint8_t id, uint32_t addr, void *buf, uint32_t len)
+{
+    if (addr + len > FATFS_TEST_SECTOR_CNT * FATFS_TEST_SECTOR_SZ) {
+        return -1;
+    }
+    fatfs_test_disk_stats.reads++;
+    fatfs_test_disk_stats.bytes_read += len;
+    return hal_flash_read(fatfs_test_flash_id, fatfs_test_flash_off + addr,
+                          buf, len);
+}
+
+/*
+ * Flash has to be erased before it can be written, so every write is a
+ * read-erase-write of the erase blocks it touches.
+ */
+static int
+fatfs_test_disk_write(uint8_t id, uint32_t addr, const void *buf,
+                      uint32_t len)
+{
+    const uint8_t *src;
+    uint32_t blk;
+    uint32_t off;
+    uint32_t cnt;
+    int rc;
+
+    if (addr + len > FATFS_TEST_SECTOR_CNT * FATFS_TEST_SECTOR_SZ) {
+        return -1;
+    }
+    fatfs_test_disk_stats.writes++;
+    fatfs_test_disk_stats.bytes_written += len;
+
+    src = buf;
+    while (len) {
+        blk = addr & ~(FATFS_TEST_ERASE_SZ - 1);
+        off = addr - blk;
+        cnt = FATFS_TEST_ERASE_SZ - off;
+        if (cnt > len) {
+            cnt = len;
+        }
+        blk += fatfs_test_flash_off;
+        rc = hal_flash_read(fatfs_test_flash_id, blk, fatfs_test_erase_buf,
+                            FATFS_TEST_ERASE_SZ);
+        if (rc) {
+            return -1;
+        }
+        memcpy(fatfs_test_erase_buf + off, src, cnt);
+        rc = hal_flash_erase(fatfs_test_flash_id, blk, FATFS_TEST_ERASE_SZ);
+        if (rc) {
+            return -1;
+        }
+        fatfs_test_disk_stats.erases++;
+        rc = hal_flash_write(fatfs_test_flash_id, blk, fatfs_test_erase_buf,
+                             FATFS_TEST_ERASE_SZ);
+        if (rc) {
+            return -1;
+        }
+        addr += cnt;
+        src += cnt;
+        len -= cnt;
+    }
+    return 0;
+}
+
+static int
+fatfs_test_disk_ioctl(uint8_t id, uint32_t cmd, void *arg)
+{
+    return 0;
+}
+
+static struct disk_ops fatfs_test_disk_ops = {
+    .read = fatfs_test_disk_read,
+    .write = fatfs_test_disk_write,
+    .ioctl = fatfs_test_disk_ioctl,
+};
+
+/*
+ * Registers the disk, at the given offset of a flash device. The offset
+ * has to be a multiple of the device's sector size, and the sectors no
+ * larger than FATFS_TEST_ERASE_SZ.
+ */
+int
+fatfs_test_disk_init(uint8_t flash_id, uint32_t off)
+{
+    static int registered;
+    int rc;
+
+    fatfs_test_flash_id = flash_id;
+    fatfs_test_flash_off = off;
+
+    if (!registered) {
+        rc = disk_register(FATFS_TEST_DISK, "fatfs", &fatfs_test_disk_ops);
+        if (rc != 0) {
+            return rc;
+        }
+        registered = 1;
+    }
+
+    return 0;
+}
+
+static void
+fatfs_test_put16(uint8_t *p, uint16_t val)
+{
+    p[0] = val;
+    p[1] = val >> 8;
+}
+
+/*
+ * Writes an empty FAT12 volume on the disk: boot sector, one FAT sector,
+ * one root directory sector and 125 single sector clusters.
+ */
+void
+fatfs_test_format(void)
+{
+    uint8_t sec[FATFS_TEST_SECTOR_SZ];
+    int rc;
+
+    rc = hal_flash_erase(fatfs_test_flash_id, fatfs_test_flash_off,
+                         FATFS_TEST_SECTOR_CNT * FATFS_TEST_SECTOR_SZ);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    memset(sec, 0, sizeof(sec));
+    memcpy(sec, "\xeb\x3c\x90" "MSWIN4.1", 11);
+    fatfs_test_put16(sec + 11, FATFS_TEST_SECTOR_SZ);   /* BytsPerSec */
+    sec[13] = 1;                                        /* SecPerClus */
+    fatfs_test_put16(sec + 14, 1);                      /* RsvdSecCnt */
+    sec[16] = 1;                                        /* NumFATs */
+    fatfs_test_put16(sec + 17, FATFS_TEST_SECTOR_SZ / 32); /* RootEntCnt */
+    fatfs_test_put16(sec + 19, FATFS_TEST_SECTOR_CNT);  /* TotSec16 */
+    sec[21] = 0xf8;                                     /* Media */
+    fatfs_test_put16(sec + 22, 1);                      /* FATSz16 */
+    sec[38] = 0x29;                                     /* BootSig */
+    memcpy(sec + 43, "NO NAME    " "FAT12   ", 19);
+    sec[510] = 0x55;
+    sec[511] = 0xaa;
+    rc = hal_flash_write(fatfs_test_flash_id, fatfs_test_flash_off, sec,
+                         sizeof(sec));
+    TEST_ASSERT_FATAL(rc == 0);
+
+    /* Clusters 0 and 1 are reserved, the rest are free. */
+    memset(sec, 0, sizeof(sec));
+    memcpy(sec, "\xf8\xff\xff", 3);
+    rc = hal_flash_write(fatfs_test_flash_id,
+                         fatfs_test_flash_off + FATFS_TEST_SECTOR_SZ, sec,
+                         sizeof(sec));
+    TEST_ASSERT_FATAL(rc == 0);
+
+    /* Empty root directory. */
+    memset(sec, 0, sizeof(sec));
+    rc = hal_flash_write(fatfs_test_flash_id,
+                         fatfs_test_flash_off + 2 * FATFS_TEST_SECTOR_SZ, sec,
+                         sizeof(sec));
+    TEST_ASSERT_FATAL(rc == 0);
+
+    memset(&fatfs_test_disk_stats, 0, sizeof(fatfs_test_disk_stats));
+}
+
+TEST_CASE_DECL(fatfs_test_cache)
+
+TEST_SUITE(fatfs_test_all)
+{
+    fatfs_test_cache();
+}
+
+#if MYNEWT_VAL(SELFTEST)
+
+int
+main(int argc, char **argv)
+{
+    int rc;
+
+    sysinit();
+
+    rc = fatfs_test_disk_init(0, 0);
+    assert(rc == 0);
+
+    fatfs_test_all();
+
+    return tu_any_failed;
+}
+
+#endif
@@ -0,0 +1,60 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef _FATFS_TEST_H
+#define _FATFS_TEST_H
+
+#include <stdio.h>
+#include <string.h>
+#include "os/mynewt.h"
+#include <testutil/testutil.h>
+#include <fs/fs.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define FATFS_TEST_DISK             "fatfs_test"
+
+/*
+ * Disk on top of flash; 128 sectors. The unit test puts it at the
+ * beginning of native flash.
+ */
+#define FATFS_TEST_SECTOR_SZ        512
+#define FATFS_TEST_SECTOR_CNT       128
+#define FATFS_TEST_ERASE_SZ         (16 * 1024)
+
+struct fatfs_test_disk_stats {
+    uint32_t reads;
+    uint32_t writes;
+    uint32_t erases;
+    uint32_t bytes_read;
+    uint32_t bytes_written;
+};
+
+extern struct fatfs_test_disk_stats fatfs_test_disk_stats;
+
+int fatfs_test_disk_init(uint8_t flash_id, uint32_t off);
+void fatfs_test_format(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _FATFS_TEST_H */
@@ -0,0 +1,119 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "fatfs_test.h"
+
+/*
+ * A few files written and read back in small chunks, and a log file which
+ * gets appended to and closed after every record. Checks the data, and the
+ * traffic to the disk where the cache makes a difference.
+ */
+#define FATFS_TEST_FILE_CNT         4
+#define FATFS_TEST_FILE_SZ          (8 * 1024)
+#define FATFS_TEST_CHUNK_SZ         128
+#define FATFS_TEST_LOG_CNT          32
+#define FATFS_TEST_LOG_REC_SZ       48
+
+static uint8_t
+fatfs_test_pattern(int file, uint32_t off)
+{
+    return (uint8_t)(file * 31 + off * 7 + (off >> 8));
+}
+
+TEST_CASE(fatfs_test_cache)
+{
+    struct fs_file *file;
+    uint8_t buf[FATFS_TEST_CHUNK_SZ];
+    char name[32];
+    uint32_t off;
+    uint32_t len;
+    int rc;
+    int i;
+    int j;
+
+    fatfs_test_format();
+
+    for (i = 0; i < FATFS_TEST_FILE_CNT; i++) {
+        snprintf(name, sizeof(name), FATFS_TEST_DISK ":/file%d.bin", i);
+        rc = fs_open(name, FS_ACCESS_WRITE | FS_ACCESS_TRUNCATE, &file);
+        TEST_ASSERT_FATAL(rc == 0);
+        for (off = 0; off < FATFS_TEST_FILE_SZ; off += sizeof(buf)) {
+            for (j = 0; j < sizeof(buf); j++) {
+                buf[j] = fatfs_test_pattern(i, off + j);
+            }
+            rc = fs_write(file, buf, sizeof(buf));
+            TEST_ASSERT_FATAL(rc == 0);
+        }
+        rc = fs_close(file);
+        TEST_ASSERT_FATAL(rc == 0);
+    }
+
+    memset(&fatfs_test_disk_stats, 0, sizeof(fatfs_test_disk_stats));
+    for (i = 0; i < FATFS_TEST_FILE_CNT; i++) {
+        snprintf(name, sizeof(name), FATFS_TEST_DISK ":/file%d.bin", i);
+        rc = fs_open(name, FS_ACCESS_READ, &file);
+        TEST_ASSERT_FATAL(rc == 0);
+        for (off = 0; off < FATFS_TEST_FILE_SZ; off += sizeof(buf)) {
+            rc = fs_read(file, sizeof(buf), buf, &len);
+            TEST_ASSERT_FATAL(rc == 0 && len == sizeof(buf));
+            for (j = 0; j < sizeof(buf); j++) {
+                TEST_ASSERT_FATAL(buf[j] == fatfs_test_pattern(i, off + j));
+            }
+        }
+        rc = fs_read(file, sizeof(buf), buf, &len);
+        TEST_ASSERT(rc == 0 && len == 0);
+        rc = fs_close(file);
+        TEST_ASSERT_FATAL(rc == 0);
+    }
+    /* Reading leaves nothing to write back. */
+    TEST_ASSERT(fatfs_test_disk_stats.writes == 0);
+
+    memset(&fatfs_test_disk_stats, 0, sizeof(fatfs_test_disk_stats));
+    for (i = 0; i < FATFS_TEST_LOG_CNT; i++) {
+        rc = fs_open(FATFS_TEST_DISK ":/log.txt",
+                     FS_ACCESS_WRITE | FS_ACCESS_APPEND, &file);
+        TEST_ASSERT_FATAL(rc == 0);
+        memset(buf, 'a' + i % 26, FATFS_TEST_LOG_REC_SZ);
+        rc = fs_write(file, buf, FATFS_TEST_LOG_REC_SZ);
+        TEST_ASSERT_FATAL(rc == 0);
+        rc = fs_close(file);
+        TEST_ASSERT_FATAL(rc == 0);
+    }
+#if MYNEWT_VAL(FATFS_CACHE_SECTORS) > 0
+    /*
+     * The directory, the FAT and the sector being appended to stay in the
+     * cache; without it, each append reads them again.
+     */
+    TEST_ASSERT(fatfs_test_disk_stats.reads <= 4);
+#endif
+
+    rc = fs_open(FATFS_TEST_DISK ":/log.txt", FS_ACCESS_READ, &file);
+    TEST_ASSERT_FATAL(rc == 0);
+    for (i = 0; i < FATFS_TEST_LOG_CNT; i++) {
+        rc = fs_read(file, FATFS_TEST_LOG_REC_SZ, buf, &len);
+        TEST_ASSERT_FATAL(rc == 0 && len == FATFS_TEST_LOG_REC_SZ);
+        for (j = 0; j < FATFS_TEST_LOG_REC_SZ; j++) {
+            TEST_ASSERT_FATAL(buf[j] == 'a' + i % 26);
+        }
+    }
+    rc = fs_read(file, sizeof(buf), buf, &len);
+    TEST_ASSERT(rc == 0 && len == 0);
+    rc = fs_close(file);
+    TEST_ASSERT_FATAL(rc == 0);
+}
@@ -78,12 +78,28 @@ struct fcb {
 
 int fcb_init(struct fcb *fcb);
 
+#if MYNEWT_VAL(FCB_LOG_SECTOR_INDEX)
+/**
+ * Index of the first log entry in a flash sector, kept by the log sector
+ * index.
+ */
+struct fcb_log_sector {
+    uint32_t fls_index;
+    uint16_t fls_id;		/* fd_id of the sector when recorded */
+    uint8_t fls_valid;
+};
+#endif
+
 /**
  * fcb_log is needed as the number of entries in a log
  */
 struct fcb_log {
     struct fcb fl_fcb;
     uint8_t fl_entries;
+#if MYNEWT_VAL(FCB_LOG_SECTOR_INDEX)
+    uint8_t fl_index_built;
+    struct fcb_log_sector fl_index[MYNEWT_VAL(FCB_LOG_SECTOR_INDEX)];
+#endif
 };
 
 /**
@@ -65,6 +65,9 @@ int nffs_format(const struct nffs_area_desc *area_descs);
 
 int nffs_misc_desc_from_flash_area(int idx, int *cnt, struct nffs_area_desc *nad);
 
+int nffs_checkpoint_set_area(const struct nffs_area_desc *area_desc);
+int nffs_checkpoint(void);
+
 #ifdef __cplusplus
 }
 #endif
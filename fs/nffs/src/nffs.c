@@ -57,6 +57,10 @@ struct nffs_inode_entry *nffs_lost_found_dir;
 
 static struct os_mutex nffs_mutex;
 
+#if MYNEWT_VAL(NFFS_GC_INCREMENTAL)
+static struct os_callout nffs_gc_callout;
+#endif
+
 struct log nffs_log;
 
 static int nffs_open(const char *path, uint8_t access_flags,
@@ -110,6 +114,12 @@ STATS_NAME_START(nffs_stats)
     STATS_NAME(nffs_stats, nffs_iocnt_read)
     STATS_NAME(nffs_stats, nffs_iocnt_write)
     STATS_NAME(nffs_stats, nffs_gccnt)
+    STATS_NAME(nffs_stats, nffs_gc_slicecnt)
+    STATS_NAME(nffs_stats, nffs_gc_slice_us)
+    STATS_NAME(nffs_stats, nffs_gc_slice_max_us)
+    STATS_NAME(nffs_stats, nffs_gc_waitcnt)
+    STATS_NAME(nffs_stats, nffs_gc_wait_us)
+    STATS_NAME(nffs_stats, nffs_gc_wait_max_us)
     STATS_NAME(nffs_stats, nffs_readcnt_data)
     STATS_NAME(nffs_stats, nffs_readcnt_block)
     STATS_NAME(nffs_stats, nffs_readcnt_crc)
@@ -139,10 +149,58 @@ nffs_unlock(void)
 {
     int rc;
 
+#if MYNEWT_VAL(NFFS_GC_INCREMENTAL)
+    /* Schedule background garbage collection if the file system is running
+     * low on free space.
+     */
+    if (!os_callout_queued(&nffs_gc_callout) && nffs_gc_wanted()) {
+        os_callout_reset(&nffs_gc_callout,
+                         os_time_ms_to_ticks32(MYNEWT_VAL(NFFS_GC_SLICE_ITVL)));
+    }
+#endif
+
     rc = os_mutex_release(&nffs_mutex);
     assert(rc == 0 || rc == OS_NOT_STARTED);
 }
 
+#if MYNEWT_VAL(NFFS_GC_INCREMENTAL)
+static void
+nffs_gc_event(struct os_event *ev)
+{
+    nffs_lock();
+    nffs_gc_bg_step();
+    nffs_unlock();
+}
+#endif
+
+#if MYNEWT_VAL(NFFS_CHECKPOINT)
+/**
+ * Writes a checkpoint of the file system's RAM representation, so that the
+ * next mount does not need to read everything from flash.  Call this before
+ * a planned reset or power down.  If a background garbage collection cycle
+ * is in progress, the checkpoint is only written when that cycle completes.
+ *
+ * @return                  0 on success; nonzero on failure.
+ */
+int
+nffs_checkpoint(void)
+{
+    int rc;
+
+    nffs_lock();
+
+    if (!nffs_misc_ready()) {
+        rc = FS_EUNINIT;
+    } else {
+        rc = nffs_ckpt_write();
+    }
+
+    nffs_unlock();
+
+    return rc;
+}
+#endif
+
 static int
 nffs_stats_init(void)
 {
@@ -695,6 +753,12 @@ nffs_init(void)
         return FS_EOS;
     }
 
+#if MYNEWT_VAL(NFFS_GC_INCREMENTAL)
+    os_callout_stop(&nffs_gc_callout);
+    os_callout_init(&nffs_gc_callout, os_eventq_dflt_get(), nffs_gc_event,
+                    NULL);
+#endif
+
     free(nffs_file_mem);
     nffs_file_mem = malloc(
         OS_MEMPOOL_BYTES(nffs_config.nc_num_files, sizeof (struct nffs_file)));
@@ -755,6 +819,11 @@ void
 nffs_pkg_init(void)
 {
     struct nffs_area_desc descs[MYNEWT_VAL(NFFS_NUM_AREAS) + 1];
+#if MYNEWT_VAL(NFFS_CHECKPOINT) && \
+    defined(MYNEWT_VAL_NFFS_CHECKPOINT_FLASH_AREA)
+    struct nffs_area_desc ckpt_desc;
+    const struct flash_area *fa;
+#endif
     int cnt;
     int rc;
 
@@ -773,6 +842,20 @@ nffs_pkg_init(void)
         MYNEWT_VAL(NFFS_FLASH_AREA), &cnt, descs);
     SYSINIT_PANIC_ASSERT(rc == 0);
 
+#if MYNEWT_VAL(NFFS_CHECKPOINT) && \
+    defined(MYNEWT_VAL_NFFS_CHECKPOINT_FLASH_AREA)
+    rc = flash_area_open(MYNEWT_VAL(NFFS_CHECKPOINT_FLASH_AREA), &fa);
+    SYSINIT_PANIC_ASSERT(rc == 0);
+
+    ckpt_desc.nad_offset = fa->fa_off;
+    ckpt_desc.nad_length = fa->fa_size;
+    ckpt_desc.nad_flash_id = fa->fa_device_id;
+    flash_area_close(fa);
+
+    rc = nffs_checkpoint_set_area(&ckpt_desc);
+    SYSINIT_PANIC_ASSERT(rc == 0);
+#endif
+
     /* Attempt to restore an existing nffs file system from flash. */
     rc = nffs_detect(descs);
     switch (rc) {
@@ -160,6 +160,112 @@ nffs_cache_inode_populate(struct nffs_cache_inode *cache_inode,
     return 0;
 }
 
+#if MYNEWT_VAL(NFFS_CACHE_INDEX_SLOTS) > 0
+
+#define NFFS_CACHE_INDEX_SLOTS  MYNEWT_VAL(NFFS_CACHE_INDEX_SLOTS)
+
+/*
+ * Block index: a sparse map from file offset to data block, used as a
+ * starting point when seeking backwards through a file's block chain.
+ * Slot n holds the block containing offset n * stride.  The stride doubles
+ * (keeping the even slots) whenever the file outgrows the index, so a seek
+ * never has to walk over more than one stride's worth of blocks once the
+ * surrounding slots are filled.  Slots are filled in by every seek as it
+ * reads blocks; the last block is never indexed, as it can still grow.
+ * The index is dropped whenever the file is written to, and after garbage
+ * collection.
+ */
+void
+nffs_cache_index_clear(struct nffs_cache_inode *cache_inode)
+{
+    memset(cache_inode->nci_index, 0, sizeof cache_inode->nci_index);
+    cache_inode->nci_index_stride = 0;
+}
+
+static void
+nffs_cache_index_fit(struct nffs_cache_inode *cache_inode)
+{
+    int i;
+
+    if (cache_inode->nci_index_stride == 0) {
+        cache_inode->nci_index_stride = nffs_block_max_data_sz;
+    }
+
+    while (cache_inode->nci_file_size >
+           cache_inode->nci_index_stride * NFFS_CACHE_INDEX_SLOTS) {
+
+        for (i = 0; i * 2 < NFFS_CACHE_INDEX_SLOTS; i++) {
+            cache_inode->nci_index[i] = cache_inode->nci_index[i * 2];
+        }
+        memset(cache_inode->nci_index + i, 0,
+               (NFFS_CACHE_INDEX_SLOTS - i) * sizeof cache_inode->nci_index[0]);
+
+        cache_inode->nci_index_stride *= 2;
+    }
+}
+
+static void
+nffs_cache_index_note(struct nffs_cache_inode *cache_inode,
+                      struct nffs_hash_entry *block_entry,
+                      uint32_t block_start, uint32_t block_end)
+{
+    struct nffs_cache_index_slot *slot;
+    uint32_t stride;
+    uint32_t idx;
+
+    if (block_entry ==
+        cache_inode->nci_inode.ni_inode_entry->nie_last_block_entry) {
+
+        return;
+    }
+
+    nffs_cache_index_fit(cache_inode);
+    stride = cache_inode->nci_index_stride;
+
+    for (idx = (block_start + stride - 1) / stride;
+         idx < NFFS_CACHE_INDEX_SLOTS && idx * stride < block_end;
+         idx++) {
+
+        slot = cache_inode->nci_index + idx;
+        slot->ncis_entry = block_entry;
+        slot->ncis_end = block_end;
+    }
+}
+
+/**
+ * Finds the indexed block which ends closest after the specified offset.
+ *
+ * @return                      0 on success; FS_ENOENT if no indexed block
+ *                                  ends after the offset.
+ */
+static int
+nffs_cache_index_find(struct nffs_cache_inode *cache_inode,
+                      uint32_t seek_offset,
+                      struct nffs_hash_entry **out_block_entry,
+                      uint32_t *out_block_end)
+{
+    struct nffs_cache_index_slot *slot;
+    uint32_t idx;
+
+    nffs_cache_index_fit(cache_inode);
+
+    for (idx = seek_offset / cache_inode->nci_index_stride;
+         idx < NFFS_CACHE_INDEX_SLOTS;
+         idx++) {
+
+        slot = cache_inode->nci_index + idx;
+        if (slot->ncis_entry != NULL && slot->ncis_end > seek_offset) {
+            *out_block_entry = slot->ncis_entry;
+            *out_block_end = slot->ncis_end;
+            return 0;
+        }
+    }
+
+    return FS_ENOENT;
+}
+
+#endif
+
 /**
  * Retrieves the block entry corresponding to the last cached block in the
  * specified inode's list.  If the inode has no cached blocks, this function
@@ -301,6 +407,11 @@ nffs_cache_inode_refresh(void)
             return rc;
         }
 
+#if MYNEWT_VAL(NFFS_CACHE_INDEX_SLOTS) > 0
+        /* Blocks may have been collated. */
+        nffs_cache_index_clear(cache_inode);
+#endif
+
         /* File size remains valid. */
     }
 
@@ -380,6 +491,10 @@ nffs_cache_seek(struct nffs_cache_inode *cache_inode, uint32_t seek_offset,
     struct nffs_hash_entry *block_entry;
     struct nffs_hash_entry *pred_entry;
     struct nffs_block block;
+#if MYNEWT_VAL(NFFS_CACHE_INDEX_SLOTS) > 0
+    struct nffs_hash_entry *index_entry;
+    uint32_t index_end;
+#endif
     uint32_t cache_start;
     uint32_t cache_end;
     uint32_t block_start;
@@ -416,6 +531,32 @@ nffs_cache_seek(struct nffs_cache_inode *cache_inode, uint32_t seek_offset,
         block_end = cache_inode->nci_file_size;
     }
 
+#if MYNEWT_VAL(NFFS_CACHE_INDEX_SLOTS) > 0
+    /* Start from an indexed block if it is closer than the file end.  When
+     * seeking prior to the cache, only do so if the gap is longer than an
+     * index stride; the cache then gets replaced with the requested block
+     * rather than bridging the gap.
+     */
+    if (cache_block == NULL &&
+        nffs_cache_index_find(cache_inode, seek_offset,
+                              &index_entry, &index_end) == 0) {
+
+        if (seek_offset < cache_start) {
+            if (index_end < block_end &&
+                block_end - index_end > cache_inode->nci_index_stride) {
+
+                nffs_cache_inode_free_blocks(cache_inode);
+                cache_start = 0;
+                block_entry = index_entry;
+                block_end = index_end;
+            }
+        } else if (index_end < block_end) {
+            block_entry = index_entry;
+            block_end = index_end;
+        }
+    }
+#endif
+
     /* Scan backwards until we find the block containing the seek offest. */
     while (1) {
         if (block_end <= cache_start) {
@@ -453,6 +594,10 @@ nffs_cache_seek(struct nffs_cache_inode *cache_inode, uint32_t seek_offset,
             pred_entry = block.nb_prev;
         }
 
+#if MYNEWT_VAL(NFFS_CACHE_INDEX_SLOTS) > 0
+        nffs_cache_index_note(cache_inode, block_entry, block_start, block_end);
+#endif
+
         if (block_start <= seek_offset) {
             /* This block contains the requested address; iteration is
              * complete.
@@ -0,0 +1,357 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <assert.h>
+#include <string.h>
+#include "os/mynewt.h"
+#include "hal/hal_flash.h"
+#include "crc/crc16.h"
+#include "nffs/nffs.h"
+#include "nffs_priv.h"
+
+#if MYNEWT_VAL(NFFS_CHECKPOINT)
+
+/*
+ * A checkpoint is a snapshot of the hash table, kept in a flash area of its
+ * own.  It lists the ID and flash location of every object that was current
+ * when the checkpoint was written, and how far each area had been written
+ * to.  At mount time, an area whose ID and garbage collection sequence number
+ * still match its checkpoint record only needs to have the listed objects and
+ * whatever got appended after the checkpoint restored, instead of being
+ * parsed from start to end.
+ *
+ * Layout: struct nffs_disk_ckpt, followed by ndc_num_areas area records,
+ * followed by ndc_num_entries hash entries.  The header is written last, so a
+ * checkpoint which did not get written completely is not recognized.
+ */
+
+/** Number of hash entries written with a single flash write. */
+#define NFFS_CKPT_ENTRY_BUF_CNT     16
+
+/**
+ * Number of bytes preceding the write offset of an area which are covered
+ * by the area record's CRC.  An area which has been formatted since the
+ * checkpoint was written can have the same ID and sequence number again, but
+ * not the same contents.
+ */
+#define NFFS_CKPT_TAIL_LEN          32
+
+/** Where the checkpoint lives; length of 0 if checkpoints are disabled. */
+static struct nffs_area_desc nffs_ckpt_area_desc;
+
+/**
+ * Specifies the flash area which holds the checkpoint.  The area must not
+ * overlap any of the areas used by the file system.
+ *
+ * @param area_desc         The checkpoint area; null disables checkpoints.
+ *
+ * @return                  0 on success; nonzero on failure.
+ */
+int
+nffs_checkpoint_set_area(const struct nffs_area_desc *area_desc)
+{
+    if (area_desc == NULL) {
+        memset(&nffs_ckpt_area_desc, 0, sizeof nffs_ckpt_area_desc);
+        return 0;
+    }
+
+    if (area_desc->nad_length < sizeof (struct nffs_disk_ckpt)) {
+        return FS_EINVAL;
+    }
+
+    nffs_ckpt_area_desc = *area_desc;
+    return 0;
+}
+
+/**
+ * Calculates the CRC of the data which was written to an area just before
+ * the specified offset.
+ */
+int
+nffs_ckpt_area_tail_crc(uint8_t area_idx, uint32_t cur, uint16_t *out_crc)
+{
+    uint32_t len;
+
+    len = cur - sizeof (struct nffs_disk_area);
+    if (len > NFFS_CKPT_TAIL_LEN) {
+        len = NFFS_CKPT_TAIL_LEN;
+    }
+
+    return nffs_crc_flash(0, area_idx, cur - len, len, out_crc);
+}
+
+static int
+nffs_ckpt_flash_write(uint32_t *offset, const void *data, uint32_t len,
+                      uint16_t *crc)
+{
+    int rc;
+
+    if (*offset + len > nffs_ckpt_area_desc.nad_length) {
+        return FS_EFULL;
+    }
+
+    STATS_INC(nffs_stats, nffs_iocnt_write);
+    rc = hal_flash_write(nffs_ckpt_area_desc.nad_flash_id,
+                         nffs_ckpt_area_desc.nad_offset + *offset, data, len);
+    if (rc != 0) {
+        return FS_EHW;
+    }
+
+    *crc = crc16_ccitt(*crc, data, len);
+    *offset += len;
+
+    return 0;
+}
+
+static int
+nffs_ckpt_flash_read(uint32_t offset, void *data, uint32_t len)
+{
+    int rc;
+
+    if (offset + len > nffs_ckpt_area_desc.nad_length) {
+        return FS_EOFFSET;
+    }
+
+    STATS_INC(nffs_stats, nffs_iocnt_read);
+    rc = hal_flash_read(nffs_ckpt_area_desc.nad_flash_id,
+                        nffs_ckpt_area_desc.nad_offset + offset, data, len);
+    if (rc != 0) {
+        return FS_EHW;
+    }
+
+    return 0;
+}
+
+/**
+ * Writes a checkpoint of the current RAM representation, replacing the
+ * previous one.  If a garbage collection cycle is in progress, nothing is
+ * written; the cycle writes the checkpoint when it completes.  Until then
+ * the previous checkpoint stays, and the objects written after it are
+ * replayed at mount time as usual.
+ *
+ * @return                  0 on success, or if the checkpoint is deferred;
+ *                          FS_EFULL if the checkpoint area is too small;
+ *                          other nonzero on failure.  No checkpoint remains
+ *                              if this function fails.
+ */
+int
+nffs_ckpt_write(void)
+{
+    struct nffs_disk_ckpt_entry entries[NFFS_CKPT_ENTRY_BUF_CNT];
+    struct nffs_disk_ckpt_area disk_ckpt_area;
+    struct nffs_disk_ckpt disk_ckpt;
+    struct nffs_hash_entry *entry;
+    struct nffs_hash_entry *next;
+    struct nffs_area *area;
+    uint32_t area_offset;
+    uint32_t offset;
+    uint16_t crc;
+    uint8_t area_idx;
+    int cnt;
+    int rc;
+    int i;
+
+    if (nffs_ckpt_area_desc.nad_length == 0 || nffs_num_areas == 0) {
+        return 0;
+    }
+
+    /* During garbage collection two areas have the same ID; don't record
+     * that.  nffs_gc_finish() calls back here.
+     */
+    if (nffs_areas[nffs_scratch_area_idx].na_id != NFFS_AREA_ID_NONE) {
+        return 0;
+    }
+
+    rc = hal_flash_erase(nffs_ckpt_area_desc.nad_flash_id,
+                         nffs_ckpt_area_desc.nad_offset,
+                         nffs_ckpt_area_desc.nad_length);
+    if (rc != 0) {
+        return FS_EHW;
+    }
+
+    offset = sizeof disk_ckpt;
+    crc = 0;
+
+    for (i = 0; i < nffs_num_areas; i++) {
+        area = nffs_areas + i;
+
+        memset(&disk_ckpt_area, 0, sizeof disk_ckpt_area);
+        disk_ckpt_area.ndca_offset = area->na_offset;
+        disk_ckpt_area.ndca_cur = area->na_cur;
+        disk_ckpt_area.ndca_flash_id = area->na_flash_id;
+        disk_ckpt_area.ndca_id = area->na_id;
+        disk_ckpt_area.ndca_gc_seq = area->na_gc_seq;
+        if (area->na_id != NFFS_AREA_ID_NONE) {
+            rc = nffs_ckpt_area_tail_crc(i, area->na_cur,
+                                         &disk_ckpt_area.ndca_tail_crc16);
+            if (rc != 0) {
+                return rc;
+            }
+        }
+
+        rc = nffs_ckpt_flash_write(&offset, &disk_ckpt_area,
+                                   sizeof disk_ckpt_area, &crc);
+        if (rc != 0) {
+            return rc;
+        }
+    }
+
+    memset(&disk_ckpt, 0, sizeof disk_ckpt);
+    cnt = 0;
+    NFFS_HASH_FOREACH(entry, i, next) {
+        nffs_flash_loc_expand(entry->nhe_flash_loc, &area_idx, &area_offset);
+        if (area_idx >= nffs_num_areas) {
+            /* Dummy; not on disk. */
+            continue;
+        }
+
+        entries[cnt].ndce_id = entry->nhe_id;
+        entries[cnt].ndce_flash_loc = entry->nhe_flash_loc;
+        cnt++;
+
+        if (cnt == NFFS_CKPT_ENTRY_BUF_CNT) {
+            rc = nffs_ckpt_flash_write(&offset, entries,
+                                       cnt * sizeof entries[0], &crc);
+            if (rc != 0) {
+                return rc;
+            }
+            disk_ckpt.ndc_num_entries += cnt;
+            cnt = 0;
+        }
+    }
+
+    if (cnt > 0) {
+        rc = nffs_ckpt_flash_write(&offset, entries, cnt * sizeof entries[0],
+                                   &crc);
+        if (rc != 0) {
+            return rc;
+        }
+        disk_ckpt.ndc_num_entries += cnt;
+    }
+
+    disk_ckpt.ndc_magic = NFFS_CKPT_MAGIC;
+    disk_ckpt.ndc_next_dir_id = nffs_hash_next_dir_id;
+    disk_ckpt.ndc_next_file_id = nffs_hash_next_file_id;
+    disk_ckpt.ndc_next_block_id = nffs_hash_next_block_id;
+    disk_ckpt.ndc_num_areas = nffs_num_areas;
+    disk_ckpt.ndc_crc16 = crc16_ccitt(crc, &disk_ckpt,
+                                      NFFS_DISK_CKPT_OFFSET_CRC);
+
+    offset = 0;
+    return nffs_ckpt_flash_write(&offset, &disk_ckpt, sizeof disk_ckpt, &crc);
+}
+
+/**
+ * Reads the checkpoint header and verifies the checkpoint's integrity.
+ *
+ * @param out_disk_ckpt     On success, the header gets written here.
+ *
+ * @return                  0 on success;
+ *                          FS_ENOENT if there is no valid checkpoint;
+ *                          other nonzero on failure.
+ */
+int
+nffs_ckpt_read_hdr(struct nffs_disk_ckpt *out_disk_ckpt)
+{
+    uint32_t offset;
+    uint32_t len;
+    uint32_t end;
+    uint16_t crc;
+    int rc;
+
+    if (nffs_ckpt_area_desc.nad_length == 0) {
+        return FS_ENOENT;
+    }
+
+    rc = nffs_ckpt_flash_read(0, out_disk_ckpt, sizeof *out_disk_ckpt);
+    if (rc != 0) {
+        return rc;
+    }
+
+    if (out_disk_ckpt->ndc_magic != NFFS_CKPT_MAGIC) {
+        return FS_ENOENT;
+    }
+
+    end = sizeof *out_disk_ckpt +
+          out_disk_ckpt->ndc_num_areas * sizeof (struct nffs_disk_ckpt_area);
+    if (end > nffs_ckpt_area_desc.nad_length ||
+        out_disk_ckpt->ndc_num_entries >
+        (nffs_ckpt_area_desc.nad_length - end) /
+        sizeof (struct nffs_disk_ckpt_entry)) {
+
+        return FS_ENOENT;
+    }
+    end += out_disk_ckpt->ndc_num_entries *
+           sizeof (struct nffs_disk_ckpt_entry);
+
+    crc = 0;
+    for (offset = sizeof *out_disk_ckpt; offset < end; offset += len) {
+        len = end - offset;
+        if (len > sizeof nffs_flash_buf) {
+            len = sizeof nffs_flash_buf;
+        }
+
+        rc = nffs_ckpt_flash_read(offset, nffs_flash_buf, len);
+        if (rc != 0) {
+            return rc;
+        }
+        crc = crc16_ccitt(crc, nffs_flash_buf, len);
+    }
+    crc = crc16_ccitt(crc, out_disk_ckpt, NFFS_DISK_CKPT_OFFSET_CRC);
+
+    if (crc != out_disk_ckpt->ndc_crc16) {
+        return FS_ENOENT;
+    }
+
+    return 0;
+}
+
+/**
+ * Reads the checkpoint record of the area which had the specified index.
+ */
+int
+nffs_ckpt_read_area(const struct nffs_disk_ckpt *disk_ckpt, int idx,
+                    struct nffs_disk_ckpt_area *out_disk_ckpt_area)
+{
+    assert(idx < disk_ckpt->ndc_num_areas);
+
+    return nffs_ckpt_flash_read(sizeof *disk_ckpt +
+                                idx * sizeof *out_disk_ckpt_area,
+                                out_disk_ckpt_area,
+                                sizeof *out_disk_ckpt_area);
+}
+
+/**
+ * Reads a run of hash entries from the checkpoint.
+ */
+int
+nffs_ckpt_read_entries(const struct nffs_disk_ckpt *disk_ckpt,
+                       uint32_t first, int count,
+                       struct nffs_disk_ckpt_entry *out_entries)
+{
+    assert(first + count <= disk_ckpt->ndc_num_entries);
+
+    return nffs_ckpt_flash_read(sizeof *disk_ckpt +
+                                disk_ckpt->ndc_num_areas *
+                                    sizeof (struct nffs_disk_ckpt_area) +
+                                first * sizeof *out_entries,
+                                out_entries, count * sizeof *out_entries);
+}
+
+#endif
@@ -181,6 +181,11 @@ nffs_format_full(const struct nffs_area_desc *area_descs)
 
     nffs_current_area_descs = (struct nffs_area_desc*) area_descs;
 
+#if MYNEWT_VAL(NFFS_CHECKPOINT)
+    /* Replace any checkpoint of the previous file system. */
+    nffs_ckpt_write();
+#endif
+
     return 0;
 
 err:
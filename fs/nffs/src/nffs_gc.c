@@ -31,6 +31,30 @@
  */
 unsigned int nffs_gc_count;
 
+/**
+ * Source area of the garbage collection cycle in progress, if any.  A cycle
+ * can be done a bit at a time with nffs_gc_step().  Until it is complete, the
+ * destination area remains nffs_scratch_area_idx, and nothing else gets
+ * written to the source area.
+ */
+static uint8_t nffs_gc_from_area_idx = NFFS_AREA_ID_NONE;
+
+/** Next hash bucket to look for objects to copy in. */
+static int nffs_gc_next_bucket;
+
+/**
+ * Number of background cycles in a row which did not free any space, and
+ * the amount of free space there was when background collection gave up.
+ */
+static uint8_t nffs_gc_idle_cycles;
+static uint32_t nffs_gc_idle_free;
+
+/** Number of bytes of garbage discarded by the last completed cycle. */
+static uint32_t nffs_gc_last_freed;
+
+static uint32_t nffs_gc_slice_max;
+static uint32_t nffs_gc_wait_max;
+
 static int
 nffs_gc_copy_object(struct nffs_hash_entry *entry, uint16_t object_size,
                     uint8_t to_area_idx)
@@ -396,79 +420,63 @@ nffs_gc_inode_blocks(struct nffs_inode_entry *inode_entry,
 }
 
 /**
- * Triggers a garbage collection cycle.  This is implemented as follows:
- *
- *  (1) The non-scratch area with the lowest garbage collection sequence
- *      number is selected as the "source area."  If there are other areas
- *      with the same sequence number, the first one encountered is selected.
- *
- *  (2) The source area's ID is written to the scratch area's header,
- *      transforming it into a non-scratch ID.  The former scratch area is now
- *      known as the "destination area."
- *
- *  (3) The RAM representation is exhaustively searched for objects which are
- *      resident in the source area.  The copy is accomplished as follows:
- *
- *      For each inode:
- *          (a) If the inode is resident in the source area, copy the inode
- *              record to the destination area.
- *
- *          (b) Walk the inode's list of data blocks, starting with the last
- *              block in the file.  Each block that is resident in the source
- *              area is copied to the destination area.  If there is a run of
- *              two or more blocks that are resident in the source area, they
- *              are consolidated and copied to the destination area as a single
- *              new block.
- *
- *  (4) The source area is reformatted as a scratch sector (i.e., its header
- *      indicates an ID of 0xffff).  The area's garbage collection sequence
- *      number is incremented prior to rewriting the header.  This area is now
- *      the new scratch sector.
- *
- * NOTE:
- *     Garbage collection invalidates all cached data blocks.  Whenever this
- *     function is called, all existing nffs_cache_block pointers are rendered
- *     invalid.  If you maintain any such pointers, you need to reset them
- *     after calling this function.  Cached inodes are not invalidated by
- *     garbage collection.
- *
- *     If a parent function potentially calls this function, the caller of the
- *     parent function needs to explicitly check if garbage collection
- *     occurred.  This is done by inspecting the nffs_gc_count variable before
- *     and after calling the function.
+ * Starts a garbage collection cycle; steps (1) and (2) in the description of
+ * nffs_gc().
+ */
+static int
+nffs_gc_begin(void)
+{
+    uint8_t from_area_idx;
+    int rc;
+
+    from_area_idx = nffs_gc_select_area();
+
+    rc = nffs_format_from_scratch_area(nffs_scratch_area_idx,
+                                       nffs_areas[from_area_idx].na_id);
+    if (rc != 0) {
+        return rc;
+    }
+
+    nffs_gc_from_area_idx = from_area_idx;
+    nffs_gc_next_bucket = 0;
+
+    return 0;
+}
+
+/**
+ * Copies the objects which are resident in the source area to the
+ * destination area, one hash bucket at a time; step (3) in the description
+ * of nffs_gc().  Objects which have already been moved are no longer in the
+ * source area, so a bucket can be gone through again if the hash table was
+ * modified in between.
  *
- * @param out_area_idx      On success, the ID of the cleaned up area gets
- *                              written here.  Pass null if you do not need
- *                              this information.
+ * @param max_bytes         Stop after this many bytes have been written to
+ *                              the destination area.  At least one bucket
+ *                              is processed.
  *
  * @return                  0 on success; nonzero on error.
  */
-int
-nffs_gc(uint8_t *out_area_idx)
+static int
+nffs_gc_copy_buckets(uint32_t max_bytes)
 {
     struct nffs_hash_entry *entry;
     struct nffs_hash_entry *next;
-    struct nffs_area *from_area;
-    struct nffs_area *to_area;
     struct nffs_inode_entry *inode_entry;
+    const struct nffs_area *to_area;
     uint32_t area_offset;
-    uint8_t from_area_idx;
+    uint32_t start;
     uint8_t area_idx;
     int rc;
-    int i;
 
-    from_area_idx = nffs_gc_select_area();
-    from_area = nffs_areas + from_area_idx;
     to_area = nffs_areas + nffs_scratch_area_idx;
+    start = to_area->na_cur;
 
-    rc = nffs_format_from_scratch_area(nffs_scratch_area_idx,
-                                       from_area->na_id);
-    if (rc != 0) {
-        return rc;
-    }
+    while (nffs_gc_next_bucket < NFFS_HASH_SIZE) {
+        if (to_area->na_cur - start >= max_bytes) {
+            break;
+        }
 
-    for (i = 0; i < NFFS_HASH_SIZE; i++) {
-        entry = SLIST_FIRST(nffs_hash + i);
+        entry = SLIST_FIRST(nffs_hash + nffs_gc_next_bucket);
         while (entry != NULL) {
             next = SLIST_NEXT(entry, nhe_next);
 
@@ -477,7 +485,7 @@ nffs_gc(uint8_t *out_area_idx)
                 nffs_flash_loc_expand(entry->nhe_flash_loc,
                                       &area_idx, &area_offset);
                 inode_entry = (struct nffs_inode_entry *)entry;
-                if (area_idx == from_area_idx) {
+                if (area_idx == nffs_gc_from_area_idx) {
                     rc = nffs_gc_copy_inode(inode_entry,
                                             nffs_scratch_area_idx);
                     if (rc != 0) {
@@ -489,7 +497,8 @@ nffs_gc(uint8_t *out_area_idx)
                  * resident in the source area get copied.
                  */
                 if (nffs_hash_id_is_file(entry->nhe_id)) {
-                    rc = nffs_gc_inode_blocks(inode_entry, from_area_idx,
+                    rc = nffs_gc_inode_blocks(inode_entry,
+                                              nffs_gc_from_area_idx,
                                               nffs_scratch_area_idx, &next);
                     if (rc != 0) {
                         return rc;
@@ -499,12 +508,34 @@ nffs_gc(uint8_t *out_area_idx)
 
             entry = next;
         }
+
+        nffs_gc_next_bucket++;
     }
 
+    return 0;
+}
+
+/**
+ * Completes a garbage collection cycle; step (4) in the description of
+ * nffs_gc().
+ */
+static int
+nffs_gc_finish(uint8_t *out_area_idx)
+{
+    struct nffs_area *from_area;
+    struct nffs_area *to_area;
+    uint8_t from_area_idx;
+    int rc;
+
+    from_area_idx = nffs_gc_from_area_idx;
+    from_area = nffs_areas + from_area_idx;
+    to_area = nffs_areas + nffs_scratch_area_idx;
+
     /* The amount of written data should never increase as a result of a gc
      * cycle.
      */
     assert(to_area->na_cur <= from_area->na_cur);
+    nffs_gc_last_freed = from_area->na_cur - to_area->na_cur;
 
     /* Turn the source area into the new scratch area. */
     from_area->na_gc_seq++;
@@ -518,6 +549,7 @@ nffs_gc(uint8_t *out_area_idx)
     }
 
     nffs_scratch_area_idx = from_area_idx;
+    nffs_gc_from_area_idx = NFFS_AREA_ID_NONE;
 
     /* Garbage collection renders the cache invalid:
      *     o All cached blocks are now invalid; drop them.
@@ -535,9 +567,265 @@ nffs_gc(uint8_t *out_area_idx)
     nffs_gc_count++;
     STATS_INC(nffs_stats, nffs_gccnt);
 
+#if MYNEWT_VAL(NFFS_CHECKPOINT)
+    /* Objects have moved; record where they are now.  Failure only means
+     * that the next mount is slower.
+     */
+    nffs_ckpt_write();
+#endif
+
+    return 0;
+}
+
+/**
+ * Triggers a garbage collection cycle.  This is implemented as follows:
+ *
+ *  (1) The non-scratch area with the lowest garbage collection sequence
+ *      number is selected as the "source area."  If there are other areas
+ *      with the same sequence number, the first one encountered is selected.
+ *
+ *  (2) The source area's ID is written to the scratch area's header,
+ *      transforming it into a non-scratch ID.  The former scratch area is now
+ *      known as the "destination area."
+ *
+ *  (3) The RAM representation is exhaustively searched for objects which are
+ *      resident in the source area.  The copy is accomplished as follows:
+ *
+ *      For each inode:
+ *          (a) If the inode is resident in the source area, copy the inode
+ *              record to the destination area.
+ *
+ *          (b) Walk the inode's list of data blocks, starting with the last
+ *              block in the file.  Each block that is resident in the source
+ *              area is copied to the destination area.  If there is a run of
+ *              two or more blocks that are resident in the source area, they
+ *              are consolidated and copied to the destination area as a single
+ *              new block.
+ *
+ *  (4) The source area is reformatted as a scratch sector (i.e., its header
+ *      indicates an ID of 0xffff).  The area's garbage collection sequence
+ *      number is incremented prior to rewriting the header.  This area is now
+ *      the new scratch sector.
+ *
+ * If a cycle started by nffs_gc_step() is in progress, that cycle is
+ * completed instead of starting a new one.
+ *
+ * NOTE:
+ *     Garbage collection invalidates all cached data blocks.  Whenever this
+ *     function is called, all existing nffs_cache_block pointers are rendered
+ *     invalid.  If you maintain any such pointers, you need to reset them
+ *     after calling this function.  Cached inodes are not invalidated by
+ *     garbage collection.
+ *
+ *     If a parent function potentially calls this function, the caller of the
+ *     parent function needs to explicitly check if garbage collection
+ *     occurred.  This is done by inspecting the nffs_gc_count variable before
+ *     and after calling the function.
+ *
+ * @param out_area_idx      On success, the ID of the cleaned up area gets
+ *                              written here.  Pass null if you do not need
+ *                              this information.
+ *
+ * @return                  0 on success; nonzero on error.
+ */
+int
+nffs_gc(uint8_t *out_area_idx)
+{
+    int rc;
+
+    if (nffs_gc_from_area_idx == NFFS_AREA_ID_NONE) {
+        rc = nffs_gc_begin();
+        if (rc != 0) {
+            return rc;
+        }
+    }
+
+    rc = nffs_gc_copy_buckets(UINT32_MAX);
+    if (rc != 0) {
+        return rc;
+    }
+
+    return nffs_gc_finish(out_area_idx);
+}
+
+/**
+ * Performs a bounded part of a garbage collection cycle, starting a new cycle
+ * if none is in progress.  Starting a cycle, copying objects and erasing the
+ * source area are all done in separate steps.  File system operations may be
+ * carried out between steps; cached data blocks are dropped if objects got
+ * moved.
+ *
+ * @param max_bytes         Approximate number of bytes to copy in one step.
+ * @param out_done          On success, set to 1 if the cycle was completed,
+ *                              0 if there is more to do.
+ *
+ * @return                  0 on success; nonzero on error.
+ */
+int
+nffs_gc_step(uint32_t max_bytes, int *out_done)
+{
+    uint32_t start;
+    int rc;
+
+    *out_done = 0;
+
+    if (nffs_gc_from_area_idx == NFFS_AREA_ID_NONE) {
+        return nffs_gc_begin();
+    }
+
+    if (nffs_gc_next_bucket < NFFS_HASH_SIZE) {
+        start = nffs_areas[nffs_scratch_area_idx].na_cur;
+        rc = nffs_gc_copy_buckets(max_bytes);
+        if (rc == 0 && nffs_areas[nffs_scratch_area_idx].na_cur != start) {
+            rc = nffs_cache_inode_refresh();
+        }
+        return rc;
+    }
+
+    rc = nffs_gc_finish(NULL);
+    if (rc != 0) {
+        return rc;
+    }
+
+    *out_done = 1;
     return 0;
 }
 
+/**
+ * Tells whether the specified area is the source of a garbage collection
+ * cycle in progress.  No new objects may be written there.
+ */
+int
+nffs_gc_area_busy(uint8_t area_idx)
+{
+    return area_idx == nffs_gc_from_area_idx;
+}
+
+/**
+ * Forgets about garbage collection in progress; used when the RAM
+ * representation is thrown away.
+ */
+void
+nffs_gc_reset(void)
+{
+    nffs_gc_from_area_idx = NFFS_AREA_ID_NONE;
+    nffs_gc_idle_cycles = 0;
+}
+
+static uint32_t
+nffs_gc_free_space(void)
+{
+    uint32_t space;
+    int i;
+
+    space = 0;
+    for (i = 0; i < nffs_num_areas; i++) {
+        if (i != nffs_scratch_area_idx && !nffs_gc_area_busy(i)) {
+            space += nffs_area_free_space(nffs_areas + i);
+        }
+    }
+
+    return space;
+}
+
+/**
+ * Tells whether background garbage collection should be done; either a cycle
+ * is in progress, or there is less than NFFS_GC_RESERVE bytes of free space.
+ * If a full round of areas has been collected without freeing any space, the
+ * background collection waits until half of the remaining free space has
+ * been used up.
+ */
+int
+nffs_gc_wanted(void)
+{
+    uint32_t space;
+
+    if (!nffs_misc_ready()) {
+        return 0;
+    }
+    if (nffs_gc_from_area_idx != NFFS_AREA_ID_NONE) {
+        return 1;
+    }
+
+    space = nffs_gc_free_space();
+    if (space >= MYNEWT_VAL(NFFS_GC_RESERVE)) {
+        return 0;
+    }
+    if (nffs_gc_idle_cycles >= nffs_num_areas - 1) {
+        if (space >= nffs_gc_idle_free / 2) {
+            return 0;
+        }
+        nffs_gc_idle_cycles = 0;
+    }
+
+    return 1;
+}
+
+static void
+nffs_gc_note_max(uint32_t *max, uint32_t usecs, int slice)
+{
+    if (usecs <= *max) {
+        return;
+    }
+    *max = usecs;
+    if (slice) {
+        STATS_CLEAR(nffs_stats, nffs_gc_slice_max_us);
+        STATS_INCN(nffs_stats, nffs_gc_slice_max_us, usecs);
+    } else {
+        STATS_CLEAR(nffs_stats, nffs_gc_wait_max_us);
+        STATS_INCN(nffs_stats, nffs_gc_wait_max_us, usecs);
+    }
+}
+
+/**
+ * Records how long a foreground operation was held up by garbage collection.
+ */
+void
+nffs_gc_note_wait(uint32_t usecs)
+{
+    STATS_INC(nffs_stats, nffs_gc_waitcnt);
+    STATS_INCN(nffs_stats, nffs_gc_wait_us, usecs);
+    nffs_gc_note_max(&nffs_gc_wait_max, usecs, 0);
+}
+
+/**
+ * Does one slice of background garbage collection, if there is need for
+ * it.  Called periodically with the file system locked.
+ *
+ * @return                  0 on success; nonzero on error.
+ */
+int
+nffs_gc_bg_step(void)
+{
+    uint32_t usecs;
+    int64_t start;
+    int done;
+    int rc;
+
+    if (!nffs_gc_wanted()) {
+        return 0;
+    }
+
+    start = os_get_uptime_usec();
+    rc = nffs_gc_step(MYNEWT_VAL(NFFS_GC_SLICE_BYTES), &done);
+    usecs = os_get_uptime_usec() - start;
+
+    STATS_INC(nffs_stats, nffs_gc_slicecnt);
+    STATS_INCN(nffs_stats, nffs_gc_slice_us, usecs);
+    nffs_gc_note_max(&nffs_gc_slice_max, usecs, 1);
+
+    if (rc == 0 && done) {
+        if (nffs_gc_last_freed != 0) {
+            nffs_gc_idle_cycles = 0;
+        } else if (++nffs_gc_idle_cycles >= nffs_num_areas - 1) {
+            /* Every area has been collected; nothing left to reclaim. */
+            nffs_gc_idle_free = nffs_gc_free_space();
+        }
+    }
+
+    return rc;
+}
+
 /**
  * Repeatedly performs garbage collection cycles until there is enough free
  * space to accommodate an object of the specified size.  If there still isn't
@@ -29,6 +29,18 @@ uint32_t nffs_hash_next_dir_id;
 uint32_t nffs_hash_next_file_id;
 uint32_t nffs_hash_next_block_id;
 
+#if MYNEWT_VAL(NFFS_DIR_HASH)
+/**
+ * Directory children, hashed by a digest of their parent's ID and their
+ * filename.  Only used to speed up path lookups; the sorted child lists are
+ * still maintained for readdir.
+ */
+static struct nffs_inode_list nffs_hash_dir[MYNEWT_VAL(NFFS_DIR_HASH_SIZE)];
+
+#define NFFS_HASH_DIR_FNV_BASIS     0x811c9dc5
+#define NFFS_HASH_DIR_FNV_PRIME     0x01000193
+#endif
+
 int
 nffs_hash_id_is_dir(uint32_t id)
 {
@@ -194,6 +206,79 @@ nffs_hash_remove(struct nffs_hash_entry *entry)
     assert(nffs_hash_find(entry->nhe_id) == NULL);
 }
 
+#if MYNEWT_VAL(NFFS_DIR_HASH)
+/**
+ * Adds a chunk of filename to a running directory entry digest (FNV-1a).
+ */
+uint32_t
+nffs_hash_dir_digest_update(uint32_t digest, const void *data, int len)
+{
+    const uint8_t *u8p;
+    int i;
+
+    u8p = data;
+    for (i = 0; i < len; i++) {
+        digest ^= u8p[i];
+        digest *= NFFS_HASH_DIR_FNV_PRIME;
+    }
+
+    return digest;
+}
+
+uint32_t
+nffs_hash_dir_digest_start(uint32_t parent_id)
+{
+    return nffs_hash_dir_digest_update(NFFS_HASH_DIR_FNV_BASIS, &parent_id,
+                                       sizeof parent_id);
+}
+
+uint16_t
+nffs_hash_dir_digest_finish(uint32_t digest)
+{
+    return (digest >> 16) ^ (digest & 0xffff);
+}
+
+struct nffs_inode_list *
+nffs_hash_dir_bucket(uint16_t name_digest)
+{
+    return nffs_hash_dir + name_digest % MYNEWT_VAL(NFFS_DIR_HASH_SIZE);
+}
+
+void
+nffs_hash_dir_insert(struct nffs_inode_entry *child, uint16_t name_digest)
+{
+    child->nie_name_digest = name_digest;
+    SLIST_INSERT_HEAD(nffs_hash_dir_bucket(name_digest), child,
+                      nie_dir_hash_next);
+}
+
+void
+nffs_hash_dir_remove(struct nffs_inode_entry *child)
+{
+    struct nffs_inode_entry *prev;
+    struct nffs_inode_entry *cur;
+    struct nffs_inode_list *list;
+
+    list = nffs_hash_dir_bucket(child->nie_name_digest);
+
+    /* The root directory has no parent, and so never gets inserted. */
+    prev = NULL;
+    SLIST_FOREACH(cur, list, nie_dir_hash_next) {
+        if (cur == child) {
+            if (prev == NULL) {
+                SLIST_REMOVE_HEAD(list, nie_dir_hash_next);
+            } else {
+                SLIST_NEXT(prev, nie_dir_hash_next) =
+                    SLIST_NEXT(cur, nie_dir_hash_next);
+            }
+            SLIST_NEXT(child, nie_dir_hash_next) = NULL;
+            return;
+        }
+        prev = cur;
+    }
+}
+#endif
+
 int
 nffs_hash_init(void)
 {
@@ -210,5 +295,11 @@ nffs_hash_init(void)
         SLIST_INIT(nffs_hash + i);
     }
 
+#if MYNEWT_VAL(NFFS_DIR_HASH)
+    for (i = 0; i < MYNEWT_VAL(NFFS_DIR_HASH_SIZE); i++) {
+        SLIST_INIT(nffs_hash_dir + i);
+    }
+#endif
+
     return 0;
 }
@@ -55,6 +55,14 @@ nffs_inode_entry_free(struct nffs_inode_entry *inode_entry)
     if (inode_entry != NULL) {
         assert(!nffs_inode_getflags(inode_entry, NFFS_INODE_FLAG_INHASH));
         assert(nffs_hash_id_is_inode(inode_entry->nie_hash_entry.nhe_id));
+#if MYNEWT_VAL(NFFS_DIR_HASH)
+        /* Children of a recursively unlinked directory are still in the
+         * directory hash when they get freed.
+         */
+        if (nffs_inode_getflags(inode_entry, NFFS_INODE_FLAG_INTREE)) {
+            nffs_hash_dir_remove(inode_entry);
+        }
+#endif
         os_memblock_put(&nffs_inode_entry_pool, inode_entry);
     }
 }
@@ -574,19 +582,6 @@ nffs_inode_rename(struct nffs_inode_entry *inode_entry,
         return rc;
     }
 
-    if (inode.ni_parent != new_parent) {
-        if (inode.ni_parent != NULL) {
-            nffs_inode_remove_child(&inode);
-        }
-        if (new_parent != NULL) {
-            rc = nffs_inode_add_child(new_parent, inode.ni_inode_entry);
-            if (rc != 0) {
-                return rc;
-            }
-        }
-        inode.ni_parent = new_parent;
-    }
-
     if (new_filename != NULL) {
         filename_len = strlen(new_filename);
     } else {
@@ -614,7 +609,11 @@ nffs_inode_rename(struct nffs_inode_entry *inode_entry,
     memset(&disk_inode, 0, sizeof disk_inode);
     disk_inode.ndi_id = inode_entry->nie_hash_entry.nhe_id;
     disk_inode.ndi_seq = inode.ni_seq + 1;
-    disk_inode.ndi_parent_id = nffs_inode_parent_id(&inode);
+    if (new_parent != NULL) {
+        disk_inode.ndi_parent_id = new_parent->nie_hash_entry.nhe_id;
+    } else {
+        disk_inode.ndi_parent_id = NFFS_ID_NONE;
+    }
     disk_inode.ndi_flags = 0;
     disk_inode.ndi_filename_len = filename_len;
     if (inode_entry->nie_last_block_entry &&
@@ -633,6 +632,21 @@ nffs_inode_rename(struct nffs_inode_entry *inode_entry,
     inode_entry->nie_hash_entry.nhe_flash_loc =
         nffs_flash_loc(area_idx, area_offset);
 
+    /* Relink the inode only now that its new name is on disk; a new name
+     * moves it within the sorted child list (and the directory hash).
+     */
+    if (inode.ni_parent != new_parent || new_filename != NULL) {
+        if (inode.ni_parent != NULL) {
+            nffs_inode_remove_child(&inode);
+        }
+        if (new_parent != NULL) {
+            rc = nffs_inode_add_child(new_parent, inode_entry);
+            if (rc != 0) {
+                return rc;
+            }
+        }
+    }
+
     return 0;
 }
 
@@ -774,6 +788,59 @@ nffs_inode_read_filename(struct nffs_inode_entry *inode_entry, size_t max_len,
     return 0;
 }
 
+#if MYNEWT_VAL(NFFS_DIR_HASH)
+/**
+ * Calculates the directory hash digest of the specified inode's filename, as
+ * a child of the specified directory.  The part of the filename which is not
+ * cached in RAM gets read from flash.
+ */
+static int
+nffs_inode_name_digest(const struct nffs_inode *inode, uint32_t parent_id,
+                       uint16_t *out_digest)
+{
+    uint32_t digest;
+    int chunk_len;
+    int rem_len;
+    int off;
+    int rc;
+
+    digest = nffs_hash_dir_digest_start(parent_id);
+
+    if (inode->ni_filename_len <= NFFS_SHORT_FILENAME_LEN) {
+        chunk_len = inode->ni_filename_len;
+    } else {
+        chunk_len = NFFS_SHORT_FILENAME_LEN;
+    }
+    digest = nffs_hash_dir_digest_update(digest, inode->ni_filename,
+                                         chunk_len);
+
+    off = chunk_len;
+    while (off < inode->ni_filename_len) {
+        rem_len = inode->ni_filename_len - off;
+        if (rem_len > NFFS_INODE_FILENAME_BUF_SZ) {
+            chunk_len = NFFS_INODE_FILENAME_BUF_SZ;
+        } else {
+            chunk_len = rem_len;
+        }
+
+        rc = nffs_inode_read_filename_chunk(inode, off,
+                                            nffs_inode_filename_buf0,
+                                            chunk_len);
+        if (rc != 0) {
+            return rc;
+        }
+
+        digest = nffs_hash_dir_digest_update(digest, nffs_inode_filename_buf0,
+                                             chunk_len);
+        off += chunk_len;
+    }
+
+    *out_digest = nffs_hash_dir_digest_finish(digest);
+
+    return 0;
+}
+#endif
+
 int
 nffs_inode_add_child(struct nffs_inode_entry *parent,
                      struct nffs_inode_entry *child)
@@ -782,6 +849,9 @@ nffs_inode_add_child(struct nffs_inode_entry *parent,
     struct nffs_inode_entry *cur;
     struct nffs_inode child_inode;
     struct nffs_inode cur_inode;
+#if MYNEWT_VAL(NFFS_DIR_HASH)
+    uint16_t digest;
+#endif
     int cmp;
     int rc;
 
@@ -793,6 +863,14 @@ nffs_inode_add_child(struct nffs_inode_entry *parent,
         return rc;
     }
 
+#if MYNEWT_VAL(NFFS_DIR_HASH)
+    rc = nffs_inode_name_digest(&child_inode, parent->nie_hash_entry.nhe_id,
+                                &digest);
+    if (rc != 0) {
+        return rc;
+    }
+#endif
+
     prev = NULL;
     SLIST_FOREACH(cur, &parent->nie_child_list, nie_sibling_next) {
         assert(cur != child);
@@ -818,6 +896,9 @@ nffs_inode_add_child(struct nffs_inode_entry *parent,
     } else {
         SLIST_INSERT_AFTER(prev, child, nie_sibling_next);
     }
+#if MYNEWT_VAL(NFFS_DIR_HASH)
+    nffs_hash_dir_insert(child, digest);
+#endif
     nffs_inode_setflags(child, NFFS_INODE_FLAG_INTREE);
 
     return 0;
@@ -835,6 +916,9 @@ nffs_inode_remove_child(struct nffs_inode *child)
     SLIST_REMOVE(&parent->nie_child_list, child->ni_inode_entry,
                  nffs_inode_entry, nie_sibling_next);
     SLIST_NEXT(child->ni_inode_entry, nie_sibling_next) = NULL;
+#if MYNEWT_VAL(NFFS_DIR_HASH)
+    nffs_hash_dir_remove(child->ni_inode_entry);
+#endif
     nffs_inode_unsetflags(child->ni_inode_entry, NFFS_INODE_FLAG_INTREE);
 }
 
@@ -196,7 +196,9 @@ nffs_misc_reserve_space_area(uint8_t area_idx, uint16_t space,
 
 /**
  * Finds an area that can accommodate an object of the specified size.  If no
- * such area exists, this function performs a garbage collection cycle.
+ * such area exists, this function performs a garbage collection cycle.  The
+ * source area of an incremental garbage collection cycle in progress is not
+ * written to.
  *
  * @param space                 The number of bytes of free space required.
  * @param out_area_idx          On success, the index of the suitable area gets
@@ -211,12 +213,13 @@ nffs_misc_reserve_space(uint16_t space,
                         uint8_t *out_area_idx, uint32_t *out_area_offset)
 {
     uint8_t area_idx;
+    int64_t start;
     int rc;
     int i;
 
     /* Find the first area with sufficient free space. */
     for (i = 0; i < nffs_num_areas; i++) {
-        if (i != nffs_scratch_area_idx) {
+        if (i != nffs_scratch_area_idx && !nffs_gc_area_busy(i)) {
             rc = nffs_misc_reserve_space_area(i, space, out_area_offset);
             if (rc == 0) {
                 *out_area_idx = i;
@@ -228,7 +231,9 @@ nffs_misc_reserve_space(uint16_t space,
     /* No area can accommodate the request.  Garbage collect until an area
      * has enough space.
      */
+    start = os_get_uptime_usec();
     rc = nffs_gc_until(space, &area_idx);
+    nffs_gc_note_wait(os_get_uptime_usec() - start);
     if (rc != 0) {
         return rc;
     }
@@ -364,6 +369,7 @@ nffs_misc_reset(void)
     int rc;
 
     nffs_cache_clear();
+    nffs_gc_reset();
 
     rc = os_mempool_init(&nffs_file_pool, nffs_config.nc_num_files,
                          sizeof (struct nffs_file), nffs_file_mem,
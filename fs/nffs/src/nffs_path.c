@@ -72,9 +72,43 @@ nffs_path_find_child(struct nffs_inode_entry *parent,
 {
     struct nffs_inode_entry *cur;
     struct nffs_inode inode;
+#if MYNEWT_VAL(NFFS_DIR_HASH)
+    uint32_t digest;
+    uint16_t name_digest;
+#endif
     int cmp;
     int rc;
 
+#if MYNEWT_VAL(NFFS_DIR_HASH)
+    digest = nffs_hash_dir_digest_start(parent->nie_hash_entry.nhe_id);
+    digest = nffs_hash_dir_digest_update(digest, name, name_len);
+    name_digest = nffs_hash_dir_digest_finish(digest);
+
+    /* Only read an inode from flash if its digest matches. */
+    SLIST_FOREACH(cur, nffs_hash_dir_bucket(name_digest), nie_dir_hash_next) {
+        if (cur->nie_name_digest != name_digest) {
+            continue;
+        }
+
+        rc = nffs_inode_from_entry(&inode, cur);
+        if (rc != 0) {
+            return rc;
+        }
+        if (inode.ni_parent != parent) {
+            continue;
+        }
+
+        rc = nffs_inode_filename_cmp_ram(&inode, name, name_len, &cmp);
+        if (rc != 0) {
+            return rc;
+        }
+
+        if (cmp == 0) {
+            *out_inode_entry = cur;
+            return 0;
+        }
+    }
+#else
     SLIST_FOREACH(cur, &parent->nie_child_list, nie_sibling_next) {
         rc = nffs_inode_from_entry(&inode, cur);
         if (rc != 0) {
@@ -94,6 +128,7 @@ nffs_path_find_child(struct nffs_inode_entry *parent,
             break;
         }
     }
+#endif
 
     return FS_ENOENT;
 }
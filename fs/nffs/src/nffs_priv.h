@@ -51,6 +51,7 @@ extern "C" {
 #define NFFS_AREA_MAGIC3             0xb185fc8e
 #define NFFS_BLOCK_MAGIC             0x53ba23b9
 #define NFFS_INODE_MAGIC             0x925f8bc0
+#define NFFS_CKPT_MAGIC              0x6e8fc1d5
 
 #define NFFS_AREA_ID_NONE            0xff
 #define NFFS_AREA_VER_0                 0
@@ -106,6 +107,38 @@ struct nffs_disk_block {
 
 #define NFFS_DISK_BLOCK_OFFSET_CRC  18
 
+/** On-disk representation of a checkpoint header. */
+struct nffs_disk_ckpt {
+    uint32_t ndc_magic;         /* NFFS_CKPT_MAGIC */
+    uint32_t ndc_next_dir_id;   /* Next unused IDs at checkpoint time. */
+    uint32_t ndc_next_file_id;
+    uint32_t ndc_next_block_id;
+    uint32_t ndc_num_entries;   /* Number of hash entry records. */
+    uint16_t ndc_num_areas;     /* Number of area records. */
+    uint16_t ndc_crc16;         /* Covers records and rest of header. */
+    /* Followed by area records, then hash entry records. */
+};
+
+#define NFFS_DISK_CKPT_OFFSET_CRC   22
+
+/** On-disk record of the state of an area at checkpoint time. */
+struct nffs_disk_ckpt_area {
+    uint32_t ndca_offset;       /* Flash offset of start of area. */
+    uint32_t ndca_cur;          /* Offset of first unwritten byte. */
+    uint16_t ndca_tail_crc16;   /* Covers data written just before cur. */
+    uint8_t ndca_flash_id;      /* Logical flash id. */
+    uint8_t ndca_id;            /* 0xff if scratch area. */
+    uint8_t ndca_gc_seq;        /* Garbage collection count. */
+    uint8_t reserved8;
+    uint16_t reserved16;
+};
+
+/** On-disk record of a hash entry at checkpoint time. */
+struct nffs_disk_ckpt_entry {
+    uint32_t ndce_id;           /* Object ID. */
+    uint32_t ndce_flash_loc;    /* Area record index; offset. */
+};
+
 /**
  * What gets stored in the hash table.  Each entry represents a data block or
  * an inode.
@@ -133,6 +166,10 @@ struct nffs_inode_entry {
     uint8_t nie_flags;
     uint8_t nie_blkcnt;
     uint8_t reserved8;
+#if MYNEWT_VAL(NFFS_DIR_HASH)
+    SLIST_ENTRY(nffs_inode_entry) nie_dir_hash_next;
+    uint16_t nie_name_digest;   /* Digest of parent ID and filename. */
+#endif
 };
 
 #define    NFFS_INODE_FLAG_FREE        0x00
@@ -228,12 +265,25 @@ struct nffs_cache_block {
 
 TAILQ_HEAD(nffs_cache_block_list, nffs_cache_block);
 
+#if MYNEWT_VAL(NFFS_CACHE_INDEX_SLOTS) > 0
+/** Data block containing a particular file offset. */
+struct nffs_cache_index_slot {
+    struct nffs_hash_entry *ncis_entry;     /* Null if not known yet. */
+    uint32_t ncis_end;                      /* File offset of block end. */
+};
+#endif
+
 /** Represents a single cached file inode. */
 struct nffs_cache_inode {
     TAILQ_ENTRY(nffs_cache_inode) nci_link;        /* Sorted; LRU at tail. */
     struct nffs_inode nci_inode;                   /* Full inode. */
     struct nffs_cache_block_list nci_block_list;   /* List of cached blocks. */
     uint32_t nci_file_size;                        /* Total file size. */
+#if MYNEWT_VAL(NFFS_CACHE_INDEX_SLOTS) > 0
+    /* Slot n holds the block containing file offset n * nci_index_stride. */
+    uint32_t nci_index_stride;
+    struct nffs_cache_index_slot nci_index[MYNEWT_VAL(NFFS_CACHE_INDEX_SLOTS)];
+#endif
 };
 
 struct nffs_dirent {
@@ -254,6 +304,12 @@ STATS_SECT_START(nffs_stats)
     STATS_SECT_ENTRY(nffs_iocnt_read)
     STATS_SECT_ENTRY(nffs_iocnt_write)
     STATS_SECT_ENTRY(nffs_gccnt)
+    STATS_SECT_ENTRY(nffs_gc_slicecnt)
+    STATS_SECT_ENTRY(nffs_gc_slice_us)
+    STATS_SECT_ENTRY(nffs_gc_slice_max_us)
+    STATS_SECT_ENTRY(nffs_gc_waitcnt)
+    STATS_SECT_ENTRY(nffs_gc_wait_us)
+    STATS_SECT_ENTRY(nffs_gc_wait_max_us)
     STATS_SECT_ENTRY(nffs_readcnt_data)
     STATS_SECT_ENTRY(nffs_readcnt_block)
     STATS_SECT_ENTRY(nffs_readcnt_crc)
@@ -347,6 +403,20 @@ void nffs_cache_inode_range(const struct nffs_cache_inode *cache_inode,
 int nffs_cache_seek(struct nffs_cache_inode *cache_inode, uint32_t to,
                     struct nffs_cache_block **out_cache_block);
 void nffs_cache_clear(void);
+#if MYNEWT_VAL(NFFS_CACHE_INDEX_SLOTS) > 0
+void nffs_cache_index_clear(struct nffs_cache_inode *cache_inode);
+#endif
+
+/* @ckpt */
+int nffs_ckpt_write(void);
+int nffs_ckpt_area_tail_crc(uint8_t area_idx, uint32_t cur,
+                            uint16_t *out_crc);
+int nffs_ckpt_read_hdr(struct nffs_disk_ckpt *out_disk_ckpt);
+int nffs_ckpt_read_area(const struct nffs_disk_ckpt *disk_ckpt, int idx,
+                        struct nffs_disk_ckpt_area *out_disk_ckpt_area);
+int nffs_ckpt_read_entries(const struct nffs_disk_ckpt *disk_ckpt,
+                           uint32_t first, int count,
+                           struct nffs_disk_ckpt_entry *out_entries);
 
 /* @crc */
 int nffs_crc_flash(uint16_t initial_crc, uint8_t area_idx,
@@ -388,6 +458,12 @@ int nffs_format_full(const struct nffs_area_desc *area_descs);
 /* @gc */
 int nffs_gc(uint8_t *out_area_idx);
 int nffs_gc_until(uint32_t space, uint8_t *out_area_idx);
+int nffs_gc_step(uint32_t max_bytes, int *out_done);
+int nffs_gc_area_busy(uint8_t area_idx);
+void nffs_gc_reset(void);
+int nffs_gc_wanted(void);
+int nffs_gc_bg_step(void);
+void nffs_gc_note_wait(uint32_t usecs);
 
 /* @flash */
 struct nffs_area *nffs_flash_find_area(uint16_t logical_id);
@@ -415,6 +491,16 @@ void nffs_hash_remove(struct nffs_hash_entry *entry);
 int nffs_hash_init(void);
 int nffs_hash_entry_is_dummy(struct nffs_hash_entry *he);
 int nffs_hash_id_is_dummy(uint32_t id);
+#if MYNEWT_VAL(NFFS_DIR_HASH)
+uint32_t nffs_hash_dir_digest_update(uint32_t digest, const void *data,
+                                     int len);
+uint32_t nffs_hash_dir_digest_start(uint32_t parent_id);
+uint16_t nffs_hash_dir_digest_finish(uint32_t digest);
+struct nffs_inode_list *nffs_hash_dir_bucket(uint16_t name_digest);
+void nffs_hash_dir_insert(struct nffs_inode_entry *child,
+                          uint16_t name_digest);
+void nffs_hash_dir_remove(struct nffs_inode_entry *child);
+#endif
 
 /* @inode */
 struct nffs_inode_entry *nffs_inode_entry_alloc(void);
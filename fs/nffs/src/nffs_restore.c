@@ -19,6 +19,7 @@
 
 #include <assert.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include "os/mynewt.h"
 #include "hal/hal_flash.h"
@@ -32,6 +33,15 @@
  */
 static uint16_t nffs_restore_largest_block_data_len;
 
+#if MYNEWT_VAL(NFFS_CHECKPOINT)
+/**
+ * Set while objects listed in a checkpoint are being restored.  These were
+ * verified when they were first restored, so the data of blocks is not read
+ * to check the CRC again.
+ */
+static int nffs_restore_from_ckpt;
+#endif
+
 /**
  * Checks that each block a chain of data blocks was properly restored.
  *
@@ -800,9 +810,14 @@ nffs_restore_block(const struct nffs_disk_block *disk_block, uint8_t area_idx,
     /* Check the block's CRC.  If the block is corrupt, discard it.  If this
      * block would have superseded another, the old block becomes current.
      */
-    rc = nffs_crc_disk_block_validate(disk_block, area_idx, area_offset);
-    if (rc != 0) {
-        goto err;
+#if MYNEWT_VAL(NFFS_CHECKPOINT)
+    if (!nffs_restore_from_ckpt)
+#endif
+    {
+        rc = nffs_crc_disk_block_validate(disk_block, area_idx, area_offset);
+        if (rc != 0) {
+            goto err;
+        }
     }
 
     entry = nffs_hash_find_block(disk_block->ndb_id);
@@ -1029,15 +1044,15 @@ nffs_restore_disk_object_size(const struct nffs_disk_object *disk_object)
 }
 
 /**
- * Reads the specified area from disk and loads its contents into the RAM
- * representation.
+ * Reads the specified area from disk, starting at its current write offset,
+ * and loads its contents into the RAM representation.
  *
  * @param area_idx              The index of the area to read.
  *
  * @return                      0 on success; nonzero on failure.
  */
 static int
-nffs_restore_area_contents(int area_idx)
+nffs_restore_area_tail(int area_idx)
 {
     struct nffs_disk_object disk_object;
     struct nffs_area *area;
@@ -1045,7 +1060,6 @@ nffs_restore_area_contents(int area_idx)
 
     area = nffs_areas + area_idx;
 
-    area->na_cur = sizeof (struct nffs_disk_area);
     while (1) {
         rc = nffs_restore_disk_object(area_idx, area->na_cur,  &disk_object);
         switch (rc) {
@@ -1087,6 +1101,167 @@ nffs_restore_area_contents(int area_idx)
     }
 }
 
+/**
+ * Reads the specified area from disk and loads its contents into the RAM
+ * representation.
+ *
+ * @param area_idx              The index of the area to read.
+ *
+ * @return                      0 on success; nonzero on failure.
+ */
+static int
+nffs_restore_area_contents(int area_idx)
+{
+    nffs_areas[area_idx].na_cur = sizeof (struct nffs_disk_area);
+    return nffs_restore_area_tail(area_idx);
+}
+
+#if MYNEWT_VAL(NFFS_CHECKPOINT)
+/**
+ * Loads the objects listed in the checkpoint into the RAM representation.
+ * Only areas which have not been erased since the checkpoint was written are
+ * used; the write offset of each such area is set to where it was at
+ * checkpoint time, so that only newer objects need to be read from it.
+ *
+ * @return                      0 on success;
+ *                              FS_ENOENT if there is no valid checkpoint;
+ *                              FS_EUNEXP if the checkpoint does not match
+ *                                  the contents of flash;
+ *                              other nonzero on failure.
+ */
+static int
+nffs_restore_ckpt(void)
+{
+    struct nffs_disk_ckpt_entry entries[8];
+    struct nffs_disk_ckpt_area disk_ckpt_area;
+    struct nffs_disk_object disk_object;
+    struct nffs_disk_ckpt disk_ckpt;
+    struct nffs_area *area;
+    uint32_t area_offset;
+    uint32_t first;
+    uint16_t crc;
+    uint8_t *area_map;
+    uint8_t area_idx;
+    int num_mapped;
+    int cnt;
+    int rc;
+    int i;
+    int j;
+
+    rc = nffs_ckpt_read_hdr(&disk_ckpt);
+    if (rc != 0) {
+        return rc;
+    }
+
+    if (disk_ckpt.ndc_num_areas > NFFS_MAX_AREAS) {
+        return FS_ENOENT;
+    }
+
+    /* Map each area recorded in the checkpoint to the area it is now. */
+    area_map = malloc(disk_ckpt.ndc_num_areas);
+    if (area_map == NULL) {
+        return FS_ENOMEM;
+    }
+
+    num_mapped = 0;
+    for (i = 0; i < disk_ckpt.ndc_num_areas; i++) {
+        area_map[i] = NFFS_AREA_ID_NONE;
+
+        rc = nffs_ckpt_read_area(&disk_ckpt, i, &disk_ckpt_area);
+        if (rc != 0) {
+            goto done;
+        }
+
+        for (j = 0; j < nffs_num_areas; j++) {
+            area = nffs_areas + j;
+            if (area->na_flash_id == disk_ckpt_area.ndca_flash_id &&
+                area->na_offset == disk_ckpt_area.ndca_offset &&
+                area->na_id == disk_ckpt_area.ndca_id &&
+                area->na_id != NFFS_AREA_ID_NONE &&
+                area->na_gc_seq == disk_ckpt_area.ndca_gc_seq &&
+                disk_ckpt_area.ndca_cur >= sizeof (struct nffs_disk_area) &&
+                disk_ckpt_area.ndca_cur <= area->na_length &&
+                nffs_ckpt_area_tail_crc(j, disk_ckpt_area.ndca_cur,
+                                        &crc) == 0 &&
+                crc == disk_ckpt_area.ndca_tail_crc16) {
+
+                area_map[i] = j;
+                area->na_cur = disk_ckpt_area.ndca_cur;
+                if (area->na_cur > sizeof (struct nffs_disk_area)) {
+                    num_mapped++;
+                }
+                break;
+            }
+        }
+    }
+
+    if (num_mapped == 0) {
+        /* The checkpoint saves nothing; every area needs to be read in
+         * full.
+         */
+        rc = FS_ENOENT;
+        goto done;
+    }
+
+    if (disk_ckpt.ndc_next_dir_id > nffs_hash_next_dir_id) {
+        nffs_hash_next_dir_id = disk_ckpt.ndc_next_dir_id;
+    }
+    if (disk_ckpt.ndc_next_file_id > nffs_hash_next_file_id) {
+        nffs_hash_next_file_id = disk_ckpt.ndc_next_file_id;
+    }
+    if (disk_ckpt.ndc_next_block_id > nffs_hash_next_block_id) {
+        nffs_hash_next_block_id = disk_ckpt.ndc_next_block_id;
+    }
+
+    nffs_restore_from_ckpt = 1;
+
+    for (first = 0; first < disk_ckpt.ndc_num_entries; first += cnt) {
+        cnt = disk_ckpt.ndc_num_entries - first;
+        if (cnt > sizeof entries / sizeof entries[0]) {
+            cnt = sizeof entries / sizeof entries[0];
+        }
+
+        rc = nffs_ckpt_read_entries(&disk_ckpt, first, cnt, entries);
+        if (rc != 0) {
+            goto done;
+        }
+
+        for (i = 0; i < cnt; i++) {
+            nffs_flash_loc_expand(entries[i].ndce_flash_loc,
+                                  &area_idx, &area_offset);
+            if (area_idx >= disk_ckpt.ndc_num_areas ||
+                area_map[area_idx] == NFFS_AREA_ID_NONE) {
+
+                /* Area has been erased since; it gets read in full. */
+                continue;
+            }
+
+            /* The object must still be where the checkpoint says it is. */
+            rc = nffs_restore_disk_object(area_map[area_idx], area_offset,
+                                          &disk_object);
+            if (rc != 0 ||
+                disk_object.ndo_disk_inode.ndi_id != entries[i].ndce_id) {
+
+                rc = FS_EUNEXP;
+                goto done;
+            }
+
+            rc = nffs_restore_object(&disk_object);
+            if (rc == 0) {
+                STATS_INC(nffs_stats, nffs_object_count);
+            }
+        }
+    }
+
+    rc = 0;
+
+done:
+    nffs_restore_from_ckpt = 0;
+    free(area_map);
+    return rc;
+}
+#endif
+
 /**
  * Reads and parses one area header.  This function does not read the area's
  * contents.
@@ -1274,20 +1449,16 @@ nffs_log_contents(void)
 }
 
 /**
- * Searches for a valid nffs file system among the specified areas.  This
- * function succeeds if a file system is detected among any subset of the
- * supplied areas.  If the area set does not contain a valid file system,
- * a new one can be created via a call to nffs_format().
+ * Performs a single attempt at restoring the file system; see
+ * nffs_restore_full().
  *
- * @param area_descs        The area set to search.  This array must be
- *                              terminated with a 0-length area.
- *
- * @return                  0 on success;
- *                          FS_ECORRUPT if no valid file system was detected;
- *                          other nonzero on error.
+ * @param use_ckpt          Whether to load the checkpoint, if any.
+ * @param out_ckpt_rc       The result of loading the checkpoint gets written
+ *                              here; FS_ENOENT if it was not used.
  */
-int
-nffs_restore_full(const struct nffs_area_desc *area_descs)
+static int
+nffs_restore_full_once(const struct nffs_area_desc *area_descs, int use_ckpt,
+                       int *out_ckpt_rc)
 {
     struct nffs_disk_area disk_area;
     int cur_area_idx;
@@ -1295,6 +1466,8 @@ nffs_restore_full(const struct nffs_area_desc *area_descs)
     int rc;
     int i;
 
+    *out_ckpt_rc = FS_ENOENT;
+
     /* Start from a clean state. */
     rc = nffs_misc_reset();
     if (rc) {
@@ -1357,11 +1530,35 @@ nffs_restore_full(const struct nffs_area_desc *area_descs)
             } else {
                 nffs_areas[cur_area_idx].na_cur =
                     sizeof (struct nffs_disk_area);
-                nffs_restore_area_contents(cur_area_idx);
             }
         }
     }
 
+#if MYNEWT_VAL(NFFS_CHECKPOINT)
+    /* Restore what the checkpoint has recorded; only the objects written
+     * since then need to be read from the areas it covers.
+     */
+    if (use_ckpt) {
+        *out_ckpt_rc = nffs_restore_ckpt();
+        switch (*out_ckpt_rc) {
+        case 0:
+        case FS_ENOENT:
+            break;
+
+        default:
+            rc = *out_ckpt_rc;
+            goto err;
+        }
+    }
+#endif
+
+    /* Read the rest of each area from flash. */
+    for (i = 0; i < nffs_num_areas; i++) {
+        if (nffs_areas[i].na_id != NFFS_AREA_ID_NONE) {
+            nffs_restore_area_tail(i);
+        }
+    }
+
     /* All areas have been restored from flash. */
 
     if (nffs_scratch_area_idx == NFFS_AREA_ID_NONE) {
@@ -1417,3 +1614,41 @@ err:
     nffs_misc_reset();
     return rc;
 }
+
+/**
+ * Searches for a valid nffs file system among the specified areas.  This
+ * function succeeds if a file system is detected among any subset of the
+ * supplied areas.  If the area set does not contain a valid file system,
+ * a new one can be created via a call to nffs_format().
+ *
+ * If a checkpoint area is configured, the checkpoint is used to avoid
+ * reading every object from flash.  A checkpoint which cannot be used is
+ * ignored, and a new one is written once the file system has been restored.
+ *
+ * @param area_descs        The area set to search.  This array must be
+ *                              terminated with a 0-length area.
+ *
+ * @return                  0 on success;
+ *                          FS_ECORRUPT if no valid file system was detected;
+ *                          other nonzero on error.
+ */
+int
+nffs_restore_full(const struct nffs_area_desc *area_descs)
+{
+    int ckpt_rc;
+    int rc;
+
+    rc = nffs_restore_full_once(area_descs, 1, &ckpt_rc);
+#if MYNEWT_VAL(NFFS_CHECKPOINT)
+    if (ckpt_rc != 0 && ckpt_rc != FS_ENOENT) {
+        /* Stale or unreadable checkpoint; start over without it. */
+        rc = nffs_restore_full_once(area_descs, 0, &ckpt_rc);
+    }
+    if (rc == 0 && ckpt_rc != 0) {
+        /* Failure only means that the next mount is slower. */
+        nffs_ckpt_write();
+    }
+#endif
+
+    return rc;
+}
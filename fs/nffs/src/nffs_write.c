@@ -422,7 +422,7 @@ nffs_write_to_file(struct nffs_file *file, const void *data, int len)
         rc = nffs_write_chunk(file->nf_inode_entry, file->nf_offset, data_ptr,
                               chunk_size);
         if (rc != 0) {
-            return rc;
+            break;
         }
 
         len -= chunk_size;
@@ -430,5 +430,13 @@ nffs_write_to_file(struct nffs_file *file, const void *data, int len)
         file->nf_offset += chunk_size;
     }
 
-    return 0;
+#if MYNEWT_VAL(NFFS_CACHE_INDEX_SLOTS) > 0
+    /* Overwritten blocks get superseded, and an append moves the end of the
+     * file; start the block index over rather than patch it up.  This is
+     * done last, as the writes themselves seek through the file.
+     */
+    nffs_cache_index_clear(cache_inode);
+#endif
+
+    return rc;
 }
@@ -108,6 +108,9 @@ TEST_CASE_DECL(nffs_test_lost_found)
 TEST_CASE_DECL(nffs_test_readdir)
 TEST_CASE_DECL(nffs_test_split_file)
 TEST_CASE_DECL(nffs_test_gc_on_oom)
+TEST_CASE_DECL(nffs_test_incremental_gc)
+TEST_CASE_DECL(nffs_test_checkpoint)
+TEST_CASE_DECL(nffs_test_dir_hash)
 
 void
 nffs_test_suite_gen_1_1_init(void)
@@ -174,9 +177,14 @@ TEST_SUITE(nffs_test_suite)
     nffs_test_readdir();
     nffs_test_split_file();
     nffs_test_gc_on_oom();
+    nffs_test_incremental_gc();
+    nffs_test_checkpoint();
+    nffs_test_dir_hash();
 }
 
 TEST_CASE_DECL(nffs_test_cache_large_file)
+TEST_CASE_DECL(nffs_test_random_read)
+TEST_CASE_DECL(nffs_test_cache_index)
 
 TEST_SUITE(nffs_suite_cache)
 {
@@ -186,6 +194,8 @@ TEST_SUITE(nffs_suite_cache)
     TEST_ASSERT(rc == 0);
 
     nffs_test_cache_large_file();
+    nffs_test_random_read();
+    nffs_test_cache_index();
 }
 
 void
@@ -0,0 +1,158 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include <string.h>
+#include "nffs_test_utils.h"
+
+#define NFFS_CACHE_INDEX_BLOCK_SZ   256
+#define NFFS_CACHE_INDEX_NUM_BLOCKS 16
+#define NFFS_CACHE_INDEX_FILE_SZ    \
+    (NFFS_CACHE_INDEX_BLOCK_SZ * NFFS_CACHE_INDEX_NUM_BLOCKS)
+
+#if MYNEWT_VAL(NFFS_CACHE_INDEX_SLOTS) > 0
+
+static uint8_t nffs_cache_index_data[NFFS_CACHE_INDEX_FILE_SZ +
+                                     NFFS_CACHE_INDEX_BLOCK_SZ];
+
+/*
+ * Returns the number of blocks in the file's index.
+ */
+static int
+nffs_cache_index_test_cnt(struct fs_file *fs_file)
+{
+    struct nffs_cache_inode *cache_inode;
+    struct nffs_file *file;
+    int cnt;
+    int rc;
+    int i;
+
+    file = (struct nffs_file *)fs_file;
+    rc = nffs_cache_inode_ensure(&cache_inode, file->nf_inode_entry);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    cnt = 0;
+    for (i = 0; i < MYNEWT_VAL(NFFS_CACHE_INDEX_SLOTS); i++) {
+        if (cache_inode->nci_index[i].ncis_entry != NULL) {
+            cnt++;
+        }
+    }
+    if (cnt == 0) {
+        TEST_ASSERT(cache_inode->nci_index_stride == 0);
+    }
+
+    return cnt;
+}
+
+/*
+ * Reads the file a block at a time, from the back, so that every seek
+ * indexes a block; checks the contents against the expected data.
+ */
+static void
+nffs_cache_index_test_read(struct fs_file *file, uint32_t file_len)
+{
+    static uint8_t buf[NFFS_CACHE_INDEX_BLOCK_SZ];
+    uint32_t off;
+    uint32_t len;
+    int rc;
+
+    off = file_len;
+    while (off > 0) {
+        off -= NFFS_CACHE_INDEX_BLOCK_SZ;
+
+        rc = fs_seek(file, off);
+        TEST_ASSERT_FATAL(rc == 0);
+        rc = fs_read(file, sizeof buf, buf, &len);
+        TEST_ASSERT_FATAL(rc == 0);
+        TEST_ASSERT_FATAL(len == sizeof buf);
+        TEST_ASSERT(memcmp(buf, nffs_cache_index_data + off, len) == 0);
+    }
+}
+
+#endif
+
+TEST_CASE(nffs_test_cache_index)
+{
+#if MYNEWT_VAL(NFFS_CACHE_INDEX_SLOTS) > 0
+    static const uint8_t patch[] = "overwritten";
+    struct fs_file *rfile;
+    struct fs_file *wfile;
+    int rc;
+    int i;
+
+    /*** Setup. */
+    rc = nffs_format(nffs_current_area_descs);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    for (i = 0; i < sizeof nffs_cache_index_data; i++) {
+        nffs_cache_index_data[i] = i ^ (i >> 8);
+    }
+
+    /* Each write appends a separate block. */
+    rc = fs_open("/idx.bin", FS_ACCESS_WRITE, &wfile);
+    TEST_ASSERT_FATAL(rc == 0);
+    for (i = 0; i < NFFS_CACHE_INDEX_NUM_BLOCKS; i++) {
+        rc = fs_write(wfile, nffs_cache_index_data +
+                             i * NFFS_CACHE_INDEX_BLOCK_SZ,
+                      NFFS_CACHE_INDEX_BLOCK_SZ);
+        TEST_ASSERT_FATAL(rc == 0);
+    }
+    rc = fs_close(wfile);
+    TEST_ASSERT(rc == 0);
+
+    nffs_cache_clear();
+
+    rc = fs_open("/idx.bin", FS_ACCESS_READ, &rfile);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(nffs_cache_index_test_cnt(rfile) == 0);
+
+    nffs_cache_index_test_read(rfile, NFFS_CACHE_INDEX_FILE_SZ);
+    TEST_ASSERT(nffs_cache_index_test_cnt(rfile) > 0);
+
+    /*** Overwrite part of a block in the middle of the file. */
+    rc = fs_open("/idx.bin", FS_ACCESS_WRITE, &wfile);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = fs_seek(wfile, NFFS_CACHE_INDEX_FILE_SZ / 2 + 10);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = fs_write(wfile, patch, sizeof patch);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = fs_close(wfile);
+    TEST_ASSERT(rc == 0);
+    memcpy(nffs_cache_index_data + NFFS_CACHE_INDEX_FILE_SZ / 2 + 10,
+           patch, sizeof patch);
+
+    TEST_ASSERT(nffs_cache_index_test_cnt(rfile) == 0);
+    nffs_cache_index_test_read(rfile, NFFS_CACHE_INDEX_FILE_SZ);
+    TEST_ASSERT(nffs_cache_index_test_cnt(rfile) > 0);
+
+    /*** Append a block. */
+    rc = fs_open("/idx.bin", FS_ACCESS_WRITE | FS_ACCESS_APPEND, &wfile);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = fs_write(wfile, nffs_cache_index_data + NFFS_CACHE_INDEX_FILE_SZ,
+                  NFFS_CACHE_INDEX_BLOCK_SZ);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = fs_close(wfile);
+    TEST_ASSERT(rc == 0);
+
+    TEST_ASSERT(nffs_cache_index_test_cnt(rfile) == 0);
+    nffs_cache_index_test_read(rfile, sizeof nffs_cache_index_data);
+    TEST_ASSERT(nffs_cache_index_test_cnt(rfile) > 0);
+
+    rc = fs_close(rfile);
+    TEST_ASSERT(rc == 0);
+#endif
+}
@@ -0,0 +1,192 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "nffs_test_utils.h"
+
+#if MYNEWT_VAL(NFFS_CHECKPOINT)
+
+#define NFFS_CKPT_TEST_FILE_CNT     8
+#define NFFS_CKPT_TEST_FILE_SZ      1024
+#define NFFS_CKPT_TEST_REWRITE_CNT  8
+
+static const struct nffs_area_desc nffs_ckpt_test_area_descs[] = {
+        { 0x00020000, 128 * 1024 },
+        { 0x00040000, 128 * 1024 },
+        { 0x00060000, 128 * 1024 },
+        { 0x00080000, 128 * 1024 },
+        { 0, 0 },
+};
+
+static const struct nffs_area_desc nffs_ckpt_test_ckpt_desc = {
+    0x00010000, 64 * 1024
+};
+
+static char nffs_ckpt_test_names[NFFS_CKPT_TEST_FILE_CNT][8];
+static char nffs_ckpt_test_data[NFFS_CKPT_TEST_FILE_CNT]
+                               [NFFS_CKPT_TEST_FILE_SZ + 16];
+
+/**
+ * Mounts the test file system, and reports how many flash reads and writes
+ * that took.
+ */
+static void
+nffs_ckpt_test_mount(int use_ckpt, uint32_t *out_reads, uint32_t *out_writes)
+{
+    uint32_t reads;
+    uint32_t writes;
+    int rc;
+
+    rc = nffs_checkpoint_set_area(use_ckpt ? &nffs_ckpt_test_ckpt_desc : NULL);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    reads = nffs_stats.snffs_iocnt_read;
+    writes = nffs_stats.snffs_iocnt_write;
+    rc = nffs_detect(nffs_ckpt_test_area_descs);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    if (out_reads != NULL) {
+        *out_reads = nffs_stats.snffs_iocnt_read - reads;
+    }
+    if (out_writes != NULL) {
+        *out_writes = nffs_stats.snffs_iocnt_write - writes;
+    }
+}
+
+TEST_CASE(nffs_test_checkpoint)
+{
+    struct nffs_test_file_desc files[NFFS_CKPT_TEST_FILE_CNT + 2];
+    struct nffs_test_file_desc root;
+    uint32_t full_reads;
+    uint32_t ckpt_reads;
+    uint32_t writes;
+    int done;
+    int rc;
+    int i;
+    int j;
+
+    /*** Set up a file system with lots of garbage in it. */
+    rc = nffs_checkpoint_set_area(&nffs_ckpt_test_ckpt_desc);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = nffs_format(nffs_ckpt_test_area_descs);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    for (i = 0; i < NFFS_CKPT_TEST_FILE_CNT; i++) {
+        sprintf(nffs_ckpt_test_names[i], "/file%d", i);
+        for (j = 0; j < NFFS_CKPT_TEST_REWRITE_CNT; j++) {
+            memset(nffs_ckpt_test_data[i], 'a' + i + j,
+                   NFFS_CKPT_TEST_FILE_SZ);
+            nffs_test_util_create_file(nffs_ckpt_test_names[i],
+                                       nffs_ckpt_test_data[i],
+                                       NFFS_CKPT_TEST_FILE_SZ);
+        }
+    }
+
+    rc = nffs_checkpoint();
+    TEST_ASSERT_FATAL(rc == 0);
+
+    /*** Changes made after the checkpoint. */
+    nffs_test_util_append_file("/file0", "tail", 4);
+    memcpy(nffs_ckpt_test_data[0] + NFFS_CKPT_TEST_FILE_SZ, "tail", 4);
+    rc = fs_unlink(nffs_ckpt_test_names[NFFS_CKPT_TEST_FILE_CNT - 1]);
+    TEST_ASSERT_FATAL(rc == 0);
+    nffs_test_util_create_file("/new", "new", 3);
+
+    memset(files, 0, sizeof files);
+    for (i = 0; i < NFFS_CKPT_TEST_FILE_CNT - 1; i++) {
+        files[i].filename = nffs_ckpt_test_names[i] + 1;
+        files[i].contents = nffs_ckpt_test_data[i];
+        files[i].contents_len = NFFS_CKPT_TEST_FILE_SZ;
+    }
+    files[0].contents_len += 4;
+    files[i].filename = "new";
+    files[i].contents = "new";
+    files[i].contents_len = 3;
+
+    memset(&root, 0, sizeof root);
+    root.filename = "";
+    root.is_dir = 1;
+    root.children = files;
+
+    /*** Mount with and without the checkpoint; both must agree. */
+    nffs_ckpt_test_mount(0, &full_reads, NULL);
+    nffs_test_assert_system_once(&root);
+
+    /* The superseded data is not read, and the checkpoint is still good. */
+    nffs_ckpt_test_mount(1, &ckpt_reads, &writes);
+    nffs_test_assert_system_once(&root);
+    TEST_ASSERT(ckpt_reads < full_reads / 2);
+    TEST_ASSERT(writes == 0);
+
+    /*** Garbage collection rewrites the checkpoint. */
+    rc = nffs_gc(NULL);
+    TEST_ASSERT_FATAL(rc == 0);
+    nffs_ckpt_test_mount(1, NULL, &writes);
+    nffs_test_assert_system(&root, nffs_ckpt_test_area_descs);
+    TEST_ASSERT(writes == 0);
+
+    /*** While a cycle is in progress, the checkpoint waits for its end. */
+    rc = nffs_gc_step(1, &done);
+    TEST_ASSERT_FATAL(rc == 0 && !done);
+    writes = nffs_stats.snffs_iocnt_write;
+    rc = nffs_checkpoint();
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(nffs_stats.snffs_iocnt_write == writes);
+    TEST_ASSERT(nffs_areas[nffs_scratch_area_idx].na_id !=
+                NFFS_AREA_ID_NONE);
+
+    rc = nffs_gc(NULL);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(nffs_stats.snffs_iocnt_write != writes);
+    nffs_ckpt_test_mount(1, NULL, &writes);
+    nffs_test_assert_system(&root, nffs_ckpt_test_area_descs);
+    TEST_ASSERT(writes == 0);
+
+    /*** A checkpoint of another file system must not be used. */
+    rc = nffs_checkpoint();
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = nffs_checkpoint_set_area(NULL);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = nffs_format(nffs_ckpt_test_area_descs);
+    TEST_ASSERT_FATAL(rc == 0);
+    nffs_test_util_create_file("/other", "other", 5);
+
+    nffs_ckpt_test_mount(1, NULL, &writes);
+    TEST_ASSERT(writes > 0);
+
+    memset(files, 0, sizeof files);
+    files[0].filename = "other";
+    files[0].contents = "other";
+    files[0].contents_len = 5;
+    nffs_test_assert_system_once(&root);
+
+    /* The stale checkpoint got replaced. */
+    nffs_ckpt_test_mount(1, NULL, &writes);
+    nffs_test_assert_system_once(&root);
+    TEST_ASSERT(writes == 0);
+
+    rc = nffs_checkpoint_set_area(NULL);
+    TEST_ASSERT(rc == 0);
+}
+
+#else
+
+TEST_CASE(nffs_test_checkpoint)
+{
+}
+
+#endif
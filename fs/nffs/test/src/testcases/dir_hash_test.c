@@ -0,0 +1,123 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdio.h>
+#include "nffs_test_utils.h"
+
+#define NFFS_TEST_DIR_HASH_NUM_FILES    200
+
+static void
+nffs_test_dir_hash_name(char *buf, const char *dir, int i)
+{
+    /* Every fourth name is long enough to not fit in the short filename. */
+    if (i % 4 == 0) {
+        sprintf(buf, "%s/sample-%04d-of-a-rather-long-series.log", dir, i);
+    } else {
+        sprintf(buf, "%s/%d", dir, i);
+    }
+}
+
+static void
+nffs_test_dir_hash_assert_all(const char *dir, int skip)
+{
+    char path[64];
+    int i;
+
+    for (i = 0; i < NFFS_TEST_DIR_HASH_NUM_FILES; i++) {
+        if (i == skip) {
+            continue;
+        }
+        nffs_test_dir_hash_name(path, dir, i);
+        nffs_test_util_assert_contents(path, path, strlen(path));
+    }
+}
+
+TEST_CASE(nffs_test_dir_hash)
+{
+    struct fs_file *file;
+    char path[64];
+    int rc;
+    int i;
+
+    /*** Setup. */
+    rc = nffs_format(nffs_current_area_descs);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    rc = fs_mkdir("/a");
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = fs_mkdir("/b");
+    TEST_ASSERT_FATAL(rc == 0);
+
+    /* Same filenames in two directories; lookups must not mix them up. */
+    for (i = 0; i < NFFS_TEST_DIR_HASH_NUM_FILES; i++) {
+        nffs_test_dir_hash_name(path, "/a", i);
+        nffs_test_util_create_file(path, path, strlen(path));
+        nffs_test_dir_hash_name(path, "/b", i);
+        nffs_test_util_create_file(path, path, strlen(path));
+    }
+
+    nffs_test_dir_hash_assert_all("/a", -1);
+    nffs_test_dir_hash_assert_all("/b", -1);
+
+    rc = fs_open("/a/nonexistent", FS_ACCESS_READ, &file);
+    TEST_ASSERT(rc == FS_ENOENT);
+    rc = fs_open("/b/sample", FS_ACCESS_READ, &file);
+    TEST_ASSERT(rc == FS_ENOENT);
+
+    /*** Rename within a directory, and across directories. */
+    rc = fs_rename("/a/5", "/a/renamed");
+    TEST_ASSERT(rc == 0);
+    rc = fs_open("/a/5", FS_ACCESS_READ, &file);
+    TEST_ASSERT(rc == FS_ENOENT);
+    nffs_test_util_assert_contents("/a/renamed", "/a/5", 4);
+
+    rc = fs_rename("/b/7", "/a/7");
+    TEST_ASSERT(rc == 0);
+    rc = fs_open("/b/7", FS_ACCESS_READ, &file);
+    TEST_ASSERT(rc == FS_ENOENT);
+    nffs_test_util_assert_contents("/a/7", "/b/7", 4);
+
+    rc = fs_unlink("/a/7");
+    TEST_ASSERT(rc == 0);
+    rc = fs_rename("/a/renamed", "/a/5");
+    TEST_ASSERT(rc == 0);
+
+    /*** Unlink a directory and reuse its children's names. */
+    rc = fs_unlink("/b");
+    TEST_ASSERT(rc == 0);
+    rc = fs_open("/b/8", FS_ACCESS_READ, &file);
+    TEST_ASSERT(rc == FS_ENOENT);
+    rc = fs_mkdir("/b");
+    TEST_ASSERT(rc == 0);
+    nffs_test_util_create_file("/b/8", "new", 3);
+    nffs_test_util_assert_contents("/b/8", "new", 3);
+
+    nffs_test_dir_hash_assert_all("/a", 7);
+
+    /*** The index gets rebuilt when the file system is restored. */
+    rc = nffs_detect(nffs_current_area_descs);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    nffs_test_dir_hash_assert_all("/a", 7);
+    nffs_test_util_assert_contents("/b/8", "new", 3);
+    rc = fs_open("/a/7", FS_ACCESS_READ, &file);
+    TEST_ASSERT(rc == FS_ENOENT);
+    rc = fs_open("/b/9", FS_ACCESS_READ, &file);
+    TEST_ASSERT(rc == FS_ENOENT);
+}
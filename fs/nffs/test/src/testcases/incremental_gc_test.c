@@ -0,0 +1,167 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "nffs_test_utils.h"
+
+static void
+nffs_test_incremental_gc_append(const char *filename, int len)
+{
+    nffs_test_util_append_file(filename, "bbbbbbbbbbbbbbbb", len);
+}
+
+TEST_CASE(nffs_test_incremental_gc)
+{
+    static char other_contents[256];
+    struct nffs_inode_entry *inode_entry;
+    unsigned int gc_count;
+    int other_len;
+    uint32_t area_offset;
+    uint8_t from_area_idx;
+    uint8_t area_idx;
+    int steps;
+    int done;
+    int rc;
+    int i;
+
+    /*** Setup. */
+    static const struct nffs_area_desc area_descs_three[] = {
+            { 0x00000000, 16 * 1024 },
+            { 0x00004000, 16 * 1024 },
+            { 0x00008000, 16 * 1024 },
+            { 0, 0 },
+    };
+
+    struct nffs_test_block_desc blocks[8] = { {
+        .data = "1",
+        .data_len = 1,
+    }, {
+        .data = "2",
+        .data_len = 1,
+    }, {
+        .data = "3",
+        .data_len = 1,
+    }, {
+        .data = "4",
+        .data_len = 1,
+    }, {
+        .data = "5",
+        .data_len = 1,
+    }, {
+        .data = "6",
+        .data_len = 1,
+    }, {
+        .data = "7",
+        .data_len = 1,
+    }, {
+        .data = "8",
+        .data_len = 1,
+    } };
+
+    rc = nffs_format(area_descs_three);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    nffs_test_util_create_file_blocks("/myfile.txt", blocks, 8);
+    nffs_test_util_create_file("/garbage.txt", "aaaaaaaa", 8);
+    nffs_test_util_create_file("/garbage.txt", "aaaa", 4);
+    nffs_test_util_create_file("/other.txt", "", 0);
+
+    /*** Collect one area a slice at a time, writing in between. */
+    gc_count = nffs_gc_count;
+    from_area_idx = NFFS_AREA_ID_NONE;
+    done = 0;
+    for (steps = 0; !done; steps++) {
+        TEST_ASSERT_FATAL(steps < 1000);
+
+        rc = nffs_gc_step(1, &done);
+        TEST_ASSERT_FATAL(rc == 0);
+
+        if (!done) {
+            if (from_area_idx == NFFS_AREA_ID_NONE) {
+                for (i = 0; i < nffs_num_areas; i++) {
+                    if (nffs_gc_area_busy(i)) {
+                        from_area_idx = i;
+                    }
+                }
+            }
+            TEST_ASSERT(nffs_gc_area_busy(from_area_idx));
+            TEST_ASSERT(nffs_gc_count == gc_count);
+
+            /* Foreground writes must stay out of the source area. */
+            nffs_test_incremental_gc_append("/other.txt", 1);
+            TEST_ASSERT(nffs_gc_count == gc_count);
+            rc = nffs_path_find_inode_entry("/other.txt", &inode_entry);
+            TEST_ASSERT_FATAL(rc == 0);
+            nffs_flash_loc_expand(
+                inode_entry->nie_last_block_entry->nhe_flash_loc,
+                &area_idx, &area_offset);
+            TEST_ASSERT(area_idx != from_area_idx);
+        }
+    }
+
+    /* Begin, at least two copy slices, and the erase. */
+    TEST_ASSERT(steps >= 4);
+    other_len = steps - 1;
+    TEST_ASSERT(nffs_gc_count == gc_count + 1);
+    TEST_ASSERT(!nffs_gc_area_busy(from_area_idx));
+    TEST_ASSERT(from_area_idx == nffs_scratch_area_idx);
+
+    nffs_test_util_assert_contents("/myfile.txt", "12345678", 8);
+    nffs_test_util_assert_block_count("/myfile.txt", 1);
+
+    /*** Interrupt a cycle; the file system must restore cleanly. */
+    rc = nffs_gc_step(1, &done);
+    TEST_ASSERT_FATAL(rc == 0 && !done);
+    rc = nffs_gc_step(1, &done);
+    TEST_ASSERT_FATAL(rc == 0 && !done);
+    nffs_test_incremental_gc_append("/other.txt", 4);
+    other_len += 4;
+    TEST_ASSERT_FATAL(other_len <= sizeof other_contents);
+
+    rc = nffs_misc_reset();
+    TEST_ASSERT(rc == 0);
+    rc = nffs_detect(area_descs_three);
+    TEST_ASSERT(rc == 0);
+
+    struct nffs_test_file_desc *expected_system =
+        (struct nffs_test_file_desc[]) { {
+            .filename = "",
+            .is_dir = 1,
+            .children = (struct nffs_test_file_desc[]) { {
+                .filename = "myfile.txt",
+                .contents = "12345678",
+                .contents_len = 8,
+            }, {
+                .filename = "garbage.txt",
+                .contents = "aaaa",
+                .contents_len = 4,
+            }, {
+                .filename = "other.txt",
+                .contents = NULL,
+                .contents_len = 0,
+            }, {
+                .filename = NULL,
+            } },
+    } };
+
+    /* Fill in the contents of the file written during collection. */
+    memset(other_contents, 'b', other_len);
+    expected_system->children[2].contents = other_contents;
+    expected_system->children[2].contents_len = other_len;
+
+    nffs_test_assert_system(expected_system, area_descs_three);
+}
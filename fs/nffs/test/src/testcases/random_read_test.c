@@ -0,0 +1,109 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "nffs_test_utils.h"
+
+#define NFFS_RANDOM_READ_BLOCK_SZ   256
+#define NFFS_RANDOM_READ_NUM_BLOCKS 1024
+#define NFFS_RANDOM_READ_FILE_SZ    \
+    (NFFS_RANDOM_READ_BLOCK_SZ * NFFS_RANDOM_READ_NUM_BLOCKS)
+#define NFFS_RANDOM_READ_ITERS      512
+#define NFFS_RANDOM_READ_LEN        16
+
+/*
+ * Flash reads a seek may take: with the block index, one header per block
+ * in a stride, and a few more to read the data.  Without it, a seek walks
+ * back from the end of the file.
+ */
+#if MYNEWT_VAL(NFFS_CACHE_INDEX_SLOTS) > 0
+#define NFFS_RANDOM_READ_MAX_IO                                         \
+    (NFFS_RANDOM_READ_FILE_SZ / MYNEWT_VAL(NFFS_CACHE_INDEX_SLOTS) /    \
+     NFFS_RANDOM_READ_BLOCK_SZ + 4)
+#else
+#define NFFS_RANDOM_READ_MAX_IO     (NFFS_RANDOM_READ_NUM_BLOCKS + 4)
+#endif
+
+static uint8_t
+nffs_random_read_byte(uint32_t off)
+{
+    return off ^ (off >> 8) ^ (off >> 16);
+}
+
+TEST_CASE(nffs_test_random_read)
+{
+    static uint8_t buf[NFFS_RANDOM_READ_BLOCK_SZ];
+    struct fs_file *file;
+    uint32_t reads;
+    uint32_t seed;
+    uint32_t off;
+    uint32_t len;
+    int rc;
+    int i;
+    int j;
+
+    /*** Setup. */
+    nffs_config.nc_num_inodes = 16;
+    nffs_config.nc_num_blocks = NFFS_RANDOM_READ_NUM_BLOCKS + 16;
+    rc = nffs_init();
+    TEST_ASSERT_FATAL(rc == 0);
+
+    rc = nffs_format(nffs_current_area_descs);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    /* Each write appends a separate block. */
+    rc = fs_open("/big.bin", FS_ACCESS_WRITE, &file);
+    TEST_ASSERT_FATAL(rc == 0);
+    for (i = 0; i < NFFS_RANDOM_READ_NUM_BLOCKS; i++) {
+        for (j = 0; j < NFFS_RANDOM_READ_BLOCK_SZ; j++) {
+            buf[j] = nffs_random_read_byte(i * NFFS_RANDOM_READ_BLOCK_SZ + j);
+        }
+        rc = fs_write(file, buf, sizeof buf);
+        TEST_ASSERT_FATAL(rc == 0);
+    }
+    rc = fs_close(file);
+    TEST_ASSERT(rc == 0);
+
+    nffs_cache_clear();
+
+    /*** Read short chunks from random offsets. */
+    rc = fs_open("/big.bin", FS_ACCESS_READ, &file);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    seed = 1;
+    reads = nffs_stats.snffs_iocnt_read;
+    for (i = 0; i < NFFS_RANDOM_READ_ITERS; i++) {
+        seed = seed * 1103515245 + 12345;
+        off = (seed >> 8) %
+              (NFFS_RANDOM_READ_FILE_SZ - NFFS_RANDOM_READ_LEN);
+
+        rc = fs_seek(file, off);
+        TEST_ASSERT_FATAL(rc == 0);
+        rc = fs_read(file, NFFS_RANDOM_READ_LEN, buf, &len);
+        TEST_ASSERT_FATAL(rc == 0);
+        TEST_ASSERT_FATAL(len == NFFS_RANDOM_READ_LEN);
+
+        for (j = 0; j < NFFS_RANDOM_READ_LEN; j++) {
+            TEST_ASSERT_FATAL(buf[j] == nffs_random_read_byte(off + j));
+        }
+    }
+    reads = nffs_stats.snffs_iocnt_read - reads;
+    TEST_ASSERT(reads <= NFFS_RANDOM_READ_ITERS * NFFS_RANDOM_READ_MAX_IO);
+
+    rc = fs_close(file);
+    TEST_ASSERT(rc == 0);
+}
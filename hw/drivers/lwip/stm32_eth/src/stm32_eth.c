@@ -38,6 +38,10 @@
 #include <lwip/ethip6.h>
 #include <string.h>
 
+#if MYNEWT_VAL(STM32_ETH_RX_MBUF)
+#include <ip/lwip_mbuf.h>
+#endif
+
 #include "stm32_eth/stm32_eth.h"
 #include "stm32_eth/stm32_eth_cfg.h"
 
@@ -114,7 +118,14 @@ stm32_eth_fill_rx(struct stm32_eth_state *ses)
         if (sed->p) {
             break;
         }
+#if MYNEWT_VAL(STM32_ETH_RX_MBUF)
+        p = lwip_mbuf_rx_pbuf_alloc(ETH_MAX_PACKET_SIZE);
+        if (!p) {
+            p = pbuf_alloc(PBUF_RAW, ETH_MAX_PACKET_SIZE, PBUF_POOL);
+        }
+#else
         p = pbuf_alloc(PBUF_RAW, ETH_MAX_PACKET_SIZE, PBUF_POOL);
+#endif
         if (!p) {
             ++stm32_eth_stats.imem;
             break;
@@ -0,0 +1,72 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+/**
+ * @addtogroup HAL
+ * @{
+ *   @defgroup HALCrc HAL CRC
+ *   @{
+ */
+
+#ifndef __HAL_CRC_H_
+#define __HAL_CRC_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <inttypes.h>
+
+/**
+ * CRCs which util/crc can hand over to the MCU.
+ */
+#define HAL_CRC_8           0   /* crc8_calc() */
+#define HAL_CRC_16_CCITT    1   /* crc16_ccitt() */
+#define HAL_CRC_32          2   /* crc32_calc() */
+#define HAL_CRC_32C         3   /* crc32c_calc() */
+
+/**
+ * Computes a CRC with the MCU CRC engine.  Both the CRC passed in and the
+ * one returned are the same as for the util/crc function of that type, so
+ * the engine can take over in the middle of a computation.
+ *
+ * Only used with CRC_HAL set in util/crc.
+ *
+ * @param type                  HAL_CRC_XXX
+ * @param crc                   In: CRC so far, out: updated CRC.
+ * @param buf                   Data to add to the CRC.
+ * @param len                   Number of bytes in buf.
+ *
+ * @return                      0 if the CRC was computed; nonzero if the
+ *                                  engine does not support the CRC or the
+ *                                  buffer, and software should do it.
+ */
+int hal_crc_calc(int type, uint32_t *crc, const void *buf, int len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
+/**
+ *   @} HALCrc
+ * @} HAL
+ */
@@ -19,6 +19,9 @@
 #ifndef __MCU_SIM_H__
 #define __MCU_SIM_H__
 
+#include <stdint.h>
+#include "syscfg/syscfg.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -31,6 +34,19 @@ extern const char *native_uart_dev_strs[];
 
 void mcu_sim_parse_args(int argc, char **argv);
 
+#if MYNEWT_VAL(MCU_TIMER_HIRES)
+/*
+ * How late hal_timer callbacks were called, in timer ticks.
+ */
+struct native_timer_jitter {
+    uint32_t ntj_cnt;           /* Number of callbacks */
+    uint32_t ntj_max;           /* Largest delay */
+    uint64_t ntj_sum;           /* Sum of delays */
+};
+
+int native_timer_jitter(int num, struct native_timer_jitter *ntj, int reset);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -21,25 +21,236 @@
 #include "os/mynewt.h"
 
 #include "hal/hal_timer.h"
+#include "mcu/mcu_sim.h"
+
+#if MYNEWT_VAL(MCU_TIMER_HIRES)
+#ifndef MN_LINUX
+#error "MCU_TIMER_HIRES needs POSIX timers"
+#endif
+#include <signal.h>
+#include <string.h>
+#include <time.h>
+#include "sim/sim.h"
+#endif
 
 /*
  * For native cpu implementation.
  */
+#if MYNEWT_VAL(MCU_TIMER_HIRES)
+/*
+ * The counter runs off the host monotonic clock. Running timers are kept
+ * in a binary heap ordered by expiry; link.tqe_prev of a running timer
+ * points to its slot in the heap. A host timer raises SIGIO at the expiry
+ * of the earliest one, and callbacks get called from the sim I/O
+ * interrupt handler, like they would be from a timer ISR.
+ */
+#define NATIVE_TIMER_HEAP_SIZE  MYNEWT_VAL(MCU_TIMER_HEAP_SIZE)
+#define NATIVE_NSEC_PER_SEC     1000000000ULL
+#else
 static uint8_t native_timer_task_started;
 #define NATIVE_TIMER_STACK_SIZE   (1024)
 static os_stack_t native_timer_stack[NATIVE_TIMER_STACK_SIZE];
 static struct os_task native_timer_task_struct;
 static struct os_eventq native_timer_evq;
+#endif
 
 struct native_timer {
+#if MYNEWT_VAL(MCU_TIMER_HIRES)
+    uint32_t freq;
+    struct timespec base;
+    timer_t host_timer;
+    uint8_t host_timer_created;
+    struct sim_io_handler io_handler;
+    struct native_timer_jitter jitter;
+    int heap_cnt;
+    struct hal_timer *heap[NATIVE_TIMER_HEAP_SIZE];
+#else
     struct os_callout callout;
     uint32_t ticks_per_ostick;
     uint32_t cnt;
     uint32_t last_ostime;
-    int num;
     TAILQ_HEAD(hal_timer_qhead, hal_timer) timers;
+#endif
+    int num;
 } native_timers[1];
 
+#if MYNEWT_VAL(MCU_TIMER_HIRES)
+/*
+ * Returns the 64 bit timer count at the current time, which is also
+ * returned in 'now'.
+ */
+static uint64_t
+native_timer_cnt(struct native_timer *nt, struct timespec *now)
+{
+    uint64_t sec;
+    long nsec;
+
+    clock_gettime(CLOCK_MONOTONIC, now);
+    sec = now->tv_sec - nt->base.tv_sec;
+    nsec = now->tv_nsec - nt->base.tv_nsec;
+    if (nsec < 0) {
+        sec--;
+        nsec += NATIVE_NSEC_PER_SEC;
+    }
+    return sec * nt->freq + (uint64_t)nsec * nt->freq / NATIVE_NSEC_PER_SEC;
+}
+
+static int
+native_timer_before(const struct hal_timer *a, const struct hal_timer *b)
+{
+    return (int32_t)(a->expiry - b->expiry) < 0;
+}
+
+static void
+native_timer_heap_set(struct native_timer *nt, int idx, struct hal_timer *ht)
+{
+    nt->heap[idx] = ht;
+    ht->link.tqe_prev = &nt->heap[idx];
+}
+
+static void
+native_timer_heap_up(struct native_timer *nt, int idx)
+{
+    struct hal_timer *ht;
+    int parent;
+
+    ht = nt->heap[idx];
+    while (idx > 0) {
+        parent = (idx - 1) / 2;
+        if (!native_timer_before(ht, nt->heap[parent])) {
+            break;
+        }
+        native_timer_heap_set(nt, idx, nt->heap[parent]);
+        idx = parent;
+    }
+    native_timer_heap_set(nt, idx, ht);
+}
+
+static void
+native_timer_heap_down(struct native_timer *nt, int idx)
+{
+    struct hal_timer *ht;
+    int child;
+
+    ht = nt->heap[idx];
+    while ((child = 2 * idx + 1) < nt->heap_cnt) {
+        if (child + 1 < nt->heap_cnt &&
+            native_timer_before(nt->heap[child + 1], nt->heap[child])) {
+            child++;
+        }
+        if (!native_timer_before(nt->heap[child], ht)) {
+            break;
+        }
+        native_timer_heap_set(nt, idx, nt->heap[child]);
+        idx = child;
+    }
+    native_timer_heap_set(nt, idx, ht);
+}
+
+static void
+native_timer_heap_remove(struct native_timer *nt, struct hal_timer *ht)
+{
+    struct hal_timer *last;
+    int idx;
+
+    idx = ht->link.tqe_prev - nt->heap;
+    ht->link.tqe_prev = NULL;
+
+    last = nt->heap[--nt->heap_cnt];
+    if (idx < nt->heap_cnt) {
+        native_timer_heap_set(nt, idx, last);
+        if (idx > 0 && native_timer_before(last, nt->heap[(idx - 1) / 2])) {
+            native_timer_heap_up(nt, idx);
+        } else {
+            native_timer_heap_down(nt, idx);
+        }
+    }
+}
+
+/*
+ * Sets the host timer to go off when the earliest timer expires, or stops
+ * it if no timers are running.
+ */
+static void
+native_timer_arm(struct native_timer *nt)
+{
+    struct itimerspec its;
+    struct timespec now;
+    int32_t delta;
+    uint64_t nsec;
+
+    if (!nt->host_timer_created) {
+        return;
+    }
+    memset(&its, 0, sizeof(its));
+    if (nt->heap_cnt) {
+        delta = (int32_t)(nt->heap[0]->expiry -
+                          (uint32_t)native_timer_cnt(nt, &now));
+        if (delta < 0) {
+            delta = 0;
+        }
+        /* Round up, so the counter has reached expiry by then. */
+        nsec = now.tv_nsec + ((uint64_t)delta * NATIVE_NSEC_PER_SEC +
+                              nt->freq - 1) / nt->freq;
+        its.it_value.tv_sec = now.tv_sec + nsec / NATIVE_NSEC_PER_SEC;
+        its.it_value.tv_nsec = nsec % NATIVE_NSEC_PER_SEC;
+    }
+    timer_settime(nt->host_timer, TIMER_ABSTIME, &its, NULL);
+}
+
+/**
+ * Called from the sim I/O interrupt; calls the callbacks of the timers
+ * that have expired.
+ */
+static void
+native_timer_irq(void *arg)
+{
+    struct native_timer *nt = arg;
+    struct native_timer_jitter *ntj;
+    struct hal_timer *ht;
+    struct timespec now;
+    uint32_t late;
+
+    ntj = &nt->jitter;
+    while (nt->heap_cnt) {
+        ht = nt->heap[0];
+        late = (uint32_t)native_timer_cnt(nt, &now) - ht->expiry;
+        if ((int32_t)late < 0) {
+            break;
+        }
+        native_timer_heap_remove(nt, ht);
+
+        ntj->ntj_cnt++;
+        ntj->ntj_sum += late;
+        if (late > ntj->ntj_max) {
+            ntj->ntj_max = late;
+        }
+        ht->cb_func(ht->cb_arg);
+    }
+    native_timer_arm(nt);
+}
+
+int
+native_timer_jitter(int num, struct native_timer_jitter *ntj, int reset)
+{
+    struct native_timer *nt;
+    os_sr_t sr;
+
+    if (num != 0) {
+        return -1;
+    }
+    nt = &native_timers[num];
+
+    OS_ENTER_CRITICAL(sr);
+    *ntj = nt->jitter;
+    if (reset) {
+        memset(&nt->jitter, 0, sizeof(nt->jitter));
+    }
+    OS_EXIT_CRITICAL(sr);
+
+    return 0;
+}
+#else
 /**
  * This is the function called when the timer fires.
  *
@@ -79,6 +290,7 @@ native_timer_task(void *arg)
         os_eventq_run(&native_timer_evq);
     }
 }
+#endif
 
 int
 hal_timer_init(int num, void *cfg)
@@ -90,12 +302,41 @@ int
 hal_timer_config(int num, uint32_t clock_freq)
 {
     struct native_timer *nt;
+#if MYNEWT_VAL(MCU_TIMER_HIRES)
+    struct sigevent sev = { 0 };
+    os_sr_t sr;
+#endif
 
     if (num != 0) {
         return -1;
     }
     nt = &native_timers[num];
 
+#if MYNEWT_VAL(MCU_TIMER_HIRES)
+    if (clock_freq == 0 || clock_freq > NATIVE_NSEC_PER_SEC) {
+        return -1;
+    }
+
+    OS_ENTER_CRITICAL(sr);
+    if (!nt->host_timer_created) {
+        /* Expiry is reported the same way as sim I/O readiness. */
+        sev.sigev_notify = SIGEV_SIGNAL;
+        sev.sigev_signo = SIGIO;
+        if (timer_create(CLOCK_MONOTONIC, &sev, &nt->host_timer)) {
+            OS_EXIT_CRITICAL(sr);
+            return -1;
+        }
+        nt->io_handler.sih_fn = native_timer_irq;
+        nt->io_handler.sih_arg = nt;
+        sim_io_handler_add(&nt->io_handler);
+        nt->host_timer_created = 1;
+    }
+    nt->num = num;
+    nt->freq = clock_freq;
+    clock_gettime(CLOCK_MONOTONIC, &nt->base);
+    native_timer_arm(nt);
+    OS_EXIT_CRITICAL(sr);
+#else
     /* Set the clock frequency */
     nt->ticks_per_ostick = clock_freq / OS_TICKS_PER_SEC;
     if (!nt->ticks_per_ostick) {
@@ -116,6 +357,7 @@ hal_timer_config(int num, uint32_t clock_freq)
 
     /* Initialize the callout function */
     os_callout_init(&nt->callout, &native_timer_evq, native_timer_cb, nt);
+#endif
 
     return 0;
 }
@@ -124,13 +366,25 @@ int
 hal_timer_deinit(int num)
 {
     struct native_timer *nt;
+#if MYNEWT_VAL(MCU_TIMER_HIRES)
+    os_sr_t sr;
+#endif
 
     if (num != 0) {
         return -1;
     }
     nt = &native_timers[num];
 
+#if MYNEWT_VAL(MCU_TIMER_HIRES)
+    OS_ENTER_CRITICAL(sr);
+    while (nt->heap_cnt) {
+        nt->heap[--nt->heap_cnt]->link.tqe_prev = NULL;
+    }
+    native_timer_arm(nt);
+    OS_EXIT_CRITICAL(sr);
+#else
     os_callout_stop(&nt->callout);
+#endif
     return 0;
 }
 
@@ -148,11 +402,15 @@ hal_timer_get_resolution(int num)
 {
     struct native_timer *nt;
 
-    if (num >= 0) {
+    if (num != 0) {
         return 0;
     }
     nt = &native_timers[num];
+#if MYNEWT_VAL(MCU_TIMER_HIRES)
+    return NATIVE_NSEC_PER_SEC / nt->freq;
+#else
     return 1000000000 / (nt->ticks_per_ostick * OS_TICKS_PER_SEC);
+#endif
 }
 
 /**
@@ -166,14 +424,21 @@ uint32_t
 hal_timer_read(int num)
 {
     struct native_timer *nt;
+#if MYNEWT_VAL(MCU_TIMER_HIRES)
+    struct timespec now;
+#else
     os_sr_t sr;
     uint32_t ostime;
     uint32_t delta_osticks;
+#endif
 
     if (num != 0) {
         return -1;
     }
     nt = &native_timers[num];
+#if MYNEWT_VAL(MCU_TIMER_HIRES)
+    return (uint32_t)native_timer_cnt(nt, &now);
+#else
     OS_ENTER_CRITICAL(sr);
     ostime = os_time_get();
     delta_osticks = (uint32_t)(ostime - nt->last_ostime);
@@ -185,6 +450,7 @@ hal_timer_read(int num)
     OS_EXIT_CRITICAL(sr);
 
     return (uint32_t)nt->cnt;
+#endif
 }
 
 /**
@@ -276,13 +542,33 @@ int
 hal_timer_start_at(struct hal_timer *timer, uint32_t tick)
 {
     struct native_timer *nt;
+#if !MYNEWT_VAL(MCU_TIMER_HIRES)
     struct hal_timer *ht;
     uint32_t curtime;
     uint32_t osticks;
+#endif
     os_sr_t sr;
 
     nt = (struct native_timer *)timer->bsp_timer;
 
+#if MYNEWT_VAL(MCU_TIMER_HIRES)
+    OS_ENTER_CRITICAL(sr);
+    if (timer->link.tqe_prev != NULL) {
+        native_timer_heap_remove(nt, timer);
+    }
+    /*
+     * Running out means MCU_TIMER_HEAP_SIZE is too small; callers such as
+     * os_cputime do not check the return code.
+     */
+    assert(nt->heap_cnt < NATIVE_TIMER_HEAP_SIZE);
+    timer->expiry = tick;
+    native_timer_heap_set(nt, nt->heap_cnt++, timer);
+    native_timer_heap_up(nt, nt->heap_cnt - 1);
+    if (nt->heap[0] == timer) {
+        native_timer_arm(nt);
+    }
+    OS_EXIT_CRITICAL(sr);
+#else
     timer->expiry = tick;
 
     OS_ENTER_CRITICAL(sr);
@@ -314,6 +600,7 @@ hal_timer_start_at(struct hal_timer *timer, uint32_t tick)
         }
     }
     OS_EXIT_CRITICAL(sr);
+#endif
 
     return 0;
 }
@@ -331,13 +618,24 @@ int
 hal_timer_stop(struct hal_timer *timer)
 {
     struct native_timer *nt;
+#if !MYNEWT_VAL(MCU_TIMER_HIRES)
     struct hal_timer *ht;
+#endif
     int reset_ocmp;
     os_sr_t sr;
 
     OS_ENTER_CRITICAL(sr);
 
     nt = (struct native_timer *)timer->bsp_timer;
+#if MYNEWT_VAL(MCU_TIMER_HIRES)
+    if (timer->link.tqe_prev != NULL) {
+        reset_ocmp = (nt->heap[0] == timer);
+        native_timer_heap_remove(nt, timer);
+        if (reset_ocmp) {
+            native_timer_arm(nt);
+        }
+    }
+#else
     if (timer->link.tqe_prev != NULL) {
         reset_ocmp = 0;
         if (timer == TAILQ_FIRST(&nt->timers)) {
@@ -357,6 +655,7 @@ hal_timer_stop(struct hal_timer *timer)
             }
         }
     }
+#endif
     OS_EXIT_CRITICAL(sr);
 
     return 0;
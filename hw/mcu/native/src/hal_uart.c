@@ -41,6 +41,9 @@
 
 #include "mcu/mcu_sim.h"
 #include "native_uart_cfg_priv.h"
+#if MYNEWT_VAL(MCU_UART_ASYNC_IO)
+#include "sim/sim.h"
+#endif
 
 #define UART_CNT                2
 
@@ -51,6 +54,21 @@
 #endif
 #define UART_POLLER_STACK_SZ	OS_STACK_ALIGN(1024)
 
+#define UART_BUF_SZ             MYNEWT_VAL(MCU_UART_BUF_SIZE)
+
+/*
+ * Line time of a byte (start, 8 data and stop bit), in bits * ticks. Each
+ * UART earns baudrate credits per tick, and spends this much per byte.
+ */
+#define UART_BYTE_COST          (10 * OS_TICKS_PER_SEC)
+
+/* How often an idle buffered poller looks for received data. */
+#if MYNEWT_VAL(MCU_UART_ASYNC_IO)
+#define UART_POLLER_IDLE_ITVL   OS_TICKS_PER_SEC
+#else
+#define UART_POLLER_IDLE_ITVL   (OS_TICKS_PER_SEC / 100)
+#endif
+
 struct uart {
     int u_open;
     int u_fd;
@@ -60,6 +78,22 @@ struct uart {
     hal_uart_tx_char u_tx_func;
     hal_uart_tx_done u_tx_done;
     void *u_func_arg;
+#if UART_BUF_SZ
+    int u_tx_done_pend;
+    int u_rx_more;
+    uint16_t u_rx_off;
+    uint16_t u_rx_len;
+    uint16_t u_tx_off;
+    uint16_t u_tx_len;
+#if MYNEWT_VAL(MCU_UART_EMULATE_BAUD)
+    int32_t u_baudrate;
+    int32_t u_rx_credit;
+    int32_t u_tx_credit;
+    os_time_t u_credit_time;
+#endif
+    uint8_t u_rx_buf[UART_BUF_SZ];
+    uint8_t u_tx_buf[UART_BUF_SZ];
+#endif
 };
 
 const char *native_uart_dev_strs[UART_CNT];
@@ -75,6 +109,12 @@ static struct uart uarts[UART_CNT];
 static int uart_poller_running;
 static struct os_task uart_poller_task;
 static os_stack_t uart_poller_stack[UART_POLLER_STACK_SZ];
+#if UART_BUF_SZ
+static struct os_sem uart_poller_sem;
+#endif
+#if MYNEWT_VAL(MCU_UART_ASYNC_IO)
+static struct sim_io_handler uart_io_handler;
+#endif
 
 static void
 uart_open_log(void)
@@ -174,6 +214,201 @@ uart_transmit_char(struct uart *uart)
     return 0;
 }
 
+#if UART_BUF_SZ
+/*
+ * Buffered mode. Each UART has a receive and a transmit buffer, which are
+ * filled and drained with a single system call. The poller keeps going
+ * while any UART makes progress, and then sleeps until it is woken up by
+ * hal_uart_start_tx(), hal_uart_start_rx(), SIGIO or the idle interval; if
+ * a UART is held up (host not reading, receiver full, baud rate limit), it
+ * tries again on the next tick.
+ */
+static void
+uart_poller_wakeup(void *arg)
+{
+    if (os_sem_get_count(&uart_poller_sem) == 0) {
+        os_sem_release(&uart_poller_sem);
+    }
+}
+
+#if MYNEWT_VAL(MCU_UART_EMULATE_BAUD)
+static void
+uart_credit_update(struct uart *uart)
+{
+    os_time_t now;
+    int32_t max;
+    int32_t add;
+    uint32_t elapsed;
+
+    now = os_time_get();
+    elapsed = now - uart->u_credit_time;
+    uart->u_credit_time = now;
+
+    max = UART_BUF_SZ * UART_BYTE_COST;
+    if (uart->u_baudrate <= 0 || elapsed >= max / uart->u_baudrate + 1) {
+        add = max;
+    } else {
+        add = elapsed * uart->u_baudrate;
+    }
+    uart->u_rx_credit = min(uart->u_rx_credit + add, max);
+    uart->u_tx_credit = min(uart->u_tx_credit + add, max);
+}
+
+#define UART_CREDIT_BYTES(credit)       ((credit) / UART_BYTE_COST)
+#define UART_CREDIT_SPEND(credit, n)    ((credit) -= (n) * UART_BYTE_COST)
+#else
+#define uart_credit_update(uart)
+#define UART_CREDIT_BYTES(credit)       UART_BUF_SZ
+#define UART_CREDIT_SPEND(credit, n)
+#endif
+
+/*
+ * Writes out the transmit buffer, refilling it from the tx callback when
+ * empty. Returns 1 if any progress was made.
+ */
+static int
+uart_poll_tx(struct uart *uart)
+{
+    int progress;
+    int len;
+    int rc;
+    int sr;
+
+    progress = 0;
+    if (uart->u_tx_off == uart->u_tx_len) {
+        uart->u_tx_off = 0;
+        uart->u_tx_len = 0;
+
+        OS_ENTER_CRITICAL(sr);
+        if (uart->u_tx_done_pend) {
+            /* Everything handed to us has been written. */
+            uart->u_tx_done_pend = 0;
+            if (uart->u_tx_done) {
+                uart->u_tx_done(uart->u_func_arg);
+            }
+        }
+        while (uart->u_tx_run && uart->u_tx_len < UART_BUF_SZ) {
+            rc = uart->u_tx_func(uart->u_func_arg);
+            if (rc < 0) {
+                uart->u_tx_run = 0;
+                uart->u_tx_done_pend = 1;
+                break;
+            }
+            uart->u_tx_buf[uart->u_tx_len++] = rc;
+            uart_log_data(uart, 1, rc);
+            progress = 1;
+        }
+        OS_EXIT_CRITICAL(sr);
+    }
+
+    len = min(uart->u_tx_len - uart->u_tx_off,
+              UART_CREDIT_BYTES(uart->u_tx_credit));
+    if (len > 0) {
+        rc = write(uart->u_fd, uart->u_tx_buf + uart->u_tx_off, len);
+        if (rc > 0) {
+            uart->u_tx_off += rc;
+            UART_CREDIT_SPEND(uart->u_tx_credit, rc);
+            progress = 1;
+        }
+        /* XXX EOF/error, what now? */
+    }
+    return progress;
+}
+
+/*
+ * Refills the receive buffer from the host when empty, and hands its
+ * contents to the rx callback until it refuses more. Returns 1 if any
+ * progress was made.
+ */
+static int
+uart_poll_rx(struct uart *uart)
+{
+    int progress;
+    int len;
+    int rc;
+    int sr;
+
+    progress = 0;
+    if (uart->u_rx_off == uart->u_rx_len) {
+        len = min(UART_BUF_SZ, UART_CREDIT_BYTES(uart->u_rx_credit));
+        /*
+         * If the baud rate holds the read back, input may be left waiting
+         * which won't raise SIGIO again; keep polling until it doesn't.
+         */
+        uart->u_rx_more = (len < UART_BUF_SZ);
+        if (len > 0) {
+            rc = read(uart->u_fd, uart->u_rx_buf, len);
+            if (rc == 0) {
+                /* XXX EOF, what now? */
+                assert(0);
+            } else if (rc > 0) {
+                uart->u_rx_off = 0;
+                uart->u_rx_len = rc;
+                UART_CREDIT_SPEND(uart->u_rx_credit, rc);
+                /* There may be more waiting, which won't raise SIGIO. */
+                uart->u_rx_more = (rc == len);
+                progress = 1;
+            }
+        }
+    }
+
+    OS_ENTER_CRITICAL(sr);
+    while (uart->u_rx_off < uart->u_rx_len) {
+        rc = uart->u_rx_func(uart->u_func_arg,
+                             uart->u_rx_buf[uart->u_rx_off]);
+        if (rc < 0) {
+            break;
+        }
+        uart_log_data(uart, 0, uart->u_rx_buf[uart->u_rx_off]);
+        uart->u_rx_off++;
+        progress = 1;
+    }
+    OS_EXIT_CRITICAL(sr);
+
+    return progress;
+}
+
+static int
+uart_pending(const struct uart *uart)
+{
+    return uart->u_tx_run || uart->u_tx_done_pend ||
+           uart->u_tx_off != uart->u_tx_len ||
+           uart->u_rx_off != uart->u_rx_len || uart->u_rx_more;
+}
+
+static void
+uart_poller(void *arg)
+{
+    struct uart *uart;
+    int progress;
+    int pending;
+    int i;
+
+    while (1) {
+        do {
+            progress = 0;
+            for (i = 0; i < UART_CNT; i++) {
+                uart = &uarts[i];
+                if (!uart->u_open) {
+                    continue;
+                }
+                uart_credit_update(uart);
+                progress |= uart_poll_tx(uart);
+                progress |= uart_poll_rx(uart);
+            }
+        } while (progress);
+
+        pending = 0;
+        for (i = 0; i < UART_CNT; i++) {
+            if (uarts[i].u_open && uart_pending(&uarts[i])) {
+                pending = 1;
+            }
+        }
+        uart_log_data(NULL, 0, 0);
+        os_sem_pend(&uart_poller_sem, pending ? 1 : UART_POLLER_IDLE_ITVL);
+    }
+}
+#else
 static void
 uart_poller(void *arg)
 {
@@ -227,6 +462,7 @@ uart_poller(void *arg)
         os_time_delay(OS_TICKS_PER_SEC / 100);
     }
 }
+#endif
 
 static void
 set_nonblock(int fd)
@@ -345,13 +581,25 @@ hal_uart_start_tx(int port)
          */
         uart_transmit_char(&uarts[port]);
     }
+#if UART_BUF_SZ
+    uart_poller_wakeup(NULL);
+#endif
     OS_EXIT_CRITICAL(sr);
 }
 
 void
 hal_uart_start_rx(int port)
 {
-    /* nothing to do here */
+#if UART_BUF_SZ
+    int sr;
+
+    /* The receiver has room again; deliver what is buffered. */
+    if (port < UART_CNT && uarts[port].u_open) {
+        OS_ENTER_CRITICAL(sr);
+        uart_poller_wakeup(NULL);
+        OS_EXIT_CRITICAL(sr);
+    }
+#endif
 }
 
 void
@@ -388,6 +636,13 @@ hal_uart_init_cbs(int port, hal_uart_tx_char tx_func, hal_uart_tx_done tx_done,
 
     if (!uart_poller_running) {
         uart_poller_running = 1;
+#if UART_BUF_SZ
+        os_sem_init(&uart_poller_sem, 0);
+#endif
+#if MYNEWT_VAL(MCU_UART_ASYNC_IO)
+        uart_io_handler.sih_fn = uart_poller_wakeup;
+        sim_io_handler_add(&uart_io_handler);
+#endif
         rc = os_task_init(&uart_poller_task, "uartpoll", uart_poller, NULL,
           MYNEWT_VAL(MCU_UART_POLLER_PRIO), OS_WAIT_FOREVER, uart_poller_stack,
           UART_POLLER_STACK_SZ);
@@ -422,7 +677,26 @@ hal_uart_config(int port, int32_t baudrate, uint8_t databits, uint8_t stopbits,
         return -1;
     }
     set_nonblock(uart->u_fd);
-
+#if MYNEWT_VAL(MCU_UART_ASYNC_IO)
+    if (sim_io_fd_async(uart->u_fd)) {
+        close(uart->u_fd);
+        return -1;
+    }
+#endif
+#if UART_BUF_SZ
+    uart->u_tx_done_pend = 0;
+    uart->u_rx_more = 0;
+    uart->u_rx_off = 0;
+    uart->u_rx_len = 0;
+    uart->u_tx_off = 0;
+    uart->u_tx_len = 0;
+#if MYNEWT_VAL(MCU_UART_EMULATE_BAUD)
+    uart->u_baudrate = baudrate;
+    uart->u_rx_credit = 0;
+    uart->u_tx_credit = 0;
+    uart->u_credit_time = os_time_get();
+#endif
+#endif
 
     uart_open_log();
     uart->u_open = 1;
@@ -0,0 +1,213 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#ifdef MN_LINUX
+#include <pty.h>
+#endif
+#ifdef MN_OSX
+#include <util.h>
+#endif
+#ifdef MN_FreeBSD
+#include <libutil.h>
+#endif
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+
+#include "native_uart_test.h"
+
+/*
+ * The UART under test is connected to the slave side of a pty, and the
+ * test plays the host on the master side.
+ */
+int native_uart_test_fd = -1;
+static char native_uart_test_pty[64];
+
+uint8_t native_uart_test_rx[NATIVE_UART_TEST_BUF_SZ];
+int native_uart_test_rx_cnt;
+int native_uart_test_rx_limit;
+
+int native_uart_test_tx_len;
+int native_uart_test_tx_cnt;
+int native_uart_test_tx_done;
+
+static uint8_t native_uart_test_buf[NATIVE_UART_TEST_BUF_SZ];
+
+uint8_t
+native_uart_test_pattern(int off)
+{
+    return (uint8_t)(off * 7 + (off >> 8));
+}
+
+static int
+native_uart_test_rx_cb(void *arg, uint8_t byte)
+{
+    if (native_uart_test_rx_cnt >= native_uart_test_rx_limit) {
+        return -1;
+    }
+    native_uart_test_rx[native_uart_test_rx_cnt++] = byte;
+    return 0;
+}
+
+static int
+native_uart_test_tx_cb(void *arg)
+{
+    if (native_uart_test_tx_cnt >= native_uart_test_tx_len) {
+        return -1;
+    }
+    return native_uart_test_pattern(native_uart_test_tx_cnt++);
+}
+
+static void
+native_uart_test_tx_done_cb(void *arg)
+{
+    native_uart_test_tx_done++;
+}
+
+void
+native_uart_test_open(int32_t baudrate)
+{
+    int slave;
+    int flags;
+    int rc;
+
+    rc = openpty(&native_uart_test_fd, &slave, native_uart_test_pty,
+                 NULL, NULL);
+    TEST_ASSERT_FATAL(rc == 0);
+    flags = fcntl(native_uart_test_fd, F_GETFL);
+    rc = fcntl(native_uart_test_fd, F_SETFL, flags | O_NONBLOCK);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    native_uart_test_rx_cnt = 0;
+    native_uart_test_rx_limit = NATIVE_UART_TEST_BUF_SZ;
+    native_uart_test_tx_len = 0;
+    native_uart_test_tx_cnt = 0;
+    native_uart_test_tx_done = 0;
+
+    rc = uart_set_dev(NATIVE_UART_TEST_PORT, native_uart_test_pty);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = hal_uart_init_cbs(NATIVE_UART_TEST_PORT, native_uart_test_tx_cb,
+                           native_uart_test_tx_done_cb,
+                           native_uart_test_rx_cb, NULL);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = hal_uart_config(NATIVE_UART_TEST_PORT, baudrate, 8, 1,
+                         HAL_UART_PARITY_NONE, HAL_UART_FLOW_CTL_NONE);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    /* Kept open until now so the pty isn't hung up in between. */
+    close(slave);
+}
+
+void
+native_uart_test_close(void)
+{
+    hal_uart_close(NATIVE_UART_TEST_PORT);
+    uart_set_dev(NATIVE_UART_TEST_PORT, NULL);
+    close(native_uart_test_fd);
+    native_uart_test_fd = -1;
+}
+
+/*
+ * Writes 'len' bytes of the test pattern for the UART to receive.
+ */
+void
+native_uart_test_send(int len)
+{
+    int off;
+    int rc;
+
+    TEST_ASSERT_FATAL(len <= NATIVE_UART_TEST_BUF_SZ);
+    for (off = 0; off < len; off++) {
+        native_uart_test_buf[off] = native_uart_test_pattern(off);
+    }
+    off = 0;
+    while (off < len) {
+        rc = write(native_uart_test_fd, native_uart_test_buf + off,
+                   len - off);
+        if (rc > 0) {
+            off += rc;
+        } else {
+            TEST_ASSERT_FATAL(errno == EAGAIN);
+            os_time_delay(1);
+        }
+    }
+}
+
+/*
+ * Reads what the UART transmitted, until there are 'len' bytes or
+ * 'timeout' ticks have passed. Returns the number of bytes read.
+ */
+int
+native_uart_test_recv(uint8_t *buf, int len, os_time_t timeout)
+{
+    os_time_t start;
+    int cnt;
+    int rc;
+
+    start = os_time_get();
+    cnt = 0;
+    while (cnt < len) {
+        rc = read(native_uart_test_fd, buf + cnt, len - cnt);
+        if (rc > 0) {
+            cnt += rc;
+        } else if (os_time_get() - start >= timeout) {
+            break;
+        } else {
+            os_time_delay(1);
+        }
+    }
+    return cnt;
+}
+
+/*
+ * Waits until the rx callback has taken 'cnt' bytes, or 'timeout' ticks
+ * have passed. Returns the number of bytes taken.
+ */
+int
+native_uart_test_rx_wait(int cnt, os_time_t timeout)
+{
+    os_time_t start;
+
+    start = os_time_get();
+    while (native_uart_test_rx_cnt < cnt &&
+           os_time_get() - start < timeout) {
+        os_time_delay(1);
+    }
+    return native_uart_test_rx_cnt;
+}
+
+TEST_CASE_DECL(native_uart_test_poller)
+
+TEST_SUITE(native_uart_test_all)
+{
+    native_uart_test_poller();
+}
+
+#if MYNEWT_VAL(SELFTEST)
+
+int
+main(int argc, char **argv)
+{
+    sysinit();
+
+    native_uart_test_all();
+
+    return tu_any_failed;
+}
+
+#endif
@@ -0,0 +1,65 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#ifndef _NATIVE_UART_TEST_H
+#define _NATIVE_UART_TEST_H
+
+#include "os/mynewt.h"
+#include "testutil/testutil.h"
+#include "hal/hal_uart.h"
+#include "mcu/native_bsp.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Port 0 is left to the console. */
+#define NATIVE_UART_TEST_PORT       1
+#define NATIVE_UART_TEST_BUF_SZ     1024
+
+/* Our end of the pty the UART is connected to. */
+extern int native_uart_test_fd;
+
+/* Bytes the rx callback took, and how many it takes before refusing. */
+extern uint8_t native_uart_test_rx[NATIVE_UART_TEST_BUF_SZ];
+extern int native_uart_test_rx_cnt;
+extern int native_uart_test_rx_limit;
+
+/* Bytes the tx callback has to give, has given, and tx done calls. */
+extern int native_uart_test_tx_len;
+extern int native_uart_test_tx_cnt;
+extern int native_uart_test_tx_done;
+
+void native_uart_test_open(int32_t baudrate);
+void native_uart_test_close(void);
+uint8_t native_uart_test_pattern(int off);
+void native_uart_test_send(int len);
+int native_uart_test_recv(uint8_t *buf, int len, os_time_t timeout);
+int native_uart_test_rx_wait(int cnt, os_time_t timeout);
+
+void native_uart_test_bulk_rx(void);
+void native_uart_test_bulk_tx(void);
+void native_uart_test_flow(void);
+void native_uart_test_async(void);
+void native_uart_test_baud(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _NATIVE_UART_TEST_H */
@@ -0,0 +1,43 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "native_uart_test.h"
+
+/*
+ * With MCU_UART_ASYNC_IO, an idle poller checks for input only once a
+ * second; input arriving in between must wake it up right away.
+ */
+void
+native_uart_test_async(void)
+{
+    os_time_t start;
+    int cnt;
+
+    native_uart_test_open(115200);
+
+    /* Let the poller go idle. */
+    os_time_delay(OS_TICKS_PER_SEC / 5);
+
+    start = os_time_get();
+    native_uart_test_send(1);
+    cnt = native_uart_test_rx_wait(1, OS_TICKS_PER_SEC * 2);
+    TEST_ASSERT(cnt == 1);
+    TEST_ASSERT(os_time_get() - start <= OS_TICKS_PER_SEC / 20);
+
+    native_uart_test_close();
+}
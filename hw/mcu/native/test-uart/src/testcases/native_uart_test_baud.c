@@ -0,0 +1,61 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "native_uart_test.h"
+
+/*
+ * With MCU_UART_EMULATE_BAUD, data moves no faster than the baud rate
+ * allows, in either direction. At 9600 baud 256 bytes take 267ms; the
+ * poller may send or take a buffer full up front.
+ */
+#define NATIVE_UART_TEST_BAUD       9600
+#define NATIVE_UART_TEST_BAUD_LEN   256
+#define NATIVE_UART_TEST_BAUD_MIN                                       \
+    ((NATIVE_UART_TEST_BAUD_LEN - MYNEWT_VAL(MCU_UART_BUF_SIZE)) * 10 *  \
+     OS_TICKS_PER_SEC / NATIVE_UART_TEST_BAUD)
+
+void
+native_uart_test_baud(void)
+{
+    static uint8_t buf[NATIVE_UART_TEST_BAUD_LEN];
+    os_time_t start;
+    os_time_t ticks;
+    int cnt;
+
+    native_uart_test_open(NATIVE_UART_TEST_BAUD);
+
+    start = os_time_get();
+    native_uart_test_send(NATIVE_UART_TEST_BAUD_LEN);
+    cnt = native_uart_test_rx_wait(NATIVE_UART_TEST_BAUD_LEN,
+                                   OS_TICKS_PER_SEC * 2);
+    ticks = os_time_get() - start;
+    TEST_ASSERT(cnt == NATIVE_UART_TEST_BAUD_LEN);
+    TEST_ASSERT(ticks >= NATIVE_UART_TEST_BAUD_MIN);
+    TEST_ASSERT(ticks < NATIVE_UART_TEST_BAUD_MIN * 3);
+
+    start = os_time_get();
+    native_uart_test_tx_len = NATIVE_UART_TEST_BAUD_LEN;
+    hal_uart_start_tx(NATIVE_UART_TEST_PORT);
+    cnt = native_uart_test_recv(buf, sizeof(buf), OS_TICKS_PER_SEC * 2);
+    ticks = os_time_get() - start;
+    TEST_ASSERT(cnt == NATIVE_UART_TEST_BAUD_LEN);
+    TEST_ASSERT(ticks >= NATIVE_UART_TEST_BAUD_MIN);
+    TEST_ASSERT(ticks < NATIVE_UART_TEST_BAUD_MIN * 3);
+
+    native_uart_test_close();
+}
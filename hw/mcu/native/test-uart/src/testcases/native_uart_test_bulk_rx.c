@@ -0,0 +1,42 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "native_uart_test.h"
+
+/*
+ * More than a buffer full of input gets to the rx callback in order,
+ * without losing or repeating anything.
+ */
+void
+native_uart_test_bulk_rx(void)
+{
+    int cnt;
+    int i;
+
+    native_uart_test_open(115200);
+
+    native_uart_test_send(NATIVE_UART_TEST_BUF_SZ);
+    cnt = native_uart_test_rx_wait(NATIVE_UART_TEST_BUF_SZ, OS_TICKS_PER_SEC);
+    TEST_ASSERT(cnt == NATIVE_UART_TEST_BUF_SZ);
+    for (i = 0; i < cnt; i++) {
+        TEST_ASSERT_FATAL(native_uart_test_rx[i] ==
+                          native_uart_test_pattern(i));
+    }
+
+    native_uart_test_close();
+}
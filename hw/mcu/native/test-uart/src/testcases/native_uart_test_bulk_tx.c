@@ -0,0 +1,57 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "native_uart_test.h"
+
+static uint8_t native_uart_test_tx_buf[NATIVE_UART_TEST_BUF_SZ];
+
+/*
+ * Everything the tx callback gives is written out in order, tx done is
+ * reported once per transfer, and the UART can be started again after.
+ */
+void
+native_uart_test_bulk_tx(void)
+{
+    int round;
+    int cnt;
+    int i;
+
+    native_uart_test_open(115200);
+
+    for (round = 1; round <= 2; round++) {
+        native_uart_test_tx_cnt = 0;
+        native_uart_test_tx_len = NATIVE_UART_TEST_BUF_SZ;
+        hal_uart_start_tx(NATIVE_UART_TEST_PORT);
+
+        cnt = native_uart_test_recv(native_uart_test_tx_buf,
+                                    sizeof(native_uart_test_tx_buf),
+                                    OS_TICKS_PER_SEC);
+        TEST_ASSERT_FATAL(cnt == NATIVE_UART_TEST_BUF_SZ);
+        for (i = 0; i < cnt; i++) {
+            TEST_ASSERT_FATAL(native_uart_test_tx_buf[i] ==
+                              native_uart_test_pattern(i));
+        }
+
+        /* Nothing extra. */
+        os_time_delay(2);
+        TEST_ASSERT(native_uart_test_recv(native_uart_test_tx_buf, 1, 0) == 0);
+        TEST_ASSERT(native_uart_test_tx_done == round);
+    }
+
+    native_uart_test_close();
+}
@@ -0,0 +1,48 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "native_uart_test.h"
+
+/*
+ * Input the rx callback refuses stays buffered, and is delivered once
+ * hal_uart_start_rx() says there is room again.
+ */
+void
+native_uart_test_flow(void)
+{
+    int cnt;
+    int i;
+
+    native_uart_test_open(115200);
+
+    native_uart_test_rx_limit = 100;
+    native_uart_test_send(300);
+    cnt = native_uart_test_rx_wait(300, OS_TICKS_PER_SEC / 4);
+    TEST_ASSERT(cnt == 100);
+
+    native_uart_test_rx_limit = 300;
+    hal_uart_start_rx(NATIVE_UART_TEST_PORT);
+    cnt = native_uart_test_rx_wait(300, OS_TICKS_PER_SEC);
+    TEST_ASSERT(cnt == 300);
+    for (i = 0; i < cnt; i++) {
+        TEST_ASSERT_FATAL(native_uart_test_rx[i] ==
+                          native_uart_test_pattern(i));
+    }
+
+    native_uart_test_close();
+}
@@ -0,0 +1,102 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "native_timer_test.h"
+
+/*
+ * The timers run on the os_cputime timer, which MCU_TIMER_HIRES drives
+ * off the host clock.
+ */
+struct hal_timer native_timer_test_timers[NATIVE_TIMER_TEST_CNT];
+int native_timer_test_fired[NATIVE_TIMER_TEST_CNT * 2];
+int native_timer_test_fired_cnt;
+
+static void
+native_timer_test_cb(void *arg)
+{
+    struct hal_timer *timer;
+
+    timer = arg;
+
+    /* Never early. */
+    TEST_ASSERT((int32_t)(os_cputime_get32() - timer->expiry) >= 0);
+
+    TEST_ASSERT_FATAL(native_timer_test_fired_cnt <
+                      sizeof native_timer_test_fired /
+                      sizeof native_timer_test_fired[0]);
+    native_timer_test_fired[native_timer_test_fired_cnt++] =
+        timer - native_timer_test_timers;
+}
+
+/*
+ * Stops all the timers, and clears the record of callbacks.
+ */
+void
+native_timer_test_reset(void)
+{
+    struct native_timer_jitter ntj;
+    int i;
+
+    for (i = 0; i < NATIVE_TIMER_TEST_CNT; i++) {
+        os_cputime_timer_stop(native_timer_test_timers + i);
+        os_cputime_timer_init(native_timer_test_timers + i,
+                              native_timer_test_cb,
+                              native_timer_test_timers + i);
+    }
+    native_timer_test_fired_cnt = 0;
+    native_timer_jitter(MYNEWT_VAL(OS_CPUTIME_TIMER_NUM), &ntj, 1);
+}
+
+void
+native_timer_test_start(int idx, uint32_t usecs)
+{
+    int rc;
+
+    rc = os_cputime_timer_relative(native_timer_test_timers + idx, usecs);
+    TEST_ASSERT_FATAL(rc == 0);
+}
+
+/*
+ * Sleeps for at least 'usecs'; the timers fire meanwhile.
+ */
+void
+native_timer_test_wait(uint32_t usecs)
+{
+    os_time_delay(usecs / (1000000 / OS_TICKS_PER_SEC) + 2);
+}
+
+TEST_CASE_DECL(native_timer_test_hires)
+
+TEST_SUITE(native_timer_test_all)
+{
+    native_timer_test_hires();
+}
+
+#if MYNEWT_VAL(SELFTEST)
+
+int
+main(int argc, char **argv)
+{
+    sysinit();
+
+    native_timer_test_all();
+
+    return tu_any_failed;
+}
+
+#endif
@@ -0,0 +1,51 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#ifndef _NATIVE_TIMER_TEST_H
+#define _NATIVE_TIMER_TEST_H
+
+#include "os/mynewt.h"
+#include "testutil/testutil.h"
+#include "hal/hal_timer.h"
+#include "mcu/mcu_sim.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define NATIVE_TIMER_TEST_CNT       8
+
+extern struct hal_timer native_timer_test_timers[NATIVE_TIMER_TEST_CNT];
+
+/* Timers whose callbacks were called, in order. */
+extern int native_timer_test_fired[NATIVE_TIMER_TEST_CNT * 2];
+extern int native_timer_test_fired_cnt;
+
+void native_timer_test_reset(void);
+void native_timer_test_start(int idx, uint32_t usecs);
+void native_timer_test_wait(uint32_t usecs);
+
+void native_timer_test_order(void);
+void native_timer_test_restart(void);
+void native_timer_test_stop(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _NATIVE_TIMER_TEST_H */
@@ -0,0 +1,52 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "native_timer_test.h"
+
+/*
+ * Timers started out of order fire in expiry order, and every callback
+ * is accounted for by native_timer_jitter().
+ */
+void
+native_timer_test_order(void)
+{
+    static const uint8_t ms[NATIVE_TIMER_TEST_CNT] = {
+        7, 3, 5, 1, 8, 2, 6, 4
+    };
+    struct native_timer_jitter ntj;
+    int rc;
+    int i;
+
+    native_timer_test_reset();
+
+    for (i = 0; i < NATIVE_TIMER_TEST_CNT; i++) {
+        native_timer_test_start(i, ms[i] * 1000);
+    }
+    native_timer_test_wait(10 * 1000);
+
+    TEST_ASSERT_FATAL(native_timer_test_fired_cnt == NATIVE_TIMER_TEST_CNT);
+    for (i = 1; i < NATIVE_TIMER_TEST_CNT; i++) {
+        TEST_ASSERT(ms[native_timer_test_fired[i - 1]] <
+                    ms[native_timer_test_fired[i]]);
+    }
+
+    rc = native_timer_jitter(MYNEWT_VAL(OS_CPUTIME_TIMER_NUM), &ntj, 0);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(ntj.ntj_cnt == NATIVE_TIMER_TEST_CNT);
+    TEST_ASSERT(ntj.ntj_sum <= (uint64_t)ntj.ntj_cnt * ntj.ntj_max);
+}
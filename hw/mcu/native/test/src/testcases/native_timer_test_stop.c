@@ -0,0 +1,43 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "native_timer_test.h"
+
+/*
+ * Stopped timers don't fire, whether they were the next one to expire or
+ * not.
+ */
+void
+native_timer_test_stop(void)
+{
+    native_timer_test_reset();
+
+    native_timer_test_start(0, 2 * 1000);
+    native_timer_test_start(1, 4 * 1000);
+    native_timer_test_start(2, 6 * 1000);
+    native_timer_test_start(3, 8 * 1000);
+    os_cputime_timer_stop(native_timer_test_timers + 0);
+    os_cputime_timer_stop(native_timer_test_timers + 2);
+    native_timer_test_wait(10 * 1000);
+
+    TEST_ASSERT_FATAL(native_timer_test_fired_cnt == 2);
+    TEST_ASSERT(native_timer_test_fired[0] == 1);
+    TEST_ASSERT(native_timer_test_fired[1] == 3);
+
+    native_timer_test_reset();
+}
@@ -29,6 +29,7 @@
 #ifndef _OS_MBUF_H
 #define _OS_MBUF_H
 
+#include "syscfg/syscfg.h"
 #include "os/queue.h"
 #include "os/os_eventq.h"
 
@@ -42,11 +43,13 @@ extern "C" {
  * and the amount of "user" data in a non-packet header mbuf. The total pool
  * size, in bytes, should be:
  *  os_mbuf_count * (omp_databuf_len + sizeof(struct os_mbuf))
+ * plus one byte per mbuf for the reference count if OS_MBUF_CLONE is enabled.
  */
 struct os_mbuf_pool {
     /**
      * Total length of the databuf in each mbuf.  This is the size of the
-     * mempool block, minus the mbuf header
+     * mempool block, minus the mbuf header (and the reference count byte if
+     * OS_MBUF_CLONE is enabled)
      */
     uint16_t omp_databuf_len;
     /**
@@ -124,6 +127,19 @@ struct os_mqueue {
  */
 #define OS_MBUF_F_MASK(__n) (1 << (__n))
 
+/*
+ * Set on mbufs created by os_mbuf_clone(); the data they point to belongs to
+ * another mbuf.
+ */
+#define OS_MBUF_F_CLONE     OS_MBUF_F_MASK(7)
+
+/*
+ * Checks whether a given mbuf shares the data of another mbuf
+ *
+ * @param __om The mbuf to check
+ */
+#define OS_MBUF_IS_CLONE(__om) (((__om)->om_flags & OS_MBUF_F_CLONE) != 0)
+
 /*
  * Checks whether a given mbuf is a packet header mbuf
  *
@@ -184,6 +200,12 @@ _os_mbuf_leadingspace(struct os_mbuf *om)
     uint16_t startoff;
     uint16_t leadingspace;
 
+#if MYNEWT_VAL(OS_MBUF_CLONE)
+    if (OS_MBUF_IS_CLONE(om)) {
+        return 0;
+    }
+#endif
+
     startoff = 0;
     if (OS_MBUF_IS_PKTHDR(om)) {
         startoff = om->om_pkthdr_len;
@@ -218,6 +240,12 @@ _os_mbuf_trailingspace(struct os_mbuf *om)
 {
     struct os_mbuf_pool *omp;
 
+#if MYNEWT_VAL(OS_MBUF_CLONE)
+    if (OS_MBUF_IS_CLONE(om)) {
+        return 0;
+    }
+#endif
+
     omp = om->om_omp;
 
     return (&om->om_databuf[0] + omp->omp_databuf_len) -
@@ -288,17 +316,19 @@ int os_mqueue_put(struct os_mqueue *, struct os_eventq *, struct os_mbuf *);
  * upon estimated mbuf size.
  *
  * os_msys_register() registers a mbuf pool with MSYS, and allows MSYS to
- * allocate mbufs out of it.
+ * allocate mbufs out of it. At most MSYS_MAX_POOLS pools can be registered.
  *
  * @param new_pool The pool to register with MSYS
  *
- * @return 0 on success, non-zero on failure
+ * @return 0 on success, OS_ENOMEM if too many pools are registered
  */
 int os_msys_register(struct os_mbuf_pool *);
 
 /**
  * Allocate a mbuf from msys.  Based upon the data size requested,
- * os_msys_get() will choose the mbuf pool that has the best fit.
+ * os_msys_get() will choose the mbuf pool that has the best fit.  If that
+ * pool is exhausted and MSYS_FALLBACK is enabled, the next larger pools are
+ * tried in turn.
  *
  * @param dsize The estimated size of the data being stored in the mbuf
  * @param leadingspace The amount of leadingspace to allocate in the mbuf
@@ -323,6 +353,18 @@ void os_msys_reset(void);
  */
 struct os_mbuf *os_msys_get_pkthdr(uint16_t dsize, uint16_t user_hdr_len);
 
+/**
+ * Clone a chain of mbufs using headers allocated from msys.  The smallest
+ * pool which fits the packet header of the chain is used, so registering a
+ * pool of small blocks makes clones cheap in RAM as well as in cycles.  See
+ * os_mbuf_clone() for a description of clones.
+ *
+ * @param om The mbuf chain to clone
+ *
+ * @return The cloned chain on success, NULL on failure.
+ */
+struct os_mbuf *os_msys_clone(struct os_mbuf *om);
+
 /**
  * Count the number of blocks in all the mbuf pools that are allocated.
  *
@@ -383,6 +425,25 @@ struct os_mbuf *os_mbuf_get_pkthdr(struct os_mbuf_pool *omp,
  */
 struct os_mbuf *os_mbuf_dup(struct os_mbuf *m);
 
+/**
+ * Clone a chain of mbufs.  Each mbuf of the clone is a header allocated out
+ * of omp pointing at the data of the corresponding source mbuf, which stays
+ * allocated until the source and all of its clones have been freed.  The
+ * packet header and user header are copied.  This is meant for sending the
+ * same packet on several interfaces without copying it; the shared data must
+ * not be modified, neither through the source chain nor through a clone,
+ * while clones exist.  Clones have no leading or trailing space, so
+ * prepending or appending to a clone allocates new mbufs.
+ *
+ * Needs OS_MBUF_CLONE.
+ *
+ * @param omp The mbuf pool to allocate the clone headers out of
+ * @param om  The mbuf chain to clone
+ *
+ * @return The cloned chain on success, NULL on failure.
+ */
+struct os_mbuf *os_mbuf_clone(struct os_mbuf_pool *omp, struct os_mbuf *om);
+
 /**
  * Locates the specified absolute offset within an mbuf chain.  The offset
  * can be one past than the total length of the chain, but no greater.
@@ -98,6 +98,7 @@ int os_sched_sleep(struct os_task *, os_time_t nticks);
 int os_sched_wakeup(struct os_task *);
 int os_sched_remove(struct os_task *);
 void os_sched_resort(struct os_task *);
+void os_sched_run_list_init(void);
 os_time_t os_sched_wakeup_ticks(os_time_t now);
 
 /** @endcond */
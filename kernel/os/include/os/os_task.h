@@ -96,7 +96,8 @@ struct os_task {
     /** Task flags, bitmask */
     uint8_t t_flags;
     uint8_t t_lockcnt;
-    uint8_t t_pad;
+    /** Priority level of the run queue task is on (OS_SCHED_BITMAP) */
+    uint8_t t_run_prio;
 
     /** Task name */
     const char *t_name;
@@ -167,7 +167,7 @@ os_init(int (*main_fn)(int argc, char **arg))
 {
     os_error_t err;
 
-    TAILQ_INIT(&g_callout_list);
+    os_callout_list_init();
     STAILQ_INIT(&g_os_task_list);
     os_eventq_init(os_eventq_dflt_get());
 
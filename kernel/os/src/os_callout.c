@@ -26,8 +26,47 @@
 #include "os/mynewt.h"
 #include "os_priv.h"
 
+#if MYNEWT_VAL(OS_CALLOUT_WHEEL_SLOTS) != 0
+/*
+ * Hashed timing wheel; a callout is kept in the slot indexed by its expiry
+ * time modulo the number of slots. Slot lists are not sorted, so arming and
+ * stopping a callout are constant time operations.
+ */
+#define OS_CALLOUT_WHEEL_SLOTS  MYNEWT_VAL(OS_CALLOUT_WHEEL_SLOTS)
+#define OS_CALLOUT_WHEEL_MASK   (OS_CALLOUT_WHEEL_SLOTS - 1)
+
+#if (OS_CALLOUT_WHEEL_SLOTS & OS_CALLOUT_WHEEL_MASK) != 0
+#error "OS_CALLOUT_WHEEL_SLOTS must be a power of 2"
+#endif
+
+static struct os_callout_list os_callout_wheel[OS_CALLOUT_WHEEL_SLOTS];
+
+/* Last tick for which expired callouts have been processed. */
+static os_time_t os_callout_wheel_time;
+
+#define OS_CALLOUT_LIST(ticks)                                  \
+    (&os_callout_wheel[(ticks) & OS_CALLOUT_WHEEL_MASK])
+#else
 struct os_callout_list g_callout_list;
 
+#define OS_CALLOUT_LIST(ticks)  (&g_callout_list)
+#endif
+
+void
+os_callout_list_init(void)
+{
+#if MYNEWT_VAL(OS_CALLOUT_WHEEL_SLOTS) != 0
+    int i;
+
+    for (i = 0; i < OS_CALLOUT_WHEEL_SLOTS; i++) {
+        TAILQ_INIT(&os_callout_wheel[i]);
+    }
+    os_callout_wheel_time = os_time_get();
+#else
+    TAILQ_INIT(&g_callout_list);
+#endif
+}
+
 void os_callout_init(struct os_callout *c, struct os_eventq *evq,
                      os_event_fn *ev_cb, void *ev_arg)
 {
@@ -51,7 +90,7 @@ os_callout_stop(struct os_callout *c)
     OS_ENTER_CRITICAL(sr);
 
     if (os_callout_queued(c)) {
-        TAILQ_REMOVE(&g_callout_list, c, c_next);
+        TAILQ_REMOVE(OS_CALLOUT_LIST(c->c_ticks), c, c_next);
         c->c_next.tqe_prev = NULL;
     }
 
@@ -67,7 +106,9 @@ os_callout_stop(struct os_callout *c)
 int
 os_callout_reset(struct os_callout *c, os_time_t ticks)
 {
+#if MYNEWT_VAL(OS_CALLOUT_WHEEL_SLOTS) == 0
     struct os_callout *entry;
+#endif
     os_sr_t sr;
     int ret;
 
@@ -88,6 +129,17 @@ os_callout_reset(struct os_callout *c, os_time_t ticks)
 
     c->c_ticks = os_time_get() + ticks;
 
+#if MYNEWT_VAL(OS_CALLOUT_WHEEL_SLOTS) != 0
+    /*
+     * Slots up to os_callout_wheel_time have been visited already; a callout
+     * hashed into one of them would only be seen a revolution later. Make
+     * it due on the next tick that gets processed instead.
+     */
+    if (!OS_TIME_TICK_GT(c->c_ticks, os_callout_wheel_time)) {
+        c->c_ticks = os_callout_wheel_time + 1;
+    }
+    TAILQ_INSERT_TAIL(OS_CALLOUT_LIST(c->c_ticks), c, c_next);
+#else
     entry = NULL;
     TAILQ_FOREACH(entry, &g_callout_list, c_next) {
         if (OS_TIME_TICK_LT(c->c_ticks, entry->c_ticks)) {
@@ -100,6 +152,7 @@ os_callout_reset(struct os_callout *c, os_time_t ticks)
     } else {
         TAILQ_INSERT_TAIL(&g_callout_list, c, c_next);
     }
+#endif
 
     OS_EXIT_CRITICAL(sr);
 
@@ -111,12 +164,78 @@ err:
 }
 
 
+static void
+os_callout_fire(struct os_callout *c)
+{
+    if (c->c_evq) {
+        os_eventq_put(c->c_evq, &c->c_ev);
+    } else {
+        c->c_ev.ev_cb(&c->c_ev);
+    }
+}
+
 /**
  * This function is called by the OS in the time tick.  It searches the list
  * of callouts, and sees if any of them are ready to run.  If they are ready
  * to run, it posts an event for each callout that's ready to run,
  * to the event queue provided to os_callout_init().
  */
+#if MYNEWT_VAL(OS_CALLOUT_WHEEL_SLOTS) != 0
+void
+os_callout_tick(void)
+{
+    struct os_callout_list *list;
+    struct os_callout *c;
+    os_time_t start;
+    os_time_t now;
+    uint32_t nslots;
+    uint32_t i;
+    os_sr_t sr;
+
+    os_trace_api_void(OS_TRACE_ID_CALLOUT_TICK);
+
+    now = os_time_get();
+
+    /*
+     * Visit the slots of every tick since the last time we got here. If
+     * more than one revolution worth of ticks has passed, each slot is
+     * visited once.
+     */
+    OS_ENTER_CRITICAL(sr);
+    start = os_callout_wheel_time + 1;
+    nslots = now - os_callout_wheel_time;
+    if (nslots > OS_CALLOUT_WHEEL_SLOTS) {
+        nslots = OS_CALLOUT_WHEEL_SLOTS;
+    }
+    os_callout_wheel_time = now;
+    OS_EXIT_CRITICAL(sr);
+
+    for (i = 0; i < nslots; i++) {
+        list = OS_CALLOUT_LIST(start + i);
+        while (1) {
+            OS_ENTER_CRITICAL(sr);
+            TAILQ_FOREACH(c, list, c_next) {
+                if (OS_TIME_TICK_GEQ(now, c->c_ticks)) {
+                    break;
+                }
+            }
+            if (c) {
+                TAILQ_REMOVE(list, c, c_next);
+                c->c_next.tqe_prev = NULL;
+            }
+            OS_EXIT_CRITICAL(sr);
+
+            if (c) {
+                os_callout_fire(c);
+            } else {
+                break;
+            }
+        }
+    }
+
+    os_trace_api_ret(OS_TRACE_ID_CALLOUT_TICK);
+}
+#else
 void
 os_callout_tick(void)
 {
@@ -142,11 +261,7 @@ os_callout_tick(void)
         OS_EXIT_CRITICAL(sr);
 
         if (c) {
-            if (c->c_evq) {
-                os_eventq_put(c->c_evq, &c->c_ev);
-            } else {
-                c->c_ev.ev_cb(&c->c_ev);
-            }
+            os_callout_fire(c);
         } else {
             break;
         }
@@ -154,6 +269,7 @@ os_callout_tick(void)
 
     os_trace_api_ret(OS_TRACE_ID_CALLOUT_TICK);
 }
+#endif
 
 /*
  * Returns the number of ticks to the first pending callout. If there are no
@@ -163,6 +279,40 @@ os_callout_tick(void)
  *
  * @return Number of ticks to first pending callout
  */
+#if MYNEWT_VAL(OS_CALLOUT_WHEEL_SLOTS) != 0
+os_time_t
+os_callout_wakeup_ticks(os_time_t now)
+{
+    struct os_callout *c;
+    os_time_t rt;
+    uint32_t i;
+
+    OS_ASSERT_CRITICAL();
+
+    /*
+     * Walk the slots in expiry order starting from now; the first callout
+     * due within its slot's tick of this revolution is the next one to
+     * expire. Callouts further away than one revolution are accounted for
+     * while walking, in case nothing is due sooner.
+     */
+    rt = OS_TIMEOUT_NEVER;
+    for (i = 0; i < OS_CALLOUT_WHEEL_SLOTS; i++) {
+        TAILQ_FOREACH(c, OS_CALLOUT_LIST(now + i), c_next) {
+            if (!OS_TIME_TICK_GT(c->c_ticks, now + i)) {
+                if (OS_TIME_TICK_GEQ(c->c_ticks, now)) {
+                    return (c->c_ticks - now);
+                }
+                return (0);     /* callout time is in the past */
+            }
+            if (c->c_ticks - now < rt) {
+                rt = c->c_ticks - now;
+            }
+        }
+    }
+
+    return (rt);
+}
+#else
 os_time_t
 os_callout_wakeup_ticks(os_time_t now)
 {
@@ -184,7 +334,7 @@ os_callout_wakeup_ticks(os_time_t now)
 
     return (rt);
 }
-
+#endif
 
 os_time_t
 os_callout_remaining_ticks(struct os_callout *c, os_time_t now)
@@ -41,6 +41,9 @@
 #define OS_TRACE_DISABLE_FILE_API
 #endif
 #include "os/mynewt.h"
+#if MYNEWT_VAL(MSYS_STATS)
+#include "stats/stats.h"
+#endif
 
 /**
  * @addtogroup OSKernel
@@ -49,8 +52,26 @@
  *   @{
  */
 
-STAILQ_HEAD(, os_mbuf_pool) g_msys_pool_list =
-    STAILQ_HEAD_INITIALIZER(g_msys_pool_list);
+/*
+ * Pools registered with msys, in order of registration, and their positions
+ * sorted by increasing buffer size. Pool selection uses a table giving, for
+ * each power of 2 size class, the first pool in sorted order big enough for
+ * the smallest size in that class.
+ */
+#define OS_MSYS_SIZE_CLASSES    (17)
+
+static struct os_mbuf_pool *os_msys_pools[MYNEWT_VAL(MSYS_MAX_POOLS)];
+static uint8_t os_msys_order[MYNEWT_VAL(MSYS_MAX_POOLS)];
+static uint8_t os_msys_num_pools;
+static uint8_t os_msys_size_idx[OS_MSYS_SIZE_CLASSES];
+
+#if MYNEWT_VAL(MSYS_STATS)
+STATS_SECT_START(os_msys_stats)
+    STATS_SECT_ENTRY(hit)
+    STATS_SECT_ENTRY(miss)
+    STATS_SECT_ENTRY(fallback)
+STATS_SECT_END
+#endif
 
 
 int
@@ -120,23 +141,132 @@ err:
     return (rc);
 }
 
+#if MYNEWT_VAL(MSYS_STATS)
+STATS_NAME_START(os_msys_stats)
+    STATS_NAME(os_msys_stats, hit)
+    STATS_NAME(os_msys_stats, miss)
+    STATS_NAME(os_msys_stats, fallback)
+STATS_NAME_END(os_msys_stats)
+
+static STATS_SECT_DECL(os_msys_stats) os_msys_stats[MYNEWT_VAL(MSYS_MAX_POOLS)];
+
+/* Set once the stats package is up, and pools can register their stats. */
+static int os_msys_stats_ready;
+
+/*
+ * Set for the slots whose stats are registered.  Stats can't be unregistered,
+ * so a slot keeps its registration across os_msys_reset(); a pool registered
+ * into the slot later on takes the counters over.
+ */
+static uint8_t os_msys_stats_reg[MYNEWT_VAL(MSYS_MAX_POOLS)];
+
+static void
+os_msys_stats_register(int idx)
+{
+    struct os_mbuf_pool *pool;
+    int rc;
+
+    if (os_msys_stats_reg[idx]) {
+        STATS_RESET(os_msys_stats[idx]);
+        return;
+    }
+
+    pool = os_msys_pools[idx];
+    rc = stats_init_and_reg(STATS_HDR(os_msys_stats[idx]),
+                            STATS_SIZE_INIT_PARMS(os_msys_stats[idx],
+                                                  STATS_SIZE_32),
+                            STATS_NAME_INIT_PARMS(os_msys_stats),
+                            pool->omp_pool->name);
+    if (rc == 0) {
+        os_msys_stats_reg[idx] = 1;
+    }
+    /* Otherwise the name is taken; the pool is still counted, but its stats
+     * are not reported.  The next pool registered into the slot retries. */
+}
+
+void
+os_msys_stats_init(void)
+{
+    int i;
+
+    /* Ensure this function only gets called by sysinit. */
+    SYSINIT_ASSERT_ACTIVE();
+
+    for (i = 0; i < os_msys_num_pools; i++) {
+        os_msys_stats_register(i);
+    }
+    os_msys_stats_ready = 1;
+}
+#endif
+
+/*
+ * Returns the size class of a requested data size; sizes in the range
+ * (2^(n-1), 2^n] are in class n.
+ */
+static int
+os_msys_size_class(uint16_t dsize)
+{
+    if (dsize <= 1) {
+        return 0;
+    }
+    return 32 - __builtin_clz((uint32_t)dsize - 1);
+}
+
+static void
+os_msys_build_index(void)
+{
+    uint32_t low;
+    int cls;
+    int i;
+
+    for (cls = 0; cls < OS_MSYS_SIZE_CLASSES; cls++) {
+        low = cls == 0 ? 0 : (1UL << (cls - 1)) + 1;
+        for (i = 0; i < os_msys_num_pools; i++) {
+            if (os_msys_pools[os_msys_order[i]]->omp_databuf_len >= low) {
+                break;
+            }
+        }
+        os_msys_size_idx[cls] = i;
+    }
+}
+
 int
 os_msys_register(struct os_mbuf_pool *new_pool)
 {
-    struct os_mbuf_pool *pool;
+    uint16_t len;
+    int idx;
+    int i;
+
+    for (i = 0; i < os_msys_num_pools; i++) {
+        if (os_msys_pools[i] == new_pool) {
+            return (0);
+        }
+    }
+    if (os_msys_num_pools >= MYNEWT_VAL(MSYS_MAX_POOLS)) {
+        return (OS_ENOMEM);
+    }
+
+    idx = os_msys_num_pools;
+    os_msys_pools[idx] = new_pool;
 
-    pool = NULL;
-    STAILQ_FOREACH(pool, &g_msys_pool_list, omp_next) {
-        if (new_pool->omp_databuf_len > pool->omp_databuf_len) {
+    /* Keep the order array sorted by increasing buffer size. */
+    len = new_pool->omp_databuf_len;
+    for (i = idx; i > 0; i--) {
+        if (os_msys_pools[os_msys_order[i - 1]]->omp_databuf_len <= len) {
             break;
         }
+        os_msys_order[i] = os_msys_order[i - 1];
     }
+    os_msys_order[i] = idx;
+    os_msys_num_pools++;
 
-    if (pool) {
-        STAILQ_INSERT_AFTER(&g_msys_pool_list, pool, new_pool, omp_next);
-    } else {
-        STAILQ_INSERT_TAIL(&g_msys_pool_list, new_pool, omp_next);
+    os_msys_build_index();
+
+#if MYNEWT_VAL(MSYS_STATS)
+    if (os_msys_stats_ready) {
+        os_msys_stats_register(idx);
     }
+#endif
 
     return (0);
 }
@@ -144,74 +274,131 @@ os_msys_register(struct os_mbuf_pool *new_pool)
 void
 os_msys_reset(void)
 {
-    STAILQ_INIT(&g_msys_pool_list);
+    os_msys_num_pools = 0;
+    os_msys_build_index();
 }
 
-static struct os_mbuf_pool *
+/*
+ * Returns the position, in os_msys_order, of the smallest pool which fits
+ * dsize. If none does, the largest pool is used. Returns -1 if there are
+ * no pools registered.
+ */
+static int
 _os_msys_find_pool(uint16_t dsize)
 {
-    struct os_mbuf_pool *pool;
+    int i;
 
-    pool = NULL;
-    STAILQ_FOREACH(pool, &g_msys_pool_list, omp_next) {
-        if (dsize <= pool->omp_databuf_len) {
-            break;
-        }
+    if (os_msys_num_pools == 0) {
+        return (-1);
     }
 
-    if (!pool) {
-        pool = STAILQ_LAST(&g_msys_pool_list, os_mbuf_pool, omp_next);
+    i = os_msys_size_idx[os_msys_size_class(dsize)];
+    while (i < os_msys_num_pools &&
+           os_msys_pools[os_msys_order[i]]->omp_databuf_len < dsize) {
+        i++;
+    }
+    if (i == os_msys_num_pools) {
+        i--;
     }
 
-    return (pool);
+    return (i);
 }
 
-
-struct os_mbuf *
-os_msys_get(uint16_t dsize, uint16_t leadingspace)
+static struct os_mbuf *
+_os_msys_get(uint16_t dsize, uint16_t len, int pkthdr)
 {
-    struct os_mbuf *m;
     struct os_mbuf_pool *pool;
+    struct os_mbuf *m;
+    int first;
+    int idx;
+    int i;
 
-    pool = _os_msys_find_pool(dsize);
-    if (!pool) {
-        goto err;
+    first = _os_msys_find_pool(dsize);
+    if (first < 0) {
+        return (NULL);
     }
 
-    m = os_mbuf_get(pool, leadingspace);
-    return (m);
-err:
+    i = first;
+    do {
+        idx = os_msys_order[i];
+        pool = os_msys_pools[idx];
+        if (pkthdr) {
+            m = os_mbuf_get_pkthdr(pool, len);
+        } else {
+            m = os_mbuf_get(pool, len);
+        }
+
+        if (m) {
+#if MYNEWT_VAL(MSYS_STATS)
+            if (i == first) {
+                STATS_INC(os_msys_stats[idx], hit);
+            } else {
+                STATS_INC(os_msys_stats[idx], fallback);
+            }
+#endif
+            return (m);
+        }
+
+#if MYNEWT_VAL(MSYS_STATS)
+        if (i == first) {
+            STATS_INC(os_msys_stats[idx], miss);
+        }
+#endif
+        i++;
+    } while (MYNEWT_VAL(MSYS_FALLBACK) && i < os_msys_num_pools);
+
     return (NULL);
 }
 
+struct os_mbuf *
+os_msys_get(uint16_t dsize, uint16_t leadingspace)
+{
+    return (_os_msys_get(dsize, leadingspace, 0));
+}
+
 struct os_mbuf *
 os_msys_get_pkthdr(uint16_t dsize, uint16_t user_hdr_len)
 {
     uint16_t total_pkthdr_len;
-    struct os_mbuf *m;
-    struct os_mbuf_pool *pool;
 
     total_pkthdr_len =  user_hdr_len + sizeof(struct os_mbuf_pkthdr);
-    pool = _os_msys_find_pool(dsize + total_pkthdr_len);
-    if (!pool) {
-        goto err;
+    return (_os_msys_get(dsize + total_pkthdr_len, user_hdr_len, 1));
+}
+
+#if MYNEWT_VAL(OS_MBUF_CLONE)
+struct os_mbuf *
+os_msys_clone(struct os_mbuf *om)
+{
+    struct os_mbuf *m;
+    int i;
+
+    /* Room for the packet header and the pointer to the source mbuf. */
+    i = _os_msys_find_pool(om->om_pkthdr_len + 2 * sizeof(struct os_mbuf *));
+    if (i < 0) {
+        return (NULL);
     }
 
-    m = os_mbuf_get_pkthdr(pool, user_hdr_len);
-    return (m);
-err:
+    do {
+        m = os_mbuf_clone(os_msys_pools[os_msys_order[i]], om);
+        if (m) {
+            return (m);
+        }
+        i++;
+    } while (MYNEWT_VAL(MSYS_FALLBACK) && i < os_msys_num_pools);
+
     return (NULL);
 }
+#endif
 
 int
 os_msys_count(void)
 {
-    struct os_mbuf_pool *omp;
     int total;
+    int i;
 
     total = 0;
-    STAILQ_FOREACH(omp, &g_msys_pool_list, omp_next) {
-        total += omp->omp_pool->mp_num_blocks;
+    for (i = 0; i < os_msys_num_pools; i++) {
+        total += os_msys_pools[i]->omp_pool->mp_num_blocks;
     }
 
     return total;
@@ -220,23 +407,71 @@ os_msys_count(void)
 int
 os_msys_num_free(void)
 {
-    struct os_mbuf_pool *omp;
     int total;
+    int i;
 
     total = 0;
-    STAILQ_FOREACH(omp, &g_msys_pool_list, omp_next) {
-        total += omp->omp_pool->mp_num_free;
+    for (i = 0; i < os_msys_num_pools; i++) {
+        total += os_msys_pools[i]->omp_pool->mp_num_free;
     }
 
     return total;
 }
 
+#if MYNEWT_VAL(OS_MBUF_CLONE)
+/*
+ * With clones, the last byte of every mbuf block counts the clones still
+ * pointing at its data; the block goes back to its pool once the count is 0
+ * and the mbuf itself has been freed.  A clone keeps a pointer to the mbuf
+ * owning its data at the (aligned) end of its own data buffer.
+ */
+#define OS_MBUF_REFCNT(__om)    \
+    ((__om)->om_databuf[(__om)->om_omp->omp_databuf_len])
+#define OS_MBUF_REFCNT_MAX  (UINT8_MAX)
+
+static uint16_t
+os_mbuf_clone_src_off(const struct os_mbuf_pool *omp)
+{
+    return (omp->omp_databuf_len - sizeof(struct os_mbuf *)) &
+           ~(sizeof(struct os_mbuf *) - 1);
+}
+
+static struct os_mbuf **
+os_mbuf_clone_src(struct os_mbuf *om)
+{
+    return (struct os_mbuf **)
+        &om->om_databuf[os_mbuf_clone_src_off(om->om_omp)];
+}
+
+/*
+ * Drops a reference to the data of an mbuf. Returns 1 if clones still
+ * point at it, and the block must not be freed yet.
+ */
+static int
+os_mbuf_unref(struct os_mbuf *om)
+{
+    os_sr_t sr;
+    int shared;
+
+    OS_ENTER_CRITICAL(sr);
+    shared = OS_MBUF_REFCNT(om) != 0;
+    if (shared) {
+        OS_MBUF_REFCNT(om)--;
+    }
+    OS_EXIT_CRITICAL(sr);
+
+    return shared;
+}
+#endif
 
 int
 os_mbuf_pool_init(struct os_mbuf_pool *omp, struct os_mempool *mp,
                   uint16_t buf_len, uint16_t nbufs)
 {
     omp->omp_databuf_len = buf_len - sizeof(struct os_mbuf);
+#if MYNEWT_VAL(OS_MBUF_CLONE)
+    omp->omp_databuf_len--;
+#endif
     omp->omp_pool = mp;
 
     return (0);
@@ -266,6 +501,9 @@ os_mbuf_get(struct os_mbuf_pool *omp, uint16_t leadingspace)
     om->om_len = 0;
     om->om_data = (&om->om_databuf[0] + leadingspace);
     om->om_omp = omp;
+#if MYNEWT_VAL(OS_MBUF_CLONE)
+    OS_MBUF_REFCNT(om) = 0;
+#endif
 
 done:
     os_trace_api_ret_u32(OS_TRACE_ID_MBUF_GET, (uint32_t)om);
@@ -313,6 +551,18 @@ os_mbuf_free(struct os_mbuf *om)
     os_trace_api_u32(OS_TRACE_ID_MBUF_FREE, (uint32_t)om);
 
     if (om->om_omp != NULL) {
+#if MYNEWT_VAL(OS_MBUF_CLONE)
+        if (os_mbuf_unref(om)) {
+            rc = 0;
+            goto done;
+        }
+        if (OS_MBUF_IS_CLONE(om)) {
+            rc = os_mbuf_free(*os_mbuf_clone_src(om));
+            if (rc != 0) {
+                goto done;
+            }
+        }
+#endif
         rc = os_memblock_put(om->om_omp->omp_pool, om);
         if (rc != 0) {
             goto done;
@@ -506,7 +756,7 @@ os_mbuf_dup(struct os_mbuf *om)
             }
             copy = head;
         }
-        copy->om_flags = om->om_flags;
+        copy->om_flags = om->om_flags & ~OS_MBUF_F_CLONE;
         copy->om_len = om->om_len;
         memcpy(OS_MBUF_DATA(copy, uint8_t *), OS_MBUF_DATA(om, uint8_t *),
                 om->om_len);
@@ -517,6 +767,77 @@ err:
     return (NULL);
 }
 
+#if MYNEWT_VAL(OS_MBUF_CLONE)
+struct os_mbuf *
+os_mbuf_clone(struct os_mbuf_pool *omp, struct os_mbuf *om)
+{
+    struct os_mbuf *head;
+    struct os_mbuf *copy;
+    struct os_mbuf *prev;
+    struct os_mbuf *src;
+    os_sr_t sr;
+    int rc;
+
+    if (omp->omp_databuf_len < sizeof(struct os_mbuf *) ||
+        om->om_pkthdr_len > os_mbuf_clone_src_off(omp)) {
+        return (NULL);
+    }
+
+    head = NULL;
+    prev = NULL;
+
+    for (; om != NULL; om = SLIST_NEXT(om, om_next)) {
+        /* Clones of clones point at the mbuf owning the data. */
+        if (OS_MBUF_IS_CLONE(om)) {
+            src = *os_mbuf_clone_src(om);
+        } else {
+            src = om;
+        }
+        if (src->om_omp == NULL) {
+            goto err;
+        }
+
+        copy = os_mbuf_get(omp, 0);
+        if (!copy) {
+            goto err;
+        }
+
+        OS_ENTER_CRITICAL(sr);
+        rc = OS_MBUF_REFCNT(src) < OS_MBUF_REFCNT_MAX;
+        if (rc) {
+            OS_MBUF_REFCNT(src)++;
+        }
+        OS_EXIT_CRITICAL(sr);
+        if (!rc) {
+            os_mbuf_free(copy);
+            goto err;
+        }
+
+        if (head) {
+            SLIST_NEXT(prev, om_next) = copy;
+        } else {
+            if (OS_MBUF_IS_PKTHDR(om)) {
+                _os_mbuf_copypkthdr(copy, om);
+            }
+            head = copy;
+        }
+        prev = copy;
+
+        copy->om_flags = om->om_flags | OS_MBUF_F_CLONE;
+        copy->om_data = om->om_data;
+        copy->om_len = om->om_len;
+        *os_mbuf_clone_src(copy) = src;
+    }
+
+    return (head);
+err:
+    if (head) {
+        os_mbuf_free_chain(head);
+    }
+    return (NULL);
+}
+#endif
+
 struct os_mbuf *
 os_mbuf_off(const struct os_mbuf *om, int off, uint16_t *out_off)
 {
@@ -31,9 +31,9 @@ extern struct os_task g_idle_task;
 extern struct os_task_list g_os_run_list;
 extern struct os_task_list g_os_sleep_list;
 extern struct os_task_stailq g_os_task_list;
-extern struct os_callout_list g_callout_list;
-
 void os_msys_init(void);
+void os_msys_stats_init(void);
+void os_callout_list_init(void);
 
 /**
  * Prints information about a crash to the console.  This functionality is
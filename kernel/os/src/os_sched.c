@@ -18,9 +18,29 @@
  */
 
 #include <assert.h>
+#include <string.h>
 #include "os/mynewt.h"
 #include "os_priv.h"
 
+#if MYNEWT_VAL(OS_SCHED_BITMAP)
+/*
+ * Ready queue is kept as one FIFO per priority level, plus a two level bitmap
+ * of the levels which are not empty. Bits are stored MSB first, so the
+ * highest priority (numerically lowest) ready level is found with two count
+ * leading zeros operations.
+ *
+ * The context switch code of the ports reads the task to switch to from the
+ * head of g_os_run_list. That head is kept pointing at the highest priority
+ * ready task; it is not a list of all ready tasks in this mode.
+ */
+#define OS_SCHED_PRIO_LEVELS    (UINT8_MAX + 1)
+#define OS_SCHED_BMAP_WORDS     (OS_SCHED_PRIO_LEVELS / 32)
+#define OS_SCHED_BMAP_BIT(n)    (0x80000000UL >> ((n) & 31))
+
+static struct os_task_list os_sched_run_q[OS_SCHED_PRIO_LEVELS];
+static uint32_t os_sched_run_bmap[OS_SCHED_BMAP_WORDS];
+static uint32_t os_sched_run_grp;
+#endif
 struct os_task_list g_os_run_list = TAILQ_HEAD_INITIALIZER(g_os_run_list);
 struct os_task_list g_os_sleep_list = TAILQ_HEAD_INITIALIZER(g_os_sleep_list);
 
@@ -29,6 +49,98 @@ struct os_task *g_current_task;
 extern os_time_t g_os_time;
 os_time_t g_os_last_ctx_sw_time;
 
+#if MYNEWT_VAL(OS_SCHED_BITMAP)
+static void
+os_sched_run_q_update(void)
+{
+    uint32_t word;
+    uint32_t prio;
+
+    if (os_sched_run_grp == 0) {
+        g_os_run_list.tqh_first = NULL;
+        return;
+    }
+    word = __builtin_clz(os_sched_run_grp);
+    prio = (word << 5) + __builtin_clz(os_sched_run_bmap[word]);
+
+    g_os_run_list.tqh_first = TAILQ_FIRST(&os_sched_run_q[prio]);
+}
+
+static void
+os_sched_run_q_insert(struct os_task *t)
+{
+    uint8_t prio;
+
+    prio = t->t_prio;
+    if (!(os_sched_run_bmap[prio >> 5] & OS_SCHED_BMAP_BIT(prio))) {
+        /* Queue heads are only initialized when the level becomes used. */
+        TAILQ_INIT(&os_sched_run_q[prio]);
+        os_sched_run_bmap[prio >> 5] |= OS_SCHED_BMAP_BIT(prio);
+        os_sched_run_grp |= OS_SCHED_BMAP_BIT(prio >> 5);
+    }
+    TAILQ_INSERT_TAIL(&os_sched_run_q[prio], t, t_os_list);
+    t->t_run_prio = prio;
+    os_sched_run_q_update();
+}
+
+static void
+os_sched_run_q_remove(struct os_task *t)
+{
+    uint8_t prio;
+
+    /*
+     * Task priority might have been changed already (mutex priority
+     * inheritance), so use the level task was queued with.
+     */
+    prio = t->t_run_prio;
+    TAILQ_REMOVE(&os_sched_run_q[prio], t, t_os_list);
+    if (TAILQ_EMPTY(&os_sched_run_q[prio])) {
+        os_sched_run_bmap[prio >> 5] &= ~OS_SCHED_BMAP_BIT(prio);
+        if (os_sched_run_bmap[prio >> 5] == 0) {
+            os_sched_run_grp &= ~OS_SCHED_BMAP_BIT(prio >> 5);
+        }
+    }
+    os_sched_run_q_update();
+}
+
+void
+os_sched_run_list_init(void)
+{
+    memset(os_sched_run_bmap, 0, sizeof(os_sched_run_bmap));
+    os_sched_run_grp = 0;
+    TAILQ_INIT(&g_os_run_list);
+}
+#else
+static void
+os_sched_run_q_insert(struct os_task *t)
+{
+    struct os_task *entry;
+
+    TAILQ_FOREACH(entry, &g_os_run_list, t_os_list) {
+        if (t->t_prio < entry->t_prio) {
+            break;
+        }
+    }
+    if (entry) {
+        TAILQ_INSERT_BEFORE(entry, (struct os_task *) t, t_os_list);
+    } else {
+        TAILQ_INSERT_TAIL(&g_os_run_list, (struct os_task *) t, t_os_list);
+    }
+}
+
+static void
+os_sched_run_q_remove(struct os_task *t)
+{
+    TAILQ_REMOVE(&g_os_run_list, t, t_os_list);
+}
+
+void
+os_sched_run_list_init(void)
+{
+    TAILQ_INIT(&g_os_run_list);
+}
+#endif
+
 /**
  * os sched insert
  *
@@ -43,7 +155,6 @@ os_time_t g_os_last_ctx_sw_time;
 os_error_t
 os_sched_insert(struct os_task *t)
 {
-    struct os_task *entry;
     os_sr_t sr;
     os_error_t rc;
 
@@ -52,18 +163,8 @@ os_sched_insert(struct os_task *t)
         goto err;
     }
 
-    entry = NULL;
     OS_ENTER_CRITICAL(sr);
-    TAILQ_FOREACH(entry, &g_os_run_list, t_os_list) {
-        if (t->t_prio < entry->t_prio) {
-            break;
-        }
-    }
-    if (entry) {
-        TAILQ_INSERT_BEFORE(entry, (struct os_task *) t, t_os_list);
-    } else {
-        TAILQ_INSERT_TAIL(&g_os_run_list, (struct os_task *) t, t_os_list);
-    }
+    os_sched_run_q_insert(t);
     OS_EXIT_CRITICAL(sr);
 
     return (0);
@@ -145,7 +246,7 @@ os_sched_sleep(struct os_task *t, os_time_t nticks)
 
     entry = NULL;
 
-    TAILQ_REMOVE(&g_os_run_list, t, t_os_list);
+    os_sched_run_q_remove(t);
     t->t_state = OS_TASK_SLEEP;
     t->t_next_wakeup = os_time_get() + nticks;
     if (nticks == OS_TIMEOUT_NEVER) {
@@ -189,7 +290,7 @@ os_sched_remove(struct os_task *t)
     if (t->t_state == OS_TASK_SLEEP) {
         TAILQ_REMOVE(&g_os_sleep_list, t, t_os_list);
     } else if (t->t_state == OS_TASK_READY) {
-        TAILQ_REMOVE(&g_os_run_list, t, t_os_list);
+        os_sched_run_q_remove(t);
     }
     t->t_next_wakeup = 0;
     t->t_flags |= OS_TASK_FLAG_NO_TIMEOUT;
@@ -339,7 +440,7 @@ void
 os_sched_resort(struct os_task *t)
 {
     if (t->t_state == OS_TASK_READY) {
-        TAILQ_REMOVE(&g_os_run_list, t, t_os_list);
+        os_sched_run_q_remove(t);
         os_sched_insert(t);
     }
 }
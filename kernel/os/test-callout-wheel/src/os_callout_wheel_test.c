@@ -0,0 +1,126 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include <string.h>
+#include "os/mynewt.h"
+#include "testutil/testutil.h"
+#include "os_callout_wheel_test.h"
+
+struct os_callout callout_wheel[CALLOUT_WHEEL_CNT];
+os_time_t callout_wheel_exp[CALLOUT_WHEEL_CNT];
+int callout_wheel_fired[CALLOUT_WHEEL_CNT];
+int callout_wheel_order[2 * CALLOUT_WHEEL_CNT];
+int callout_wheel_cnt;
+
+static void
+callout_wheel_cb(struct os_event *ev)
+{
+    struct os_callout *c;
+    int idx;
+
+    c = (struct os_callout *)ev;
+    idx = c - callout_wheel;
+
+    TEST_ASSERT(os_time_get() == callout_wheel_exp[idx],
+                "callout %d fired at %u, expected %u", idx,
+                (unsigned int)os_time_get(),
+                (unsigned int)callout_wheel_exp[idx]);
+    callout_wheel_fired[idx]++;
+    TEST_ASSERT_FATAL(callout_wheel_cnt < 2 * CALLOUT_WHEEL_CNT);
+    callout_wheel_order[callout_wheel_cnt++] = idx;
+}
+
+void
+callout_wheel_arm(int idx, os_time_t ticks)
+{
+    int rc;
+
+    rc = os_callout_reset(&callout_wheel[idx], ticks);
+    TEST_ASSERT_FATAL(rc == 0);
+    callout_wheel_exp[idx] = os_time_get() + (ticks ? ticks : 1);
+}
+
+os_time_t
+callout_wheel_wakeup(void)
+{
+    os_time_t ticks;
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+    ticks = os_callout_wakeup_ticks(os_time_get());
+    OS_EXIT_CRITICAL(sr);
+
+    return ticks;
+}
+
+/*
+ * Advances time to the next callout expiry the way tickless idle does,
+ * checking that the wakeup time reported matches.
+ */
+void
+callout_wheel_advance(os_time_t expected)
+{
+    os_time_t ticks;
+
+    ticks = callout_wheel_wakeup();
+    TEST_ASSERT_FATAL(ticks == expected, "wakeup in %u ticks, expected %u",
+                      (unsigned int)ticks, (unsigned int)expected);
+    os_time_advance(ticks);
+    os_callout_tick();
+}
+
+/*
+ * The OS is not started; time is moved forward by the test cases, and
+ * callouts have no event queue, so they fire from os_callout_tick(). Each
+ * case leaves no callout armed.
+ */
+static void
+callout_wheel_test_init(void *arg)
+{
+    int k;
+
+    for (k = 0; k < CALLOUT_WHEEL_CNT; k++) {
+        os_callout_init(&callout_wheel[k], NULL, callout_wheel_cb, NULL);
+    }
+    memset(callout_wheel_fired, 0, sizeof(callout_wheel_fired));
+    callout_wheel_cnt = 0;
+}
+
+TEST_CASE_DECL(callout_test_wheel)
+TEST_CASE_DECL(callout_test_wheel_many)
+
+TEST_SUITE(os_callout_wheel_test_suite)
+{
+    tu_suite_set_pre_test_cb(callout_wheel_test_init, NULL);
+    callout_test_wheel();
+    callout_test_wheel_many();
+}
+
+#if MYNEWT_VAL(SELFTEST)
+
+int
+main(int argc, char **argv)
+{
+    sysinit();
+
+    os_callout_wheel_test_suite();
+
+    return tu_any_failed;
+}
+
+#endif
@@ -0,0 +1,50 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#ifndef H_OS_CALLOUT_WHEEL_TEST_
+#define H_OS_CALLOUT_WHEEL_TEST_
+
+#include "os/mynewt.h"
+#include "testutil/testutil.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CALLOUT_WHEEL_CNT   1000
+
+/* Ticks per wheel revolution. */
+#define CALLOUT_WHEEL_REV   MYNEWT_VAL(OS_CALLOUT_WHEEL_SLOTS)
+
+extern struct os_callout callout_wheel[CALLOUT_WHEEL_CNT];
+extern os_time_t callout_wheel_exp[CALLOUT_WHEEL_CNT];
+extern int callout_wheel_fired[CALLOUT_WHEEL_CNT];
+
+/* Callouts in the order they fired. */
+extern int callout_wheel_order[2 * CALLOUT_WHEEL_CNT];
+extern int callout_wheel_cnt;
+
+void callout_wheel_arm(int idx, os_time_t ticks);
+os_time_t callout_wheel_wakeup(void);
+void callout_wheel_advance(os_time_t expected);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
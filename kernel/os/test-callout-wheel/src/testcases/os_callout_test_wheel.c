@@ -0,0 +1,76 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "os_callout_wheel_test.h"
+
+/*
+ * Callouts sharing wheel slots, further out than one revolution, and armed
+ * for the current tick fire in expiry order, at their expiry tick.
+ */
+TEST_CASE(callout_test_wheel)
+{
+    TEST_ASSERT_FATAL(!os_started());
+
+    TEST_ASSERT(callout_wheel_wakeup() == OS_TIMEOUT_NEVER);
+
+    /* 0, 3 and 4 share a slot, 3 and 4 a revolution and more away. */
+    callout_wheel_arm(0, 5);
+    callout_wheel_arm(1, 1);
+    callout_wheel_arm(2, 3);
+    callout_wheel_arm(3, CALLOUT_WHEEL_REV + 5);
+    callout_wheel_arm(4, 2 * CALLOUT_WHEEL_REV + 5);
+
+    /* Armed for now; due on the next tick. */
+    callout_wheel_arm(5, 0);
+
+    callout_wheel_advance(1);
+    TEST_ASSERT(callout_wheel_cnt == 2);
+
+    /*
+     * Re-arming for the tick just processed must not land in a visited
+     * slot, and tickless idle must not see it as overdue.
+     */
+    callout_wheel_arm(5, 0);
+    TEST_ASSERT(callout_wheel_wakeup() == 1);
+    callout_wheel_advance(1);
+    TEST_ASSERT(callout_wheel_cnt == 3);
+
+    callout_wheel_advance(1);
+    callout_wheel_advance(2);
+    callout_wheel_advance(CALLOUT_WHEEL_REV);
+    callout_wheel_advance(CALLOUT_WHEEL_REV);
+    TEST_ASSERT(callout_wheel_wakeup() == OS_TIMEOUT_NEVER);
+
+    TEST_ASSERT_FATAL(callout_wheel_cnt == 7);
+    TEST_ASSERT(callout_wheel_order[0] == 1);
+    TEST_ASSERT(callout_wheel_order[1] == 5);
+    TEST_ASSERT(callout_wheel_order[2] == 5);
+    TEST_ASSERT(callout_wheel_order[3] == 2);
+    TEST_ASSERT(callout_wheel_order[4] == 0);
+    TEST_ASSERT(callout_wheel_order[5] == 3);
+    TEST_ASSERT(callout_wheel_order[6] == 4);
+
+    /* Stopped callouts do not fire, and are not waited for. */
+    callout_wheel_arm(0, 4);
+    callout_wheel_arm(1, 4 + CALLOUT_WHEEL_REV);
+    os_callout_stop(&callout_wheel[0]);
+    callout_wheel_advance(4 + CALLOUT_WHEEL_REV);
+    TEST_ASSERT(callout_wheel_fired[0] == 1);
+    TEST_ASSERT(callout_wheel_fired[1] == 2);
+    TEST_ASSERT(callout_wheel_wakeup() == OS_TIMEOUT_NEVER);
+}
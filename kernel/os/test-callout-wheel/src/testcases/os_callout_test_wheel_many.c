@@ -0,0 +1,93 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "os_callout_wheel_test.h"
+
+/* Spread over a few revolutions. */
+#define CALLOUT_WHEEL_SPAN  (4 * CALLOUT_WHEEL_REV + 3)
+
+/*
+ * Returns the ticks until the earliest callout that should still fire.
+ */
+static os_time_t
+callout_wheel_next(const int *armed)
+{
+    os_time_t next;
+    os_time_t left;
+    int k;
+
+    next = OS_TIMEOUT_NEVER;
+    for (k = 0; k < CALLOUT_WHEEL_CNT; k++) {
+        if (armed[k] && !callout_wheel_fired[k]) {
+            left = callout_wheel_exp[k] - os_time_get();
+            if (left < next) {
+                next = left;
+            }
+        }
+    }
+    return next;
+}
+
+/*
+ * Many callouts armed, re-armed and stopped across several revolutions each
+ * fire once, in expiry order.
+ */
+TEST_CASE(callout_test_wheel_many)
+{
+    static int armed[CALLOUT_WHEEL_CNT];
+    os_time_t next;
+    int cnt;
+    int k;
+
+    for (k = 0; k < CALLOUT_WHEEL_CNT; k++) {
+        callout_wheel_arm(k, 1 + (k * 7919) % CALLOUT_WHEEL_SPAN);
+        armed[k] = 1;
+    }
+    for (k = 0; k < CALLOUT_WHEEL_CNT; k += 2) {
+        callout_wheel_arm(k, 1 + (k * 104729) % CALLOUT_WHEEL_SPAN);
+    }
+    cnt = 0;
+    for (k = 0; k < CALLOUT_WHEEL_CNT; k++) {
+        if (k % 3 == 0) {
+            os_callout_stop(&callout_wheel[k]);
+            TEST_ASSERT(!os_callout_queued(&callout_wheel[k]));
+            armed[k] = 0;
+        } else {
+            cnt++;
+        }
+    }
+
+    /* Every step fires at least one callout. */
+    for (k = 0; k < cnt; k++) {
+        next = callout_wheel_next(armed);
+        if (next == OS_TIMEOUT_NEVER) {
+            break;
+        }
+        callout_wheel_advance(next);
+    }
+    TEST_ASSERT(callout_wheel_wakeup() == OS_TIMEOUT_NEVER);
+
+    TEST_ASSERT_FATAL(callout_wheel_cnt == cnt);
+    for (k = 0; k < CALLOUT_WHEEL_CNT; k++) {
+        TEST_ASSERT(callout_wheel_fired[k] == armed[k]);
+    }
+    for (k = 1; k < callout_wheel_cnt; k++) {
+        TEST_ASSERT(!OS_TIME_TICK_LT(callout_wheel_exp[callout_wheel_order[k]],
+                    callout_wheel_exp[callout_wheel_order[k - 1]]));
+    }
+}
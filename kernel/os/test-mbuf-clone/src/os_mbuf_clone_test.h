@@ -0,0 +1,47 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#ifndef H_OS_MBUF_CLONE_TEST_
+#define H_OS_MBUF_CLONE_TEST_
+
+#include "os/mynewt.h"
+#include "testutil/testutil.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MBUF_TEST_POOL_BUF_SIZE     (256)
+#define MBUF_TEST_POOL_BUF_COUNT    (10)
+
+/* Clones take the last byte of each block for a reference count. */
+#define MBUF_TEST_POOL_BLOCK_SIZE   (MBUF_TEST_POOL_BUF_SIZE + 1)
+
+#define MBUF_TEST_DATA_LEN          (1024)
+
+extern struct os_mbuf_pool os_mbuf_pool;
+extern struct os_mempool os_mbuf_mempool;
+extern uint8_t os_mbuf_test_data[MBUF_TEST_DATA_LEN];
+
+void os_mbuf_test_setup(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
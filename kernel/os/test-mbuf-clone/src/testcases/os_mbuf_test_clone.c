@@ -0,0 +1,134 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include <string.h>
+#include "os_mbuf_clone_test.h"
+
+static void
+os_mbuf_test_clone_assert_data(struct os_mbuf *om, int pktlen)
+{
+    uint8_t buf[MBUF_TEST_DATA_LEN];
+    int rc;
+
+    TEST_ASSERT_FATAL(OS_MBUF_PKTLEN(om) == pktlen);
+    rc = os_mbuf_copydata(om, 0, pktlen, buf);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(memcmp(buf, os_mbuf_test_data, pktlen) == 0);
+}
+
+TEST_CASE(os_mbuf_test_clone)
+{
+    struct os_mbuf *clone2;
+    struct os_mbuf *clone;
+    struct os_mbuf *om;
+    struct os_mbuf *c;
+    struct os_mbuf *m;
+    int nfree;
+    int rc;
+
+    os_mbuf_test_setup();
+    nfree = os_mbuf_mempool.mp_num_free;
+
+    /* A two mbuf packet with a user header */
+    om = os_mbuf_get_pkthdr(&os_mbuf_pool, 8);
+    TEST_ASSERT_FATAL(om != NULL);
+    memset(OS_MBUF_USRHDR(om), 0xa5, 8);
+    rc = os_mbuf_append(om, os_mbuf_test_data, 300);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT_FATAL(SLIST_NEXT(om, om_next) != NULL);
+    TEST_ASSERT(os_mbuf_mempool.mp_num_free == nfree - 2);
+
+    clone = os_mbuf_clone(&os_mbuf_pool, om);
+    TEST_ASSERT_FATAL(clone != NULL);
+    TEST_ASSERT(os_mbuf_mempool.mp_num_free == nfree - 4);
+    TEST_ASSERT(clone->om_pkthdr_len == om->om_pkthdr_len);
+    TEST_ASSERT(memcmp(OS_MBUF_USRHDR(clone), OS_MBUF_USRHDR(om), 8) == 0);
+    os_mbuf_test_clone_assert_data(clone, 300);
+
+    /* The data is shared, not copied */
+    for (c = clone, m = om; m != NULL;
+         c = SLIST_NEXT(c, om_next), m = SLIST_NEXT(m, om_next)) {
+        TEST_ASSERT_FATAL(c != NULL);
+        TEST_ASSERT(c != m);
+        TEST_ASSERT(OS_MBUF_IS_CLONE(c));
+        TEST_ASSERT(c->om_data == m->om_data);
+        TEST_ASSERT(c->om_len == m->om_len);
+        TEST_ASSERT(OS_MBUF_LEADINGSPACE(c) == 0);
+        TEST_ASSERT(OS_MBUF_TRAILINGSPACE(c) == 0);
+    }
+    TEST_ASSERT(c == NULL);
+
+    /* Clones of clones share the same data */
+    clone2 = os_mbuf_clone(&os_mbuf_pool, clone);
+    TEST_ASSERT_FATAL(clone2 != NULL);
+    TEST_ASSERT(clone2->om_data == om->om_data);
+    TEST_ASSERT(os_mbuf_mempool.mp_num_free == nfree - 6);
+
+    /* Freeing the source keeps the data around for the clones */
+    rc = os_mbuf_free_chain(om);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(os_mbuf_mempool.mp_num_free == nfree - 6);
+    os_mbuf_test_clone_assert_data(clone, 300);
+
+    rc = os_mbuf_free_chain(clone);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(os_mbuf_mempool.mp_num_free == nfree - 4);
+    os_mbuf_test_clone_assert_data(clone2, 300);
+
+    /* Headers can be added in front of a clone */
+    clone2 = os_mbuf_prepend(clone2, 4);
+    TEST_ASSERT_FATAL(clone2 != NULL);
+    TEST_ASSERT(!OS_MBUF_IS_CLONE(clone2));
+    TEST_ASSERT(OS_MBUF_PKTLEN(clone2) == 304);
+    TEST_ASSERT(os_mbuf_mempool.mp_num_free == nfree - 5);
+
+    rc = os_mbuf_free_chain(clone2);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(os_mbuf_mempool.mp_num_free == nfree);
+
+    /* A duplicate of a clone owns its data */
+    om = os_mbuf_get_pkthdr(&os_mbuf_pool, 0);
+    TEST_ASSERT_FATAL(om != NULL);
+    rc = os_mbuf_append(om, os_mbuf_test_data, 100);
+    TEST_ASSERT_FATAL(rc == 0);
+    clone = os_mbuf_clone(&os_mbuf_pool, om);
+    TEST_ASSERT_FATAL(clone != NULL);
+    m = os_mbuf_dup(clone);
+    TEST_ASSERT_FATAL(m != NULL);
+    TEST_ASSERT(!OS_MBUF_IS_CLONE(m));
+    TEST_ASSERT(m->om_data != om->om_data);
+    os_mbuf_test_clone_assert_data(m, 100);
+
+    os_mbuf_free_chain(clone);
+    os_mbuf_free_chain(om);
+    os_mbuf_free_chain(m);
+    TEST_ASSERT(os_mbuf_mempool.mp_num_free == nfree);
+
+    /* Running out of headers frees the partial clone */
+    om = os_mbuf_get_pkthdr(&os_mbuf_pool, 0);
+    TEST_ASSERT_FATAL(om != NULL);
+    rc = os_mbuf_append(om, os_mbuf_test_data, MBUF_TEST_DATA_LEN);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = os_mbuf_append(om, os_mbuf_test_data, 300);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(os_mbuf_mempool.mp_num_free < nfree / 2);
+    clone = os_mbuf_clone(&os_mbuf_pool, om);
+    TEST_ASSERT(clone == NULL);
+    os_mbuf_free_chain(om);
+    TEST_ASSERT(os_mbuf_mempool.mp_num_free == nfree);
+}
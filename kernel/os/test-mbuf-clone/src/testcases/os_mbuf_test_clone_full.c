@@ -0,0 +1,67 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include <string.h>
+#include "os_mbuf_clone_test.h"
+
+TEST_CASE(os_mbuf_test_clone_full)
+{
+    struct os_mbuf *clone;
+    struct os_mbuf *om;
+    struct os_mbuf *m;
+    uint8_t buf[MBUF_TEST_DATA_LEN];
+    int nfree;
+    int len;
+    int rc;
+
+    os_mbuf_test_setup();
+    nfree = os_mbuf_mempool.mp_num_free;
+
+    /* The reference count byte is not part of the data buffer. */
+    TEST_ASSERT(os_mbuf_pool.omp_databuf_len ==
+                MBUF_TEST_POOL_BLOCK_SIZE - sizeof(struct os_mbuf) - 1);
+
+    /* Two mbufs, with every byte of their data buffers in use. */
+    om = os_mbuf_get_pkthdr(&os_mbuf_pool, 0);
+    TEST_ASSERT_FATAL(om != NULL);
+    len = 2 * os_mbuf_pool.omp_databuf_len - sizeof(struct os_mbuf_pkthdr);
+    rc = os_mbuf_append(om, os_mbuf_test_data, len);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(os_mbuf_mempool.mp_num_free == nfree - 2);
+    for (m = om; m != NULL; m = SLIST_NEXT(m, om_next)) {
+        TEST_ASSERT(OS_MBUF_TRAILINGSPACE(m) == 0);
+    }
+
+    clone = os_mbuf_clone(&os_mbuf_pool, om);
+    TEST_ASSERT_FATAL(clone != NULL);
+    TEST_ASSERT(os_mbuf_mempool.mp_num_free == nfree - 4);
+
+    /* Writing the data did not clobber the counts; the blocks stay. */
+    rc = os_mbuf_free_chain(om);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(os_mbuf_mempool.mp_num_free == nfree - 4);
+
+    TEST_ASSERT_FATAL(OS_MBUF_PKTLEN(clone) == len);
+    rc = os_mbuf_copydata(clone, 0, len, buf);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(memcmp(buf, os_mbuf_test_data, len) == 0);
+
+    rc = os_mbuf_free_chain(clone);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(os_mbuf_mempool.mp_num_free == nfree);
+}
@@ -0,0 +1,164 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include <string.h>
+#include "os/mynewt.h"
+#include "mem/mem.h"
+#include "stats/stats.h"
+#include "testutil/testutil.h"
+#include "os_msys_test.h"
+
+#define MSYS_TEST_MEMPOOL_SIZE                                  \
+    OS_MEMPOOL_SIZE(MSYS_TEST_BLOCK_CNT,                        \
+                    MSYS_TEST_MAX_LEN + sizeof(struct os_mbuf))
+
+static os_membuf_t msys_test_data[MSYS_TEST_POOL_CNT][MSYS_TEST_MEMPOOL_SIZE];
+static struct os_mempool msys_test_mempools[MSYS_TEST_POOL_CNT];
+struct os_mbuf_pool msys_test_pools[MSYS_TEST_POOL_CNT];
+
+/* Two pools on a power of 2, which is a size class boundary, two not. */
+const uint16_t msys_test_lens[MSYS_TEST_POOL_CNT] = {
+    64, 100, 256, MSYS_TEST_MAX_LEN
+};
+static char *msys_test_names[MSYS_TEST_POOL_CNT] = {
+    "msys_test_64", "msys_test_100", "msys_test_256", "msys_test_1000"
+};
+static const int msys_test_reg_order[MSYS_TEST_POOL_CNT] = { 3, 1, 0, 2 };
+
+struct msys_test_stat_arg {
+    char *name;
+    uint32_t val;
+    int found;
+};
+
+void
+msys_test_pool_init(struct os_mbuf_pool *omp, struct os_mempool *mp,
+                    os_membuf_t *data, uint16_t len, char *name)
+{
+    int rc;
+
+    rc = mem_init_mbuf_pool(data, mp, omp, MSYS_TEST_BLOCK_CNT,
+                            len + sizeof(struct os_mbuf), name);
+    TEST_ASSERT_FATAL(rc == 0, "Error creating mbuf pool %d", rc);
+    TEST_ASSERT_FATAL(omp->omp_databuf_len == len);
+}
+
+/*
+ * Registers the test pools, always in the same order, so every slot's stats
+ * are reported under the name of the same pool.
+ */
+void
+msys_test_register(void)
+{
+    int rc;
+    int i;
+
+    os_msys_reset();
+    for (i = 0; i < MSYS_TEST_POOL_CNT; i++) {
+        rc = os_msys_register(&msys_test_pools[msys_test_reg_order[i]]);
+        TEST_ASSERT_FATAL(rc == 0, "Error registering pool %d", rc);
+    }
+}
+
+/* The smallest pool which fits dsize, or the largest one. */
+struct os_mbuf_pool *
+msys_test_best_fit(uint16_t dsize)
+{
+    int i;
+
+    for (i = 0; i < MSYS_TEST_POOL_CNT - 1; i++) {
+        if (msys_test_lens[i] >= dsize) {
+            break;
+        }
+    }
+    return &msys_test_pools[i];
+}
+
+static int
+msys_test_stat_walk(struct stats_hdr *hdr, void *arg, char *name,
+                    uint16_t off)
+{
+    struct msys_test_stat_arg *sa;
+
+    sa = arg;
+    if (strcmp(name, sa->name) == 0) {
+        sa->val = *(uint32_t *)((uint8_t *)hdr + off);
+        sa->found = 1;
+    }
+    return 0;
+}
+
+uint32_t
+msys_test_stat(int pool, char *name)
+{
+    struct msys_test_stat_arg sa;
+    struct stats_hdr *hdr;
+
+    hdr = stats_group_find(msys_test_names[pool]);
+    TEST_ASSERT_FATAL(hdr != NULL, "no stats for %s", msys_test_names[pool]);
+
+    sa.name = name;
+    sa.val = 0;
+    sa.found = 0;
+    stats_walk(hdr, msys_test_stat_walk, &sa);
+    TEST_ASSERT_FATAL(sa.found, "no %s stat", name);
+
+    return sa.val;
+}
+
+static void
+msys_test_init(void *arg)
+{
+    msys_test_register();
+}
+
+TEST_CASE_DECL(os_msys_test_best_fit)
+TEST_CASE_DECL(os_msys_test_max_pools)
+TEST_CASE_DECL(os_msys_test_exhaust)
+TEST_CASE_DECL(os_msys_test_stats)
+
+TEST_SUITE(os_msys_test_suite)
+{
+    int i;
+
+    for (i = 0; i < MSYS_TEST_POOL_CNT; i++) {
+        msys_test_pool_init(&msys_test_pools[i], &msys_test_mempools[i],
+                            msys_test_data[i], msys_test_lens[i],
+                            msys_test_names[i]);
+    }
+
+    tu_suite_set_pre_test_cb(msys_test_init, NULL);
+    os_msys_test_best_fit();
+    os_msys_test_max_pools();
+    os_msys_test_exhaust();
+    os_msys_test_stats();
+}
+
+#if MYNEWT_VAL(SELFTEST)
+
+int
+main(int argc, char **argv)
+{
+    sysinit();
+
+    os_msys_test_suite();
+
+    return tu_any_failed;
+}
+
+#endif
@@ -0,0 +1,47 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#ifndef H_OS_MSYS_TEST_
+#define H_OS_MSYS_TEST_
+
+#include "os/mynewt.h"
+#include "testutil/testutil.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MSYS_TEST_POOL_CNT          (4)
+#define MSYS_TEST_BLOCK_CNT         (2)
+#define MSYS_TEST_MAX_LEN           (1000)
+
+/* Pools, in increasing buffer size; they're registered out of order. */
+extern struct os_mbuf_pool msys_test_pools[MSYS_TEST_POOL_CNT];
+extern const uint16_t msys_test_lens[MSYS_TEST_POOL_CNT];
+
+void msys_test_pool_init(struct os_mbuf_pool *omp, struct os_mempool *mp,
+                         os_membuf_t *data, uint16_t len, char *name);
+void msys_test_register(void);
+struct os_mbuf_pool *msys_test_best_fit(uint16_t dsize);
+uint32_t msys_test_stat(int pool, char *name);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
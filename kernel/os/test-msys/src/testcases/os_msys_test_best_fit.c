@@ -0,0 +1,56 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "os_msys_test.h"
+
+/*
+ * Every data size up to past the largest pool, covering each size class
+ * boundary, gets a buffer from the best fit pool.
+ */
+TEST_CASE(os_msys_test_best_fit)
+{
+    struct os_mbuf *om;
+    uint16_t hdr;
+    int dsize;
+
+    TEST_ASSERT(os_msys_count() == MSYS_TEST_POOL_CNT * MSYS_TEST_BLOCK_CNT);
+
+    hdr = sizeof(struct os_mbuf_pkthdr);
+    for (dsize = 0; dsize <= MSYS_TEST_MAX_LEN + 64; dsize++) {
+        om = os_msys_get(dsize, 0);
+        TEST_ASSERT_FATAL(om != NULL, "no mbuf for %d", dsize);
+        TEST_ASSERT(om->om_omp == msys_test_best_fit(dsize),
+                    "%d bytes from the %d byte pool", dsize,
+                    om->om_omp->omp_databuf_len);
+        os_mbuf_free_chain(om);
+
+        om = os_msys_get_pkthdr(dsize, 0);
+        TEST_ASSERT_FATAL(om != NULL, "no pkthdr mbuf for %d", dsize);
+        TEST_ASSERT(om->om_omp == msys_test_best_fit(dsize + hdr),
+                    "%d bytes with pkthdr from the %d byte pool", dsize,
+                    om->om_omp->omp_databuf_len);
+        os_mbuf_free_chain(om);
+    }
+
+    om = os_msys_get(UINT16_MAX, 0);
+    TEST_ASSERT_FATAL(om != NULL);
+    TEST_ASSERT(om->om_omp == &msys_test_pools[MSYS_TEST_POOL_CNT - 1]);
+    os_mbuf_free_chain(om);
+
+    TEST_ASSERT(os_msys_num_free() == os_msys_count());
+}
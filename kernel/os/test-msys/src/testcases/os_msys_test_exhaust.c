@@ -0,0 +1,60 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "os_msys_test.h"
+
+/*
+ * Exhausts the 100 byte pool.  With MSYS_FALLBACK, buffers come from the
+ * larger pools until they are all gone, without MSYS_FALLBACK not at all;
+ * the smaller pool is never used.
+ */
+TEST_CASE(os_msys_test_exhaust)
+{
+    struct os_mbuf *om[MSYS_TEST_POOL_CNT * MSYS_TEST_BLOCK_CNT];
+    int cnt;
+    int i;
+
+    for (cnt = 0; cnt < MSYS_TEST_BLOCK_CNT; cnt++) {
+        om[cnt] = os_msys_get(msys_test_lens[1], 0);
+        TEST_ASSERT_FATAL(om[cnt] != NULL);
+        TEST_ASSERT(om[cnt]->om_omp == &msys_test_pools[1]);
+    }
+
+#if MYNEWT_VAL(MSYS_FALLBACK)
+    for (i = 2; i < MSYS_TEST_POOL_CNT; i++) {
+        for (; cnt < i * MSYS_TEST_BLOCK_CNT; cnt++) {
+            om[cnt] = os_msys_get(msys_test_lens[1], 0);
+            TEST_ASSERT_FATAL(om[cnt] != NULL, "no fallback to pool %d", i);
+            TEST_ASSERT(om[cnt]->om_omp == &msys_test_pools[i],
+                        "fell back to the %d byte pool, expected %d",
+                        om[cnt]->om_omp->omp_databuf_len, msys_test_lens[i]);
+        }
+    }
+#endif
+
+    TEST_ASSERT(os_msys_get(msys_test_lens[1], 0) == NULL);
+    TEST_ASSERT(os_msys_num_free() ==
+                MSYS_TEST_POOL_CNT * MSYS_TEST_BLOCK_CNT - cnt);
+    TEST_ASSERT(msys_test_pools[0].omp_pool->mp_num_free ==
+                MSYS_TEST_BLOCK_CNT);
+
+    for (i = 0; i < cnt; i++) {
+        os_mbuf_free_chain(om[i]);
+    }
+    TEST_ASSERT(os_msys_num_free() == os_msys_count());
+}
@@ -0,0 +1,66 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "os_msys_test.h"
+
+static os_membuf_t msys_test_extra_data[
+    OS_MEMPOOL_SIZE(MSYS_TEST_BLOCK_CNT, 32 + sizeof(struct os_mbuf))];
+static struct os_mempool msys_test_extra_mempool;
+static struct os_mbuf_pool msys_test_extra_pool;
+
+TEST_CASE(os_msys_test_max_pools)
+{
+    struct os_mbuf *om;
+    int rc;
+
+    TEST_ASSERT_FATAL(MYNEWT_VAL(MSYS_MAX_POOLS) == MSYS_TEST_POOL_CNT);
+
+    msys_test_pool_init(&msys_test_extra_pool, &msys_test_extra_mempool,
+                        msys_test_extra_data, 32, "msys_test_extra");
+
+    /* All slots are taken; the smaller pool is not used. */
+    rc = os_msys_register(&msys_test_extra_pool);
+    TEST_ASSERT(rc == OS_ENOMEM);
+    TEST_ASSERT(os_msys_count() == MSYS_TEST_POOL_CNT * MSYS_TEST_BLOCK_CNT);
+
+    om = os_msys_get(1, 0);
+    TEST_ASSERT_FATAL(om != NULL);
+    TEST_ASSERT(om->om_omp == &msys_test_pools[0]);
+    os_mbuf_free_chain(om);
+
+    /* Registering a pool again is a no-op. */
+    rc = os_msys_register(&msys_test_pools[0]);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(os_msys_count() == MSYS_TEST_POOL_CNT * MSYS_TEST_BLOCK_CNT);
+
+    /* Once reset, msys is empty, and the slots free again. */
+    os_msys_reset();
+    TEST_ASSERT(os_msys_count() == 0);
+    TEST_ASSERT(os_msys_get(1, 0) == NULL);
+
+    rc = os_msys_register(&msys_test_extra_pool);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(os_msys_count() == MSYS_TEST_BLOCK_CNT);
+
+    om = os_msys_get(MSYS_TEST_MAX_LEN, 0);
+    TEST_ASSERT_FATAL(om != NULL);
+    TEST_ASSERT(om->om_omp == &msys_test_extra_pool);
+    os_mbuf_free_chain(om);
+
+    os_msys_reset();
+}
@@ -0,0 +1,90 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include <string.h>
+#include "stats/stats.h"
+#include "os_msys_test.h"
+
+static int msys_test_stats_cnt;
+
+static int
+msys_test_stats_count(struct stats_hdr *hdr, void *arg)
+{
+    if (strcmp(hdr->s_name, arg) == 0) {
+        msys_test_stats_cnt++;
+    }
+    return 0;
+}
+
+TEST_CASE(os_msys_test_stats)
+{
+    struct os_mbuf *om[MSYS_TEST_BLOCK_CNT + 2];
+    int fallback;
+    int cnt;
+    int i;
+
+    fallback = MYNEWT_VAL(MSYS_FALLBACK);
+
+    /* Counters start from 0 each time the pools are registered. */
+    for (i = 0; i < MSYS_TEST_POOL_CNT; i++) {
+        TEST_ASSERT(msys_test_stat(i, "hit") == 0);
+        TEST_ASSERT(msys_test_stat(i, "miss") == 0);
+        TEST_ASSERT(msys_test_stat(i, "fallback") == 0);
+    }
+
+    for (cnt = 0; cnt < MSYS_TEST_BLOCK_CNT + 1; cnt++) {
+        om[cnt] = os_msys_get(msys_test_lens[1], 0);
+    }
+    om[cnt++] = os_msys_get(1, 0);
+
+    TEST_ASSERT(msys_test_stat(0, "hit") == 1);
+    TEST_ASSERT(msys_test_stat(1, "hit") == MSYS_TEST_BLOCK_CNT);
+    TEST_ASSERT(msys_test_stat(1, "miss") == 1);
+    TEST_ASSERT(msys_test_stat(1, "fallback") == 0);
+    TEST_ASSERT(msys_test_stat(2, "hit") == 0);
+    TEST_ASSERT(msys_test_stat(2, "fallback") == fallback);
+    TEST_ASSERT(msys_test_stat(3, "fallback") == 0);
+
+    for (i = 0; i < cnt; i++) {
+        os_mbuf_free_chain(om[i]);
+    }
+
+    /*
+     * Pools registered again after a reset, in any order, take over the
+     * registered stats instead of registering them again.
+     */
+    os_msys_reset();
+    for (i = 0; i < MSYS_TEST_POOL_CNT; i++) {
+        TEST_ASSERT_FATAL(os_msys_register(&msys_test_pools[i]) == 0);
+    }
+    msys_test_register();
+
+    for (i = 0; i < MSYS_TEST_POOL_CNT; i++) {
+        TEST_ASSERT(msys_test_stat(i, "hit") == 0);
+        TEST_ASSERT(msys_test_stat(i, "miss") == 0);
+        TEST_ASSERT(msys_test_stat(i, "fallback") == 0);
+    }
+
+    for (i = 0; i < MSYS_TEST_POOL_CNT; i++) {
+        msys_test_stats_cnt = 0;
+        stats_group_walk(msys_test_stats_count,
+                         msys_test_pools[i].omp_pool->name);
+        TEST_ASSERT(msys_test_stats_cnt == 1, "%s registered %d times",
+                    msys_test_pools[i].omp_pool->name, msys_test_stats_cnt);
+    }
+}
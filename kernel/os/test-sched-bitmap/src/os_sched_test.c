@@ -0,0 +1,91 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include <string.h>
+#include "os/mynewt.h"
+#include "testutil/testutil.h"
+#include "os_sched_test.h"
+
+struct os_task os_sched_test_tasks[OS_SCHED_TEST_TASKS];
+
+/*
+ * The tasks used here are never started; they are only moved between the
+ * run and sleep lists, so the tests run without the OS running.
+ */
+void
+os_sched_test_ready(struct os_task *t, uint8_t prio)
+{
+    os_sr_t sr;
+    int rc;
+
+    t->t_prio = prio;
+    t->t_state = OS_TASK_READY;
+
+    OS_ENTER_CRITICAL(sr);
+    rc = os_sched_insert(t);
+    OS_EXIT_CRITICAL(sr);
+    TEST_ASSERT_FATAL(rc == 0);
+}
+
+/*
+ * Checks that 'expected' is selected to run next, and that the head of
+ * g_os_run_list, which the port context switch code reads, agrees.
+ */
+void
+os_sched_test_check(struct os_task *expected)
+{
+    TEST_ASSERT(os_sched_next_task() == expected,
+                "next task %p, expected %p", os_sched_next_task(), expected);
+    TEST_ASSERT(TAILQ_FIRST(&g_os_run_list) == expected,
+                "run list head %p, expected %p",
+                TAILQ_FIRST(&g_os_run_list), expected);
+}
+
+static void
+os_sched_test_init(void *arg)
+{
+    memset(os_sched_test_tasks, 0, sizeof(os_sched_test_tasks));
+    TAILQ_INIT(&g_os_sleep_list);
+    os_sched_run_list_init();
+}
+
+TEST_CASE_DECL(os_sched_test_order)
+TEST_CASE_DECL(os_sched_test_sleep)
+TEST_CASE_DECL(os_sched_test_resort)
+
+TEST_SUITE(os_sched_test_suite)
+{
+    tu_suite_set_pre_test_cb(os_sched_test_init, NULL);
+    os_sched_test_order();
+    os_sched_test_sleep();
+    os_sched_test_resort();
+}
+
+#if MYNEWT_VAL(SELFTEST)
+
+int
+main(int argc, char **argv)
+{
+    sysinit();
+
+    os_sched_test_suite();
+
+    return tu_any_failed;
+}
+
+#endif
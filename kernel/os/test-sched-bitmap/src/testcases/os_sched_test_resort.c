@@ -0,0 +1,54 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "os_sched_test.h"
+
+TEST_CASE(os_sched_test_resort)
+{
+    struct os_task *t;
+    os_sr_t sr;
+
+    t = os_sched_test_tasks;
+    os_sched_test_ready(&t[0], 10);
+    os_sched_test_ready(&t[1], 100);
+    os_sched_test_ready(&t[2], 100);
+    os_sched_test_check(&t[0]);
+
+    OS_ENTER_CRITICAL(sr);
+
+    /*
+     * Priority inheritance changes t_prio of a ready task before resorting;
+     * it has to be removed from the level it was queued at.
+     */
+    t[2].t_prio = 5;
+    os_sched_resort(&t[2]);
+    os_sched_test_check(&t[2]);
+
+    t[2].t_prio = 100;
+    os_sched_resort(&t[2]);
+    os_sched_test_check(&t[0]);
+
+    os_sched_sleep(&t[0], OS_TIMEOUT_NEVER);
+    os_sched_test_check(&t[1]);
+    os_sched_sleep(&t[1], OS_TIMEOUT_NEVER);
+    os_sched_test_check(&t[2]);
+    os_sched_sleep(&t[2], OS_TIMEOUT_NEVER);
+    os_sched_test_check(NULL);
+
+    OS_EXIT_CRITICAL(sr);
+}
@@ -0,0 +1,53 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "os_sched_test.h"
+
+TEST_CASE(os_sched_test_sleep)
+{
+    struct os_task *t;
+    os_sr_t sr;
+
+    t = os_sched_test_tasks;
+    os_sched_test_ready(&t[0], 10);
+    os_sched_test_ready(&t[1], 10);
+    os_sched_test_ready(&t[2], 20);
+    os_sched_test_check(&t[0]);
+
+    OS_ENTER_CRITICAL(sr);
+
+    /* Sleeping task goes behind its peers when woken up. */
+    os_sched_sleep(&t[0], OS_TIMEOUT_NEVER);
+    os_sched_test_check(&t[1]);
+    os_sched_wakeup(&t[0]);
+    os_sched_test_check(&t[1]);
+
+    os_sched_sleep(&t[1], OS_TIMEOUT_NEVER);
+    os_sched_test_check(&t[0]);
+    os_sched_sleep(&t[0], OS_TIMEOUT_NEVER);
+    os_sched_test_check(&t[2]);
+    os_sched_sleep(&t[2], OS_TIMEOUT_NEVER);
+    os_sched_test_check(NULL);
+
+    os_sched_wakeup(&t[2]);
+    os_sched_test_check(&t[2]);
+    os_sched_wakeup(&t[1]);
+    os_sched_test_check(&t[1]);
+
+    OS_EXIT_CRITICAL(sr);
+}
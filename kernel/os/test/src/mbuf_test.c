@@ -29,9 +29,13 @@
 #define MBUF_TEST_POOL_BUF_SIZE     (256)
 #define MBUF_TEST_POOL_BUF_COUNT    (10)
 
+/* Clones take the last byte of each block for a reference count. */
+#define MBUF_TEST_POOL_BLOCK_SIZE   \
+    (MBUF_TEST_POOL_BUF_SIZE + MYNEWT_VAL(OS_MBUF_CLONE))
+
 #define MBUF_TEST_DATA_LEN          (1024)
 
-os_membuf_t os_mbuf_membuf[OS_MEMPOOL_SIZE(MBUF_TEST_POOL_BUF_SIZE,
+os_membuf_t os_mbuf_membuf[OS_MEMPOOL_SIZE(MBUF_TEST_POOL_BLOCK_SIZE,
         MBUF_TEST_POOL_BUF_COUNT)];
 
 struct os_mbuf_pool os_mbuf_pool;
@@ -45,11 +49,11 @@ os_mbuf_test_setup(void)
     int i;
 
     rc = os_mempool_init(&os_mbuf_mempool, MBUF_TEST_POOL_BUF_COUNT,
-            MBUF_TEST_POOL_BUF_SIZE, &os_mbuf_membuf[0], "mbuf_pool");
+            MBUF_TEST_POOL_BLOCK_SIZE, &os_mbuf_membuf[0], "mbuf_pool");
     TEST_ASSERT_FATAL(rc == 0, "Error creating memory pool %d", rc);
 
     rc = os_mbuf_pool_init(&os_mbuf_pool, &os_mbuf_mempool,
-            MBUF_TEST_POOL_BUF_SIZE, MBUF_TEST_POOL_BUF_COUNT);
+            MBUF_TEST_POOL_BLOCK_SIZE, MBUF_TEST_POOL_BUF_COUNT);
     TEST_ASSERT_FATAL(rc == 0, "Error creating mbuf pool %d", rc);
 
     for (i = 0; i < sizeof os_mbuf_test_data; i++) {
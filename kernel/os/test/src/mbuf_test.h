@@ -35,9 +35,13 @@
 #define MBUF_TEST_POOL_BUF_SIZE     (256)
 #define MBUF_TEST_POOL_BUF_COUNT    (10)
 
+/* Clones take the last byte of each block for a reference count. */
+#define MBUF_TEST_POOL_BLOCK_SIZE   \
+    (MBUF_TEST_POOL_BUF_SIZE + MYNEWT_VAL(OS_MBUF_CLONE))
+
 #define MBUF_TEST_DATA_LEN          (1024)
 
-extern os_membuf_t os_mbuf_membuf[OS_MEMPOOL_SIZE(MBUF_TEST_POOL_BUF_SIZE,
+extern os_membuf_t os_mbuf_membuf[OS_MEMPOOL_SIZE(MBUF_TEST_POOL_BLOCK_SIZE,
         MBUF_TEST_POOL_BUF_COUNT)];
 
 extern struct os_mbuf_pool os_mbuf_pool;
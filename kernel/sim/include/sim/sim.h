@@ -48,6 +48,27 @@ void sim_restore_sr(os_sr_t osr);
 int sim_in_critical(void);
 void sim_tick_idle(os_time_t ticks);
 
+/**
+ * Handler for host I/O readiness. Called in interrupt context whenever
+ * SIGIO is delivered for any descriptor set up with sim_io_fd_async(); it
+ * is up to the handler to find out which descriptors are ready.
+ */
+struct sim_io_handler {
+    void (*sih_fn)(void *arg);
+    void *sih_arg;
+    SLIST_ENTRY(sim_io_handler) sih_next;
+};
+
+void sim_io_handler_add(struct sim_io_handler *sih);
+
+/**
+ * Requests SIGIO to be delivered when the file descriptor becomes ready
+ * for reading or writing.
+ *
+ * @return 0 on success, -1 if the descriptor does not support it.
+ */
+int sim_io_fd_async(int fd);
+
 /**
  * Prints information about a crash to stdout.  This functionality is defined
  * as a macro rather than a function to ensure that it gets inlined, enforcing
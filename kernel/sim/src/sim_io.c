@@ -0,0 +1,72 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Asynchronous I/O notifications for native drivers. File descriptors set
+ * up with sim_io_fd_async() make the host deliver SIGIO when they become
+ * ready; the signal is treated like any other interrupt source, and the
+ * registered handlers are called with interrupts disabled.
+ */
+
+#include "os/mynewt.h"
+#include "sim/sim.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include "sim_priv.h"
+
+static SLIST_HEAD(, sim_io_handler) sim_io_handlers =
+    SLIST_HEAD_INITIALIZER(sim_io_handlers);
+
+void
+sim_io_handler_add(struct sim_io_handler *sih)
+{
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+    SLIST_INSERT_HEAD(&sim_io_handlers, sih, sih_next);
+    OS_EXIT_CRITICAL(sr);
+}
+
+int
+sim_io_fd_async(int fd)
+{
+    int flags;
+
+    if (fcntl(fd, F_SETOWN, getpid()) < 0) {
+        return -1;
+    }
+    flags = fcntl(fd, F_GETFL, 0);
+    if (flags < 0 || fcntl(fd, F_SETFL, flags | O_ASYNC) < 0) {
+        return -1;
+    }
+    return 0;
+}
+
+void
+sim_io_irq(void)
+{
+    struct sim_io_handler *sih;
+
+    OS_ASSERT_CRITICAL();
+
+    SLIST_FOREACH(sih, &sim_io_handlers, sih_next) {
+        sih->sih_fn(sih->sih_arg);
+    }
+}
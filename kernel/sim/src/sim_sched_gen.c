@@ -243,7 +243,7 @@ sim_os_init(void)
     g_current_task = NULL;
 
     STAILQ_INIT(&g_os_task_list);
-    TAILQ_INIT(&g_os_run_list);
+    os_sched_run_list_init();
     TAILQ_INIT(&g_os_sleep_list);
 
     sim_signals_init();
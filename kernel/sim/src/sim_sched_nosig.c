@@ -113,39 +113,42 @@ sim_in_critical(void)
 }
 
 /**
- * Unblocks the SIGALRM signal that is delivered by the OS tick timer.
+ * Unblocks the SIGALRM signal that is delivered by the OS tick timer, and
+ * SIGIO delivered for host I/O.
  */
 static void
-unblock_timer(void)
+unblock_sigs(void)
 {
     sigset_t sigs;
     int rc;
 
     sigemptyset(&sigs);
     sigaddset(&sigs, SIGALRM);
+    sigaddset(&sigs, SIGIO);
 
     rc = sigprocmask(SIG_UNBLOCK, &sigs, NULL);
     assert(rc == 0);
 }
 
 /**
- * Blocks the SIGALRM signal that is delivered by the OS tick timer.
+ * Blocks the SIGALRM and SIGIO signals.
  */
 static void
-block_timer(void)
+block_sigs(void)
 {
     sigset_t sigs;
     int rc;
 
     sigemptyset(&sigs);
     sigaddset(&sigs, SIGALRM);
+    sigaddset(&sigs, SIGIO);
 
     rc = sigprocmask(SIG_BLOCK, &sigs, NULL);
     assert(rc == 0);
 }
 
 static void
-sig_handler_alrm(int sig)
+sig_handler_idle(int sig)
 {
     /* Wake the idle task. */
     sigaddset(&suspsigs, sig);
@@ -172,12 +175,12 @@ sim_tick_idle(os_time_t ticks)
         assert(rc == 0);
     }
 
-    unblock_timer();
+    unblock_sigs();
 
     sigemptyset(&suspsigs);
     sigsuspend(&nosigs);        /* Wait for a signal to wake us up */
 
-    block_timer();
+    block_sigs();
 
     /*
      * Call handlers for signals delivered to the process during sigsuspend().
@@ -187,6 +190,9 @@ sim_tick_idle(os_time_t ticks)
     if (sigismember(&suspsigs, SIGALRM)) {
         sim_tick();
     }
+    if (sigismember(&suspsigs, SIGIO)) {
+        sim_io_irq();
+    }
 
     if (ticks > 0) {
         /*
@@ -204,23 +210,26 @@ sim_tick_idle(os_time_t ticks)
 void
 sim_signals_init(void)
 {
-    sigset_t sigset_alrm;
+    sigset_t sigset_idle;
     struct sigaction sa;
     int error;
 
-    block_timer();
+    block_sigs();
 
     sigemptyset(&nosigs);
 
-    sigemptyset(&sigset_alrm);
-    sigaddset(&sigset_alrm, SIGALRM);
+    sigemptyset(&sigset_idle);
+    sigaddset(&sigset_idle, SIGALRM);
+    sigaddset(&sigset_idle, SIGIO);
 
     memset(&sa, 0, sizeof sa);
-    sa.sa_handler = sig_handler_alrm;
-    sa.sa_mask = sigset_alrm;
+    sa.sa_handler = sig_handler_idle;
+    sa.sa_mask = sigset_idle;
     sa.sa_flags = SA_RESTART;
     error = sigaction(SIGALRM, &sa, NULL);
     assert(error == 0);
+    error = sigaction(SIGIO, &sa, NULL);
+    assert(error == 0);
 }
 
 void
@@ -233,6 +242,11 @@ sim_signals_cleanup(void)
     sa.sa_handler = SIG_DFL;
     error = sigaction(SIGALRM, &sa, NULL);
     assert(error == 0);
+
+    /* Descriptors may still be set up to raise SIGIO. */
+    sa.sa_handler = SIG_IGN;
+    error = sigaction(SIGIO, &sa, NULL);
+    assert(error == 0);
 }
 
 #endif /* !MYNEWT_VAL(MCU_NATIVE_USE_SIGNALS) */
@@ -152,12 +152,25 @@ timer_handler(int sig)
     }
 }
 
+static void
+io_handler(int sig)
+{
+    OS_ASSERT_CRITICAL();
+
+    if (suspended) {
+        sigaddset(&suspsigs, sig);
+    } else {
+        sim_io_irq();
+    }
+}
+
 static struct {
     int num;
     void (*handler)(int sig);
 } signals[] = {
     { SIGALRM, timer_handler },
     { SIGURG, ctxsw_handler },
+    { SIGIO, io_handler },
 };
 
 #define NUMSIGS     (sizeof(signals)/sizeof(signals[0]))
@@ -255,7 +268,12 @@ sim_signals_cleanup(void)
 
     for (i = 0; i < NUMSIGS; i++) {
         memset(&sa, 0, sizeof sa);
-        sa.sa_handler = SIG_DFL;
+        if (signals[i].num == SIGIO) {
+            /* Descriptors may still be set up to raise it. */
+            sa.sa_handler = SIG_IGN;
+        } else {
+            sa.sa_handler = SIG_DFL;
+        }
         error = sigaction(signals[i].num, &sa, NULL);
         assert(error == 0);
     }
@@ -35,7 +35,9 @@
 #include "imgmgr/imgmgr.h"
 #include "imgmgr_priv.h"
 
+#if !MYNEWT_VAL(IMGMGR_UPLOAD_WINDOW)
 static int imgr_upload(struct mgmt_cbuf *);
+#endif
 static int imgr_erase(struct mgmt_cbuf *);
 static int imgr_erase_state(struct mgmt_cbuf *);
 
@@ -46,7 +48,11 @@ static const struct mgmt_handler imgr_nmgr_handlers[] = {
     },
     [IMGMGR_NMGR_ID_UPLOAD] = {
         .mh_read = NULL,
+#if MYNEWT_VAL(IMGMGR_UPLOAD_WINDOW)
+        .mh_write = imgr_upload_win
+#else
         .mh_write = imgr_upload
+#endif
     },
     [IMGMGR_NMGR_ID_ERASE] = {
         .mh_read = NULL,
@@ -403,6 +409,61 @@ imgr_erase_state(struct mgmt_cbuf *cb)
     return 0;
 }
 
+/*
+ * Starts a new upload of an image of the given size: picks the slot to
+ * upload to, and makes sure it is erased.
+ */
+int
+imgr_upload_start(uint32_t size)
+{
+    int area_id;
+    int rc;
+    bool empty = false;
+
+    imgr_state.upload.off = 0;
+    imgr_state.upload.size = size;
+
+    area_id = imgmgr_find_best_area_id();
+    if (area_id >= 0) {
+        if (imgr_state.upload.fa) {
+            flash_area_close(imgr_state.upload.fa);
+            imgr_state.upload.fa = NULL;
+        }
+        rc = flash_area_open(area_id, &imgr_state.upload.fa);
+        if (rc) {
+            return MGMT_ERR_EINVAL;
+        }
+
+        rc = flash_area_is_empty(imgr_state.upload.fa, &empty);
+        if (rc) {
+            return MGMT_ERR_EINVAL;
+        }
+
+#if MYNEWT_VAL(LOG_FCB_SLOT1)
+        /*
+         * If logging to slot1 is enabled, make sure it's locked before
+         * erasing so log handler does not corrupt our data.
+         */
+        if (area_id == FLASH_AREA_IMAGE_1) {
+            log_fcb_slot1_lock();
+        }
+#endif
+
+        if(!empty) {
+            rc = flash_area_erase(imgr_state.upload.fa, 0,
+              imgr_state.upload.fa->fa_size);
+        }
+    } else {
+        /*
+         * No slot where to upload!
+         */
+        return MGMT_ERR_ENOMEM;
+    }
+
+    return 0;
+}
+
+#if !MYNEWT_VAL(IMGMGR_UPLOAD_WINDOW)
 static int
 imgr_upload(struct mgmt_cbuf *cb)
 {
@@ -434,9 +495,7 @@ imgr_upload(struct mgmt_cbuf *cb)
         [3] = { 0 },
     };
     struct image_header *hdr;
-    int area_id;
     int rc;
-    bool empty = false;
     CborError g_err = CborNoError;
 
     rc = cbor_read_object(&cb->it, off_attr);
@@ -459,44 +518,9 @@ imgr_upload(struct mgmt_cbuf *cb)
         /*
          * New upload.
          */
-        imgr_state.upload.off = 0;
-        imgr_state.upload.size = size;
-
-        area_id = imgmgr_find_best_area_id();
-        if (area_id >= 0) {
-            if (imgr_state.upload.fa) {
-                flash_area_close(imgr_state.upload.fa);
-                imgr_state.upload.fa = NULL;
-            }
-            rc = flash_area_open(area_id, &imgr_state.upload.fa);
-            if (rc) {
-                return MGMT_ERR_EINVAL;
-            }
-
-            rc = flash_area_is_empty(imgr_state.upload.fa, &empty);
-            if (rc) {
-                return MGMT_ERR_EINVAL;
-            }
-
-#if MYNEWT_VAL(LOG_FCB_SLOT1)
-            /*
-             * If logging to slot1 is enabled, make sure it's locked before
-             * erasing so log handler does not corrupt our data.
-             */
-            if (area_id == FLASH_AREA_IMAGE_1) {
-                log_fcb_slot1_lock();
-            }
-#endif
-
-            if(!empty) {
-                rc = flash_area_erase(imgr_state.upload.fa, 0,
-                  imgr_state.upload.fa->fa_size);
-            }
-        } else {
-            /*
-             * No slot where to upload!
-             */
-            return MGMT_ERR_ENOMEM;
+        rc = imgr_upload_start(size);
+        if (rc) {
+            return rc;
         }
     } else if (off != imgr_state.upload.off) {
         /*
@@ -548,6 +572,7 @@ err_close:
     imgr_state.upload.fa = NULL;
     return rc;
 }
+#endif
 
 void
 imgmgr_module_init(void)
@@ -560,6 +585,11 @@ imgmgr_module_init(void)
     rc = mgmt_group_register(&imgr_nmgr_group);
     SYSINIT_PANIC_ASSERT(rc == 0);
 
+#if MYNEWT_VAL(IMGMGR_UPLOAD_WINDOW)
+    rc = imgr_upload_win_init();
+    SYSINIT_PANIC_ASSERT(rc == 0);
+#endif
+
 #if MYNEWT_VAL(IMGMGR_CLI)
     rc = imgr_cli_register();
     SYSINIT_PANIC_ASSERT(rc == 0);
@@ -22,6 +22,9 @@
 
 #include <stdint.h>
 #include "os/mynewt.h"
+#if MYNEWT_VAL(IMGMGR_UPLOAD_WINDOW)
+#include "stats/stats.h"
+#endif
 
 #ifdef __cplusplus
 extern "C" {
@@ -73,6 +76,10 @@ struct imgmgr_upload_cmd {
  *      "off":<offset>
  * }
  *
+ * With IMGMGR_UPLOAD_WINDOW, <offset> in the response is the end of the
+ * data received in order so far.  Up to IMGMGR_UPLOAD_WINDOW chunks past it
+ * may be sent without waiting for their responses, in any order.
+ *
  *
  * Request to image upload:
  * {
@@ -98,6 +105,22 @@ struct imgr_state {
 
 extern struct imgr_state imgr_state;
 
+#if MYNEWT_VAL(IMGMGR_UPLOAD_WINDOW)
+STATS_SECT_START(imgr_upload_stats)
+    STATS_SECT_ENTRY(chunks)
+    STATS_SECT_ENTRY(chunks_ooo)
+    STATS_SECT_ENTRY(chunks_dropped)
+    STATS_SECT_ENTRY(bytes)
+    STATS_SECT_ENTRY(chunk_lat_us)
+    /* Set, not counted: how long the last finished upload took, */
+    STATS_SECT_ENTRY(upload_us)
+    /* and the longest a chunk of it took to get to flash. */
+    STATS_SECT_ENTRY(chunk_lat_max_us)
+STATS_SECT_END
+
+extern STATS_SECT_DECL(imgr_upload_stats) imgr_upload_stats;
+#endif
+
 struct nmgr_jbuf;
 
 int imgr_core_list(struct mgmt_cbuf *);
@@ -108,6 +131,11 @@ int imgmgr_state_write(struct mgmt_cbuf *njb);
 int imgr_find_by_ver(struct image_version *find, uint8_t *hash);
 int imgr_find_by_hash(uint8_t *find, struct image_version *ver);
 int imgr_cli_register(void);
+int imgr_upload_start(uint32_t size);
+#if MYNEWT_VAL(IMGMGR_UPLOAD_WINDOW)
+int imgr_upload_win(struct mgmt_cbuf *cb);
+int imgr_upload_win_init(void);
+#endif
 
 #ifdef __cplusplus
 }
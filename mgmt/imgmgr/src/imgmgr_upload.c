@@ -0,0 +1,481 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "os/mynewt.h"
+
+#if MYNEWT_VAL(IMGMGR_UPLOAD_WINDOW)
+
+#include <limits.h>
+#include <string.h>
+
+#include "flash_map/flash_map.h"
+#include "cborattr/cborattr.h"
+#include "bootutil/image.h"
+#include "mgmt/mgmt.h"
+
+#include "imgmgr/imgmgr.h"
+#include "imgmgr_priv.h"
+
+/*
+ * Windowed image upload.  Chunks are received into a pool of
+ * IMGMGR_UPLOAD_WINDOW buffers.  Once a chunk is in order it is handed to the
+ * upload task, which writes it to flash while newtmgr goes on receiving the
+ * next ones.  Chunks ahead of the data received so far are held until the
+ * gap before them is filled.
+ */
+#define IMGR_UPLOAD_WINDOW      MYNEWT_VAL(IMGMGR_UPLOAD_WINDOW)
+
+/* How long a request waits for the upload task to free a buffer. */
+#define IMGR_UPLOAD_WAIT_MS     1000
+
+struct imgr_chunk {
+    STAILQ_ENTRY(imgr_chunk) ic_next;
+    uint32_t ic_off;
+    uint32_t ic_len;
+    uint32_t ic_rx_usec;
+    uint8_t ic_data[MYNEWT_VAL(IMGMGR_MAX_CHUNK_SIZE)];
+};
+
+STAILQ_HEAD(imgr_chunk_list, imgr_chunk);
+
+static struct imgr_chunk imgr_chunks[IMGR_UPLOAD_WINDOW];
+
+/* Free buffers, counted by imgr_chunk_sem. */
+static struct imgr_chunk_list imgr_chunk_free;
+/* Chunks waiting for the upload task. */
+static struct imgr_chunk_list imgr_chunk_wr;
+/* Chunks received out of order, sorted by offset; newtmgr task only. */
+static struct imgr_chunk_list imgr_chunk_held;
+static struct os_sem imgr_chunk_sem;
+
+static struct {
+    /* End of the data received in order. */
+    uint32_t rx_off;
+    uint32_t start_usec;
+    /* Longest chunk latency in this upload; upload task only. */
+    uint32_t lat_max_us;
+    /* Set by the upload task if writing a chunk failed. */
+    int wr_err;
+} imgr_win;
+
+static struct os_eventq imgr_upload_evq;
+static struct os_task imgr_upload_task;
+static os_stack_t imgr_upload_stack[MYNEWT_VAL(IMGMGR_UPLOAD_STACK_SIZE)];
+
+static void imgr_upload_write_ev(struct os_event *ev);
+
+static struct os_event imgr_upload_ev = {
+    .ev_cb = imgr_upload_write_ev,
+};
+
+STATS_SECT_DECL(imgr_upload_stats) imgr_upload_stats;
+
+STATS_NAME_START(imgr_upload_stats)
+    STATS_NAME(imgr_upload_stats, chunks)
+    STATS_NAME(imgr_upload_stats, chunks_ooo)
+    STATS_NAME(imgr_upload_stats, chunks_dropped)
+    STATS_NAME(imgr_upload_stats, bytes)
+    STATS_NAME(imgr_upload_stats, chunk_lat_us)
+    STATS_NAME(imgr_upload_stats, upload_us)
+    STATS_NAME(imgr_upload_stats, chunk_lat_max_us)
+STATS_NAME_END(imgr_upload_stats)
+
+static void
+imgr_chunk_put(struct imgr_chunk *c)
+{
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+    STAILQ_INSERT_HEAD(&imgr_chunk_free, c, ic_next);
+    OS_EXIT_CRITICAL(sr);
+    os_sem_release(&imgr_chunk_sem);
+}
+
+/*
+ * Gets a buffer for an incoming chunk.  If all of them are taken, and some
+ * hold chunks received out of order, the one furthest ahead is given up;
+ * the client sends it again later.  Otherwise waits for the upload task to
+ * finish writing one.
+ */
+static struct imgr_chunk *
+imgr_chunk_get(void)
+{
+    struct imgr_chunk *c;
+    os_sr_t sr;
+    int rc;
+
+    rc = os_sem_pend(&imgr_chunk_sem, 0);
+    if (rc != 0 && !STAILQ_EMPTY(&imgr_chunk_held)) {
+        c = STAILQ_LAST(&imgr_chunk_held, imgr_chunk, ic_next);
+        STAILQ_REMOVE(&imgr_chunk_held, c, imgr_chunk, ic_next);
+        STATS_INC(imgr_upload_stats, chunks_dropped);
+        return c;
+    }
+    if (rc != 0) {
+        rc = os_sem_pend(&imgr_chunk_sem,
+                         os_time_ms_to_ticks32(IMGR_UPLOAD_WAIT_MS));
+        if (rc != 0) {
+            return NULL;
+        }
+    }
+
+    OS_ENTER_CRITICAL(sr);
+    c = STAILQ_FIRST(&imgr_chunk_free);
+    STAILQ_REMOVE_HEAD(&imgr_chunk_free, ic_next);
+    OS_EXIT_CRITICAL(sr);
+
+    return c;
+}
+
+static void
+imgr_chunk_write(struct imgr_chunk *c)
+{
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+    STAILQ_INSERT_TAIL(&imgr_chunk_wr, c, ic_next);
+    OS_EXIT_CRITICAL(sr);
+    os_eventq_put(&imgr_upload_evq, &imgr_upload_ev);
+}
+
+static void
+imgr_chunk_hold(struct imgr_chunk *c)
+{
+    struct imgr_chunk *cur;
+    struct imgr_chunk *prev;
+
+    prev = NULL;
+    STAILQ_FOREACH(cur, &imgr_chunk_held, ic_next) {
+        if (cur->ic_off > c->ic_off) {
+            break;
+        }
+        prev = cur;
+    }
+    if (prev) {
+        STAILQ_INSERT_AFTER(&imgr_chunk_held, prev, c, ic_next);
+    } else {
+        STAILQ_INSERT_HEAD(&imgr_chunk_held, c, ic_next);
+    }
+}
+
+/*
+ * Passes held chunks which are now in order to the upload task.  Ones that
+ * start before the end of the data received, because an earlier chunk was
+ * cut to flash alignment, are dropped.
+ */
+static void
+imgr_chunk_release_held(void)
+{
+    struct imgr_chunk *c;
+
+    while ((c = STAILQ_FIRST(&imgr_chunk_held)) != NULL) {
+        if (c->ic_off > imgr_win.rx_off) {
+            break;
+        }
+        STAILQ_REMOVE_HEAD(&imgr_chunk_held, ic_next);
+        if (c->ic_off == imgr_win.rx_off) {
+            imgr_win.rx_off += c->ic_len;
+            imgr_chunk_write(c);
+        } else {
+            STATS_INC(imgr_upload_stats, chunks_dropped);
+            imgr_chunk_put(c);
+        }
+    }
+}
+
+static void
+imgr_chunk_drop_held(void)
+{
+    struct imgr_chunk *c;
+
+    while ((c = STAILQ_FIRST(&imgr_chunk_held)) != NULL) {
+        STAILQ_REMOVE_HEAD(&imgr_chunk_held, ic_next);
+        imgr_chunk_put(c);
+    }
+}
+
+/*
+ * Waits until the upload task has written everything passed to it.  The
+ * caller owns 'own' buffers, and none are held.
+ */
+static void
+imgr_upload_drain(int own)
+{
+    int i;
+
+    for (i = 0; i < IMGR_UPLOAD_WINDOW - own; i++) {
+        os_sem_pend(&imgr_chunk_sem, OS_TIMEOUT_NEVER);
+    }
+    for (i = 0; i < IMGR_UPLOAD_WINDOW - own; i++) {
+        os_sem_release(&imgr_chunk_sem);
+    }
+}
+
+static void
+imgr_upload_close(void)
+{
+    imgr_chunk_drop_held();
+    imgr_upload_drain(0);
+    if (imgr_state.upload.fa) {
+        flash_area_close(imgr_state.upload.fa);
+        imgr_state.upload.fa = NULL;
+    }
+}
+
+static void
+imgr_upload_write_ev(struct os_event *ev)
+{
+    struct imgr_chunk *c;
+    uint32_t usecs;
+    os_sr_t sr;
+    int rc;
+
+    while (1) {
+        OS_ENTER_CRITICAL(sr);
+        c = STAILQ_FIRST(&imgr_chunk_wr);
+        if (c) {
+            STAILQ_REMOVE_HEAD(&imgr_chunk_wr, ic_next);
+        }
+        OS_EXIT_CRITICAL(sr);
+        if (!c) {
+            break;
+        }
+
+        if (!imgr_win.wr_err) {
+            rc = flash_area_write(imgr_state.upload.fa, c->ic_off, c->ic_data,
+                                  c->ic_len);
+            if (rc) {
+                imgr_win.wr_err = MGMT_ERR_EINVAL;
+            } else {
+                imgr_state.upload.off = c->ic_off + c->ic_len;
+                STATS_INCN(imgr_upload_stats, bytes, c->ic_len);
+            }
+        }
+
+        usecs = (uint32_t)os_get_uptime_usec() - c->ic_rx_usec;
+        STATS_INCN(imgr_upload_stats, chunk_lat_us, usecs);
+        if (usecs > imgr_win.lat_max_us) {
+            imgr_win.lat_max_us = usecs;
+            STATS_SET(imgr_upload_stats, chunk_lat_max_us, usecs);
+        }
+
+        imgr_chunk_put(c);
+    }
+}
+
+static void
+imgr_upload_task_handler(void *arg)
+{
+    while (1) {
+        os_eventq_run(&imgr_upload_evq);
+    }
+}
+
+int
+imgr_upload_win(struct mgmt_cbuf *cb)
+{
+    struct imgr_chunk *c;
+    struct imgr_chunk *cur;
+    long long unsigned int off = UINT_MAX;
+    long long unsigned int size = UINT_MAX;
+    size_t data_len = 0;
+    struct cbor_attr_t off_attr[4] = {
+        [0] = {
+            .attribute = "data",
+            .type = CborAttrByteStringType,
+            .addr.bytestring.len = &data_len,
+            .len = MYNEWT_VAL(IMGMGR_MAX_CHUNK_SIZE)
+        },
+        [1] = {
+            .attribute = "len",
+            .type = CborAttrUnsignedIntegerType,
+            .addr.uinteger = &size,
+            .nodefault = true
+        },
+        [2] = {
+            .attribute = "off",
+            .type = CborAttrUnsignedIntegerType,
+            .addr.uinteger = &off,
+            .nodefault = true
+        },
+        [3] = { 0 },
+    };
+    struct image_header *hdr;
+    int rc;
+    CborError g_err = CborNoError;
+
+    c = imgr_chunk_get();
+    if (!c) {
+        return MGMT_ERR_ETIMEOUT;
+    }
+    off_attr[0].addr.bytestring.data = c->ic_data;
+
+    rc = cbor_read_object(&cb->it, off_attr);
+    if (rc || off == UINT_MAX) {
+        rc = MGMT_ERR_EINVAL;
+        goto err;
+    }
+
+    if (off == 0) {
+        if (data_len < sizeof(struct image_header)) {
+            /*
+             * Image header is the first thing in the image.
+             */
+            rc = MGMT_ERR_EINVAL;
+            goto err;
+        }
+        hdr = (struct image_header *)c->ic_data;
+        if (hdr->ih_magic != IMAGE_MAGIC) {
+            rc = MGMT_ERR_EINVAL;
+            goto err;
+        }
+
+        /*
+         * New upload.  Whatever is left of the previous one has to be
+         * written before its slot can be reused.
+         */
+        imgr_chunk_drop_held();
+        imgr_upload_drain(1);
+        rc = imgr_upload_start(size);
+        if (rc) {
+            goto err;
+        }
+        imgr_win.rx_off = 0;
+        imgr_win.wr_err = 0;
+        imgr_win.lat_max_us = 0;
+        STATS_CLEAR(imgr_upload_stats, chunk_lat_max_us);
+        imgr_win.start_usec = os_get_uptime_usec();
+    }
+
+    if (!imgr_state.upload.fa) {
+        /*
+         * Either overtook the first chunk of an upload, or was still in
+         * flight when the previous one finished.  Ask for data from the
+         * start.
+         */
+        imgr_win.rx_off = 0;
+        goto drop;
+    }
+    if (imgr_win.wr_err) {
+        rc = imgr_win.wr_err;
+        imgr_chunk_put(c);
+        imgr_upload_close();
+        return rc;
+    }
+
+    if (data_len && off + data_len < imgr_state.upload.size) {
+        /*
+         * Respect flash write alignment if not in the last block
+         */
+        data_len -= data_len % flash_area_align(imgr_state.upload.fa);
+    }
+
+    /*
+     * Drop chunks already received, or too far ahead to be held.  The
+     * response has the offset we're expecting data for.
+     */
+    if (data_len == 0 || off < imgr_win.rx_off ||
+        off >= imgr_win.rx_off +
+               IMGR_UPLOAD_WINDOW * MYNEWT_VAL(IMGMGR_MAX_CHUNK_SIZE)) {
+        goto drop;
+    }
+    STAILQ_FOREACH(cur, &imgr_chunk_held, ic_next) {
+        if (cur->ic_off == off) {
+            goto drop;
+        }
+    }
+
+    c->ic_off = off;
+    c->ic_len = data_len;
+    c->ic_rx_usec = os_get_uptime_usec();
+    STATS_INC(imgr_upload_stats, chunks);
+
+    if (off == imgr_win.rx_off) {
+        imgr_win.rx_off += data_len;
+        imgr_chunk_write(c);
+        imgr_chunk_release_held();
+    } else {
+        STATS_INC(imgr_upload_stats, chunks_ooo);
+        imgr_chunk_hold(c);
+    }
+
+    if (imgr_win.rx_off >= imgr_state.upload.size) {
+        /* Done, once the upload task catches up */
+        imgr_upload_close();
+        if (imgr_win.wr_err) {
+            return imgr_win.wr_err;
+        }
+
+        STATS_SET(imgr_upload_stats, upload_us,
+                  (uint32_t)os_get_uptime_usec() - imgr_win.start_usec);
+    }
+    goto out;
+
+drop:
+    STATS_INC(imgr_upload_stats, chunks_dropped);
+    imgr_chunk_put(c);
+out:
+    g_err |= cbor_encode_text_stringz(&cb->encoder, "rc");
+    g_err |= cbor_encode_int(&cb->encoder, MGMT_ERR_EOK);
+    g_err |= cbor_encode_text_stringz(&cb->encoder, "off");
+    g_err |= cbor_encode_int(&cb->encoder, imgr_win.rx_off);
+
+    if (g_err) {
+        return MGMT_ERR_ENOMEM;
+    }
+    return 0;
+err:
+    imgr_chunk_put(c);
+    return rc;
+}
+
+int
+imgr_upload_win_init(void)
+{
+    int rc;
+    int i;
+
+    STAILQ_INIT(&imgr_chunk_free);
+    STAILQ_INIT(&imgr_chunk_wr);
+    STAILQ_INIT(&imgr_chunk_held);
+    for (i = 0; i < IMGR_UPLOAD_WINDOW; i++) {
+        STAILQ_INSERT_TAIL(&imgr_chunk_free, &imgr_chunks[i], ic_next);
+    }
+    rc = os_sem_init(&imgr_chunk_sem, IMGR_UPLOAD_WINDOW);
+    if (rc) {
+        return rc;
+    }
+
+    rc = stats_init_and_reg(
+                    STATS_HDR(imgr_upload_stats),
+                    STATS_SIZE_INIT_PARMS(imgr_upload_stats, STATS_SIZE_32),
+                    STATS_NAME_INIT_PARMS(imgr_upload_stats),
+                    "imgmgr_upload");
+    if (rc) {
+        return rc;
+    }
+
+    os_eventq_init(&imgr_upload_evq);
+    return os_task_init(&imgr_upload_task, "imgmgr", imgr_upload_task_handler,
+                        NULL, MYNEWT_VAL(IMGMGR_UPLOAD_PRIO), OS_WAIT_FOREVER,
+                        imgr_upload_stack,
+                        MYNEWT_VAL(IMGMGR_UPLOAD_STACK_SIZE));
+}
+
+#endif /* MYNEWT_VAL(IMGMGR_UPLOAD_WINDOW) */
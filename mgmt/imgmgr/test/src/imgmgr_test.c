@@ -0,0 +1,153 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include <string.h>
+
+#include "os/mynewt.h"
+#include "testutil/testutil.h"
+#include "bootutil/image.h"
+#include "tinycbor/cbor.h"
+#include "tinycbor/cbor_buf_reader.h"
+#include "tinycbor/cbor_buf_writer.h"
+#include "imgmgr_test.h"
+
+static uint8_t imgmgr_test_img[IMGMGR_TEST_IMG_MAX];
+const struct flash_area *imgmgr_test_fa;
+
+/*
+ * Sends one upload request, and returns the offset in the response.  The
+ * first chunk of an image also carries its size.
+ */
+void
+imgmgr_test_send(uint32_t off, uint32_t len, uint32_t size,
+                 uint32_t *rsp_off)
+{
+    uint8_t req[MYNEWT_VAL(IMGMGR_MAX_CHUNK_SIZE) + 32];
+    uint8_t rsp[32];
+    struct cbor_buf_writer req_writer;
+    struct cbor_buf_writer rsp_writer;
+    struct cbor_buf_reader reader;
+    struct mgmt_cbuf cb;
+    CborEncoder enc;
+    CborEncoder map;
+    CborParser parser;
+    CborValue root;
+    CborValue val;
+    uint64_t u;
+    int rc;
+
+    cbor_buf_writer_init(&req_writer, req, sizeof(req));
+    cbor_encoder_init(&enc, &req_writer.enc, 0);
+    rc = cbor_encoder_create_map(&enc, &map, CborIndefiniteLength);
+    rc |= cbor_encode_text_stringz(&map, "off");
+    rc |= cbor_encode_uint(&map, off);
+    if (off == 0) {
+        rc |= cbor_encode_text_stringz(&map, "len");
+        rc |= cbor_encode_uint(&map, size);
+    }
+    rc |= cbor_encode_text_stringz(&map, "data");
+    rc |= cbor_encode_byte_string(&map, imgmgr_test_img + off, len);
+    rc |= cbor_encoder_close_container(&enc, &map);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    cbor_buf_reader_init(&reader, req, req_writer.ptr - req);
+    cbor_parser_init(&reader.r, 0, &cb.parser, &cb.it);
+    cbor_buf_writer_init(&rsp_writer, rsp, sizeof(rsp));
+    cbor_encoder_init(&cb.encoder, &rsp_writer.enc, 0);
+    rc = cbor_encoder_create_map(&cb.encoder, &map, CborIndefiniteLength);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    rc = imgr_upload_win(&cb);
+    TEST_ASSERT_FATAL(rc == 0, "upload of %u failed: %d",
+                      (unsigned)off, rc);
+    rc = cbor_encoder_close_container(&cb.encoder, &map);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    if (off == 0) {
+        imgmgr_test_fa = imgr_state.upload.fa;
+        TEST_ASSERT_FATAL(imgmgr_test_fa != NULL);
+    }
+
+    cbor_buf_reader_init(&reader, rsp, rsp_writer.ptr - rsp);
+    rc = cbor_parser_init(&reader.r, 0, &parser, &root);
+    rc |= cbor_value_map_find_value(&root, "off", &val);
+    rc |= cbor_value_get_uint64(&val, &u);
+    TEST_ASSERT_FATAL(rc == 0);
+    *rsp_off = u;
+}
+
+/*
+ * Checks that the upload is complete and in flash, then erases the slot
+ * again so the next upload picks the same one.
+ */
+void
+imgmgr_test_check_flash(uint32_t size)
+{
+    uint8_t buf[IMGMGR_TEST_CHUNK];
+    uint32_t off;
+    int rc;
+
+    TEST_ASSERT(imgr_state.upload.fa == NULL);
+    TEST_ASSERT(imgr_state.upload.off == size);
+
+    for (off = 0; off < size; off += sizeof(buf)) {
+        rc = flash_area_read(imgmgr_test_fa, off, buf, sizeof(buf));
+        TEST_ASSERT_FATAL(rc == 0);
+        TEST_ASSERT(memcmp(buf, imgmgr_test_img + off, sizeof(buf)) == 0,
+                    "mismatch at %u", (unsigned)off);
+    }
+
+    rc = flash_area_erase(imgmgr_test_fa, 0, imgmgr_test_fa->fa_size);
+    TEST_ASSERT_FATAL(rc == 0);
+}
+
+static void
+imgmgr_test_init_img(void)
+{
+    struct image_header *hdr;
+    int i;
+
+    for (i = 0; i < sizeof(imgmgr_test_img); i++) {
+        imgmgr_test_img[i] = i * 7 + (i >> 8);
+    }
+    hdr = (struct image_header *)imgmgr_test_img;
+    hdr->ih_magic = IMAGE_MAGIC;
+}
+
+TEST_CASE_DECL(imgmgr_upload_tests)
+
+TEST_SUITE(imgmgr_test_all)
+{
+    imgmgr_test_init_img();
+
+    imgmgr_upload_tests();
+}
+
+#if MYNEWT_VAL(SELFTEST)
+
+int
+main(int argc, char **argv)
+{
+    sysinit();
+
+    imgmgr_test_all();
+
+    return tu_any_failed;
+}
+
+#endif
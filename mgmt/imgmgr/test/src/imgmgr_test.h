@@ -0,0 +1,53 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#ifndef _IMGMGR_TEST_H
+#define _IMGMGR_TEST_H
+
+#include "os/mynewt.h"
+#include "testutil/testutil.h"
+#include "flash_map/flash_map.h"
+#include "imgmgr/imgmgr.h"
+#include "imgmgr_priv.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Size of the chunks the tests send; the window is 8 of them. */
+#define IMGMGR_TEST_CHUNK       64
+#define IMGMGR_TEST_WIN_BYTES   (MYNEWT_VAL(IMGMGR_UPLOAD_WINDOW) *     \
+                                 MYNEWT_VAL(IMGMGR_MAX_CHUNK_SIZE))
+#define IMGMGR_TEST_IMG_MAX     1024
+
+/* Slot the current upload goes to; set by the first chunk. */
+extern const struct flash_area *imgmgr_test_fa;
+
+void imgmgr_test_send(uint32_t off, uint32_t len, uint32_t size,
+                      uint32_t *rsp_off);
+void imgmgr_test_check_flash(uint32_t size);
+
+void test_upload_ooo(void);
+void test_upload_overflow(void);
+void test_upload_drain(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _IMGMGR_TEST_H */
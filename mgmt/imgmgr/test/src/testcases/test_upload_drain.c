@@ -0,0 +1,54 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "imgmgr_test.h"
+
+#define C   IMGMGR_TEST_CHUNK
+
+/*
+ * The upload task runs below the test task here, so nothing is written
+ * until the last chunk arrives.  Its response is only sent once all of the
+ * image is in flash, and the slot is closed.
+ */
+void
+test_upload_drain(void)
+{
+    uint32_t bytes;
+    uint32_t off;
+
+    bytes = imgr_upload_stats.sbytes;
+    imgr_upload_stats.supload_us = UINT32_MAX;
+    imgr_upload_stats.schunk_lat_max_us = UINT32_MAX;
+
+    imgmgr_test_send(0, C, 4 * C, &off);
+    imgmgr_test_send(2 * C, C, 4 * C, &off);
+    imgmgr_test_send(C, C, 4 * C, &off);
+    TEST_ASSERT(off == 3 * C);
+    TEST_ASSERT(imgr_state.upload.fa != NULL);
+    TEST_ASSERT(imgr_state.upload.off == 0);
+    TEST_ASSERT(imgr_upload_stats.sbytes == bytes);
+    TEST_ASSERT(imgr_upload_stats.supload_us == UINT32_MAX);
+    TEST_ASSERT(imgr_upload_stats.schunk_lat_max_us == 0);
+
+    imgmgr_test_send(3 * C, C, 4 * C, &off);
+    TEST_ASSERT(off == 4 * C);
+    TEST_ASSERT(imgr_upload_stats.sbytes - bytes == 4 * C);
+    TEST_ASSERT(imgr_upload_stats.schunk_lat_max_us <=
+                imgr_upload_stats.supload_us);
+    imgmgr_test_check_flash(4 * C);
+}
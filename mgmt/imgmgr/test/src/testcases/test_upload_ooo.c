@@ -0,0 +1,59 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "imgmgr_test.h"
+
+#define C   IMGMGR_TEST_CHUNK
+
+/*
+ * Chunks which arrive ahead of the data received so far are held until the
+ * gap before them is filled; the response always has the end of the data
+ * received in order.
+ */
+void
+test_upload_ooo(void)
+{
+    uint32_t ooo;
+    uint32_t off;
+
+    ooo = imgr_upload_stats.schunks_ooo;
+
+    imgmgr_test_send(0, C, 8 * C, &off);
+    TEST_ASSERT(off == C);
+
+    imgmgr_test_send(3 * C, C, 8 * C, &off);
+    TEST_ASSERT(off == C);
+    imgmgr_test_send(2 * C, C, 8 * C, &off);
+    TEST_ASSERT(off == C);
+    imgmgr_test_send(C, C, 8 * C, &off);
+    TEST_ASSERT(off == 4 * C);
+
+    /* All buffers are queued for writing; this one waits for a free one. */
+    imgmgr_test_send(4 * C, C, 8 * C, &off);
+    TEST_ASSERT(off == 5 * C);
+
+    imgmgr_test_send(7 * C, C, 8 * C, &off);
+    TEST_ASSERT(off == 5 * C);
+    imgmgr_test_send(5 * C, C, 8 * C, &off);
+    TEST_ASSERT(off == 6 * C);
+    imgmgr_test_send(6 * C, C, 8 * C, &off);
+    TEST_ASSERT(off == 8 * C);
+
+    TEST_ASSERT(imgr_upload_stats.schunks_ooo - ooo == 3);
+    imgmgr_test_check_flash(8 * C);
+}
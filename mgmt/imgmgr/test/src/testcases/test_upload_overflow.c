@@ -0,0 +1,76 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "imgmgr_test.h"
+
+#define C   IMGMGR_TEST_CHUNK
+
+/*
+ * Chunks already received, duplicates of held ones, and ones past the
+ * window are dropped.  When every buffer is taken, held chunks are given up
+ * starting from the one furthest ahead, and the client sends them again.
+ */
+void
+test_upload_overflow(void)
+{
+    uint32_t dropped;
+    uint32_t size;
+    uint32_t off;
+
+    dropped = imgr_upload_stats.schunks_dropped;
+    size = 16 * C;
+
+    imgmgr_test_send(0, C, size, &off);
+    TEST_ASSERT(off == C);
+
+    imgmgr_test_send(2 * C, C, size, &off);
+    TEST_ASSERT(off == C);
+    imgmgr_test_send(2 * C, C, size, &off);
+    TEST_ASSERT(off == C);
+    TEST_ASSERT(imgr_upload_stats.schunks_dropped - dropped == 1);
+
+    /* Just past the window. */
+    imgmgr_test_send(C + IMGMGR_TEST_WIN_BYTES, C, size, &off);
+    TEST_ASSERT(off == C);
+    TEST_ASSERT(imgr_upload_stats.schunks_dropped - dropped == 2);
+
+    /*
+     * First chunk is still queued, and three are held.  The fourth held
+     * one pushes out the furthest, and so does the chunk filling the gap.
+     */
+    imgmgr_test_send(3 * C, C, size, &off);
+    imgmgr_test_send(4 * C, C, size, &off);
+    TEST_ASSERT(imgr_upload_stats.schunks_dropped - dropped == 2);
+    imgmgr_test_send(5 * C, C, size, &off);
+    TEST_ASSERT(off == C);
+    TEST_ASSERT(imgr_upload_stats.schunks_dropped - dropped == 3);
+    imgmgr_test_send(C, C, size, &off);
+    TEST_ASSERT(off == 4 * C);
+    TEST_ASSERT(imgr_upload_stats.schunks_dropped - dropped == 4);
+
+    /* Already received. */
+    imgmgr_test_send(2 * C, C, size, &off);
+    TEST_ASSERT(off == 4 * C);
+    TEST_ASSERT(imgr_upload_stats.schunks_dropped - dropped == 5);
+
+    for (off = 4 * C; off < size; ) {
+        imgmgr_test_send(off, C, size, &off);
+    }
+    TEST_ASSERT(off == size);
+    imgmgr_test_check_flash(size);
+}
@@ -68,6 +68,15 @@ extern "C" {
 
 #define NMGR_HDR_SIZE           (8)
 
+/*
+ * Header flags.  A client sets NMGR_F_STREAM in a read request to say it
+ * accepts the response as several messages.  Every part of such a response
+ * has NMGR_F_STREAM set; all but the last one also have NMGR_F_MORE.  A
+ * failure part way through ends the stream with a plain error response.
+ */
+#define NMGR_F_STREAM           (0x01)
+#define NMGR_F_MORE             (0x02)
+
 struct nmgr_hdr {
 #if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
     uint8_t  nh_op:3;           /* NMGR_OP_XXX */
@@ -77,7 +86,7 @@ struct nmgr_hdr {
     uint8_t  _res1:5;
     uint8_t  nh_op:3;           /* NMGR_OP_XXX */
 #endif
-    uint8_t  nh_flags;          /* XXX reserved for future flags */
+    uint8_t  nh_flags;          /* NMGR_F_XXX */
     uint16_t nh_len;            /* length of the payload */
     uint16_t nh_group;          /* NMGR_GROUP_XXX */
     uint8_t  nh_seq;            /* sequence number */
@@ -88,9 +97,30 @@ struct mgmt_cbuf;
 
 typedef int (*mgmt_handler_func_t)(struct mgmt_cbuf *);
 
+#if MYNEWT_VAL(MGMT_STREAM)
+/**
+ * State of a streamed read response.  The stream handler is called once per
+ * part, with the request parser rewound, and fills in the root map of that
+ * part.
+ */
+struct mgmt_stream {
+    /* Limit for cbor_encode_bytes_written() of the response encoder. */
+    uint16_t ms_budget;
+    /* Set by the handler if another part should follow this one. */
+    uint8_t ms_more;
+    /* Owned by the handler; zero when the first part is built. */
+    uint32_t ms_cursor[2];
+};
+
+typedef int (*mgmt_stream_func_t)(struct mgmt_cbuf *, struct mgmt_stream *);
+#endif
+
 struct mgmt_handler {
     mgmt_handler_func_t mh_read;
     mgmt_handler_func_t mh_write;
+#if MYNEWT_VAL(MGMT_STREAM)
+    mgmt_stream_func_t mh_stream;
+#endif
 };
 
 struct mgmt_group {
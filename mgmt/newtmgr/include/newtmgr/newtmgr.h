@@ -59,6 +59,7 @@ int nmgr_transport_init(struct nmgr_transport *nt,
         nmgr_transport_out_func_t output_func,
         nmgr_transport_get_mtu_func_t get_mtu_func);
 int nmgr_rx_req(struct nmgr_transport *nt, struct os_mbuf *req);
+void nmgr_tx_done(void);
 
 #ifdef __cplusplus
 }
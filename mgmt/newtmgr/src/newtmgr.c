@@ -180,6 +180,209 @@ nmgr_rsp_tx(struct nmgr_transport *nt, struct os_mbuf **rsp, uint16_t mtu)
     return MGMT_ERR_EOK;
 }
 
+#if MYNEWT_VAL(MGMT_STREAM)
+/*
+ * Streamed read response in progress.  Parts are built one per event on the
+ * newtmgr queue, so that transports which send from the same queue get to
+ * run in between.  There is one stream at a time.
+ */
+static struct nmgr_stream {
+    struct nmgr_transport *ns_nt;
+    struct os_mbuf *ns_req;
+    struct os_mbuf *ns_rsp;
+    const struct mgmt_handler *ns_handler;
+    struct nmgr_hdr ns_hdr;
+    struct mgmt_stream ns_ms;
+    /* Waiting for nmgr_tx_done() to get an mbuf for the next part. */
+    volatile uint8_t ns_waiting;
+    struct os_event ns_ev;
+    struct os_callout ns_timer;
+} nmgr_stream;
+
+/**
+ * Builds and sends the next part of the stream.  The part is sized to the
+ * MTU the transport reports now; an MTU of 0 means the peer is gone.
+ *
+ * On failure ns_rsp is either NULL or an empty mbuf which can carry an
+ * error response.
+ */
+static int
+nmgr_stream_part(struct nmgr_stream *ns)
+{
+    CborEncoder payload_enc;
+    struct nmgr_hdr *rsp_hdr;
+    uint16_t mtu;
+    int rc;
+
+    mtu = ns->ns_nt->nt_get_mtu(ns->ns_req);
+    if (mtu == 0) {
+        os_mbuf_free_chain(ns->ns_rsp);
+        ns->ns_rsp = NULL;
+        return MGMT_ERR_EUNKNOWN;
+    }
+
+    rsp_hdr = nmgr_init_rsp(ns->ns_rsp, &ns->ns_hdr);
+    if (!rsp_hdr) {
+        return MGMT_ERR_ENOMEM;
+    }
+
+    cbor_mbuf_reader_init(&nmgr_task_cbuf.reader, ns->ns_req,
+                          sizeof(ns->ns_hdr));
+    cbor_parser_init(&nmgr_task_cbuf.reader.r, 0,
+                     &nmgr_task_cbuf.n_b.parser, &nmgr_task_cbuf.n_b.it);
+
+    rc = cbor_encoder_create_map(&nmgr_task_cbuf.n_b.encoder, &payload_enc,
+                                 CborIndefiniteLength);
+    if (rc != 0) {
+        return MGMT_ERR_ENOMEM;
+    }
+
+    /* Leave room for the header and the break closing the root map. */
+    if (mtu > sizeof(*rsp_hdr) + 1) {
+        ns->ns_ms.ms_budget = mtu - sizeof(*rsp_hdr) - 1;
+    } else {
+        ns->ns_ms.ms_budget = 0;
+    }
+    ns->ns_ms.ms_more = 0;
+
+    rc = ns->ns_handler->mh_stream(&nmgr_task_cbuf.n_b, &ns->ns_ms);
+    if (rc != 0) {
+        return rc;
+    }
+
+    rc = cbor_encoder_close_container(&nmgr_task_cbuf.n_b.encoder,
+                                      &payload_enc);
+    if (rc != 0) {
+        return MGMT_ERR_ENOMEM;
+    }
+
+    rsp_hdr->nh_flags = NMGR_F_STREAM;
+    if (ns->ns_ms.ms_more) {
+        rsp_hdr->nh_flags |= NMGR_F_MORE;
+    }
+    rsp_hdr->nh_len =
+        htons(cbor_encode_bytes_written(&nmgr_task_cbuf.n_b.encoder));
+
+    return nmgr_rsp_tx(ns->ns_nt, &ns->ns_rsp, mtu);
+}
+
+/**
+ * Ends the stream.  On failure, an error response is sent if there is an
+ * mbuf for it.
+ */
+static void
+nmgr_stream_end(struct nmgr_stream *ns, int rc)
+{
+    os_callout_stop(&ns->ns_timer);
+    os_eventq_remove(mgmt_evq_get(), &ns->ns_ev);
+    ns->ns_waiting = 0;
+
+    if (rc != 0 && ns->ns_rsp) {
+        os_mbuf_adj(ns->ns_rsp, OS_MBUF_PKTLEN(ns->ns_rsp));
+        nmgr_send_err_rsp(ns->ns_nt, ns->ns_rsp, &ns->ns_hdr, rc);
+    } else {
+        os_mbuf_free_chain(ns->ns_rsp);
+    }
+    os_mbuf_free_chain(ns->ns_req);
+
+    ns->ns_rsp = NULL;
+    ns->ns_req = NULL;
+    ns->ns_nt = NULL;
+}
+
+static void
+nmgr_stream_step(struct os_event *ev)
+{
+    struct nmgr_stream *ns = &nmgr_stream;
+    int rc;
+
+    if (!ns->ns_nt) {
+        return;
+    }
+
+    if (!ns->ns_rsp) {
+        /* Set before trying, so that a nmgr_tx_done() in between counts. */
+        ns->ns_waiting = 1;
+        ns->ns_rsp = os_msys_get_pkthdr(512, OS_MBUF_USRHDR_LEN(ns->ns_req));
+        if (!ns->ns_rsp) {
+            if (!os_callout_queued(&ns->ns_timer)) {
+                os_callout_reset(&ns->ns_timer, os_time_ms_to_ticks32(
+                                   MYNEWT_VAL(MGMT_STREAM_WAIT_MS)));
+            }
+            return;
+        }
+        memcpy(OS_MBUF_USRHDR(ns->ns_rsp), OS_MBUF_USRHDR(ns->ns_req),
+               OS_MBUF_USRHDR_LEN(ns->ns_req));
+    }
+    ns->ns_waiting = 0;
+    os_callout_stop(&ns->ns_timer);
+
+    rc = nmgr_stream_part(ns);
+    if (rc == 0 && ns->ns_ms.ms_more) {
+        os_eventq_put(mgmt_evq_get(), &ns->ns_ev);
+    } else {
+        nmgr_stream_end(ns, rc);
+    }
+}
+
+/*
+ * No nmgr_tx_done() within MGMT_STREAM_WAIT_MS.  Try once more, as not all
+ * transports report freeing mbufs, then give up.
+ */
+static void
+nmgr_stream_tmo(struct os_event *ev)
+{
+    struct nmgr_stream *ns = &nmgr_stream;
+
+    nmgr_stream_step(ev);
+    if (ns->ns_waiting) {
+        nmgr_stream_end(ns, MGMT_ERR_ENOMEM);
+    }
+}
+
+/**
+ * Starts a streamed read response.  On success, the stream takes ownership
+ * of both mbufs.
+ */
+static int
+nmgr_stream_start(struct nmgr_transport *nt, struct os_mbuf *req,
+                  struct os_mbuf *rsp, struct nmgr_hdr *hdr,
+                  const struct mgmt_handler *handler)
+{
+    struct nmgr_stream *ns = &nmgr_stream;
+
+    if (ns->ns_nt) {
+        return MGMT_ERR_EBADSTATE;
+    }
+    memset(ns, 0, sizeof(*ns));
+    ns->ns_nt = nt;
+    ns->ns_req = req;
+    ns->ns_rsp = rsp;
+    ns->ns_handler = handler;
+    ns->ns_hdr = *hdr;
+    ns->ns_ev.ev_cb = nmgr_stream_step;
+    os_callout_init(&ns->ns_timer, mgmt_evq_get(), nmgr_stream_tmo, NULL);
+
+    os_eventq_put(mgmt_evq_get(), &ns->ns_ev);
+    return 0;
+}
+#endif
+
+/**
+ * Called by a transport when it has freed mbufs it was given to send.  A
+ * streamed response waiting for an mbuf then goes on with its next part.
+ * Can be called from interrupt context.
+ */
+void
+nmgr_tx_done(void)
+{
+#if MYNEWT_VAL(MGMT_STREAM)
+    if (nmgr_stream.ns_waiting) {
+        os_eventq_put(mgmt_evq_get(), &nmgr_stream.ns_ev);
+    }
+#endif
+}
+
 static void
 nmgr_handle_req(struct nmgr_transport *nt, struct os_mbuf *req)
 {
@@ -233,6 +436,22 @@ nmgr_handle_req(struct nmgr_transport *nt, struct os_mbuf *req)
             goto err;
         }
 
+#if MYNEWT_VAL(MGMT_STREAM)
+        if (hdr.nh_op == NMGR_OP_READ && (hdr.nh_flags & NMGR_F_STREAM) &&
+            handler->mh_stream) {
+            rc = nmgr_stream_start(nt, req, rsp, &hdr, handler);
+            if (rc) {
+                goto err;
+            }
+
+            /*
+             * The stream owns the mbufs now.  Any requests after this one
+             * are dropped.
+             */
+            return;
+        }
+#endif
+
         /* Build response header apriori.  Then pass to the handlers
          * to fill out the response data, and adjust length & flags.
          */
@@ -0,0 +1,300 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include <stdlib.h>
+#include <string.h>
+
+#include "os/mynewt.h"
+#include "testutil/testutil.h"
+#include "cbmem/cbmem.h"
+#include "tinycbor/cbor.h"
+#include "tinycbor/cbor_mbuf_reader.h"
+#include "tinycbor/cbor_mbuf_writer.h"
+#include "nmgr_test.h"
+
+struct log nmgr_test_log;
+static struct cbmem nmgr_test_cbmem;
+static uint32_t nmgr_test_cbmem_buf[512];
+
+STATS_SECT_DECL(nmgr_test_stats) nmgr_test_stats;
+STATS_NAME_START(nmgr_test_stats)
+    STATS_NAME(nmgr_test_stats, s0)
+    STATS_NAME(nmgr_test_stats, s1)
+    STATS_NAME(nmgr_test_stats, s2)
+    STATS_NAME(nmgr_test_stats, s3)
+    STATS_NAME(nmgr_test_stats, s4)
+    STATS_NAME(nmgr_test_stats, s5)
+    STATS_NAME(nmgr_test_stats, s6)
+    STATS_NAME(nmgr_test_stats, s7)
+    STATS_NAME(nmgr_test_stats, s8)
+    STATS_NAME(nmgr_test_stats, s9)
+    STATS_NAME(nmgr_test_stats, s10)
+    STATS_NAME(nmgr_test_stats, s11)
+    STATS_NAME(nmgr_test_stats, s12)
+    STATS_NAME(nmgr_test_stats, s13)
+    STATS_NAME(nmgr_test_stats, s14)
+    STATS_NAME(nmgr_test_stats, s15)
+STATS_NAME_END(nmgr_test_stats)
+
+/*
+ * Requests are processed from this queue when the test runs it; there is
+ * no OS running, so callouts do not fire.
+ */
+static struct os_eventq nmgr_test_evq;
+static struct nmgr_transport nmgr_test_nt;
+static nmgr_test_rsp_func_t *nmgr_test_rsp_cb;
+
+uint16_t nmgr_test_mtu;
+int nmgr_test_parts;
+int nmgr_test_done;
+int nmgr_test_hold;
+struct os_mbuf *nmgr_test_held[NMGR_TEST_HELD_MAX];
+int nmgr_test_held_cnt;
+int nmgr_test_log_next;
+
+static int
+nmgr_test_out(struct nmgr_transport *nt, struct os_mbuf *om)
+{
+    struct nmgr_hdr hdr;
+    int rc;
+
+    rc = os_mbuf_copydata(om, 0, sizeof(hdr), &hdr);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(OS_MBUF_PKTLEN(om) <= nmgr_test_mtu);
+    TEST_ASSERT(OS_MBUF_PKTLEN(om) == sizeof(hdr) + ntohs(hdr.nh_len));
+    TEST_ASSERT(hdr.nh_op == NMGR_OP_READ_RSP);
+
+    /* Nothing comes after the last part. */
+    TEST_ASSERT(!nmgr_test_done);
+    TEST_ASSERT(hdr.nh_flags & NMGR_F_STREAM);
+    nmgr_test_parts++;
+    if (!(hdr.nh_flags & NMGR_F_MORE)) {
+        nmgr_test_done = 1;
+    }
+
+    if (nmgr_test_rsp_cb) {
+        nmgr_test_rsp_cb(om, &hdr);
+    }
+
+    if (nmgr_test_hold) {
+        TEST_ASSERT_FATAL(nmgr_test_held_cnt < NMGR_TEST_HELD_MAX);
+        nmgr_test_held[nmgr_test_held_cnt++] = om;
+    } else {
+        os_mbuf_free_chain(om);
+    }
+    return 0;
+}
+
+static uint16_t
+nmgr_test_get_mtu(struct os_mbuf *om)
+{
+    return nmgr_test_mtu;
+}
+
+/*
+ * Resets the transport state for a new streamed read.
+ */
+void
+nmgr_test_start(uint16_t mtu, nmgr_test_rsp_func_t *rsp_cb)
+{
+    nmgr_test_mtu = mtu;
+    nmgr_test_rsp_cb = rsp_cb;
+    nmgr_test_parts = 0;
+    nmgr_test_done = 0;
+    nmgr_test_hold = 0;
+    nmgr_test_log_next = 0;
+}
+
+/*
+ * Sends a streamed read request with a single string argument.
+ */
+void
+nmgr_test_read(uint16_t group, uint8_t id, const char *key, const char *val)
+{
+    struct cbor_mbuf_writer writer;
+    struct nmgr_hdr hdr;
+    struct os_mbuf *om;
+    CborEncoder enc;
+    CborEncoder map;
+    int rc;
+
+    om = os_msys_get_pkthdr(0, 0);
+    TEST_ASSERT_FATAL(om != NULL);
+
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.nh_op = NMGR_OP_READ;
+    hdr.nh_flags = NMGR_F_STREAM;
+    hdr.nh_group = htons(group);
+    hdr.nh_id = id;
+    rc = os_mbuf_append(om, &hdr, sizeof(hdr));
+    TEST_ASSERT_FATAL(rc == 0);
+
+    cbor_mbuf_writer_init(&writer, om);
+    cbor_encoder_init(&enc, &writer.enc, 0);
+    rc = cbor_encoder_create_map(&enc, &map, CborIndefiniteLength);
+    rc |= cbor_encode_text_stringz(&map, key);
+    rc |= cbor_encode_text_stringz(&map, val);
+    rc |= cbor_encoder_close_container(&enc, &map);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    hdr.nh_len = htons(cbor_encode_bytes_written(&enc));
+    rc = os_mbuf_copyinto(om, 0, &hdr, sizeof(hdr));
+    TEST_ASSERT_FATAL(rc == 0);
+
+    rc = nmgr_rx_req(&nmgr_test_nt, om);
+    TEST_ASSERT_FATAL(rc == 0);
+}
+
+/*
+ * Processes queued newtmgr events until there are none left.
+ */
+void
+nmgr_test_run(void)
+{
+    struct os_event *ev;
+
+    while ((ev = os_eventq_get_no_wait(&nmgr_test_evq)) != NULL) {
+        ev->ev_cb(ev);
+    }
+}
+
+/*
+ * Frees the held parts, and tells newtmgr about it.
+ */
+void
+nmgr_test_release(void)
+{
+    int i;
+
+    for (i = 0; i < nmgr_test_held_cnt; i++) {
+        os_mbuf_free_chain(nmgr_test_held[i]);
+    }
+    nmgr_test_held_cnt = 0;
+    nmgr_tx_done();
+}
+
+/*
+ * Checks a part of a log read response; entries must follow each other
+ * across parts, starting from "entry 0".
+ */
+void
+nmgr_test_log_part(struct os_mbuf *om, const struct nmgr_hdr *hdr)
+{
+    struct cbor_mbuf_reader reader;
+    struct CborParser parser;
+    CborValue root;
+    CborValue logs;
+    CborValue log;
+    CborValue entries;
+    CborValue entry;
+    CborValue val;
+    char msg[16];
+    size_t len;
+    int64_t rc;
+    int cnt;
+
+    cbor_mbuf_reader_init(&reader, om, sizeof(*hdr));
+    TEST_ASSERT_FATAL(cbor_parser_init(&reader.r, 0, &parser, &root) == 0);
+
+    TEST_ASSERT_FATAL(cbor_value_map_find_value(&root, "rc", &val) == 0);
+    TEST_ASSERT_FATAL(cbor_value_get_int64(&val, &rc) == 0);
+    TEST_ASSERT(rc == 0);
+
+    /* One log per part. */
+    TEST_ASSERT_FATAL(cbor_value_map_find_value(&root, "logs", &logs) == 0);
+    TEST_ASSERT_FATAL(cbor_value_enter_container(&logs, &log) == 0);
+    TEST_ASSERT_FATAL(!cbor_value_at_end(&log));
+    TEST_ASSERT_FATAL(cbor_value_map_find_value(&log, "entries",
+                                                &entries) == 0);
+    TEST_ASSERT_FATAL(cbor_value_enter_container(&entries, &entry) == 0);
+
+    cnt = 0;
+    while (!cbor_value_at_end(&entry)) {
+        TEST_ASSERT_FATAL(cbor_value_map_find_value(&entry, "msg", &val) == 0);
+        TEST_ASSERT_FATAL(cbor_value_is_text_string(&val));
+        len = sizeof(msg);
+        TEST_ASSERT_FATAL(cbor_value_copy_text_string(&val, msg, &len,
+                                                      NULL) == 0);
+        TEST_ASSERT(strncmp(msg, "entry ", 6) == 0);
+        TEST_ASSERT(atoi(msg + 6) == nmgr_test_log_next);
+        nmgr_test_log_next++;
+        cnt++;
+        TEST_ASSERT_FATAL(cbor_value_advance(&entry) == 0);
+    }
+    TEST_ASSERT(cnt > 0);
+}
+
+static void
+nmgr_test_setup(void)
+{
+    int rc;
+    int i;
+
+    os_eventq_init(&nmgr_test_evq);
+    mgmt_evq_set(&nmgr_test_evq);
+
+    rc = nmgr_transport_init(&nmgr_test_nt, nmgr_test_out,
+                             nmgr_test_get_mtu);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    cbmem_init(&nmgr_test_cbmem, nmgr_test_cbmem_buf,
+               sizeof(nmgr_test_cbmem_buf));
+    rc = log_register("nmgr_test", &nmgr_test_log, &log_cbmem_handler,
+                      &nmgr_test_cbmem, LOG_SYSLEVEL);
+    TEST_ASSERT_FATAL(rc == 0);
+    for (i = 0; i < NMGR_TEST_LOG_ENTRIES; i++) {
+        log_printf(&nmgr_test_log, LOG_MODULE_DEFAULT, LOG_LEVEL_INFO,
+                   "entry %d", i);
+    }
+
+    rc = stats_init_and_reg(STATS_HDR(nmgr_test_stats),
+                            STATS_SIZE_INIT_PARMS(nmgr_test_stats,
+                                                  STATS_SIZE_32),
+                            STATS_NAME_INIT_PARMS(nmgr_test_stats),
+                            "nmgr_test");
+    TEST_ASSERT_FATAL(rc == 0);
+}
+
+TEST_CASE_DECL(nmgr_stream_log)
+TEST_CASE_DECL(nmgr_stream_stats)
+TEST_CASE_DECL(nmgr_stream_mtu)
+TEST_CASE_DECL(nmgr_stream_wait)
+
+TEST_SUITE(nmgr_test_all)
+{
+    nmgr_test_setup();
+
+    nmgr_stream_log();
+    nmgr_stream_stats();
+    nmgr_stream_mtu();
+    nmgr_stream_wait();
+}
+
+#if MYNEWT_VAL(SELFTEST)
+
+int
+main(int argc, char **argv)
+{
+    sysinit();
+
+    nmgr_test_all();
+
+    return tu_any_failed;
+}
+
+#endif
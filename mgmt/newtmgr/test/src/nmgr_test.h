@@ -0,0 +1,90 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#ifndef _NMGR_TEST_H
+#define _NMGR_TEST_H
+
+#include "os/mynewt.h"
+#include "testutil/testutil.h"
+#include "mgmt/mgmt.h"
+#include "newtmgr/newtmgr.h"
+#include "log/log.h"
+#include "stats/stats.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define NMGR_TEST_LOG_ENTRIES   20
+#define NMGR_TEST_HELD_MAX      16
+
+extern struct log nmgr_test_log;
+
+STATS_SECT_START(nmgr_test_stats)
+    STATS_SECT_ENTRY(s0)
+    STATS_SECT_ENTRY(s1)
+    STATS_SECT_ENTRY(s2)
+    STATS_SECT_ENTRY(s3)
+    STATS_SECT_ENTRY(s4)
+    STATS_SECT_ENTRY(s5)
+    STATS_SECT_ENTRY(s6)
+    STATS_SECT_ENTRY(s7)
+    STATS_SECT_ENTRY(s8)
+    STATS_SECT_ENTRY(s9)
+    STATS_SECT_ENTRY(s10)
+    STATS_SECT_ENTRY(s11)
+    STATS_SECT_ENTRY(s12)
+    STATS_SECT_ENTRY(s13)
+    STATS_SECT_ENTRY(s14)
+    STATS_SECT_ENTRY(s15)
+STATS_SECT_END
+
+#define NMGR_TEST_STATS_CNT     16
+
+extern STATS_SECT_DECL(nmgr_test_stats) nmgr_test_stats;
+
+/*
+ * Called for every part of a response; the payload starts after hdr.
+ */
+typedef void nmgr_test_rsp_func_t(struct os_mbuf *om,
+                                  const struct nmgr_hdr *hdr);
+
+/* MTU the test transport reports. */
+extern uint16_t nmgr_test_mtu;
+/* Parts received, and whether the last one (without NMGR_F_MORE) was. */
+extern int nmgr_test_parts;
+extern int nmgr_test_done;
+/* If set, parts are kept in nmgr_test_held[] instead of being freed. */
+extern int nmgr_test_hold;
+extern struct os_mbuf *nmgr_test_held[NMGR_TEST_HELD_MAX];
+extern int nmgr_test_held_cnt;
+
+void nmgr_test_start(uint16_t mtu, nmgr_test_rsp_func_t *rsp_cb);
+void nmgr_test_read(uint16_t group, uint8_t id, const char *key,
+                    const char *val);
+void nmgr_test_run(void);
+void nmgr_test_release(void);
+
+void nmgr_test_log_part(struct os_mbuf *om, const struct nmgr_hdr *hdr);
+extern int nmgr_test_log_next;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _NMGR_TEST_H */
@@ -0,0 +1,54 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "nmgr_test.h"
+
+static void
+nmgr_stream_mtu_part(struct os_mbuf *om, const struct nmgr_hdr *hdr)
+{
+    nmgr_test_log_part(om, hdr);
+
+    /* Peer goes away after the second part. */
+    if (nmgr_test_parts == 2) {
+        nmgr_test_mtu = 0;
+    }
+}
+
+/*
+ * A stream ends, without an error response, when the transport reports an
+ * MTU of 0.  A new one can be started after that.
+ */
+TEST_CASE(nmgr_stream_mtu)
+{
+    nmgr_test_start(128, nmgr_stream_mtu_part);
+    nmgr_test_read(MGMT_GROUP_ID_LOGS, LOGS_NMGR_OP_READ, "log_name",
+                   "nmgr_test");
+    nmgr_test_run();
+
+    TEST_ASSERT(nmgr_test_parts == 2);
+    TEST_ASSERT(!nmgr_test_done);
+    TEST_ASSERT(nmgr_test_log_next < NMGR_TEST_LOG_ENTRIES);
+
+    nmgr_test_start(128, nmgr_test_log_part);
+    nmgr_test_read(MGMT_GROUP_ID_LOGS, LOGS_NMGR_OP_READ, "log_name",
+                   "nmgr_test");
+    nmgr_test_run();
+
+    TEST_ASSERT(nmgr_test_done);
+    TEST_ASSERT(nmgr_test_log_next == NMGR_TEST_LOG_ENTRIES);
+}
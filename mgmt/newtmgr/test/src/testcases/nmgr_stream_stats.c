@@ -0,0 +1,88 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include <stdio.h>
+#include "tinycbor/cbor.h"
+#include "tinycbor/cbor_mbuf_reader.h"
+#include "nmgr_test.h"
+
+static uint32_t nmgr_stream_stats_seen;
+
+static void
+nmgr_stream_stats_part(struct os_mbuf *om, const struct nmgr_hdr *hdr)
+{
+    struct cbor_mbuf_reader reader;
+    struct CborParser parser;
+    CborValue root;
+    CborValue fields;
+    CborValue field;
+    char name[8];
+    uint64_t val;
+    size_t len;
+    int cnt;
+    int n;
+
+    cbor_mbuf_reader_init(&reader, om, sizeof(*hdr));
+    TEST_ASSERT_FATAL(cbor_parser_init(&reader.r, 0, &parser, &root) == 0);
+    TEST_ASSERT_FATAL(cbor_value_map_find_value(&root, "fields",
+                                                &fields) == 0);
+    TEST_ASSERT_FATAL(cbor_value_enter_container(&fields, &field) == 0);
+
+    cnt = 0;
+    while (!cbor_value_at_end(&field)) {
+        len = sizeof(name);
+        TEST_ASSERT_FATAL(cbor_value_copy_text_string(&field, name, &len,
+                                                      NULL) == 0);
+        TEST_ASSERT_FATAL(cbor_value_advance(&field) == 0);
+        TEST_ASSERT_FATAL(cbor_value_get_uint64(&field, &val) == 0);
+        TEST_ASSERT_FATAL(cbor_value_advance(&field) == 0);
+
+        TEST_ASSERT_FATAL(sscanf(name, "s%d", &n) == 1);
+        TEST_ASSERT_FATAL(n >= 0 && n < NMGR_TEST_STATS_CNT);
+        TEST_ASSERT(!(nmgr_stream_stats_seen & (1 << n)));
+        nmgr_stream_stats_seen |= 1 << n;
+        TEST_ASSERT(val == 1000 + n);
+        cnt++;
+    }
+    TEST_ASSERT(cnt > 0);
+}
+
+/*
+ * A stats read at a small MTU comes in several parts, and every value is
+ * in exactly one of them.
+ */
+TEST_CASE(nmgr_stream_stats)
+{
+    uint32_t *val;
+    int i;
+
+    val = (uint32_t *)((uint8_t *)&nmgr_test_stats +
+                       sizeof(struct stats_hdr));
+    for (i = 0; i < NMGR_TEST_STATS_CNT; i++) {
+        val[i] = 1000 + i;
+    }
+
+    nmgr_stream_stats_seen = 0;
+    nmgr_test_start(64, nmgr_stream_stats_part);
+    nmgr_test_read(MGMT_GROUP_ID_STATS, 0, "name", "nmgr_test");
+    nmgr_test_run();
+
+    TEST_ASSERT(nmgr_test_done);
+    TEST_ASSERT(nmgr_test_parts > 1);
+    TEST_ASSERT(nmgr_stream_stats_seen == (1 << NMGR_TEST_STATS_CNT) - 1);
+}
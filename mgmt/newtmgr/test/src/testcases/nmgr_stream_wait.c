@@ -0,0 +1,57 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "nmgr_test.h"
+
+/*
+ * When the transport holds on to the parts until msys runs out, the stream
+ * stops, and goes on when the transport frees them and calls
+ * nmgr_tx_done().
+ */
+TEST_CASE(nmgr_stream_wait)
+{
+    int waits;
+    int parts;
+
+    nmgr_test_start(128, nmgr_test_log_part);
+    nmgr_test_hold = 1;
+    nmgr_test_read(MGMT_GROUP_ID_LOGS, LOGS_NMGR_OP_READ, "log_name",
+                   "nmgr_test");
+
+    waits = 0;
+    while (1) {
+        nmgr_test_run();
+        if (nmgr_test_done) {
+            break;
+        }
+        TEST_ASSERT_FATAL(os_msys_num_free() == 0);
+        TEST_ASSERT_FATAL(nmgr_test_held_cnt > 0);
+        waits++;
+
+        /* Nothing happens until the transport says so. */
+        parts = nmgr_test_parts;
+        nmgr_test_run();
+        TEST_ASSERT_FATAL(nmgr_test_parts == parts);
+
+        nmgr_test_release();
+    }
+    nmgr_test_release();
+
+    TEST_ASSERT(waits > 0);
+    TEST_ASSERT(nmgr_test_log_next == NMGR_TEST_LOG_ENTRIES);
+}
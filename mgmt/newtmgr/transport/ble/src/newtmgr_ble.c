@@ -181,6 +181,7 @@ nmgr_ble_event_data_in(struct os_event *ev)
         ble_gattc_notify_custom(conn_handle, g_ble_nmgr_attr_handle,
                                 m_resp);
     }
+    nmgr_tx_done();
 }
 
 static int
@@ -203,6 +203,7 @@ nmgr_uart_tx_char(void *arg)
         m = SLIST_NEXT(nus->nus_tx, om_next);
         os_mbuf_free(nus->nus_tx);
         nus->nus_tx = m;
+        nmgr_tx_done();
 
         nus->nus_tx_off = 0;
         if (!nus->nus_tx) {
@@ -0,0 +1,46 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#ifndef __LWIP_MBUF_H__
+#define __LWIP_MBUF_H__
+
+#include <inttypes.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct pbuf;
+
+/**
+ * Allocates a receive buffer for a network interface driver. The pbuf is
+ * backed by a single msys mbuf, and its payload is handed to the socket
+ * layer without copying.
+ *
+ * @param len                   Size of the buffer.
+ *
+ * @return                      The pbuf, NULL if no msys mbuf large enough
+ *                                  was available.
+ */
+struct pbuf *lwip_mbuf_rx_pbuf_alloc(uint16_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __LWIP_MBUF_H__ */
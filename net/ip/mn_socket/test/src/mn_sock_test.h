@@ -34,6 +34,7 @@ void sock_listen(void);
 void sock_tcp_connect(void);
 void sock_udp_data(void);
 void sock_tcp_data(void);
+void sock_tcp_bulk(void);
 void sock_itf_list(void);
 void sock_udp_ll(void);
 void sock_udp_mcast_v4(void);
@@ -401,6 +401,157 @@ sock_tcp_data(void)
     mn_close(listen_sock);
 }
 
+/*
+ * Bulk transfer over loopback, several times the receive window; checks
+ * that all data arrives in order.
+ */
+#define STT_BYTES       (64 * 1024)
+#define STT_CHUNK       1024
+
+static struct os_sem stt_sem;
+
+static void
+stt_event(void *cb_arg, int err)
+{
+    os_sem_release(&stt_sem);
+}
+
+static union mn_socket_cb stt_sock_cbs = {
+    .socket.writable = stt_event,
+    .socket.readable = stt_event
+};
+
+static int
+stt_newconn(void *cb_arg, struct mn_socket *new)
+{
+    struct mn_socket **r_sock;
+
+    r_sock = cb_arg;
+    *r_sock = new;
+
+    mn_socket_set_cbs(new, NULL, &stt_sock_cbs);
+
+    os_sem_release(&stt_sem);
+    return 0;
+}
+
+static struct os_mbuf *
+stt_chunk(int off, int len)
+{
+    struct os_mbuf *m;
+    uint8_t data[64];
+    int blen;
+    int i;
+
+    m = os_msys_get_pkthdr(0, 0);
+    if (!m) {
+        return NULL;
+    }
+    while (len > 0) {
+        blen = min(len, sizeof(data));
+        for (i = 0; i < blen; i++) {
+            data[i] = off + i;
+        }
+        if (os_mbuf_append(m, data, blen)) {
+            os_mbuf_free_chain(m);
+            return NULL;
+        }
+        off += blen;
+        len -= blen;
+    }
+    return m;
+}
+
+void
+sock_tcp_bulk(void)
+{
+    struct mn_socket *listen_sock;
+    struct mn_socket *sock;
+    struct mn_socket *new_sock = NULL;
+    struct mn_sockaddr_in msin;
+    union mn_socket_cb listen_cbs = {
+        .listen.newconn = stt_newconn,
+    };
+    struct os_mbuf *m;
+    struct os_mbuf *n;
+    int sent;
+    int rcvd;
+    int len;
+    int rc;
+    int i;
+
+    os_sem_init(&stt_sem, 0);
+
+    rc = mn_socket(&listen_sock, MN_PF_INET, MN_SOCK_STREAM, 0);
+    TEST_ASSERT(rc == 0);
+
+    msin.msin_family = MN_PF_INET;
+    msin.msin_len = sizeof(msin);
+    msin.msin_port = htons(12448);
+
+    mn_inet_pton(MN_PF_INET, "127.0.0.1", &msin.msin_addr);
+
+    mn_socket_set_cbs(listen_sock, &new_sock, &listen_cbs);
+    rc = mn_bind(listen_sock, (struct mn_sockaddr *)&msin);
+    TEST_ASSERT(rc == 0);
+
+    rc = mn_listen(listen_sock, 2);
+    TEST_ASSERT(rc == 0);
+
+    rc = mn_socket(&sock, MN_PF_INET, MN_SOCK_STREAM, 0);
+    TEST_ASSERT(rc == 0);
+
+    mn_socket_set_cbs(sock, NULL, &stt_sock_cbs);
+
+    rc = mn_connect(sock, (struct mn_sockaddr *)&msin);
+    TEST_ASSERT(rc == 0);
+
+    while (!new_sock) {
+        rc = os_sem_pend(&stt_sem, OS_TICKS_PER_SEC);
+        TEST_ASSERT_FATAL(rc == 0);
+    }
+
+    sent = 0;
+    rcvd = 0;
+    while (rcvd < STT_BYTES) {
+        rc = MN_EAGAIN;
+        if (sent < STT_BYTES) {
+            len = min(STT_BYTES - sent, STT_CHUNK);
+            m = stt_chunk(sent, len);
+            if (m) {
+                rc = mn_sendto(new_sock, m, NULL);
+                if (rc == 0) {
+                    sent += len;
+                } else {
+                    TEST_ASSERT_FATAL(rc == MN_EAGAIN);
+                    os_mbuf_free_chain(m);
+                }
+            }
+        }
+        while (mn_recvfrom(sock, &m, NULL) == 0) {
+            for (n = m; n; n = SLIST_NEXT(n, om_next)) {
+                for (i = 0; i < n->om_len; i++) {
+                    TEST_ASSERT_FATAL(n->om_data[i] == (uint8_t)rcvd);
+                    rcvd++;
+                }
+            }
+            os_mbuf_free_chain(m);
+            rc = 0;
+        }
+        if (rc != 0) {
+            /* Nothing moved; wait for socket to become readable/writable. */
+            rc = os_sem_pend(&stt_sem, OS_TICKS_PER_SEC);
+            TEST_ASSERT_FATAL(rc == 0);
+        }
+    }
+    TEST_ASSERT(sent == STT_BYTES);
+    TEST_ASSERT(rcvd == STT_BYTES);
+
+    mn_close(new_sock);
+    mn_close(sock);
+    mn_close(listen_sock);
+}
+
 void
 sock_itf_list(void)
 {
@@ -792,6 +943,7 @@ mn_socket_test_handler(void *arg)
     sock_tcp_connect();
     sock_udp_data();
     sock_tcp_data();
+    sock_tcp_bulk();
     sock_itf_list();
     sock_udp_ll();
     sock_udp_mcast_v4();
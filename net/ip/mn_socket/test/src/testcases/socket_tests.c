@@ -28,6 +28,7 @@ TEST_CASE_TASK(socket_tests)
     sock_tcp_connect();
     sock_udp_data();
     sock_tcp_data();
+    sock_tcp_bulk();
     sock_itf_list();
     sock_udp_ll();
     sock_udp_mcast_v4();
@@ -26,6 +26,7 @@
 #include <assert.h>
 #include <fcntl.h>
 #include <sys/ioctl.h>
+#include <sys/uio.h>
 #include <sys/un.h>
 #include <stdio.h>
 
@@ -36,6 +37,13 @@
 
 #include "native_sock_priv.h"
 
+#if MYNEWT_VAL(NATIVE_SOCKETS_ASYNC_IO)
+#include "sim/sim.h"
+#endif
+
+/* Max number of mbufs handed to a single writev() */
+#define NATIVE_SOCK_TX_IOV  16
+
 static struct native_sock {
     struct mn_socket ns_sock;
     int ns_fd;
@@ -54,6 +62,10 @@ static struct native_sock_state {
     int poll_fd_cnt;
     struct os_mutex mtx;
     struct os_task task;
+#if MYNEWT_VAL(NATIVE_SOCKETS_ASYNC_IO)
+    struct os_sem sem;          /* Released when there might be I/O to do */
+    struct sim_io_handler io_handler;
+#endif
 } native_sock_state;
 
 static const struct mn_socket_ops native_sock_ops = {
@@ -107,6 +119,28 @@ native_find_sock(int fd)
     return NULL;
 }
 
+#if MYNEWT_VAL(NATIVE_SOCKETS_ASYNC_IO)
+static void
+native_sock_io_irq(void *arg)
+{
+    struct native_sock_state *nss = arg;
+
+    if (os_sem_get_count(&nss->sem) == 0) {
+        os_sem_release(&nss->sem);
+    }
+}
+
+static void
+native_sock_wakeup(struct native_sock_state *nss)
+{
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+    native_sock_io_irq(nss);
+    OS_EXIT_CRITICAL(sr);
+}
+#endif
+
 static void
 native_sock_poll_rebuild(struct native_sock_state *nss)
 {
@@ -129,6 +163,13 @@ native_sock_poll_rebuild(struct native_sock_state *nss)
         j++;
     }
     nss->poll_fd_cnt = j;
+#if MYNEWT_VAL(NATIVE_SOCKETS_ASYNC_IO)
+    /*
+     * Events for new descriptors might have come in before they were
+     * being polled.
+     */
+    native_sock_wakeup(nss);
+#endif
     os_mutex_release(&nss->mtx);
 }
 
@@ -296,6 +337,10 @@ native_sock_create(struct mn_socket **sp, uint8_t domain,
     /* Make the socket nonblocking. */
     rc = fcntl(idx, F_SETFL, fcntl(idx, F_GETFL, 0) | O_NONBLOCK);
     assert(rc == 0);
+#if MYNEWT_VAL(NATIVE_SOCKETS_ASYNC_IO)
+    rc = sim_io_fd_async(idx);
+    assert(rc == 0);
+#endif
 
     ns->ns_fd = idx;
     ns->ns_pf = domain;
@@ -441,33 +486,42 @@ native_sock_listen(struct mn_socket *s, uint8_t qlen)
  * by ns_tx.
  * Keep sending mbufs until socket says that it can't take anymore.
  * then wait for send event notification before continuing.
+ * Chain is handed to the socket NATIVE_SOCK_TX_IOV mbufs at a time.
  */
 static int
 native_sock_stream_tx(struct native_sock *ns, int notify)
 {
     struct native_sock_state *nss = &native_sock_state;
+    struct iovec iov[NATIVE_SOCK_TX_IOV];
     struct os_mbuf *m;
-    struct os_mbuf *n;
+    ssize_t written;
+    int iovcnt;
     int rc;
 
     rc = 0;
 
     os_mutex_pend(&nss->mtx, OS_TIMEOUT_NEVER);
     while (ns->ns_tx && rc == 0) {
-        m = ns->ns_tx;
-        n = SLIST_NEXT(m, om_next);
+        iovcnt = 0;
+        for (m = ns->ns_tx; m && iovcnt < NATIVE_SOCK_TX_IOV;
+             m = SLIST_NEXT(m, om_next)) {
+            iov[iovcnt].iov_base = m->om_data;
+            iov[iovcnt].iov_len = m->om_len;
+            iovcnt++;
+        }
 
         errno = 0;
-        rc = write(ns->ns_fd, m->om_data, m->om_len);
-        if (rc == m->om_len) {
-            /* Complete write. */
-            ns->ns_tx = n;
-            os_mbuf_free(m);
-            rc = 0;
-        } else if (rc != -1) {
-            /* Partial write. */
-            os_mbuf_adj(m, m->om_len - rc);
-            rc = 0;
+        written = writev(ns->ns_fd, iov, iovcnt);
+        if (written >= 0) {
+            /* Free what went out completely, trim a partially sent one. */
+            while ((m = ns->ns_tx) && written >= m->om_len) {
+                written -= m->om_len;
+                ns->ns_tx = SLIST_NEXT(m, om_next);
+                os_mbuf_free(m);
+            }
+            if (written) {
+                os_mbuf_adj(m, written);
+            }
         } else {
             /* Error. */
             rc = errno;
@@ -725,7 +779,10 @@ native_sock_getpeername(struct mn_socket *s, struct mn_sockaddr *addr)
 }
 
 /*
- * XXX should do this task with SIGIO as well.
+ * With NATIVE_SOCKETS_ASYNC_IO the task sleeps until SIGIO reports activity
+ * on one of the sockets, or the socket set changes. Readiness is re-checked
+ * every NATIVE_SOCKETS_POLL_ITVL ticks anyway, as data left unread by the
+ * application does not raise a new signal.
  */
 static void
 socket_task(void *arg)
@@ -738,12 +795,17 @@ socket_task(void *arg)
     int i;
     socklen_t slen;
     int sock_err;
+    int val;
     int rc;
 
     os_mutex_pend(&nss->mtx, OS_WAIT_FOREVER);
     while (1) {
         os_mutex_release(&nss->mtx);
+#if MYNEWT_VAL(NATIVE_SOCKETS_ASYNC_IO)
+        os_sem_pend(&nss->sem, MYNEWT_VAL(NATIVE_SOCKETS_POLL_ITVL));
+#else
         os_time_delay(MYNEWT_VAL(NATIVE_SOCKETS_POLL_ITVL));
+#endif
         os_mutex_pend(&nss->mtx, OS_WAIT_FOREVER);
         if (nss->poll_fd_cnt) {
             rc = poll(nss->poll_fds, nss->poll_fd_cnt, 0);
@@ -775,6 +837,12 @@ socket_task(void *arg)
                     if (new_ns->ns_fd < 0) {
                         continue;
                     }
+                    /* Linux doesn't pass O_NONBLOCK on to accepted sockets. */
+                    val = 1;
+                    ioctl(new_ns->ns_fd, FIONBIO, (char *)&val);
+#if MYNEWT_VAL(NATIVE_SOCKETS_ASYNC_IO)
+                    sim_io_fd_async(new_ns->ns_fd);
+#endif
                     new_ns->ns_type = ns->ns_type;
                     new_ns->ns_sock.ms_ops = &native_sock_ops;
                     os_mutex_release(&nss->mtx);
@@ -835,6 +903,12 @@ native_sock_init(void)
         return -1;
     }
     os_mutex_init(&nss->mtx);
+#if MYNEWT_VAL(NATIVE_SOCKETS_ASYNC_IO)
+    os_sem_init(&nss->sem, 0);
+    nss->io_handler.sih_fn = native_sock_io_irq;
+    nss->io_handler.sih_arg = nss;
+    sim_io_handler_add(&nss->io_handler);
+#endif
     i = os_task_init(&nss->task, "socket", socket_task, &native_sock_state,
       MYNEWT_VAL(NATIVE_SOCKETS_PRIO), OS_WAIT_FOREVER, sp,
       MYNEWT_VAL(NATIVE_SOCKETS_STACK_SZ));
@@ -0,0 +1,208 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "native_sock_test.h"
+
+struct os_sem native_sock_test_sem;
+int native_sock_test_readable;
+int native_sock_test_writable;
+
+static void
+native_sock_test_readable_cb(void *cb_arg, int err)
+{
+    native_sock_test_readable++;
+    os_sem_release(&native_sock_test_sem);
+}
+
+static void
+native_sock_test_writable_cb(void *cb_arg, int err)
+{
+    native_sock_test_writable++;
+    os_sem_release(&native_sock_test_sem);
+}
+
+const union mn_socket_cb native_sock_test_cbs = {
+    .socket.readable = native_sock_test_readable_cb,
+    .socket.writable = native_sock_test_writable_cb,
+};
+
+static int
+native_sock_test_newconn(void *cb_arg, struct mn_socket *new)
+{
+    struct mn_socket **r_sock;
+
+    r_sock = cb_arg;
+    *r_sock = new;
+    mn_socket_set_cbs(new, NULL, &native_sock_test_cbs);
+    os_sem_release(&native_sock_test_sem);
+
+    return 0;
+}
+
+static const union mn_socket_cb native_sock_test_listen_cbs = {
+    .listen.newconn = native_sock_test_newconn,
+};
+
+uint8_t
+native_sock_test_pattern(int off)
+{
+    return (uint8_t)(off * 7 + (off >> 8));
+}
+
+/*
+ * Returns a chain from msys holding 'len' bytes of the test pattern,
+ * starting at offset 'off'.
+ */
+struct os_mbuf *
+native_sock_test_chain(int off, int len)
+{
+    struct os_mbuf *m;
+    uint8_t data[64];
+    int blen;
+    int i;
+
+    m = os_msys_get_pkthdr(0, 0);
+    TEST_ASSERT_FATAL(m != NULL);
+    while (len > 0) {
+        blen = min(len, sizeof(data));
+        for (i = 0; i < blen; i++) {
+            data[i] = native_sock_test_pattern(off + i);
+        }
+        TEST_ASSERT_FATAL(os_mbuf_append(m, data, blen) == 0);
+        off += blen;
+        len -= blen;
+    }
+    return m;
+}
+
+int
+native_sock_test_chain_cnt(struct os_mbuf *m)
+{
+    int cnt;
+
+    for (cnt = 0; m; m = SLIST_NEXT(m, om_next)) {
+        cnt++;
+    }
+    return cnt;
+}
+
+/*
+ * Waits up to 'timeout' ticks for the callback counter 'cnt', cleared by
+ * the caller, to go up. Returns the number of ticks waited, or -1 on timeout.
+ */
+int
+native_sock_test_event(int *cnt, os_time_t timeout)
+{
+    os_time_t start;
+    os_time_t now;
+
+    start = os_time_get();
+    while (*cnt == 0) {
+        now = os_time_get();
+        if (now - start >= timeout) {
+            return -1;
+        }
+        os_sem_pend(&native_sock_test_sem, timeout - (now - start));
+    }
+    return os_time_get() - start;
+}
+
+/*
+ * Opens a TCP connection between a native socket and a plain host socket,
+ * the peer, which the test reads from and writes to directly. The peer is
+ * non-blocking, and has a small receive buffer.
+ */
+void
+native_sock_test_tcp_open(struct mn_socket **listen_sock,
+                          struct mn_socket **sock, int *peer_fd)
+{
+    struct mn_sockaddr_in msin;
+    struct sockaddr_in sin;
+    int flags;
+    int val;
+    int rc;
+
+    os_sem_init(&native_sock_test_sem, 0);
+    native_sock_test_readable = 0;
+    native_sock_test_writable = 0;
+
+    rc = mn_socket(listen_sock, MN_PF_INET, MN_SOCK_STREAM, 0);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    memset(&msin, 0, sizeof(msin));
+    msin.msin_family = MN_PF_INET;
+    msin.msin_len = sizeof(msin);
+    msin.msin_port = htons(NATIVE_SOCK_TEST_PORT);
+    mn_inet_pton(MN_PF_INET, "127.0.0.1", &msin.msin_addr);
+
+    *sock = NULL;
+    mn_socket_set_cbs(*listen_sock, sock, &native_sock_test_listen_cbs);
+    rc = mn_bind(*listen_sock, (struct mn_sockaddr *)&msin);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = mn_listen(*listen_sock, 1);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    *peer_fd = socket(AF_INET, SOCK_STREAM, 0);
+    TEST_ASSERT_FATAL(*peer_fd >= 0);
+    val = NATIVE_SOCK_TEST_RCVBUF;
+    rc = setsockopt(*peer_fd, SOL_SOCKET, SO_RCVBUF, &val, sizeof(val));
+    TEST_ASSERT_FATAL(rc == 0);
+
+    memset(&sin, 0, sizeof(sin));
+    sin.sin_family = AF_INET;
+    sin.sin_port = htons(NATIVE_SOCK_TEST_PORT);
+    sin.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    rc = connect(*peer_fd, (struct sockaddr *)&sin, sizeof(sin));
+    TEST_ASSERT_FATAL(rc == 0);
+    flags = fcntl(*peer_fd, F_GETFL);
+    rc = fcntl(*peer_fd, F_SETFL, flags | O_NONBLOCK);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    while (*sock == NULL) {
+        rc = os_sem_pend(&native_sock_test_sem, OS_TICKS_PER_SEC);
+        TEST_ASSERT_FATAL(rc == 0, "connection not accepted");
+    }
+}
+
+TEST_CASE_DECL(native_sock_test_io)
+
+TEST_SUITE(native_sock_test_all)
+{
+    native_sock_test_io();
+}
+
+#if MYNEWT_VAL(SELFTEST)
+
+int
+main(int argc, char **argv)
+{
+    sysinit();
+
+    native_sock_test_all();
+
+    return tu_any_failed;
+}
+
+#endif
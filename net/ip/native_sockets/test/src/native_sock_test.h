@@ -0,0 +1,56 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#ifndef _NATIVE_SOCK_TEST_H
+#define _NATIVE_SOCK_TEST_H
+
+#include "os/mynewt.h"
+#include "testutil/testutil.h"
+#include "mn_socket/mn_socket.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define NATIVE_SOCK_TEST_PORT       12460
+/* Bytes handed to each mn_sendto(); a chain of several mbufs. */
+#define NATIVE_SOCK_TEST_CHUNK      2000
+/* Keep the peer's window small, so that the socket fills up quickly. */
+#define NATIVE_SOCK_TEST_RCVBUF     4096
+
+/* Socket callbacks seen, each also releases native_sock_test_sem. */
+extern struct os_sem native_sock_test_sem;
+extern int native_sock_test_readable;
+extern int native_sock_test_writable;
+extern const union mn_socket_cb native_sock_test_cbs;
+
+uint8_t native_sock_test_pattern(int off);
+struct os_mbuf *native_sock_test_chain(int off, int len);
+int native_sock_test_chain_cnt(struct os_mbuf *m);
+void native_sock_test_tcp_open(struct mn_socket **listen_sock,
+                               struct mn_socket **sock, int *peer_fd);
+int native_sock_test_event(int *cnt, os_time_t timeout);
+
+void native_sock_test_partial_tx(void);
+void native_sock_test_sigio_rx(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _NATIVE_SOCK_TEST_H */
@@ -0,0 +1,107 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include <errno.h>
+#include <unistd.h>
+
+#include "native_sock_test.h"
+
+/*
+ * Fills up the socket with the peer not reading, until a chain is only
+ * partly written. The rest of the chain stays queued, and goes out as the
+ * peer reads; the peer must get all the data, in order. The poll interval
+ * is longer than the test, so the socket task only runs on SIGIO.
+ */
+void
+native_sock_test_partial_tx(void)
+{
+    struct mn_socket *listen_sock;
+    struct mn_socket *sock;
+    struct os_mbuf *m;
+    os_time_t start;
+    uint8_t buf[512];
+    int total;
+    int peer;
+    int sent;
+    int rcvd;
+    int left;
+    int cnt;
+    int rc;
+    int i;
+
+    native_sock_test_tcp_open(&listen_sock, &sock, &peer);
+    total = os_msys_num_free();
+
+    sent = 0;
+    left = 0;
+    while (!left) {
+        TEST_ASSERT_FATAL(sent < 16 * 1024 * 1024, "socket never filled up");
+        m = native_sock_test_chain(sent, NATIVE_SOCK_TEST_CHUNK);
+        cnt = native_sock_test_chain_cnt(m);
+        TEST_ASSERT_FATAL(cnt > 1);
+
+        left = os_msys_num_free();
+        rc = mn_sendto(sock, m, NULL);
+        TEST_ASSERT_FATAL(rc == 0);
+        sent += NATIVE_SOCK_TEST_CHUNK;
+
+        /* Mbufs which went out are freed as soon as they're written. */
+        left = cnt - (os_msys_num_free() - left);
+        TEST_ASSERT_FATAL(left >= 0 && left <= cnt);
+    }
+    TEST_ASSERT(os_msys_num_free() == total - left);
+
+    /* Nothing more is taken until the rest of the chain is out. */
+    m = native_sock_test_chain(sent, NATIVE_SOCK_TEST_CHUNK);
+    rc = mn_sendto(sock, m, NULL);
+    TEST_ASSERT(rc == MN_EAGAIN);
+    os_mbuf_free_chain(m);
+
+    native_sock_test_writable = 0;
+    start = os_time_get();
+    rcvd = 0;
+    while (rcvd < sent) {
+        rc = read(peer, buf, sizeof(buf));
+        if (rc > 0) {
+            for (i = 0; i < rc; i++) {
+                TEST_ASSERT_FATAL(
+                    buf[i] == native_sock_test_pattern(rcvd + i),
+                    "byte %d of %d out of order", rcvd + i, sent);
+            }
+            rcvd += rc;
+        } else {
+            TEST_ASSERT_FATAL(rc < 0 && errno == EAGAIN);
+            TEST_ASSERT_FATAL(os_time_get() - start < OS_TICKS_PER_SEC * 5,
+                              "%d of %d bytes received", rcvd, sent);
+            os_time_delay(1);
+        }
+    }
+    rc = read(peer, buf, sizeof(buf));
+    TEST_ASSERT(rc < 0 && errno == EAGAIN);
+    TEST_ASSERT(native_sock_test_writable > 0);
+    TEST_ASSERT(os_msys_num_free() == total);
+
+    /* Once the chain is out, the socket takes data again. */
+    m = native_sock_test_chain(sent, NATIVE_SOCK_TEST_CHUNK);
+    rc = mn_sendto(sock, m, NULL);
+    TEST_ASSERT(rc == 0);
+
+    mn_close(sock);
+    mn_close(listen_sock);
+    close(peer);
+}
@@ -0,0 +1,125 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "native_sock_test.h"
+
+#define NATIVE_SOCK_TEST_RX_LEN     100
+
+static void
+native_sock_test_rx_check(struct mn_socket *sock)
+{
+    uint8_t data[NATIVE_SOCK_TEST_RX_LEN];
+    struct os_mbuf *m;
+    int rc;
+    int i;
+
+    m = NULL;
+    rc = mn_recvfrom(sock, &m, NULL);
+    TEST_ASSERT_FATAL(rc == 0 && m != NULL);
+    TEST_ASSERT(OS_MBUF_PKTLEN(m) == NATIVE_SOCK_TEST_RX_LEN);
+    rc = os_mbuf_copydata(m, 0, NATIVE_SOCK_TEST_RX_LEN, data);
+    TEST_ASSERT(rc == 0);
+    for (i = 0; i < NATIVE_SOCK_TEST_RX_LEN; i++) {
+        TEST_ASSERT(data[i] == native_sock_test_pattern(i));
+    }
+    os_mbuf_free_chain(m);
+}
+
+/*
+ * Data sent to an idle socket, UDP and TCP, is reported right away;
+ * otherwise it would wait for the next poll, 10 seconds on.
+ */
+void
+native_sock_test_sigio_rx(void)
+{
+    struct mn_socket *listen_sock;
+    struct mn_socket *sock;
+    struct mn_sockaddr_in msin;
+    struct sockaddr_in sin;
+    uint8_t buf[NATIVE_SOCK_TEST_RX_LEN];
+    int ticks;
+    int peer;
+    int rc;
+    int i;
+
+    for (i = 0; i < NATIVE_SOCK_TEST_RX_LEN; i++) {
+        buf[i] = native_sock_test_pattern(i);
+    }
+
+    os_sem_init(&native_sock_test_sem, 0);
+
+    rc = mn_socket(&sock, MN_PF_INET, MN_SOCK_DGRAM, 0);
+    TEST_ASSERT_FATAL(rc == 0);
+    mn_socket_set_cbs(sock, NULL, &native_sock_test_cbs);
+
+    memset(&msin, 0, sizeof(msin));
+    msin.msin_family = MN_PF_INET;
+    msin.msin_len = sizeof(msin);
+    msin.msin_port = htons(NATIVE_SOCK_TEST_PORT + 1);
+    mn_inet_pton(MN_PF_INET, "127.0.0.1", &msin.msin_addr);
+    rc = mn_bind(sock, (struct mn_sockaddr *)&msin);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    peer = socket(AF_INET, SOCK_DGRAM, 0);
+    TEST_ASSERT_FATAL(peer >= 0);
+    memset(&sin, 0, sizeof(sin));
+    sin.sin_family = AF_INET;
+    sin.sin_port = htons(NATIVE_SOCK_TEST_PORT + 1);
+    sin.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    for (i = 0; i < 3; i++) {
+        /* Let the socket task go idle. */
+        os_time_delay(OS_TICKS_PER_SEC / 5);
+
+        native_sock_test_readable = 0;
+        rc = sendto(peer, buf, sizeof(buf), 0, (struct sockaddr *)&sin,
+                    sizeof(sin));
+        TEST_ASSERT_FATAL(rc == sizeof(buf));
+        ticks = native_sock_test_event(&native_sock_test_readable,
+                                       OS_TICKS_PER_SEC * 2);
+        TEST_ASSERT_FATAL(ticks >= 0, "datagram %d not reported", i);
+        TEST_ASSERT(ticks <= OS_TICKS_PER_SEC / 20,
+                    "datagram %d reported after %d ticks", i, ticks);
+        native_sock_test_rx_check(sock);
+    }
+    mn_close(sock);
+    close(peer);
+
+    native_sock_test_tcp_open(&listen_sock, &sock, &peer);
+    for (i = 0; i < 3; i++) {
+        os_time_delay(OS_TICKS_PER_SEC / 5);
+
+        native_sock_test_readable = 0;
+        rc = write(peer, buf, sizeof(buf));
+        TEST_ASSERT_FATAL(rc == sizeof(buf));
+        ticks = native_sock_test_event(&native_sock_test_readable,
+                                       OS_TICKS_PER_SEC * 2);
+        TEST_ASSERT_FATAL(ticks >= 0, "data %d not reported", i);
+        TEST_ASSERT(ticks <= OS_TICKS_PER_SEC / 20,
+                    "data %d reported after %d ticks", i, ticks);
+        native_sock_test_rx_check(sock);
+    }
+    mn_close(sock);
+    mn_close(listen_sock);
+    close(peer);
+}
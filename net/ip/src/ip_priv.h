@@ -20,6 +20,15 @@
 #ifndef __IP_PRIV_H__
 #define __IP_PRIV_H__
 
+/*
+ * lwIP has stats macros of its own with the same names; this code uses
+ * the ones from sys/stats.
+ */
+#undef stats_init
+#undef STATS_INC
+#undef STATS_DEC
+#include "stats/stats.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -34,6 +43,24 @@ void lwip_cli_init(void);
 
 int lwip_err_to_mn_err(int rc);
 
+struct pbuf;
+int lwip_mbuf_init(void);
+struct os_mbuf *lwip_pbuf_to_mbuf(struct pbuf *p, uint16_t usrhdr_len);
+struct pbuf *lwip_mbuf_to_pbuf(struct os_mbuf *m);
+void lwip_mbuf_pbuf_release(struct pbuf *p);
+
+/*
+ * Packets passed between sockets and the stack, and how many bytes of
+ * them had to be copied on the way.
+ */
+STATS_SECT_START(lwip_sock_stats)
+    STATS_SECT_ENTRY(rx_pkt)
+    STATS_SECT_ENTRY(rx_copy_bytes)
+    STATS_SECT_ENTRY(tx_pkt)
+    STATS_SECT_ENTRY(tx_copy_bytes)
+STATS_SECT_END
+extern STATS_SECT_DECL(lwip_sock_stats) lwip_sock_stats;
+
 #ifdef __cplusplus
 }
 #endif
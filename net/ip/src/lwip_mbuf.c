@@ -0,0 +1,258 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include <string.h>
+
+#include "os/mynewt.h"
+
+#include <mn_socket/mn_socket.h>
+
+#include <lwip/pbuf.h>
+#include "ip/lwip_mbuf.h"
+#include "ip_priv.h"
+
+/*
+ * Receive buffers which are msys mbufs underneath. lwIP sees a custom
+ * PBUF_REF pbuf whose payload is the mbuf data area; the pbuf itself lives
+ * in the user header of the mbuf, after room for the source address of
+ * a datagram. When such a pbuf reaches a socket, the mbuf is handed to the
+ * application as is.
+ */
+struct lwip_mbuf_pbuf {
+    struct pbuf_custom lmp_pc;
+    struct os_mbuf *lmp_om;
+};
+
+#define LWIP_MBUF_ADDR_LEN                                              \
+    OS_ALIGN(sizeof(struct mn_sockaddr_in6), sizeof(void *))
+#define LWIP_MBUF_USRHDR_LEN                                            \
+    (LWIP_MBUF_ADDR_LEN + sizeof(struct lwip_mbuf_pbuf))
+
+#if MYNEWT_VAL(LWIP_TX_PBUF_CNT) > 0
+/*
+ * Pbufs referring to data of an outgoing mbuf chain; one per mbuf. Each
+ * frees its mbuf when lwIP is done with it.
+ */
+static struct os_mempool lwip_mbuf_tx_pool;
+#endif
+
+static void
+lwip_mbuf_pbuf_free(struct pbuf *p)
+{
+    struct lwip_mbuf_pbuf *lmp = (struct lwip_mbuf_pbuf *)p;
+
+    os_mbuf_free_chain(lmp->lmp_om);
+}
+
+int
+lwip_mbuf_init(void)
+{
+#if MYNEWT_VAL(LWIP_TX_PBUF_CNT) > 0
+    void *mem;
+
+    mem = os_malloc(OS_MEMPOOL_BYTES(MYNEWT_VAL(LWIP_TX_PBUF_CNT),
+                                     sizeof(struct lwip_mbuf_pbuf)));
+    if (!mem) {
+        return -1;
+    }
+    os_mempool_init(&lwip_mbuf_tx_pool, MYNEWT_VAL(LWIP_TX_PBUF_CNT),
+                    sizeof(struct lwip_mbuf_pbuf), mem, "lwip_txpbuf");
+#endif
+    return 0;
+}
+
+struct pbuf *
+lwip_mbuf_rx_pbuf_alloc(uint16_t len)
+{
+    struct lwip_mbuf_pbuf *lmp;
+    struct os_mbuf *om;
+    struct pbuf *p;
+
+    om = os_msys_get_pkthdr(len, LWIP_MBUF_USRHDR_LEN);
+    if (!om) {
+        return NULL;
+    }
+    lmp = (struct lwip_mbuf_pbuf *)
+      ((uint8_t *)OS_MBUF_USRHDR(om) + LWIP_MBUF_ADDR_LEN);
+    lmp->lmp_om = om;
+    lmp->lmp_pc.custom_free_function = lwip_mbuf_pbuf_free;
+    p = pbuf_alloced_custom(PBUF_RAW, len, PBUF_REF, &lmp->lmp_pc,
+                            om->om_data, OS_MBUF_TRAILINGSPACE(om));
+    if (!p) {
+        /* Data does not fit in a single mbuf. */
+        os_mbuf_free_chain(om);
+    }
+    return p;
+}
+
+static struct os_mbuf *
+lwip_pbuf_mbuf(struct pbuf *p)
+{
+    struct pbuf_custom *pc = (struct pbuf_custom *)p;
+
+    if (!(p->flags & PBUF_FLAG_IS_CUSTOM) || p->ref != 1 ||
+      pc->custom_free_function != lwip_mbuf_pbuf_free) {
+        return NULL;
+    }
+    return ((struct lwip_mbuf_pbuf *)pc)->lmp_om;
+}
+
+/*
+ * Moves data from received pbuf chain to an mbuf chain with packet
+ * header and user header of usrhdr_len bytes. The pbuf chain is consumed
+ * unless NULL is returned.
+ */
+struct os_mbuf *
+lwip_pbuf_to_mbuf(struct pbuf *p, uint16_t usrhdr_len)
+{
+    struct os_mbuf *head;
+    struct os_mbuf *prev;
+    struct os_mbuf *om;
+    struct pbuf *q;
+    int off;
+
+    if (usrhdr_len <= LWIP_MBUF_ADDR_LEN) {
+        for (q = p; q; q = q->next) {
+            if (!lwip_pbuf_mbuf(q)) {
+                break;
+            }
+        }
+        if (!q) {
+            /*
+             * All data is in mbufs, just point them at the payload. The pbufs
+             * are inside the mbufs, so after this they're gone.
+             */
+            head = NULL;
+            prev = NULL;
+            for (q = p; q; q = q->next) {
+                om = lwip_pbuf_mbuf(q);
+                om->om_data = q->payload;
+                om->om_len = q->len;
+                if (!head) {
+                    head = om;
+                    OS_MBUF_PKTHDR(head)->omp_len = p->tot_len;
+                } else {
+                    om->om_pkthdr_len = 0;
+                    SLIST_NEXT(prev, om_next) = om;
+                }
+                prev = om;
+            }
+            return head;
+        }
+    }
+
+    head = os_msys_get_pkthdr(p->tot_len, usrhdr_len);
+    if (!head) {
+        return NULL;
+    }
+    STATS_INCN(lwip_sock_stats, rx_copy_bytes, p->tot_len);
+    off = 0;
+    for (q = p; q; q = q->next) {
+        if (os_mbuf_copyinto(head, off, q->payload, q->len)) {
+            os_mbuf_free_chain(head);
+            return NULL;
+        }
+        off += q->len;
+    }
+    pbuf_free(p);
+    return head;
+}
+
+#if MYNEWT_VAL(LWIP_TX_PBUF_CNT) > 0
+static void
+lwip_mbuf_tx_pbuf_free(struct pbuf *p)
+{
+    struct lwip_mbuf_pbuf *lmp = (struct lwip_mbuf_pbuf *)p;
+
+    if (lmp->lmp_om) {
+        os_mbuf_free(lmp->lmp_om);
+    }
+    os_memblock_put(&lwip_mbuf_tx_pool, lmp);
+}
+#endif
+
+/*
+ * Returns a PBUF_REF chain referring to data in mbuf chain m, without
+ * copying. When lwIP frees the pbufs, the mbufs get freed with them.
+ * Returns NULL if there are not enough pbufs for this; m is left as is.
+ */
+struct pbuf *
+lwip_mbuf_to_pbuf(struct os_mbuf *m)
+{
+#if MYNEWT_VAL(LWIP_TX_PBUF_CNT) > 0
+    struct lwip_mbuf_pbuf *lmp;
+    struct lwip_mbuf_pbuf *free_list;
+    struct os_mbuf *om;
+    struct pbuf *head;
+    struct pbuf *p;
+
+    /*
+     * Get all the pbufs first; the mbufs are owned by them once they're
+     * bound.
+     */
+    free_list = NULL;
+    for (om = m; om; om = SLIST_NEXT(om, om_next)) {
+        lmp = os_memblock_get(&lwip_mbuf_tx_pool);
+        if (!lmp) {
+            while ((lmp = free_list)) {
+                free_list = (struct lwip_mbuf_pbuf *)lmp->lmp_om;
+                os_memblock_put(&lwip_mbuf_tx_pool, lmp);
+            }
+            return NULL;
+        }
+        lmp->lmp_om = (struct os_mbuf *)free_list;
+        free_list = lmp;
+    }
+
+    head = NULL;
+    for (om = m; om; om = SLIST_NEXT(om, om_next)) {
+        lmp = free_list;
+        free_list = (struct lwip_mbuf_pbuf *)lmp->lmp_om;
+
+        lmp->lmp_om = om;
+        lmp->lmp_pc.custom_free_function = lwip_mbuf_tx_pbuf_free;
+        p = pbuf_alloced_custom(PBUF_RAW, om->om_len, PBUF_REF, &lmp->lmp_pc,
+                                om->om_data, om->om_len);
+        if (!head) {
+            head = p;
+        } else {
+            pbuf_cat(head, p);
+        }
+    }
+    return head;
+#else
+    return NULL;
+#endif
+}
+
+/*
+ * Frees a chain from lwip_mbuf_to_pbuf() without freeing the mbufs; used
+ * when the stack did not take the data.
+ */
+void
+lwip_mbuf_pbuf_release(struct pbuf *p)
+{
+#if MYNEWT_VAL(LWIP_TX_PBUF_CNT) > 0
+    struct pbuf *q;
+
+    for (q = p; q; q = q->next) {
+        ((struct lwip_mbuf_pbuf *)q)->lmp_om = NULL;
+    }
+    pbuf_free(p);
+#endif
+}
@@ -82,6 +82,14 @@ struct lwip_sock {
 
 static struct os_mempool lwip_sockets;
 
+STATS_SECT_DECL(lwip_sock_stats) lwip_sock_stats;
+STATS_NAME_START(lwip_sock_stats)
+    STATS_NAME(lwip_sock_stats, rx_pkt)
+    STATS_NAME(lwip_sock_stats, rx_copy_bytes)
+    STATS_NAME(lwip_sock_stats, tx_pkt)
+    STATS_NAME(lwip_sock_stats, tx_copy_bytes)
+STATS_NAME_END(lwip_sock_stats)
+
 static int lwip_stream_tx(struct lwip_sock *s, int notify);
 
 static int
@@ -184,21 +192,15 @@ lwip_sock_udp_rx(void *arg, struct udp_pcb *pcb, struct pbuf *p,
 {
     struct lwip_sock *s = (struct lwip_sock *)arg;
     struct os_mbuf *m;
-    struct pbuf *q;
-    int off;
 
-    m = os_msys_get_pkthdr(p->tot_len, sizeof(struct mn_sockaddr_in6));
+    m = lwip_pbuf_to_mbuf(p, sizeof(struct mn_sockaddr_in6));
     if (!m) {
         pbuf_free(p);
         return;
     }
     lwip_addr_to_mn_addr((struct mn_sockaddr *)OS_MBUF_USRHDR(m),
       addr, port);
-    off = 0;
-    for (q = p; q; q = q->next) {
-        os_mbuf_copyinto(m, off, q->payload, p->len);
-    }
-    pbuf_free(p);
+    STATS_INC(lwip_sock_stats, rx_pkt);
     STAILQ_INSERT_TAIL(&s->ls_rx, OS_MBUF_PKTHDR(m), omp_next);
     mn_socket_readable(&s->ls_sock, 0);
 }
@@ -210,8 +212,6 @@ lwip_sock_tcp_rx(void *arg, struct tcp_pcb *pcb, struct pbuf *p, err_t err)
 {
     struct lwip_sock *s = (struct lwip_sock *)arg;
     struct os_mbuf *m;
-    struct pbuf *q;
-    int off;
 
     if (!p) {
         /*
@@ -220,14 +220,12 @@ lwip_sock_tcp_rx(void *arg, struct tcp_pcb *pcb, struct pbuf *p, err_t err)
         mn_socket_readable(&s->ls_sock, MN_ECONNABORTED);
         return ERR_OK;
     }
-    m = os_msys_get_pkthdr(p->tot_len, 0);
-    assert(m);
-    /* XXX fix this */
-    off = 0;
-    for (q = p; q; q = q->next) {
-        os_mbuf_copyinto(m, off, q->payload, p->len);
+    m = lwip_pbuf_to_mbuf(p, 0);
+    if (!m) {
+        /* lwIP holds on to the data, and gives it to us again later. */
+        return ERR_MEM;
     }
-    pbuf_free(p);
+    STATS_INC(lwip_sock_stats, rx_pkt);
     STAILQ_INSERT_TAIL(&s->ls_rx, OS_MBUF_PKTHDR(m), omp_next);
     mn_socket_readable(&s->ls_sock, 0);
 
@@ -257,6 +255,11 @@ lwip_sock_tcp_err(void *arg, err_t err)
 {
     struct lwip_sock *s = (struct lwip_sock *)arg;
 
+    /*
+     * lwIP has freed the pcb already. Data received before the error
+     * can still be read from the socket.
+     */
+    s->ls_pcb.tcp = NULL;
     mn_socket_writable(&s->ls_sock, lwip_err_to_mn_err(err));
 }
 
@@ -349,6 +352,10 @@ lwip_close(struct mn_socket *ms)
 #endif
 #if LWIP_TCP
     case MN_SOCK_STREAM:
+        if (!s->ls_pcb.tcp) {
+            /* Connection was reset or aborted. */
+            break;
+        }
         tcp_recv(s->ls_pcb.tcp, NULL);
         tcp_sent(s->ls_pcb.tcp, NULL);
         tcp_err(s->ls_pcb.tcp, NULL);
@@ -392,6 +399,10 @@ lwip_connect(struct mn_socket *ms, struct mn_sockaddr *addr)
 #endif
 #if LWIP_TCP
     case MN_SOCK_STREAM:
+        if (!s->ls_pcb.tcp) {
+            rc = MN_EINVAL;
+            break;
+        }
         rc = tcp_connect(s->ls_pcb.tcp, &ip, port, lwip_sock_tcp_connected);
         rc = lwip_err_to_mn_err(rc);
         break;
@@ -426,6 +437,10 @@ lwip_bind(struct mn_socket *ms, struct mn_sockaddr *addr)
 #endif
 #if LWIP_TCP
     case MN_SOCK_STREAM:
+        if (!s->ls_pcb.tcp) {
+            rc = MN_EINVAL;
+            break;
+        }
         rc = tcp_bind(s->ls_pcb.tcp, &ip, port);
         rc = lwip_err_to_mn_err(rc);
         break;
@@ -445,6 +460,9 @@ lwip_listen(struct mn_socket *ms, uint8_t qlen)
     struct tcp_pcb *pcb;
 
     if (s->ls_type == MN_SOCK_STREAM) {
+        if (!s->ls_pcb.tcp) {
+            return MN_EINVAL;
+        }
         LOCK_TCPIP_CORE();
         pcb = tcp_listen_with_backlog(s->ls_pcb.tcp, qlen);
         UNLOCK_TCPIP_CORE();
@@ -472,10 +490,17 @@ lwip_stream_tx(struct lwip_sock *s, int notify)
         n = SLIST_NEXT(m, om_next);
         rc = tcp_write(s->ls_pcb.tcp, m->om_data, m->om_len, 0);
         if (rc == 0) {
+            /* lwIP copies, LWIP_NETIF_TX_SINGLE_PBUF is set. */
+            STATS_INCN(lwip_sock_stats, tx_copy_bytes, m->om_len);
             s->ls_tx = n;
             os_mbuf_free(m);
         }
     }
+    /*
+     * tcp_write() only queues. Send now instead of waiting for the next
+     * incoming segment or tcp timer.
+     */
+    tcp_output(s->ls_pcb.tcp);
     if (rc) {
         if (rc == ERR_MEM) {
             rc = 0;
@@ -515,6 +540,22 @@ lwip_sendto(struct mn_socket *ms, struct os_mbuf *m,
         if (rc) {
             return rc;
         }
+        p = lwip_mbuf_to_pbuf(m);
+        if (p) {
+            LOCK_TCPIP_CORE();
+            rc = udp_sendto(s->ls_pcb.udp, p, &ip_addr, port);
+            UNLOCK_TCPIP_CORE();
+            if (rc) {
+                /* Caller keeps the mbufs. */
+                lwip_mbuf_pbuf_release(p);
+                return lwip_err_to_mn_err(rc);
+            }
+            /* mbufs are freed with the pbufs, maybe later. */
+            pbuf_free(p);
+            STATS_INC(lwip_sock_stats, tx_pkt);
+            return 0;
+        }
+
         off = 0;
         for (n = m; n; n = SLIST_NEXT(n, om_next)) {
             off += n->om_len;
@@ -532,25 +573,30 @@ lwip_sendto(struct mn_socket *ms, struct os_mbuf *m,
         LOCK_TCPIP_CORE();
         rc = udp_sendto(s->ls_pcb.udp, p, &ip_addr, port);
         UNLOCK_TCPIP_CORE();
+        pbuf_free(p);
         if (rc) {
-            rc = lwip_err_to_mn_err(rc);
-            pbuf_free(p);
-            return rc;
+            return lwip_err_to_mn_err(rc);
         }
+        STATS_INC(lwip_sock_stats, tx_pkt);
+        STATS_INCN(lwip_sock_stats, tx_copy_bytes, off);
         os_mbuf_free_chain(m);
         return 0;
 #endif
 #if LWIP_TCP
     case MN_SOCK_STREAM:
-        if (s->ls_tx) {
-            return MN_EAGAIN;
-        }
         if (addr) {
             return MN_EINVAL;
         }
         LOCK_TCPIP_CORE();
-        s->ls_tx = m;
-        rc = lwip_stream_tx(s, 0);
+        if (!s->ls_pcb.tcp) {
+            rc = MN_ENOTCONN;
+        } else if (s->ls_tx) {
+            rc = MN_EAGAIN;
+        } else {
+            STATS_INC(lwip_sock_stats, tx_pkt);
+            s->ls_tx = m;
+            rc = lwip_stream_tx(s, 0);
+        }
         UNLOCK_TCPIP_CORE();
         return rc;
 #endif
@@ -576,6 +622,12 @@ lwip_recvfrom(struct mn_socket *ms, struct os_mbuf **mp,
     }
     if (m) {
         *mp = OS_MBUF_PKTHDR_TO_MBUF(m);
+#if LWIP_TCP
+        if (s->ls_type == MN_SOCK_STREAM && s->ls_pcb.tcp) {
+            /* Data is out of the stack now, open up the window. */
+            tcp_recved(s->ls_pcb.tcp, m->omp_len);
+        }
+#endif
         if (addr) {
             if (s->ls_type == MN_SOCK_DGRAM) {
                 ms_a = (struct mn_sockaddr *)(m + 1);
@@ -587,8 +639,10 @@ lwip_recvfrom(struct mn_socket *ms, struct os_mbuf **mp,
                 memcpy(addr, ms_a, slen);
             } else {
 #if LWIP_TCP
-                lwip_addr_to_mn_addr(addr, &s->ls_pcb.ip->local_ip,
-                                     s->ls_pcb.tcp->local_port);
+                if (s->ls_pcb.tcp) {
+                    lwip_addr_to_mn_addr(addr, &s->ls_pcb.ip->local_ip,
+                                         s->ls_pcb.tcp->local_port);
+                }
 #endif
             }
         }
@@ -681,12 +735,18 @@ lwip_getsockname(struct mn_socket *ms, struct mn_sockaddr *addr)
         lwip_addr_to_mn_addr(addr, &s->ls_pcb.ip->local_ip,
                              s->ls_pcb.udp->local_port);
         rc = 0;
+        break;
 #endif
 #if LWIP_TCP
     case MN_SOCK_STREAM:
+        if (!s->ls_pcb.tcp) {
+            rc = MN_ENOTCONN;
+            break;
+        }
         lwip_addr_to_mn_addr(addr, &s->ls_pcb.ip->local_ip,
                              s->ls_pcb.tcp->local_port);
         rc = 0;
+        break;
 #endif
     default:
         break;
@@ -709,12 +769,18 @@ lwip_getpeername(struct mn_socket *ms, struct mn_sockaddr *addr)
         lwip_addr_to_mn_addr(addr, &s->ls_pcb.ip->remote_ip,
                              s->ls_pcb.udp->remote_port);
         rc = 0;
+        break;
 #endif
 #if LWIP_TCP
     case MN_SOCK_STREAM:
+        if (!s->ls_pcb.tcp) {
+            rc = MN_ENOTCONN;
+            break;
+        }
         lwip_addr_to_mn_addr(addr, &s->ls_pcb.ip->remote_ip,
                              s->ls_pcb.tcp->remote_port);
         rc = 0;
+        break;
 #endif
     default:
         break;
@@ -737,6 +803,18 @@ lwip_socket_init(void)
     }
     os_mempool_init(&lwip_sockets, cnt, sizeof(struct lwip_sock), mem, "sock");
 
+    rc = lwip_mbuf_init();
+    if (rc) {
+        return -1;
+    }
+
+    rc = stats_init_and_reg(STATS_HDR(lwip_sock_stats),
+      STATS_SIZE_INIT_PARMS(lwip_sock_stats, STATS_SIZE_32),
+      STATS_NAME_INIT_PARMS(lwip_sock_stats), "lwip_sock");
+    if (rc) {
+        return -1;
+    }
+
     rc = mn_socket_ops_reg(&lwip_sock_ops);
     if (rc) {
         return -1;
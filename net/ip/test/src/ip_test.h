@@ -0,0 +1,74 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#ifndef H_IP_TEST_
+#define H_IP_TEST_
+
+#include "os/mynewt.h"
+#include "testutil/testutil.h"
+#include "mn_socket/mn_socket.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Two interfaces, 10.0.0.1/24 and 10.0.0.2/32, wired back to back. Frames
+ * sent towards 10.0.0.2 are received into msys backed pbufs, the way a
+ * network driver using lwip_mbuf_rx_pbuf_alloc() would, unless
+ * ip_test_rx_mbuf is cleared.
+ */
+#define IP_TEST_ADDR_SRV        "10.0.0.1"
+#define IP_TEST_ADDR_CLI        "10.0.0.2"
+
+extern int ip_test_rx_mbuf;
+
+/*
+ * Transmit failure and completion, see ip_test_nif_output().
+ */
+struct pbuf;
+extern int ip_test_tx_err;
+extern int ip_test_tx_hold;
+extern struct pbuf *ip_test_tx_held;
+
+/*
+ * Socket events; each one releases ip_test_sem.
+ */
+extern struct os_sem ip_test_sem;
+extern int ip_test_readable_err;
+extern int ip_test_writable_err;
+extern union mn_socket_cb ip_test_sock_cbs;
+
+void ip_test_nif_init(void);
+void ip_test_wait(void);
+void ip_test_tcp_pair(struct mn_socket **listen_sock,
+                      struct mn_socket **srv_sock,
+                      struct mn_socket **cli_sock, uint16_t port);
+struct os_mbuf *ip_test_data(int off, int len);
+int ip_test_data_check(struct os_mbuf *m, int off);
+
+void ip_test_tcp_bulk(void);
+void ip_test_tcp_reset(void);
+void ip_test_tcp_speed(void);
+void ip_test_udp_ref(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,211 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include <stdio.h>
+#include <lwip/tcp.h>
+#include "ip_priv.h"
+#include "ip_test.h"
+
+#define IP_TEST_BULK_BYTES      (32 * 1024)
+#define IP_TEST_BULK_CHUNK      1024
+#define IP_TEST_RESET_BYTES     100
+#define IP_TEST_SPEED_BYTES     (1024 * 1024)
+/* Full segments, so that Nagle does not wait for delayed acks. */
+#define IP_TEST_SPEED_CHUNK     TCP_MSS
+
+/*
+ * Server sends 'bytes' to the client, 'chunk' bytes at a time; the client
+ * checks the data as it reads.
+ */
+static void
+ip_test_tcp_xfer(struct mn_socket *srv_sock, struct mn_socket *cli_sock,
+                 int bytes, int chunk)
+{
+    struct os_mbuf *m;
+    int moved;
+    int sent;
+    int rcvd;
+    int len;
+    int rc;
+
+    sent = 0;
+    rcvd = 0;
+    while (rcvd < bytes) {
+        moved = 0;
+        if (sent < bytes) {
+            len = min(bytes - sent, chunk);
+            m = ip_test_data(sent, len);
+            rc = mn_sendto(srv_sock, m, NULL);
+            if (rc == 0) {
+                sent += len;
+                moved = 1;
+            } else {
+                TEST_ASSERT_FATAL(rc == MN_EAGAIN, "mn_sendto %d", rc);
+                os_mbuf_free_chain(m);
+            }
+        }
+        while (mn_recvfrom(cli_sock, &m, NULL) == 0) {
+            rcvd += ip_test_data_check(m, rcvd);
+            moved = 1;
+        }
+        if (!moved) {
+            ip_test_wait();
+        }
+    }
+    TEST_ASSERT(sent == bytes);
+    TEST_ASSERT(rcvd == bytes);
+}
+
+/*
+ * Server sends several receive windows worth of data. The client only
+ * gets it all if reading the data reopens the window, and none of it
+ * should be copied on the way up.
+ */
+void
+ip_test_tcp_bulk(void)
+{
+    struct mn_socket *listen_sock;
+    struct mn_socket *srv_sock;
+    struct mn_socket *cli_sock;
+    uint32_t rx_pkt;
+    uint32_t rx_copy_bytes;
+
+    TEST_ASSERT_FATAL(IP_TEST_BULK_BYTES > 4 * TCP_WND);
+
+    ip_test_tcp_pair(&listen_sock, &srv_sock, &cli_sock, 5001);
+
+    rx_pkt = STATS_GET(lwip_sock_stats, rx_pkt);
+    rx_copy_bytes = STATS_GET(lwip_sock_stats, rx_copy_bytes);
+
+    ip_test_tcp_xfer(srv_sock, cli_sock, IP_TEST_BULK_BYTES,
+                     IP_TEST_BULK_CHUNK);
+
+    TEST_ASSERT(STATS_GET(lwip_sock_stats, rx_pkt) > rx_pkt);
+    rx_copy_bytes = STATS_GET(lwip_sock_stats, rx_copy_bytes) - rx_copy_bytes;
+    TEST_ASSERT(rx_copy_bytes == 0, "%u bytes copied", (unsigned)rx_copy_bytes);
+
+    mn_close(cli_sock);
+    mn_close(srv_sock);
+    mn_close(listen_sock);
+}
+
+/*
+ * Server closes with data it has not read, which makes lwIP reset the
+ * connection. lwIP frees the client's pcb when the reset arrives; data
+ * queued on the client socket must still be readable, and nothing may
+ * touch the freed pcb.
+ */
+void
+ip_test_tcp_reset(void)
+{
+    struct mn_socket *listen_sock;
+    struct mn_socket *srv_sock;
+    struct mn_socket *cli_sock;
+    struct mn_sockaddr_in msin;
+    struct os_mbuf *m;
+    int rc;
+
+    ip_test_tcp_pair(&listen_sock, &srv_sock, &cli_sock, 5002);
+
+    /* Data both ways; neither side reads it yet. */
+    rc = mn_sendto(cli_sock, ip_test_data(0, IP_TEST_RESET_BYTES), NULL);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = mn_sendto(srv_sock, ip_test_data(0, IP_TEST_RESET_BYTES), NULL);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    /* Let the data and acks go through, and drop the events. */
+    os_time_delay(OS_TICKS_PER_SEC / 10);
+    while (os_sem_pend(&ip_test_sem, 0) == 0) {
+    }
+
+    ip_test_writable_err = 0;
+    mn_close(srv_sock);
+    while (ip_test_writable_err == 0) {
+        ip_test_wait();
+    }
+    TEST_ASSERT(ip_test_writable_err == MN_ECONNABORTED,
+                "writable err %d", ip_test_writable_err);
+
+    rc = mn_recvfrom(cli_sock, &m, (struct mn_sockaddr *)&msin);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(ip_test_data_check(m, 0) == IP_TEST_RESET_BYTES);
+
+    rc = mn_recvfrom(cli_sock, &m, NULL);
+    TEST_ASSERT(rc == MN_EAGAIN);
+    TEST_ASSERT(m == NULL);
+
+    m = ip_test_data(0, IP_TEST_RESET_BYTES);
+    rc = mn_sendto(cli_sock, m, NULL);
+    TEST_ASSERT(rc == MN_ENOTCONN);
+    os_mbuf_free_chain(m);
+
+    rc = mn_getpeername(cli_sock, (struct mn_sockaddr *)&msin);
+    TEST_ASSERT(rc == MN_ENOTCONN);
+    rc = mn_getsockname(cli_sock, (struct mn_sockaddr *)&msin);
+    TEST_ASSERT(rc == MN_ENOTCONN);
+
+    rc = mn_close(cli_sock);
+    TEST_ASSERT(rc == 0);
+    mn_close(listen_sock);
+}
+
+/*
+ * iperf style timed transfer, with the client receiving into msys backed
+ * pbufs and then into the pbuf pool; reports the throughput of each.
+ */
+void
+ip_test_tcp_speed(void)
+{
+    struct mn_socket *listen_sock;
+    struct mn_socket *srv_sock;
+    struct mn_socket *cli_sock;
+    uint32_t rx_copy_bytes;
+    int64_t usecs;
+    int rx_mbuf;
+
+    for (rx_mbuf = 1; rx_mbuf >= 0; rx_mbuf--) {
+        ip_test_rx_mbuf = rx_mbuf;
+        ip_test_tcp_pair(&listen_sock, &srv_sock, &cli_sock,
+                         5003 + rx_mbuf);
+
+        rx_copy_bytes = STATS_GET(lwip_sock_stats, rx_copy_bytes);
+        usecs = os_get_uptime_usec();
+
+        ip_test_tcp_xfer(srv_sock, cli_sock, IP_TEST_SPEED_BYTES,
+                         IP_TEST_SPEED_CHUNK);
+
+        usecs = os_get_uptime_usec() - usecs;
+        if (usecs == 0) {
+            usecs = 1;
+        }
+        rx_copy_bytes = STATS_GET(lwip_sock_stats, rx_copy_bytes) -
+                        rx_copy_bytes;
+        TEST_ASSERT(rx_copy_bytes == (rx_mbuf ? 0 : IP_TEST_SPEED_BYTES),
+                    "%u bytes copied", (unsigned)rx_copy_bytes);
+
+        printf("tcp rx %s: %d bytes in %lu usec, %lu KB/s\n",
+               rx_mbuf ? "zero-copy" : "copied", IP_TEST_SPEED_BYTES,
+               (unsigned long)usecs,
+               (unsigned long)(IP_TEST_SPEED_BYTES * 1000000LL / 1024 / usecs));
+
+        mn_close(cli_sock);
+        mn_close(srv_sock);
+        mn_close(listen_sock);
+    }
+    ip_test_rx_mbuf = 1;
+}
@@ -0,0 +1,132 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include <string.h>
+#include <lwip/tcpip.h>
+#include <lwip/pbuf.h>
+#include "ip_priv.h"
+#include "ip_test.h"
+
+#define IP_TEST_UDP_PORT        5010
+#define IP_TEST_UDP_BYTES       1000
+
+static struct os_mbuf *
+ip_test_udp_recv(struct mn_socket *sock)
+{
+    struct mn_sockaddr_in msin;
+    struct os_mbuf *m;
+    int rc;
+
+    while (1) {
+        rc = mn_recvfrom(sock, &m, (struct mn_sockaddr *)&msin);
+        if (rc != MN_EAGAIN) {
+            break;
+        }
+        ip_test_wait();
+    }
+    TEST_ASSERT_FATAL(rc == 0);
+    return m;
+}
+
+/*
+ * Datagrams sent from an mbuf chain go out in PBUF_REF pbufs pointing at
+ * the mbufs. The mbufs go back to msys only once the driver is done with
+ * the frame; if the send fails, the caller still owns them and the pbufs
+ * go back to their pool.
+ */
+void
+ip_test_udp_ref(void)
+{
+    struct mn_sockaddr_in msin;
+    struct mn_socket *srv_sock;
+    struct mn_socket *cli_sock;
+    struct os_mbuf *m;
+    uint32_t tx_copy_bytes;
+    int msys_free;
+    int msys_used;
+    int rc;
+    int i;
+
+    os_sem_init(&ip_test_sem, 0);
+
+    rc = mn_socket(&srv_sock, MN_PF_INET, MN_SOCK_DGRAM, 0);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = mn_socket(&cli_sock, MN_PF_INET, MN_SOCK_DGRAM, 0);
+    TEST_ASSERT_FATAL(rc == 0);
+    mn_socket_set_cbs(cli_sock, NULL, &ip_test_sock_cbs);
+
+    memset(&msin, 0, sizeof(msin));
+    msin.msin_family = MN_PF_INET;
+    msin.msin_len = sizeof(msin);
+    mn_inet_pton(MN_PF_INET, IP_TEST_ADDR_SRV, &msin.msin_addr);
+    rc = mn_bind(srv_sock, (struct mn_sockaddr *)&msin);
+    TEST_ASSERT_FATAL(rc == 0);
+    msin.msin_port = htons(IP_TEST_UDP_PORT);
+    mn_inet_pton(MN_PF_INET, IP_TEST_ADDR_CLI, &msin.msin_addr);
+    rc = mn_bind(cli_sock, (struct mn_sockaddr *)&msin);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    tx_copy_bytes = STATS_GET(lwip_sock_stats, tx_copy_bytes);
+    msys_free = os_msys_num_free();
+
+    /* Held by the driver; the mbufs stay out of msys until it lets go. */
+    m = ip_test_data(0, IP_TEST_UDP_BYTES);
+    TEST_ASSERT_FATAL(SLIST_NEXT(m, om_next) != NULL);
+    msys_used = msys_free - os_msys_num_free();
+
+    ip_test_tx_hold = 1;
+    rc = mn_sendto(srv_sock, m, (struct mn_sockaddr *)&msin);
+    ip_test_tx_hold = 0;
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT_FATAL(ip_test_tx_held != NULL);
+
+    m = ip_test_udp_recv(cli_sock);
+    TEST_ASSERT(ip_test_data_check(m, 0) == IP_TEST_UDP_BYTES);
+    TEST_ASSERT(os_msys_num_free() == msys_free - msys_used);
+
+    LOCK_TCPIP_CORE();
+    pbuf_free(ip_test_tx_held);
+    UNLOCK_TCPIP_CORE();
+    ip_test_tx_held = NULL;
+    TEST_ASSERT(os_msys_num_free() == msys_free);
+
+    /*
+     * Failed sends leave the mbufs with the caller. Enough of them to use
+     * up the pbufs several times over, if they were not given back.
+     */
+    m = ip_test_data(0, IP_TEST_UDP_BYTES);
+    ip_test_tx_err = ERR_MEM;
+    for (i = 0; i < MYNEWT_VAL(LWIP_TX_PBUF_CNT); i++) {
+        rc = mn_sendto(srv_sock, m, (struct mn_sockaddr *)&msin);
+        TEST_ASSERT_FATAL(rc == MN_ENOBUFS, "rc %d", rc);
+        TEST_ASSERT(os_msys_num_free() == msys_free - msys_used);
+    }
+    ip_test_tx_err = 0;
+
+    /* The pbufs are all back, so this one is not copied either. */
+    rc = mn_sendto(srv_sock, m, (struct mn_sockaddr *)&msin);
+    TEST_ASSERT_FATAL(rc == 0);
+    m = ip_test_udp_recv(cli_sock);
+    TEST_ASSERT(ip_test_data_check(m, 0) == IP_TEST_UDP_BYTES);
+    TEST_ASSERT(os_msys_num_free() == msys_free);
+
+    TEST_ASSERT(STATS_GET(lwip_sock_stats, tx_copy_bytes) == tx_copy_bytes);
+
+    mn_close(cli_sock);
+    mn_close(srv_sock);
+}
@@ -303,6 +303,9 @@ uint16_t coap_tcp_msg_size(uint8_t *hdr, int datalen);
 void coap_init_message(coap_packet_t *, coap_message_type_t type,
                        uint8_t code, uint16_t mid);
 int coap_serialize_message(coap_packet_t *, struct os_mbuf *m);
+int coap_serialize_body(coap_packet_t *, struct os_mbuf *m);
+int coap_serialize_message_body(coap_packet_t *, struct os_mbuf *m,
+                                struct os_mbuf *body);
 void coap_send_message(struct os_mbuf *m, int dup);
 coap_status_t coap_parse_message(struct coap_packet_rx *request,
                                  struct os_mbuf **mp);
@@ -48,6 +48,7 @@ extern "C" {
 
 typedef struct coap_observer {
   SLIST_ENTRY(coap_observer) next;
+  SLIST_ENTRY(coap_observer) res_next; /* observers of the same resource */
 
   oc_resource_t *resource;
 
@@ -68,6 +69,7 @@ int coap_remove_observer_by_token(oc_endpoint_t *endpoint, uint8_t *token,
                                   size_t token_len);
 int coap_remove_observer_by_uri(oc_endpoint_t *endpoint, const char *uri);
 int coap_remove_observer_by_mid(oc_endpoint_t *endpoint, uint16_t mid);
+int coap_remove_observer_by_resource(oc_resource_t *resource);
 
 int coap_notify_observers(oc_resource_t *resource,
                           struct oc_response_buffer *response_buf,
@@ -78,6 +80,7 @@ int coap_observe_handler(struct coap_packet_rx *req, coap_packet_t *response,
                          oc_resource_t *resource, oc_endpoint_t *endpoint);
 
 void coap_observe_init(void);
+void coap_observe_resource_init(oc_resource_t *resource);
 
 #ifdef __cplusplus
 }
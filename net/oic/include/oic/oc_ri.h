@@ -30,6 +30,7 @@ extern "C" {
 struct oc_separate_response;
 struct oc_response_buffer;
 struct oc_endpoint;
+struct coap_observer;
 
 typedef struct oc_response {
     struct oc_separate_response *separate_response;
@@ -61,6 +62,15 @@ typedef struct oc_resource {
   oc_request_handler_t delete_handler;
   struct os_callout callout;
   uint32_t observe_period_mseconds;
+  SLIST_HEAD(, coap_observer) observers;
+#if MYNEWT_VAL(OC_APP_RES_HASH_SIZE)
+  SLIST_ENTRY(oc_resource) hash_next;
+  uint32_t uri_hash;
+#endif
+#if MYNEWT_VAL(OC_NOTIFY_MIN_ITVL)
+  struct os_callout notify_callout;
+  os_time_t notify_time;
+#endif
   uint8_t num_observers;
 } oc_resource_t;
 
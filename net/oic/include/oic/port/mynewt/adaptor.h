@@ -24,8 +24,17 @@
 extern "C" {
 #endif
 
+struct os_eventq;
+struct os_mbuf;
+
 struct os_eventq *oc_evq_get(void);
 
+/*
+ * Returns a copy of m for sending the same packet on one more interface.
+ * Shares the data with m, instead of copying it, if OS_MBUF_CLONE is enabled.
+ */
+struct os_mbuf *oc_mbuf_clone(struct os_mbuf *m);
+
 #ifdef __cplusplus
 }
 #endif
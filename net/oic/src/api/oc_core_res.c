@@ -19,6 +19,7 @@
 #include "oic/port/mynewt/config.h"
 #include "oic/oc_core_res.h"
 #include "oic/messaging/coap/oc_coap.h"
+#include "oic/messaging/coap/observe.h"
 #include "oic/oc_rep.h"
 #include "oic/oc_ri.h"
 
@@ -273,6 +274,9 @@ oc_core_populate_resource(int type, const char *uri, const char *rt,
     r->put_handler = put;
     r->post_handler = post;
     r->delete_handler = delete;
+#ifdef OC_SERVER
+    coap_observe_resource_init(r);
+#endif
 }
 
 oc_uuid_t *
@@ -50,6 +50,14 @@ static struct os_mempool oc_resource_pool;
 static uint8_t oc_resource_area[OS_MEMPOOL_BYTES(MAX_APP_RESOURCES,
       sizeof(oc_resource_t))];
 
+#if MYNEWT_VAL(OC_APP_RES_HASH_SIZE)
+/*
+ * Application resources, hashed by their URI without the leading '/'.
+ */
+static SLIST_HEAD(oc_res_bucket, oc_resource)
+    oc_app_res_hash[MYNEWT_VAL(OC_APP_RES_HASH_SIZE)];
+#endif
+
 static void periodic_observe_handler(struct os_event *ev);
 #endif /* OC_SERVER */
 
@@ -191,19 +199,75 @@ stop_processes(void)
 }
 
 #ifdef OC_SERVER
-oc_resource_t *
-oc_ri_get_app_resource_by_uri(const char *uri)
+#if MYNEWT_VAL(OC_APP_RES_HASH_SIZE)
+/*
+ * FNV-1a.
+ */
+static uint32_t
+oc_ri_uri_hash(const char *path, int len)
+{
+    uint32_t hash;
+
+    hash = 2166136261U;
+    while (len-- > 0) {
+        hash ^= (uint8_t)*path++;
+        hash *= 16777619U;
+    }
+    return hash;
+}
+
+static struct oc_res_bucket *
+oc_ri_uri_bucket(uint32_t hash)
+{
+    return &oc_app_res_hash[hash % MYNEWT_VAL(OC_APP_RES_HASH_SIZE)];
+}
+#endif
+
+/*
+ * Finds application resource by request path, which is the URI without
+ * the leading '/'.
+ */
+static oc_resource_t *
+oc_ri_find_app_resource(const char *path, int len)
 {
     oc_resource_t *res;
+#if MYNEWT_VAL(OC_APP_RES_HASH_SIZE)
+    uint32_t hash;
 
+    hash = oc_ri_uri_hash(path, len);
+    SLIST_FOREACH(res, oc_ri_uri_bucket(hash), hash_next) {
+        if (res->uri_hash == hash && oc_string_len(res->uri) == len + 1 &&
+          memcmp(oc_string(res->uri) + 1, path, len) == 0) {
+            return res;
+        }
+    }
+#else
     SLIST_FOREACH(res, &oc_app_resources, next) {
-        if (oc_string_len(res->uri) == strlen(uri) &&
-          strncmp(uri, oc_string(res->uri), strlen(uri)) == 0)
+        if (oc_string_len(res->uri) == len + 1 &&
+          strncmp(oc_string(res->uri) + 1, path, len) == 0) {
             return res;
+        }
     }
-
+#endif
     return NULL;
 }
+
+oc_resource_t *
+oc_ri_get_app_resource_by_uri(const char *uri)
+{
+    oc_resource_t *res;
+    int len;
+
+    len = strlen(uri);
+    if (len == 0) {
+        return NULL;
+    }
+    res = oc_ri_find_app_resource(uri + 1, len - 1);
+    if (res && oc_string(res->uri)[0] != uri[0]) {
+        return NULL;
+    }
+    return res;
+}
 #endif
 
 void
@@ -249,6 +313,7 @@ oc_ri_alloc_resource(void)
     if (resource) {
         os_callout_init(&resource->callout, oc_evq_get(),
           periodic_observe_handler, resource);
+        coap_observe_resource_init(resource);
     }
     return resource;
 }
@@ -264,6 +329,20 @@ oc_ri_delete_resource(oc_resource_t *resource)
             break;
         }
     }
+#if MYNEWT_VAL(OC_APP_RES_HASH_SIZE)
+    SLIST_FOREACH(tmp, oc_ri_uri_bucket(resource->uri_hash), hash_next) {
+        if (tmp == resource) {
+            SLIST_REMOVE(oc_ri_uri_bucket(resource->uri_hash), tmp,
+                         oc_resource, hash_next);
+            break;
+        }
+    }
+#endif
+    os_callout_stop(&resource->callout);
+#if MYNEWT_VAL(OC_NOTIFY_MIN_ITVL)
+    os_callout_stop(&resource->notify_callout);
+#endif
+    coap_remove_observer_by_resource(resource);
     os_memblock_put(&oc_resource_pool, resource);
 }
 
@@ -282,6 +361,12 @@ oc_ri_add_resource(oc_resource_t *resource)
     }
     if (valid) {
         SLIST_INSERT_HEAD(&oc_app_resources, resource, next);
+#if MYNEWT_VAL(OC_APP_RES_HASH_SIZE)
+        resource->uri_hash = oc_ri_uri_hash(oc_string(resource->uri) + 1,
+                                            oc_string_len(resource->uri) - 1);
+        SLIST_INSERT_HEAD(oc_ri_uri_bucket(resource->uri_hash), resource,
+                          hash_next);
+#endif
     }
 
     return valid;
@@ -474,14 +559,8 @@ oc_ri_invoke_coap_entity_handler(struct coap_packet_rx *request,
   /* Check against list of declared application resources.
    */
   if (!cur_resource && !bad_request) {
-      SLIST_FOREACH(resource, &oc_app_resources, next) {
-          if (oc_string_len(resource->uri) == (uri_path_len + 1) &&
-            strncmp((const char *)oc_string(resource->uri) + 1, uri_path,
-              uri_path_len) == 0) {
-              request_obj.resource = cur_resource = resource;
-              break;
-          }
-      }
+      request_obj.resource = cur_resource =
+        oc_ri_find_app_resource(uri_path, uri_path_len);
   }
 #endif
 
@@ -336,32 +336,14 @@ coap_init_message(coap_packet_t *pkt, coap_message_type_t type,
 
 /*---------------------------------------------------------------------------*/
 
+/*
+ * Appends the options, payload marker and payload of pkt to m. The payload
+ * mbuf chain is consumed.
+ */
 int
-coap_serialize_message(coap_packet_t *pkt, struct os_mbuf *m)
+coap_serialize_body(coap_packet_t *pkt, struct os_mbuf *m)
 {
-    struct coap_udp_hdr *cuh;
-    struct coap_tcp_hdr0 *cth0;
-    struct coap_tcp_hdr8 *cth8;
-    struct coap_tcp_hdr16 *cth16;
-    struct coap_tcp_hdr32 *cth32;
     unsigned int current_number = 0;
-    uint16_t u16;
-    uint32_t u32;
-    int tcp_hdr;
-    int len, data_len;
-
-    /* Initialize */
-    pkt->version = 1;
-
-    OC_LOG_DEBUG("coap_tx: 0x%x\n", (unsigned)m);
-
-    tcp_hdr = oc_endpoint_use_tcp(OC_MBUF_ENDPOINT(m));
-
-    /*
-     * Move data pointer, leave enough space to insert coap header and
-     * token before options.
-     */
-    m->om_data += (sizeof(struct coap_tcp_hdr32) + pkt->token_len);
 
     /* Serialize options */
     current_number = 0;
@@ -415,7 +397,42 @@ coap_serialize_message(coap_packet_t *pkt, struct os_mbuf *m)
             goto err_mem;
         }
     }
-    data_len = OS_MBUF_PKTLEN(m) + pkt->payload_len;
+    if (pkt->payload_m) {
+        assert(pkt->payload_len <= OS_MBUF_PKTLEN(pkt->payload_m));
+        if (pkt->payload_len < OS_MBUF_PKTLEN(pkt->payload_m)) {
+            os_mbuf_adj(pkt->payload_m,
+                        OS_MBUF_PKTLEN(pkt->payload_m) - pkt->payload_len);
+        }
+        os_mbuf_concat(m, pkt->payload_m);
+        pkt->payload_m = NULL;
+    }
+    return 0;
+err_mem:
+    if (pkt->payload_m) {
+        os_mbuf_free_chain(pkt->payload_m);
+        pkt->payload_m = NULL;
+    }
+    return -1;
+}
+
+/*
+ * Prepends CoAP header and token in front of the options already in m.
+ * Space for this was reserved before options were serialized.
+ */
+static void
+coap_serialize_hdr(coap_packet_t *pkt, struct os_mbuf *m, int tcp_hdr)
+{
+    struct coap_udp_hdr *cuh;
+    struct coap_tcp_hdr0 *cth0;
+    struct coap_tcp_hdr8 *cth8;
+    struct coap_tcp_hdr16 *cth16;
+    struct coap_tcp_hdr32 *cth32;
+    uint16_t u16;
+    uint32_t u32;
+    int len, data_len;
+
+    pkt->version = 1;
+    data_len = OS_MBUF_PKTLEN(m);
 
     /*
      * Set header fields, aka CoAP header alignment nightmare.
@@ -471,26 +488,59 @@ coap_serialize_message(coap_packet_t *pkt, struct os_mbuf *m)
             memcpy(cth32 + 1, pkt->token, pkt->token_len);
         }
     }
+}
 
-    if (pkt->payload_m) {
-        assert(pkt->payload_len <= OS_MBUF_PKTLEN(pkt->payload_m));
-        if (pkt->payload_len < OS_MBUF_PKTLEN(pkt->payload_m)) {
-            os_mbuf_adj(pkt->payload_m,
-                        OS_MBUF_PKTLEN(pkt->payload_m) - pkt->payload_len);
-        }
-        os_mbuf_concat(m, pkt->payload_m);
+int
+coap_serialize_message(coap_packet_t *pkt, struct os_mbuf *m)
+{
+    int tcp_hdr;
+
+    OC_LOG_DEBUG("coap_tx: 0x%x\n", (unsigned)m);
+
+    tcp_hdr = oc_endpoint_use_tcp(OC_MBUF_ENDPOINT(m));
+
+    /*
+     * Move data pointer, leave enough space to insert coap header and
+     * token before options.
+     */
+    m->om_data += (sizeof(struct coap_tcp_hdr32) + pkt->token_len);
+
+    if (coap_serialize_body(pkt, m)) {
+        STATS_INC(coap_stats, oerr);
+        return -1;
     }
+    coap_serialize_hdr(pkt, m, tcp_hdr);
+
     OC_LOG_DEBUG("coap_tx: serialized %u B (header len %u, payload len %u)\n",
         OS_MBUF_PKTLEN(m), OS_MBUF_PKTLEN(m) - pkt->payload_len,
         pkt->payload_len);
 
     return 0;
-err_mem:
-    if (pkt->payload_m) {
-        os_mbuf_free_chain(pkt->payload_m);
+}
+
+/*
+ * Like coap_serialize_message(), but instead of serializing options and
+ * payload of pkt, copies them from body, which was built earlier with
+ * coap_serialize_body(). Only header and token come from pkt. Used when
+ * the same message goes out to several recipients.
+ */
+int
+coap_serialize_message_body(coap_packet_t *pkt, struct os_mbuf *m,
+                            struct os_mbuf *body)
+{
+    int tcp_hdr;
+
+    tcp_hdr = oc_endpoint_use_tcp(OC_MBUF_ENDPOINT(m));
+
+    m->om_data += (sizeof(struct coap_tcp_hdr32) + pkt->token_len);
+
+    if (os_mbuf_appendfrom(m, body, 0, OS_MBUF_PKTLEN(body))) {
+        STATS_INC(coap_stats, oerr);
+        return -1;
     }
-    STATS_INC(coap_stats, oerr);
-    return -1;
+    coap_serialize_hdr(pkt, m, tcp_hdr);
+
+    return 0;
 }
 /*---------------------------------------------------------------------------*/
 void
@@ -42,6 +42,7 @@
 
 #include "oic/messaging/coap/observe.h"
 #include "oic/messaging/coap/oc_coap.h"
+#include "oic/port/mynewt/adaptor.h"
 #include "oic/oc_rep.h"
 #include "oic/oc_ri.h"
 
@@ -81,6 +82,7 @@ add_observer(oc_resource_t *resource, oc_endpoint_t *endpoint,
         o->obs_counter = observe_counter;
         o->resource = resource;
         resource->num_observers++;
+        SLIST_INSERT_HEAD(&resource->observers, o, res_next);
         OC_LOG_DEBUG("Adding observer (%u/%u) for /%s [0x%02X%02X]\n",
           coap_observer_pool.mp_num_blocks - coap_observer_pool.mp_num_free,
           coap_observer_pool.mp_num_blocks, o->url, o->token[0], o->token[1]);
@@ -98,6 +100,7 @@ coap_remove_observer(coap_observer_t *o)
     OC_LOG_DEBUG("Removing observer for /%s [0x%02X%02X]\n",
                  o->url, o->token[0], o->token[1]);
     SLIST_REMOVE(&oc_observers, o, coap_observer, next);
+    SLIST_REMOVE(&o->resource->observers, o, coap_observer, res_next);
     os_memblock_put(&coap_observer_pool, o);
 }
 /*---------------------------------------------------------------------------*/
@@ -184,9 +187,100 @@ coap_remove_observer_by_mid(oc_endpoint_t *endpoint, uint16_t mid)
     }
     return removed;
 }
+/*
+ * Drops all observers of a resource; called when the resource goes away.
+ */
+int
+coap_remove_observer_by_resource(oc_resource_t *resource)
+{
+    int removed = 0;
+    coap_observer_t *obs;
+
+    while ((obs = SLIST_FIRST(&resource->observers))) {
+        resource->num_observers--;
+        coap_remove_observer(obs);
+        removed++;
+    }
+    return removed;
+}
 /*---------------------------------------------------------------------------*/
 /*- Notification ------------------------------------------------------------*/
 /*---------------------------------------------------------------------------*/
+#if MYNEWT_VAL(OC_NOTIFY_MIN_ITVL)
+#define COAP_NOTIFY_MIN_ITVL                                            \
+    ((MYNEWT_VAL(OC_NOTIFY_MIN_ITVL) * OS_TICKS_PER_SEC + 999) / 1000)
+
+static void
+coap_notify_deferred(struct os_event *ev)
+{
+    coap_notify_observers(ev->ev_arg, NULL, NULL);
+}
+
+/*
+ * Returns 1 if previous notification for the resource went out less than
+ * OC_NOTIFY_MIN_ITVL ago. Notification then gets sent from a callout when
+ * the interval expires, with whatever the resource state is at that time.
+ */
+static int
+coap_notify_defer(oc_resource_t *resource)
+{
+    os_time_t now;
+    os_stime_t left;
+
+    now = os_time_get();
+    left = (os_stime_t)(resource->notify_time + COAP_NOTIFY_MIN_ITVL - now);
+    if (left > 0 && left <= COAP_NOTIFY_MIN_ITVL) {
+        if (!os_callout_queued(&resource->notify_callout)) {
+            os_callout_reset(&resource->notify_callout, left);
+        }
+        return 1;
+    }
+    os_callout_stop(&resource->notify_callout);
+    resource->notify_time = now;
+    return 0;
+}
+#endif
+
+/*
+ * Serializes options and payload of a notification once, to be copied
+ * behind header and token of every observer.
+ */
+static struct os_mbuf *
+coap_notify_body(oc_response_buffer_t *response_buf)
+{
+    coap_packet_t notification[1];
+    struct os_mbuf *body;
+
+    body = os_msys_get_pkthdr(0, 0);
+    if (!body) {
+        return NULL;
+    }
+    coap_init_message(notification, COAP_TYPE_NON, CONTENT_2_05, 0);
+    if (coap_set_payload(notification, response_buf->buffer,
+                         OS_MBUF_PKTLEN(response_buf->buffer)) < 0) {
+        goto err;
+    }
+    coap_set_status_code(notification, response_buf->code);
+    coap_set_header_content_format(notification, APPLICATION_CBOR);
+
+    /*
+     * All observers get the same sequence number. It comes from a global
+     * counter, so it keeps increasing for each one of them.
+     */
+    if (notification->code < BAD_REQUEST_4_00) {
+        coap_set_header_observe(notification, observe_counter++);
+    } else {
+        coap_set_header_observe(notification, 1);
+    }
+    if (coap_serialize_body(notification, body)) {
+        goto err;
+    }
+    return body;
+err:
+    os_mbuf_free_chain(body);
+    return NULL;
+}
+
 int
 coap_notify_observers(oc_resource_t *resource,
                       oc_response_buffer_t *response_buf,
@@ -197,6 +291,7 @@ coap_notify_observers(oc_resource_t *resource,
     oc_response_t response = {};
     oc_response_buffer_t response_buffer;
     struct os_mbuf *m = NULL;
+    struct os_mbuf *body = NULL;
 
     if (resource) {
         if (!resource->num_observers) {
@@ -207,6 +302,12 @@ coap_notify_observers(oc_resource_t *resource,
     }
     response.separate_response = 0;
     if (!response_buf && resource) {
+#if MYNEWT_VAL(OC_NOTIFY_MIN_ITVL)
+        if (!endpoint && coap_notify_defer(resource)) {
+            OC_LOG_DEBUG("coap_notify_observers: coalescing notification\n");
+            return num_observers;
+        }
+#endif
         OC_LOG_DEBUG("coap_notify_observers: Issue GET request to resource\n");
         /* performing GET on the resource */
         m = os_msys_get_pkthdr(0, 0);
@@ -230,12 +331,20 @@ coap_notify_observers(oc_resource_t *resource,
     }
 
     coap_observer_t *obs = NULL;
-    /* iterate over observers */
-    for (obs = SLIST_FIRST(&oc_observers); obs; obs = SLIST_NEXT(obs, next)) {
-        /* skip if neither resource nor endpoint match */
-        if ((resource && resource != obs->resource) ||
-            (endpoint && memcmp(&obs->endpoint, endpoint,
-                                oc_endpoint_size(endpoint)) != 0)) {
+    /*
+     * Iterate over observers; just the ones of the resource, if one was
+     * given.
+     */
+    if (resource) {
+        obs = SLIST_FIRST(&resource->observers);
+    } else {
+        obs = SLIST_FIRST(&oc_observers);
+    }
+    for (; obs; obs = resource ? SLIST_NEXT(obs, res_next) :
+                                 SLIST_NEXT(obs, next)) {
+        /* skip if endpoint does not match */
+        if (endpoint && memcmp(&obs->endpoint, endpoint,
+                               oc_endpoint_size(endpoint)) != 0) {
             continue;
         }
 
@@ -263,40 +372,38 @@ coap_notify_observers(oc_resource_t *resource,
         } else {
 #endif /* OC_SEPARATE_RESPONSES */
             OC_LOG_DEBUG("coap_notify_observers: notifying observer\n");
+            if (!response_buf) {
+                continue;
+            }
+            if (!body) {
+                body = coap_notify_body(response_buf);
+                if (!body) {
+                    break;
+                }
+            }
             coap_transaction_t *transaction = NULL;
-            if (response_buf && (transaction = coap_new_transaction(
-                  coap_get_mid(), &obs->endpoint))) {
+            if ((transaction = coap_new_transaction(coap_get_mid(),
+                                                    &obs->endpoint))) {
 
                 /* update last MID for RST matching */
                 obs->last_mid = transaction->mid;
 
-                /* prepare response */
-                /* build notification */
+                /* build notification; options and payload are in body */
                 coap_packet_t notification[1];
-                /* this way the packet can be treated as pointer as usual */
-                coap_init_message(notification, COAP_TYPE_NON, CONTENT_2_05, 0);
-
-                notification->mid = transaction->mid;
+                coap_init_message(notification, COAP_TYPE_NON, CONTENT_2_05,
+                                  transaction->mid);
                 if (!oc_endpoint_use_tcp(&obs->endpoint) &&
                     obs->obs_counter % COAP_OBSERVE_REFRESH_INTERVAL == 0) {
                     OC_LOG_DEBUG("coap_observe_notify: forcing CON "
                                  "notification to check for client liveness\n");
                     notification->type = COAP_TYPE_CON;
                 }
-                coap_set_payload(notification, response_buf->buffer,
-                                 OS_MBUF_PKTLEN(response_buf->buffer));
+                obs->obs_counter++;
                 coap_set_status_code(notification, response_buf->code);
-                coap_set_header_content_format(notification, APPLICATION_CBOR);
-                if (notification->code < BAD_REQUEST_4_00 &&
-                  obs->resource->num_observers) {
-                    coap_set_header_observe(notification, (obs->obs_counter)++);
-                    observe_counter++;
-                } else {
-                    coap_set_header_observe(notification, 1);
-                }
                 coap_set_token(notification, obs->token, obs->token_len);
 
-                if (!coap_serialize_message(notification, transaction->m)) {
+                if (!coap_serialize_message_body(notification, transaction->m,
+                                                 body)) {
                     transaction->type = notification->type;
                     coap_send_transaction(transaction);
                 } else {
@@ -307,6 +414,9 @@ coap_notify_observers(oc_resource_t *resource,
         }
 #endif
     }
+    if (body) {
+        os_mbuf_free_chain(body);
+    }
     if (m) {
         os_mbuf_free_chain(m);
     }
@@ -346,4 +456,15 @@ coap_observe_init(void)
     os_mempool_init(&coap_observer_pool, COAP_MAX_OBSERVERS,
       sizeof(coap_observer_t), coap_observer_area, "coap_obs");
 }
+
+void
+coap_observe_resource_init(oc_resource_t *resource)
+{
+    SLIST_INIT(&resource->observers);
+#if MYNEWT_VAL(OC_NOTIFY_MIN_ITVL)
+    os_callout_init(&resource->notify_callout, oc_evq_get(),
+      coap_notify_deferred, resource);
+    resource->notify_time = os_time_get() - COAP_NOTIFY_MIN_ITVL;
+#endif
+}
 #endif /* OC_SERVER */
@@ -103,6 +103,20 @@ oc_send_buffer(struct os_mbuf *m)
     }
 }
 
+struct os_mbuf *
+oc_mbuf_clone(struct os_mbuf *m)
+{
+#if MYNEWT_VAL(OS_MBUF_CLONE)
+    struct os_mbuf *n;
+
+    n = os_msys_clone(m);
+    if (n) {
+        return n;
+    }
+#endif
+    return os_mbuf_dup(m);
+}
+
 /*
  * Send on all the transports.
  */
@@ -121,7 +135,7 @@ oc_send_multicast_message(struct os_mbuf *m)
 
         ot = oc_transports[i];
         if (prev) {
-            n = os_mbuf_dup(m);
+            n = oc_mbuf_clone(m);
             prev->ot_tx_mcast(m);
             if (!n) {
                 return;
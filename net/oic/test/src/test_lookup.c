@@ -0,0 +1,74 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "os/mynewt.h"
+#include <oic/oc_api.h>
+#include "test_oic.h"
+
+static const char *test_lookup_uris[] = {
+    "/a", "/b", "/a/b", "/b/a", "/light/1", "/light/2"
+};
+#define TEST_LOOKUP_CNT                                                 \
+    (int)(sizeof(test_lookup_uris) / sizeof(test_lookup_uris[0]))
+
+static void
+test_lookup_get(struct oc_request *request, oc_interface_mask_t interface)
+{
+    oc_send_response(request, OC_STATUS_OK);
+}
+
+void
+test_lookup(void)
+{
+    struct oc_resource *res[TEST_LOOKUP_CNT];
+    int i;
+
+    for (i = 0; i < TEST_LOOKUP_CNT; i++) {
+        res[i] = oc_new_resource(test_lookup_uris[i], 1, 0);
+        TEST_ASSERT_FATAL(res[i]);
+        oc_resource_set_request_handler(res[i], OC_GET, test_lookup_get);
+        TEST_ASSERT(oc_add_resource(res[i]) == true);
+    }
+    for (i = 0; i < TEST_LOOKUP_CNT; i++) {
+        TEST_ASSERT(oc_ri_get_app_resource_by_uri(test_lookup_uris[i]) ==
+                    res[i]);
+    }
+    TEST_ASSERT(oc_ri_get_app_resource_by_uri("") == NULL);
+    TEST_ASSERT(oc_ri_get_app_resource_by_uri("/") == NULL);
+    TEST_ASSERT(oc_ri_get_app_resource_by_uri("a") == NULL);
+    TEST_ASSERT(oc_ri_get_app_resource_by_uri("/a/") == NULL);
+    TEST_ASSERT(oc_ri_get_app_resource_by_uri("/light") == NULL);
+    TEST_ASSERT(oc_ri_get_app_resource_by_uri("/light/3") == NULL);
+
+    /*
+     * Deleted resources can't be found, others still can.
+     */
+    oc_delete_resource(res[2]);
+    oc_delete_resource(res[4]);
+    for (i = 0; i < TEST_LOOKUP_CNT; i++) {
+        if (i == 2 || i == 4) {
+            TEST_ASSERT(oc_ri_get_app_resource_by_uri(test_lookup_uris[i]) ==
+                        NULL);
+        } else {
+            TEST_ASSERT(oc_ri_get_app_resource_by_uri(test_lookup_uris[i]) ==
+                        res[i]);
+            oc_delete_resource(res[i]);
+        }
+    }
+    TEST_ASSERT(oc_ri_get_app_resources() == NULL);
+}
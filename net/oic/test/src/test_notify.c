@@ -0,0 +1,362 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdio.h>
+#include "os/mynewt.h"
+#include <oic/oc_api.h>
+#include <oic/port/oc_connectivity.h>
+#include <oic/port/mynewt/transport.h>
+#include <oic/messaging/coap/observe.h>
+#include <cborattr/cborattr.h>
+#include "test_oic.h"
+
+/*
+ * Observers are added directly with coap_observe_handler(), with endpoints
+ * of a local transport which captures the notifications sent to them.
+ * Resource A has observers 1-3, resource B has observer 4.
+ */
+#define TEST_NOTIFY_OBS_CNT     4
+#define TEST_NOTIFY_A_CNT       3
+#define TEST_NOTIFY_MAX_TX      8
+
+/* Long enough for a coalesced notification to go out. */
+#define TEST_NOTIFY_WAIT                                                \
+    ((MYNEWT_VAL(OC_NOTIFY_MIN_ITVL) * 2 * OS_TICKS_PER_SEC) / 1000 + 1)
+
+struct test_notify_ep {
+    struct oc_ep_hdr ep;
+    uint8_t id;
+};
+
+static int test_notify_state;
+static volatile int test_notify_done;
+static int test_notify_value;
+static int8_t test_notify_tid;
+static struct oc_resource *test_notify_res_a;
+static struct oc_resource *test_notify_res_b;
+static struct test_notify_ep test_notify_eps[TEST_NOTIFY_OBS_CNT];
+static struct os_mbuf *test_notify_tx[TEST_NOTIFY_MAX_TX];
+static int test_notify_tx_cnt;
+static struct os_callout test_notify_timer;
+
+static void test_notify_next_step(struct os_event *);
+static struct os_event test_notify_next_ev = {
+    .ev_cb = test_notify_next_step
+};
+
+static uint8_t
+test_notify_ep_size(const struct oc_endpoint *oe)
+{
+    return sizeof(struct test_notify_ep);
+}
+
+static void
+test_notify_tx_ucast(struct os_mbuf *m)
+{
+    if (test_notify_tx_cnt < TEST_NOTIFY_MAX_TX) {
+        test_notify_tx[test_notify_tx_cnt] = m;
+    } else {
+        os_mbuf_free_chain(m);
+    }
+    test_notify_tx_cnt++;
+}
+
+static char *
+test_notify_ep_str(char *ptr, int maxlen, const struct oc_endpoint *oe)
+{
+    snprintf(ptr, maxlen, "test %u", ((struct test_notify_ep *)oe)->id);
+    return ptr;
+}
+
+static void
+test_notify_shutdown(void)
+{
+}
+
+static const struct oc_transport test_notify_transport = {
+    .ot_flags = OC_TRANSPORT_USE_TCP, /* no CON notifications to ack */
+    .ot_ep_size = test_notify_ep_size,
+    .ot_tx_ucast = test_notify_tx_ucast,
+    .ot_ep_str = test_notify_ep_str,
+    .ot_shutdown = test_notify_shutdown
+};
+
+static void
+test_notify_get(struct oc_request *request, oc_interface_mask_t interface)
+{
+    oc_rep_start_root_object();
+    oc_rep_set_int(root, value, test_notify_value);
+    oc_rep_end_root_object();
+    oc_send_response(request, OC_STATUS_OK);
+}
+
+static struct oc_resource *
+test_notify_new_res(const char *uri)
+{
+    struct oc_resource *res;
+
+    res = oc_new_resource(uri, 1, 0);
+    TEST_ASSERT_FATAL(res);
+    oc_resource_bind_resource_interface(res, OC_IF_R);
+    oc_resource_set_default_interface(res, OC_IF_R);
+    oc_resource_set_observable(res);
+    oc_resource_set_request_handler(res, OC_GET, test_notify_get);
+    TEST_ASSERT_FATAL(oc_add_resource(res) == true);
+    return res;
+}
+
+/*
+ * Registers observer idx for the resource, like a GET with Observe: 0
+ * from that endpoint would.
+ */
+static void
+test_notify_observe(struct oc_resource *res, int idx)
+{
+    struct coap_packet_rx req;
+    coap_packet_t rsp;
+    struct test_notify_ep *tep;
+    const char *uri;
+    int rc;
+
+    tep = &test_notify_eps[idx];
+    tep->ep.oe_type = test_notify_tid;
+    tep->ep.oe_flags = 0;
+    tep->id = idx + 1;
+
+    memset(&req, 0, sizeof(req));
+    req.code = COAP_GET;
+    req.token_len = 2;
+    req.token[0] = 0xa0;
+    req.token[1] = tep->id;
+    req.m = os_msys_get_pkthdr(0, 0);
+    TEST_ASSERT_FATAL(req.m);
+    uri = oc_string(res->uri) + 1;
+    rc = os_mbuf_append(req.m, uri, strlen(uri));
+    TEST_ASSERT_FATAL(rc == 0);
+    req.uri_path_off = 0;
+    req.uri_path_len = strlen(uri);
+    SET_OPTION(&req, COAP_OPTION_URI_PATH);
+    req.observe = 0;
+    SET_OPTION(&req, COAP_OPTION_OBSERVE);
+
+    coap_init_message(&rsp, COAP_TYPE_ACK, CONTENT_2_05, 0);
+
+    rc = coap_observe_handler(&req, &rsp, res, (oc_endpoint_t *)tep);
+    TEST_ASSERT(rc == 0);
+    os_mbuf_free_chain(req.m);
+}
+
+static void
+test_notify_tx_free(void)
+{
+    int i;
+
+    for (i = 0; i < test_notify_tx_cnt && i < TEST_NOTIFY_MAX_TX; i++) {
+        os_mbuf_free_chain(test_notify_tx[i]);
+        test_notify_tx[i] = NULL;
+    }
+    test_notify_tx_cnt = 0;
+}
+
+/*
+ * Checks that captured notification idx went to one of our observers,
+ * carries its token, and has the expected value.
+ */
+static void
+test_notify_tx_check(int idx, struct coap_packet_rx *rx, int value)
+{
+    struct test_notify_ep *tep;
+    long long rsp_value = -1;
+    struct cbor_attr_t attrs[] = {
+        [0] = {
+            .attribute = "value",
+            .type = CborAttrIntegerType,
+            .addr.integer = &rsp_value,
+            .dflt.integer = 0
+        },
+        [1] = {
+        }
+    };
+    struct os_mbuf *m;
+    uint16_t data_off;
+    int len;
+    int rc;
+
+    TEST_ASSERT_FATAL(test_notify_tx[idx]);
+    tep = (struct test_notify_ep *)OC_MBUF_ENDPOINT(test_notify_tx[idx]);
+    TEST_ASSERT_FATAL(tep->ep.oe_type == test_notify_tid);
+
+    rc = coap_parse_message(rx, &test_notify_tx[idx]);
+    TEST_ASSERT_FATAL(rc == NO_ERROR);
+    TEST_ASSERT(rx->code == CONTENT_2_05);
+    TEST_ASSERT(rx->token_len == 2);
+    TEST_ASSERT(rx->token[0] == 0xa0 && rx->token[1] == tep->id);
+    TEST_ASSERT(IS_OPTION(rx, COAP_OPTION_OBSERVE));
+
+    len = coap_get_payload(rx, &m, &data_off);
+    TEST_ASSERT_FATAL(len > 0);
+    rc = cbor_read_mbuf_attrs(m, data_off, len, attrs);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(rsp_value == value);
+}
+
+static void
+test_notify_next_step(struct os_event *ev)
+{
+    struct coap_packet_rx rx[TEST_NOTIFY_A_CNT];
+    int seen;
+    int rc;
+    int i;
+
+    test_notify_state++;
+    switch (test_notify_state) {
+    case 1:
+        test_notify_tid = oc_transport_register(&test_notify_transport);
+        TEST_ASSERT_FATAL(test_notify_tid >= 0);
+
+        test_notify_res_a = test_notify_new_res("/notify/a");
+        test_notify_res_b = test_notify_new_res("/notify/b");
+        for (i = 0; i < TEST_NOTIFY_A_CNT; i++) {
+            test_notify_observe(test_notify_res_a, i);
+        }
+        test_notify_observe(test_notify_res_b, TEST_NOTIFY_A_CNT);
+        TEST_ASSERT(test_notify_res_a->num_observers == TEST_NOTIFY_A_CNT);
+        TEST_ASSERT(test_notify_res_b->num_observers == 1);
+
+        /*
+         * Only the observers of A get notified.
+         */
+        test_notify_value = 1;
+        rc = oc_notify_observers(test_notify_res_a);
+        TEST_ASSERT(rc == TEST_NOTIFY_A_CNT);
+        oic_test_reset_tmo("notify1");
+        os_eventq_put(os_eventq_dflt_get(), &test_notify_next_ev);
+        break;
+    case 2:
+        TEST_ASSERT_FATAL(test_notify_tx_cnt == TEST_NOTIFY_A_CNT);
+        seen = 0;
+        for (i = 0; i < TEST_NOTIFY_A_CNT; i++) {
+            test_notify_tx_check(i, &rx[i], 1);
+            seen |= 1 << ((struct test_notify_ep *)
+                          OC_MBUF_ENDPOINT(test_notify_tx[i]))->id;
+        }
+        TEST_ASSERT(seen == 0x0e);
+
+        /*
+         * Observe option and payload come from the same body, so they
+         * are the same for everyone.
+         */
+        for (i = 1; i < TEST_NOTIFY_A_CNT; i++) {
+            TEST_ASSERT(rx[i].observe == rx[0].observe);
+            TEST_ASSERT_FATAL(rx[i].payload_len == rx[0].payload_len);
+            TEST_ASSERT(os_mbuf_cmpm(rx[i].m, rx[i].payload_off,
+                                     rx[0].m, rx[0].payload_off,
+                                     rx[0].payload_len) == 0);
+        }
+        test_notify_tx_free();
+
+        test_notify_value = 2;
+        rc = oc_notify_observers(test_notify_res_b);
+        TEST_ASSERT(rc == 1);
+        oic_test_reset_tmo("notify2");
+        os_eventq_put(os_eventq_dflt_get(), &test_notify_next_ev);
+        break;
+    case 3:
+        TEST_ASSERT_FATAL(test_notify_tx_cnt == 1);
+        test_notify_tx_check(0, &rx[0], 2);
+        test_notify_tx_free();
+
+#if MYNEWT_VAL(OC_NOTIFY_MIN_ITVL)
+        /*
+         * Within OC_NOTIFY_MIN_ITVL of the previous one; these get
+         * coalesced into one notification with the latest value.
+         */
+        test_notify_value = 3;
+        rc = oc_notify_observers(test_notify_res_b);
+        TEST_ASSERT(rc == 1);
+        test_notify_value = 4;
+        rc = oc_notify_observers(test_notify_res_b);
+        TEST_ASSERT(rc == 1);
+        os_callout_reset(&test_notify_timer, TEST_NOTIFY_WAIT);
+#else
+        os_eventq_put(os_eventq_dflt_get(), &test_notify_next_ev);
+#endif
+        oic_test_reset_tmo("notify3");
+        break;
+    case 4:
+#if MYNEWT_VAL(OC_NOTIFY_MIN_ITVL)
+        TEST_ASSERT_FATAL(test_notify_tx_cnt == 1);
+        test_notify_tx_check(0, &rx[0], 4);
+        test_notify_tx_free();
+
+        /*
+         * Depending on timing, this one goes out now or gets deferred.
+         * The next one gets deferred either way.
+         */
+        test_notify_value = 5;
+        rc = oc_notify_observers(test_notify_res_b);
+        TEST_ASSERT(rc == 1);
+#endif
+        os_eventq_put(os_eventq_dflt_get(), &test_notify_next_ev);
+        oic_test_reset_tmo("notify4");
+        break;
+    case 5:
+        test_notify_tx_free();
+#if MYNEWT_VAL(OC_NOTIFY_MIN_ITVL)
+        /*
+         * Resource gets deleted while notification is pending.
+         */
+        test_notify_value = 6;
+        rc = oc_notify_observers(test_notify_res_b);
+        TEST_ASSERT(rc == 1);
+#endif
+        /*
+         * Deleting resources takes their observers with them.
+         */
+        oc_delete_resource(test_notify_res_a);
+        oc_delete_resource(test_notify_res_b);
+        for (i = 0; i < TEST_NOTIFY_OBS_CNT; i++) {
+            rc = coap_remove_observer_by_client(
+              (oc_endpoint_t *)&test_notify_eps[i]);
+            TEST_ASSERT(rc == 0);
+        }
+        os_callout_reset(&test_notify_timer, TEST_NOTIFY_WAIT);
+        oic_test_reset_tmo("notify5");
+        break;
+    case 6:
+        TEST_ASSERT(test_notify_tx_cnt == 0);
+        test_notify_tx_free();
+        oc_transport_unregister(&test_notify_transport);
+        test_notify_done = 1;
+        break;
+    default:
+        TEST_ASSERT_FATAL(0);
+        break;
+    }
+}
+
+void
+test_notify(void)
+{
+    os_callout_init(&test_notify_timer, os_eventq_dflt_get(),
+                    test_notify_next_step, NULL);
+    os_eventq_put(os_eventq_dflt_get(), &test_notify_next_ev);
+    while (!test_notify_done)
+        ;
+}
@@ -43,6 +43,8 @@ void oic_test_get_endpoint(struct oc_server_handle *);
 void test_discovery(void);
 void test_getset(void);
 void test_observe(void);
+void test_notify(void);
+void test_lookup(void);
 
 #ifdef __cplusplus
 }
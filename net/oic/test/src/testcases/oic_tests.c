@@ -82,5 +82,7 @@ TEST_CASE_TASK(oic_tests)
     test_discovery();
     test_getset();
     test_observe();
+    test_notify();
+    test_lookup();
     oc_main_shutdown();
 }
@@ -23,6 +23,7 @@
 
 #include <fcb/fcb.h>
 #include <string.h>
+#include <stdlib.h>
 
 #include "config/config.h"
 #include "config/config_fcb.h"
@@ -35,6 +36,28 @@ struct conf_fcb_load_cb_arg {
     void *cb_arg;
 };
 
+#if MYNEWT_VAL(CONFIG_FCB_INDEX_SIZE) > 0
+/*
+ * Index from setting name to the location of the newest entry carrying that
+ * name. Rebuilt with a single walk over the FCB whenever it is needed; this
+ * keeps compression and loading linear in the number of entries. Callers
+ * are serialized by conf_lock(), so one table is shared by all conf_fcbs.
+ */
+struct conf_fcb_idx_ent {
+    uint32_t cfi_hash;          /* 0 when slot is unused */
+    uint32_t cfi_data_off;
+    uint16_t cfi_data_len;
+    uint8_t cfi_sector;
+    uint8_t cfi_rel_sector;     /* sector distance from f_oldest */
+};
+
+static struct conf_fcb_idx_ent
+    conf_fcb_idx[MYNEWT_VAL(CONFIG_FCB_INDEX_SIZE)];
+static int conf_fcb_idx_cnt;
+
+#define CONF_FCB_IDX_SIZE   MYNEWT_VAL(CONFIG_FCB_INDEX_SIZE)
+#endif
+
 static int conf_fcb_load(struct conf_store *, load_cb cb, void *cb_arg);
 static int conf_fcb_save(struct conf_store *, const char *name,
   const char *value);
@@ -89,6 +112,204 @@ conf_fcb_dst(struct conf_fcb *cf)
     return OS_OK;
 }
 
+#if MYNEWT_VAL(CONFIG_FCB_INDEX_SIZE) > 0
+static uint32_t
+conf_fcb_idx_hash(const char *name)
+{
+    uint32_t hash;
+
+    /* FNV-1a */
+    hash = 2166136261UL;
+    while (*name) {
+        hash ^= (uint8_t)*name++;
+        hash *= 16777619UL;
+    }
+    if (hash == 0) {
+        hash = 1;
+    }
+    return hash;
+}
+
+static void
+conf_fcb_idx_loc(struct conf_fcb *cf, struct conf_fcb_idx_ent *ent,
+                 struct fcb_entry *loc)
+{
+    loc->fe_area = &cf->cf_fcb.f_sectors[ent->cfi_sector];
+    loc->fe_elem_off = 0;
+    loc->fe_data_off = ent->cfi_data_off;
+    loc->fe_data_len = ent->cfi_data_len;
+}
+
+/*
+ * Check whether entry at loc starts with "<name>=". Only entries written
+ * by conf_fcb_save() are in that canonical form; anything else compares as
+ * different, which at worst makes compression keep an extra entry.
+ */
+static int
+conf_fcb_idx_name_match(struct fcb_entry *loc, const char *name)
+{
+    char buf[16];
+    int nlen;
+    int off;
+    int len;
+
+    nlen = strlen(name);
+    if (loc->fe_data_len < nlen + 1) {
+        return 0;
+    }
+    for (off = 0; off < nlen + 1; off += len) {
+        len = nlen + 1 - off;
+        if (len > sizeof(buf)) {
+            len = sizeof(buf);
+        }
+        if (flash_area_read(loc->fe_area, loc->fe_data_off + off, buf, len)) {
+            return 0;
+        }
+        if (off + len > nlen) {
+            if (buf[len - 1] != '=') {
+                return 0;
+            }
+            len--;
+            if (memcmp(buf, name + off, len)) {
+                return 0;
+            }
+            len++;
+        } else if (memcmp(buf, name + off, len)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/*
+ * Returns the slot holding name, or the free slot where it should be
+ * inserted. NULL if neither can be found.
+ */
+static struct conf_fcb_idx_ent *
+conf_fcb_idx_find(struct conf_fcb *cf, const char *name, uint32_t hash)
+{
+    struct conf_fcb_idx_ent *ent;
+    struct fcb_entry loc;
+    int i;
+    int j;
+
+    j = hash % CONF_FCB_IDX_SIZE;
+    for (i = 0; i < CONF_FCB_IDX_SIZE; i++) {
+        ent = &conf_fcb_idx[j];
+        if (ent->cfi_hash == 0) {
+            return ent;
+        }
+        if (ent->cfi_hash == hash) {
+            conf_fcb_idx_loc(cf, ent, &loc);
+            if (conf_fcb_idx_name_match(&loc, name)) {
+                return ent;
+            }
+        }
+        if (++j == CONF_FCB_IDX_SIZE) {
+            j = 0;
+        }
+    }
+    return NULL;
+}
+
+static int
+conf_fcb_idx_add_cb(struct fcb_entry *loc, void *arg)
+{
+    struct conf_fcb *cf = (struct conf_fcb *)arg;
+    struct conf_fcb_idx_ent *ent;
+    char buf[CONF_MAX_NAME_LEN + 2];
+    char *name_str;
+    char *val_str;
+    uint32_t hash;
+    int len;
+    int rc;
+
+    len = loc->fe_data_len;
+    if (len >= sizeof(buf)) {
+        len = sizeof(buf) - 1;
+    }
+    rc = flash_area_read(loc->fe_area, loc->fe_data_off, buf, len);
+    if (rc) {
+        return 0;
+    }
+    buf[len] = '\0';
+
+    rc = conf_line_parse(buf, &name_str, &val_str);
+    if (rc) {
+        if (len < loc->fe_data_len) {
+            /* Name did not fit; can't index this one. */
+            return OS_ENOMEM;
+        }
+        return 0;
+    }
+
+    hash = conf_fcb_idx_hash(name_str);
+    ent = conf_fcb_idx_find(cf, name_str, hash);
+    if (!ent) {
+        return OS_ENOMEM;
+    }
+    if (ent->cfi_hash == 0) {
+        /* Keep at least one slot free, lookups stop there. */
+        if (conf_fcb_idx_cnt == CONF_FCB_IDX_SIZE - 1) {
+            return OS_ENOMEM;
+        }
+        conf_fcb_idx_cnt++;
+        ent->cfi_hash = hash;
+    }
+    ent->cfi_sector = loc->fe_area - cf->cf_fcb.f_sectors;
+    ent->cfi_rel_sector = (loc->fe_area - cf->cf_fcb.f_oldest +
+      cf->cf_fcb.f_sector_cnt) % cf->cf_fcb.f_sector_cnt;
+    ent->cfi_data_off = loc->fe_data_off;
+    ent->cfi_data_len = loc->fe_data_len;
+    return 0;
+}
+
+/*
+ * Builds the index. Returns non-zero if all names did not fit, in which
+ * case callers fall back to scanning.
+ */
+static int
+conf_fcb_idx_build(struct conf_fcb *cf)
+{
+    memset(conf_fcb_idx, 0, sizeof(conf_fcb_idx));
+    conf_fcb_idx_cnt = 0;
+    return fcb_walk(&cf->cf_fcb, 0, conf_fcb_idx_add_cb, cf);
+}
+
+static int
+conf_fcb_idx_is_newest(struct conf_fcb *cf, struct fcb_entry *loc,
+                       const char *name)
+{
+    struct conf_fcb_idx_ent *ent;
+
+    ent = conf_fcb_idx_find(cf, name, conf_fcb_idx_hash(name));
+    if (!ent || ent->cfi_hash == 0) {
+        /* Not indexed (unparseable when walked); keep it. */
+        return 1;
+    }
+    return &cf->cf_fcb.f_sectors[ent->cfi_sector] == loc->fe_area &&
+      ent->cfi_data_off == loc->fe_data_off;
+}
+
+static int
+conf_fcb_idx_cmp(const void *a, const void *b)
+{
+    const struct conf_fcb_idx_ent *ea = a;
+    const struct conf_fcb_idx_ent *eb = b;
+
+    if (ea->cfi_rel_sector != eb->cfi_rel_sector) {
+        return (int)ea->cfi_rel_sector - (int)eb->cfi_rel_sector;
+    }
+    if (ea->cfi_data_off < eb->cfi_data_off) {
+        return -1;
+    }
+    return ea->cfi_data_off > eb->cfi_data_off;
+}
+#else
+#define conf_fcb_idx_build(cf)                  (-1)
+#define conf_fcb_idx_is_newest(cf, loc, name)   1
+#endif
+
 static int
 conf_fcb_load_cb(struct fcb_entry *loc, void *arg)
 {
@@ -129,6 +350,29 @@ conf_fcb_load(struct conf_store *cs, load_cb cb, void *cb_arg)
 
     arg.cb = cb;
     arg.cb_arg = cb_arg;
+#if MYNEWT_VAL(CONFIG_FCB_INDEX_SIZE) > 0
+    if (conf_fcb_idx_build(cf) == 0) {
+        struct fcb_entry loc;
+        int i;
+        int j;
+
+        /*
+         * Only report the newest value of every setting, in the order
+         * they were written.
+         */
+        for (i = 0, j = 0; i < CONF_FCB_IDX_SIZE; i++) {
+            if (conf_fcb_idx[i].cfi_hash) {
+                conf_fcb_idx[j++] = conf_fcb_idx[i];
+            }
+        }
+        qsort(conf_fcb_idx, j, sizeof(conf_fcb_idx[0]), conf_fcb_idx_cmp);
+        for (i = 0; i < j; i++) {
+            conf_fcb_idx_loc(cf, &conf_fcb_idx[i], &loc);
+            conf_fcb_load_cb(&loc, &arg);
+        }
+        return OS_OK;
+    }
+#endif
     rc = fcb_walk(&cf->cf_fcb, 0, conf_fcb_load_cb, &arg);
     if (rc) {
         return OS_EINVAL;
@@ -160,6 +404,7 @@ conf_fcb_compress(struct conf_fcb *cf)
     struct fcb_entry loc2;
     char *name1, *val1;
     char *name2, *val2;
+    int use_idx;
     int copy;
 
     rc = fcb_append_to_scratch(&cf->cf_fcb);
@@ -167,6 +412,8 @@ conf_fcb_compress(struct conf_fcb *cf)
         return; /* XXX */
     }
 
+    use_idx = (conf_fcb_idx_build(cf) == 0);
+
     loc1.fe_area = NULL;
     loc1.fe_elem_off = 0;
     while (fcb_getnext(&cf->cf_fcb, &loc1) == 0) {
@@ -180,16 +427,20 @@ conf_fcb_compress(struct conf_fcb *cf)
         if (!val1) {
             continue;
         }
-        loc2 = loc1;
-        copy = 1;
-        while (fcb_getnext(&cf->cf_fcb, &loc2) == 0) {
-            rc = conf_fcb_var_read(&loc2, buf2, &name2, &val2);
-            if (rc) {
-                continue;
-            }
-            if (!strcmp(name1, name2)) {
-                copy = 0;
-                break;
+        if (use_idx) {
+            copy = conf_fcb_idx_is_newest(cf, &loc1, name1);
+        } else {
+            loc2 = loc1;
+            copy = 1;
+            while (fcb_getnext(&cf->cf_fcb, &loc2) == 0) {
+                rc = conf_fcb_var_read(&loc2, buf2, &name2, &val2);
+                if (rc) {
+                    continue;
+                }
+                if (!strcmp(name1, name2)) {
+                    copy = 0;
+                    break;
+                }
             }
         }
         if (!copy) {
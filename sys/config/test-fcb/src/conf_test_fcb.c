@@ -332,6 +332,7 @@ TEST_CASE_DECL(config_test_insert3)
 TEST_CASE_DECL(config_test_save_3_fcb)
 TEST_CASE_DECL(config_test_compress_reset)
 TEST_CASE_DECL(config_test_save_one_fcb)
+TEST_CASE_DECL(config_test_load_newest_fcb)
 
 TEST_SUITE(config_test_all)
 {
@@ -363,6 +364,8 @@ TEST_SUITE(config_test_all)
     config_test_compress_reset();
 
     config_test_save_one_fcb();
+
+    config_test_load_newest_fcb();
 }
 
 #if MYNEWT_VAL(SELFTEST)
@@ -0,0 +1,78 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include <stdlib.h>
+#include "conf_test_fcb.h"
+
+#define CONF_TEST_NEWEST_CNT    16
+
+static void
+config_test_load_newest_cb(char *name, char *val, void *cb_arg)
+{
+    int *cnt = (int *)cb_arg;
+
+    if (!strcmp(name, "myfoo/mybar")) {
+        (*cnt)++;
+        TEST_ASSERT(val && atoi(val) == CONF_TEST_NEWEST_CNT - 1);
+    }
+}
+
+TEST_CASE(config_test_load_newest_fcb)
+{
+    int rc;
+    struct conf_fcb cf;
+    char val[8];
+    int cnt;
+    int i;
+
+    config_wipe_srcs();
+    config_wipe_fcb(fcb_areas, sizeof(fcb_areas) / sizeof(fcb_areas[0]));
+
+    cf.cf_fcb.f_magic = MYNEWT_VAL(CONFIG_FCB_MAGIC);
+    cf.cf_fcb.f_sectors = fcb_areas;
+    cf.cf_fcb.f_sector_cnt = sizeof(fcb_areas) / sizeof(fcb_areas[0]);
+
+    rc = conf_fcb_src(&cf);
+    TEST_ASSERT(rc == 0);
+
+    rc = conf_fcb_dst(&cf);
+    TEST_ASSERT(rc == 0);
+
+    for (i = 0; i < CONF_TEST_NEWEST_CNT; i++) {
+        snprintf(val, sizeof(val), "%d", i);
+        rc = conf_save_one("myfoo/mybar", val);
+        TEST_ASSERT(rc == 0);
+    }
+
+    /*
+     * With the name index only the last value written is reported.
+     */
+    cnt = 0;
+    rc = cf.cf_store.cs_itf->csi_load(&cf.cf_store,
+                                      config_test_load_newest_cb, &cnt);
+    TEST_ASSERT(rc == 0);
+#if MYNEWT_VAL(CONFIG_FCB_INDEX_SIZE) > 0
+    TEST_ASSERT(cnt == 1);
+#else
+    TEST_ASSERT(cnt == CONF_TEST_NEWEST_CNT);
+#endif
+
+    rc = conf_load();
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(val8 == CONF_TEST_NEWEST_CNT - 1);
+}
@@ -86,6 +86,7 @@ struct log_handler {
     lh_append_func_t log_append;
     lh_append_mbuf_func_t log_append_mbuf;
     lh_walk_func_t log_walk;
+    lh_walk_func_t log_walk_reverse;
     lh_flush_func_t log_flush;
     /* Functions called only internally (no API for apps) */
     lh_registered_func_t log_registered;
@@ -147,6 +148,8 @@ struct log_entry_hdr {
 #if MYNEWT_VAL(LOG_VERSION) > 2
 #define LOG_ETYPE_CBOR           (1)
 #define LOG_ETYPE_BINARY         (2)
+/* Format string ID and arguments; see log_printf_deferred(). */
+#define LOG_ETYPE_FMT            (3)
 #endif
 
 /* Logging medium */
@@ -272,12 +275,47 @@ log_append_mbuf(struct log *log, uint8_t module, uint8_t level,
 
 #define LOG_PRINTF_MAX_ENTRY_LEN (128)
 void log_printf(struct log *log, uint16_t, uint16_t, char *, ...);
+#if MYNEWT_VAL(LOG_DEFERRED_FMT)
+/*
+ * Deferred format strings are kept together in the log_fmt section.  An
+ * entry refers to its format string by the offset from log_fmt_start, which
+ * is the same on every boot of an image.
+ */
+#ifdef __APPLE__
+#define LOG_FMT_SECTION "__TEXT,log_fmt"
+extern const char log_fmt_start[] __asm("section$start$__TEXT$log_fmt");
+extern const char log_fmt_end[] __asm("section$end$__TEXT$log_fmt");
+#else
+#define LOG_FMT_SECTION "log_fmt"
+extern const char log_fmt_start[] __asm("__start_log_fmt")
+    __attribute__((weak));
+extern const char log_fmt_end[] __asm("__stop_log_fmt")
+    __attribute__((weak));
+#endif
+
+/*
+ * Like log_printf(), but the text is only formatted when the entry is read
+ * back.  __msg must be a string literal.
+ */
+#define log_printf_deferred(__l, __mod, __level, __msg, ...)            \
+    do {                                                                \
+        static const char __log_fmt[]                                   \
+            __attribute__((section(LOG_FMT_SECTION))) = __msg;          \
+        log_fmt_printf(__l, __mod, __level, __log_fmt, ##__VA_ARGS__);  \
+    } while (0)
+
+void log_fmt_printf(struct log *log, uint16_t, uint16_t, const char *, ...);
+int log_fmt_read(struct log *log, void *dptr, uint16_t len, char *buf,
+                 int buf_len);
+#endif
 int log_read(struct log *log, void *dptr, void *buf, uint16_t off,
         uint16_t len);
 int log_read_mbuf(struct log *log, void *dptr, struct os_mbuf *om, uint16_t off,
                   uint16_t len);
 int log_walk(struct log *log, log_walk_func_t walk_func,
         struct log_offset *log_offset);
+int log_walk_reverse(struct log *log, log_walk_func_t walk_func,
+        struct log_offset *log_offset);
 int log_flush(struct log *log);
 
 /* Handler exports */
@@ -431,6 +431,27 @@ err:
     return (rc);
 }
 
+/**
+ * Walks the specified log newest entry first.  The walk function is called
+ * for each entry, in the reverse of the order log_walk() uses.  Entries whose
+ * index (or timestamp) is below the one given in log_offset may be skipped.
+ *
+ * @return                      0 on success; SYS_ENOTSUP if the log handler
+ *                                  cannot walk backwards; the walk
+ *                                  function's return code if it aborted
+ *                                  the walk.
+ */
+int
+log_walk_reverse(struct log *log, log_walk_func_t walk_func,
+                 struct log_offset *log_offset)
+{
+    if (log->l_log->log_walk_reverse == NULL) {
+        return SYS_ENOTSUP;
+    }
+
+    return log->l_log->log_walk_reverse(log, walk_func, log_offset);
+}
+
 /**
  * Reads from the specified log.
  *
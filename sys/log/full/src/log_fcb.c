@@ -31,6 +31,184 @@ static struct flash_area sector;
 
 static int log_fcb_rtr_erase(struct log *log, void *arg);
 
+/*
+ * Returns the flash area preceding fa in the FCB's ring of sectors.
+ */
+static struct flash_area *
+log_fcb_prev_area(struct fcb *fcb, struct flash_area *fa)
+{
+    if (fa == &fcb->f_sectors[0]) {
+        fa = &fcb->f_sectors[fcb->f_sector_cnt];
+    }
+    return fa - 1;
+}
+
+/*
+ * Reads the index of the first valid log entry in flash area fa.
+ */
+static int
+log_fcb_first_index(struct fcb *fcb, struct flash_area *fa,
+                    uint32_t *out_index)
+{
+    struct log_entry_hdr ueh;
+    struct fcb_entry loc;
+    int rc;
+
+    loc.fe_area = fa;
+    loc.fe_elem_off = 0;
+    rc = fcb_getnext(fcb, &loc);
+    if (rc) {
+        return rc;
+    }
+    if (loc.fe_area != fa || loc.fe_data_len < sizeof(ueh)) {
+        return FCB_ERR_NOVAR;
+    }
+
+    rc = flash_area_read(fa, loc.fe_data_off, &ueh, sizeof(ueh));
+    if (rc) {
+        return FCB_ERR_FLASH;
+    }
+    *out_index = ueh.ue_index;
+
+    return 0;
+}
+
+#if MYNEWT_VAL(FCB_LOG_SECTOR_INDEX)
+/*
+ * Sector index.  For every sector of the FCB, remember the index of the first
+ * log entry written into it, along with the sector's id.  Entry indices only
+ * ever grow (see log_register()), so all entries in sectors older than one
+ * starting at or below the requested index can be skipped by a walk.  The id
+ * tells if the slot still describes the data in the sector after it has been
+ * rotated out and reused.
+ */
+static struct fcb_log_sector *
+log_fcb_index_slot(struct fcb_log *fcb_log, struct flash_area *fa)
+{
+    int idx;
+
+    idx = fa - fcb_log->fl_fcb.f_sectors;
+    if (idx >= MYNEWT_VAL(FCB_LOG_SECTOR_INDEX)) {
+        return NULL;
+    }
+    return &fcb_log->fl_index[idx];
+}
+
+static void
+log_fcb_index_rebuild(struct fcb_log *fcb_log)
+{
+    struct fcb_log_sector *fls;
+    struct flash_area *fa;
+    struct fcb *fcb;
+    uint32_t index;
+    uint16_t id;
+
+    fcb = &fcb_log->fl_fcb;
+    memset(fcb_log->fl_index, 0, sizeof(fcb_log->fl_index));
+
+    fa = fcb->f_active.fe_area;
+    if (!fa) {
+        return;
+    }
+    id = fcb->f_active_id;
+    while (1) {
+        fls = log_fcb_index_slot(fcb_log, fa);
+        if (fls && log_fcb_first_index(fcb, fa, &index) == 0) {
+            fls->fls_index = index;
+            fls->fls_id = id;
+            fls->fls_valid = 1;
+        }
+        if (fa == fcb->f_oldest) {
+            break;
+        }
+        fa = log_fcb_prev_area(fcb, fa);
+        id--;
+    }
+    fcb_log->fl_index_built = 1;
+}
+
+/*
+ * Called after an entry has been appended. If it is the first one in the
+ * active sector, its index goes into the slot of that sector.
+ */
+static void
+log_fcb_index_note(struct fcb_log *fcb_log, struct fcb_entry *loc,
+                   const struct log_entry_hdr *ueh)
+{
+    struct fcb_log_sector *fls;
+    struct fcb *fcb;
+
+    fcb = &fcb_log->fl_fcb;
+    if (!fcb_log->fl_index_built || loc->fe_area != fcb->f_active.fe_area) {
+        return;
+    }
+
+    fls = log_fcb_index_slot(fcb_log, loc->fe_area);
+    if (!fls || (fls->fls_valid && fls->fls_id == fcb->f_active_id)) {
+        return;
+    }
+    fls->fls_index = ueh->ue_index;
+    fls->fls_id = fcb->f_active_id;
+    fls->fls_valid = 1;
+}
+
+/*
+ * Finds the newest sector whose first entry has an index at or below
+ * lo_index. Returns NULL if the walk has to start from the oldest sector.
+ */
+static struct flash_area *
+log_fcb_index_seek(struct fcb_log *fcb_log, uint32_t lo_index)
+{
+    struct fcb_log_sector *fls;
+    struct flash_area *fa;
+    struct fcb *fcb;
+    uint32_t index;
+    uint16_t id;
+    int pass;
+
+    fcb = &fcb_log->fl_fcb;
+    for (pass = 0; pass < 2; pass++) {
+        if (!fcb_log->fl_index_built || pass > 0) {
+            log_fcb_index_rebuild(fcb_log);
+        }
+
+        fa = fcb->f_active.fe_area;
+        id = fcb->f_active_id;
+        while (1) {
+            fls = log_fcb_index_slot(fcb_log, fa);
+            if (fls && fls->fls_valid && fls->fls_id == id &&
+                fls->fls_index <= lo_index) {
+                break;
+            }
+            if (fa == fcb->f_oldest) {
+                return NULL;
+            }
+            fa = log_fcb_prev_area(fcb, fa);
+            id--;
+        }
+        if (fa == fcb->f_oldest) {
+            return NULL;
+        }
+
+        /*
+         * The FCB can get reinitialized underneath the log (see
+         * log_fcb_slot1), so check against flash before skipping anything.
+         */
+        if (log_fcb_first_index(fcb, fa, &index) == 0 && index <= lo_index) {
+            return fa;
+        }
+    }
+    return NULL;
+}
+
+static int
+log_fcb_registered(struct log *log)
+{
+    log_fcb_index_rebuild(log->l_arg);
+    return 0;
+}
+#endif
+
 static int
 log_fcb_start_append(struct log *log, int len, struct fcb_entry *loc)
 {
@@ -91,6 +269,11 @@ log_fcb_append(struct log *log, void *buf, int len)
     }
 
     rc = fcb_append_finish(fcb, &loc);
+#if MYNEWT_VAL(FCB_LOG_SECTOR_INDEX)
+    if (rc == 0 && len >= sizeof(struct log_entry_hdr)) {
+        log_fcb_index_note(fcb_log, &loc, buf);
+    }
+#endif
 
 err:
     return (rc);
@@ -103,6 +286,10 @@ log_fcb_append_mbuf(struct log *log, struct os_mbuf *om)
     struct fcb_entry loc;
     struct fcb_log *fcb_log;
     struct os_mbuf *om_tmp;
+#if MYNEWT_VAL(FCB_LOG_SECTOR_INDEX)
+    struct log_entry_hdr ueh;
+    int hdr_rc;
+#endif
     int len;
     int rc;
 
@@ -122,6 +309,10 @@ log_fcb_append_mbuf(struct log *log, struct os_mbuf *om)
         goto err;
     }
 
+#if MYNEWT_VAL(FCB_LOG_SECTOR_INDEX)
+    hdr_rc = os_mbuf_copydata(om, 0, sizeof(ueh), &ueh);
+#endif
+
     while (om) {
         rc = flash_area_write(loc.fe_area, loc.fe_data_off, om->om_data,
                               om->om_len);
@@ -134,6 +325,11 @@ log_fcb_append_mbuf(struct log *log, struct os_mbuf *om)
     }
 
     rc = fcb_append_finish(fcb, &loc);
+#if MYNEWT_VAL(FCB_LOG_SECTOR_INDEX)
+    if (rc == 0 && hdr_rc == 0) {
+        log_fcb_index_note(fcb_log, &loc, &ueh);
+    }
+#endif
 
 err:
     return (rc);
@@ -202,13 +398,15 @@ static int
 log_fcb_walk(struct log *log, log_walk_func_t walk_func,
              struct log_offset *log_offset)
 {
+    struct fcb_log *fcb_log;
     struct fcb *fcb;
     struct fcb_entry loc;
     struct fcb_entry *locp;
     int rc;
 
     rc = 0;
-    fcb = &((struct fcb_log *)log->l_arg)->fl_fcb;
+    fcb_log = log->l_arg;
+    fcb = &fcb_log->fl_fcb;
 
     memset(&loc, 0, sizeof(loc));
 
@@ -219,6 +417,15 @@ log_fcb_walk(struct log *log, log_walk_func_t walk_func,
         locp = &fcb->f_active;
         rc = walk_func(log, log_offset, (void *)locp, locp->fe_data_len);
     } else {
+#if MYNEWT_VAL(FCB_LOG_SECTOR_INDEX)
+        /*
+         * Timestamps are not guaranteed to grow (e.g. clock reset at
+         * reboot), so only a walk by index can skip sectors.
+         */
+        if (log_offset->lo_ts == 0 && log_offset->lo_index != 0) {
+            loc.fe_area = log_fcb_index_seek(fcb_log, log_offset->lo_index);
+        }
+#endif
         while (fcb_getnext(fcb, &loc) == 0) {
             rc = walk_func(log, log_offset, (void *) &loc, loc.fe_data_len);
             if (rc) {
@@ -229,6 +436,83 @@ log_fcb_walk(struct log *log, log_walk_func_t walk_func,
     return (rc);
 }
 
+/*
+ * Walks the log newest entry first.  FCB entries can only be read forwards,
+ * so each sector is scanned from its start and the entries are handed to
+ * walk_func in batches of LOG_FCB_REVERSE_BATCH, last batch first.  A sector
+ * with more entries than that gets rescanned once per batch.
+ */
+#define LOG_FCB_REVERSE_BATCH   16
+
+static int
+log_fcb_walk_reverse(struct log *log, log_walk_func_t walk_func,
+                     struct log_offset *log_offset)
+{
+    struct fcb_entry batch[LOG_FCB_REVERSE_BATCH];
+    struct fcb_entry *locp;
+    struct fcb_entry loc;
+    struct flash_area *fa;
+    struct fcb *fcb;
+    uint32_t end_off;
+    uint32_t index;
+    int total;
+    int cnt;
+    int rc;
+    int i;
+
+    fcb = &((struct fcb_log *)log->l_arg)->fl_fcb;
+
+    if (log_offset->lo_ts < 0) {
+        locp = &fcb->f_active;
+        return walk_func(log, log_offset, (void *)locp, locp->fe_data_len);
+    }
+
+    fa = fcb->f_active.fe_area;
+    while (1) {
+        /* Entries at or past end_off have been handed out already. */
+        end_off = UINT32_MAX;
+        do {
+            total = 0;
+            loc.fe_area = fa;
+            loc.fe_elem_off = 0;
+            while (fcb_getnext(fcb, &loc) == 0 && loc.fe_area == fa &&
+                   loc.fe_elem_off < end_off) {
+                batch[total % LOG_FCB_REVERSE_BATCH] = loc;
+                total++;
+            }
+
+            cnt = min(total, LOG_FCB_REVERSE_BATCH);
+            for (i = total - 1; i >= total - cnt; i--) {
+                locp = &batch[i % LOG_FCB_REVERSE_BATCH];
+                rc = walk_func(log, log_offset, locp, locp->fe_data_len);
+                if (rc) {
+                    return rc;
+                }
+            }
+            if (cnt) {
+                end_off = locp->fe_elem_off;
+            }
+        } while (total > cnt);
+
+        if (fa == fcb->f_oldest) {
+            break;
+        }
+
+        /*
+         * Indices grow with every entry, so once this sector starts at or
+         * below the requested index the older ones hold nothing of interest.
+         */
+        if (log_offset->lo_ts == 0 && log_offset->lo_index != 0 &&
+            log_fcb_first_index(fcb, fa, &index) == 0 &&
+            index <= log_offset->lo_index) {
+            break;
+        }
+        fa = log_fcb_prev_area(fcb, fa);
+    }
+
+    return 0;
+}
+
 static int
 log_fcb_flush(struct log *log)
 {
@@ -242,13 +526,13 @@ log_fcb_flush(struct log *log)
  */
 static int
 log_fcb_copy_entry(struct log *log, struct fcb_entry *entry,
-                   struct fcb *dst_fcb)
+                   struct fcb_log *dst_fcb)
 {
     struct log_entry_hdr ueh;
     char data[LOG_PRINTF_MAX_ENTRY_LEN + sizeof(ueh)];
     int dlen;
     int rc;
-    struct fcb *fcb_tmp;
+    struct fcb_log *fcb_tmp;
 
     rc = log_fcb_read(log, entry, &ueh, 0, sizeof(ueh));
     if (rc != sizeof(ueh)) {
@@ -264,7 +548,7 @@ log_fcb_copy_entry(struct log *log, struct fcb_entry *entry,
     data[rc] = '\0';
 
     /* Changing the fcb to be logged to be dst fcb */
-    fcb_tmp = &((struct fcb_log *)log->l_arg)->fl_fcb;
+    fcb_tmp = log->l_arg;
 
     log->l_arg = dst_fcb;
     rc = log_fcb_append(log, data, dlen);
@@ -283,7 +567,7 @@ err:
  * @return 0 on success; non-zero on error
  */
 static int
-log_fcb_copy(struct log *log, struct fcb *src_fcb, struct fcb *dst_fcb,
+log_fcb_copy(struct log *log, struct fcb *src_fcb, struct fcb_log *dst_fcb,
              uint32_t offset)
 {
     struct fcb_entry entry;
@@ -315,7 +599,7 @@ static int
 log_fcb_rtr_erase(struct log *log, void *arg)
 {
     struct fcb_log *fcb_log;
-    struct fcb fcb_scratch;
+    struct fcb_log fcb_scratch;
     struct fcb *fcb;
     const struct flash_area *ptr;
     struct fcb_entry entry;
@@ -336,13 +620,13 @@ log_fcb_rtr_erase(struct log *log, void *arg)
         goto err;
     }
     sector = *ptr;
-    fcb_scratch.f_sectors = &sector;
-    fcb_scratch.f_sector_cnt = 1;
-    fcb_scratch.f_magic = 0x7EADBADF;
-    fcb_scratch.f_version = g_log_info.li_version;
+    fcb_scratch.fl_fcb.f_sectors = &sector;
+    fcb_scratch.fl_fcb.f_sector_cnt = 1;
+    fcb_scratch.fl_fcb.f_magic = 0x7EADBADF;
+    fcb_scratch.fl_fcb.f_version = g_log_info.li_version;
 
     flash_area_erase(&sector, 0, sector.fa_size);
-    rc = fcb_init(&fcb_scratch);
+    rc = fcb_init(&fcb_scratch.fl_fcb);
     if (rc) {
         goto err;
     }
@@ -366,7 +650,7 @@ log_fcb_rtr_erase(struct log *log, void *arg)
     }
 
     /* Copy back from scratch */
-    rc = log_fcb_copy(log, &fcb_scratch, fcb, 0);
+    rc = log_fcb_copy(log, &fcb_scratch.fl_fcb, fcb_log, 0);
 
 err:
     return (rc);
@@ -379,7 +663,11 @@ const struct log_handler log_fcb_handler = {
     .log_append = log_fcb_append,
     .log_append_mbuf = log_fcb_append_mbuf,
     .log_walk = log_fcb_walk,
+    .log_walk_reverse = log_fcb_walk_reverse,
     .log_flush = log_fcb_flush,
+#if MYNEWT_VAL(FCB_LOG_SECTOR_INDEX)
+    .log_registered = log_fcb_registered,
+#endif
 };
 
 #endif
@@ -0,0 +1,482 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "os/mynewt.h"
+
+#if MYNEWT_VAL(LOG_DEFERRED_FMT)
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "log/log.h"
+
+/*
+ * Deferred formatting.  Rather than the formatted text, LOG_ETYPE_FMT entries
+ * hold the ID of the format string, a hash of it, and the raw argument
+ * values; the text is only put together when the entry gets read back.
+ *
+ * The ID is the format string's offset in the log_fmt section, where
+ * log_printf_deferred() puts it.  It depends only on the image, so entries
+ * written on an earlier boot read back the same.  Reading an entry never
+ * follows a pointer stored in the log, and an ID written by another image
+ * is used only if the hash matches the string at that offset now.
+ */
+struct log_fmt_hdr {
+    uint16_t lfh_id;
+    uint16_t lfh_hash;
+} __attribute__((__packed__));
+
+/* Argument types, as given by the conversion specification. */
+#define LOG_FMT_ARG_BAD         (-1)
+#define LOG_FMT_ARG_NONE        (0)
+#define LOG_FMT_ARG_INT         (1)
+#define LOG_FMT_ARG_LONG        (2)
+#define LOG_FMT_ARG_LLONG       (3)
+#define LOG_FMT_ARG_INTMAX      (4)
+#define LOG_FMT_ARG_SIZE        (5)
+#define LOG_FMT_ARG_PTRDIFF     (6)
+#define LOG_FMT_ARG_PTR         (7)
+#define LOG_FMT_ARG_DOUBLE      (8)
+#define LOG_FMT_ARG_STR         (9)
+
+/* Longest conversion specification handled, once '*'s are filled in. */
+#define LOG_FMT_SPEC_MAX        (24)
+
+/*
+ * Parses the conversion specification following a '%'.  Returns the type of
+ * the argument it consumes and points *end past the specification.
+ */
+static int
+log_fmt_spec(const char *p, const char **end)
+{
+    int type;
+
+    while (*p != '\0' && strchr("-+ #0123456789.*", *p) != NULL) {
+        p++;
+    }
+
+    type = LOG_FMT_ARG_INT;
+    for (; *p != '\0' && strchr("hljzt", *p) != NULL; p++) {
+        switch (*p) {
+        case 'l':
+            type = type == LOG_FMT_ARG_LONG ? LOG_FMT_ARG_LLONG :
+                                              LOG_FMT_ARG_LONG;
+            break;
+        case 'j':
+            type = LOG_FMT_ARG_INTMAX;
+            break;
+        case 'z':
+            type = LOG_FMT_ARG_SIZE;
+            break;
+        case 't':
+            type = LOG_FMT_ARG_PTRDIFF;
+            break;
+        }
+    }
+
+    switch (*p) {
+    case 'd':
+    case 'i':
+    case 'u':
+    case 'o':
+    case 'x':
+    case 'X':
+        break;
+    case 'c':
+        type = type == LOG_FMT_ARG_INT ? type : LOG_FMT_ARG_BAD;
+        break;
+    case 'p':
+        type = type == LOG_FMT_ARG_INT ? LOG_FMT_ARG_PTR : LOG_FMT_ARG_BAD;
+        break;
+    case 's':
+        type = type == LOG_FMT_ARG_INT ? LOG_FMT_ARG_STR : LOG_FMT_ARG_BAD;
+        break;
+    case 'f':
+    case 'F':
+    case 'e':
+    case 'E':
+    case 'g':
+    case 'G':
+    case 'a':
+    case 'A':
+        type = type == LOG_FMT_ARG_INT ? LOG_FMT_ARG_DOUBLE : LOG_FMT_ARG_BAD;
+        break;
+    case '%':
+        type = LOG_FMT_ARG_NONE;
+        break;
+    default:
+        /* %n, long double, wide characters. */
+        type = LOG_FMT_ARG_BAD;
+        break;
+    }
+
+    *end = *p != '\0' ? p + 1 : p;
+    return type;
+}
+
+#define LOG_FMT_PUT(_buf, _off, _max, _ctype, _ap)                      \
+    do {                                                                \
+        _ctype _v = va_arg(_ap, _ctype);                                \
+        if ((_off) + sizeof(_v) > (_max)) {                             \
+            goto full;                                                  \
+        }                                                               \
+        memcpy((_buf) + (_off), &_v, sizeof(_v));                       \
+        (_off) += sizeof(_v);                                           \
+    } while (0)
+
+static uint16_t
+log_fmt_hash(const char *fmt)
+{
+    uint32_t hash;
+
+    hash = 2166136261UL;
+    for (; *fmt != '\0'; fmt++) {
+        hash = (hash ^ (uint8_t)*fmt) * 16777619;
+    }
+    return (hash >> 16) ^ (hash & 0xffff);
+}
+
+/*
+ * Returns the ID of format string fmt, or -1 if it does not fit in an entry
+ * header.
+ */
+static int
+log_fmt_id(const char *fmt)
+{
+    ptrdiff_t id;
+
+    id = fmt - log_fmt_start;
+    if (id < 0 || id > UINT16_MAX) {
+        return -1;
+    }
+    return id;
+}
+
+/*
+ * Returns the format string with ID id, or NULL if there is none.
+ */
+static const char *
+log_fmt_lookup(unsigned int id)
+{
+    const char *fmt;
+    size_t max;
+
+    if (id >= log_fmt_end - log_fmt_start) {
+        return NULL;
+    }
+    fmt = log_fmt_start + id;
+    max = log_fmt_end - fmt;
+    if (strnlen(fmt, max) == max) {
+        return NULL;
+    }
+    return fmt;
+}
+
+/*
+ * Stores the format string's ID, its hash and the arguments in buf.
+ * Returns the number of bytes used.  Arguments not fitting in max_len are
+ * left out; they show up as a truncated message when read back.
+ */
+static int
+log_fmt_encode(uint8_t *buf, int max_len, int id, const char *fmt,
+               va_list ap)
+{
+    struct log_fmt_hdr hdr;
+    const char *end;
+    const char *p;
+    const char *s;
+    int type;
+    int off;
+    int len;
+
+    hdr.lfh_id = id;
+    hdr.lfh_hash = log_fmt_hash(fmt);
+    memcpy(buf, &hdr, sizeof(hdr));
+    off = sizeof(hdr);
+
+    for (p = fmt; *p != '\0'; p++) {
+        if (*p != '%') {
+            continue;
+        }
+
+        type = log_fmt_spec(p + 1, &end);
+        for (p++; p < end; p++) {
+            if (*p == '*') {
+                LOG_FMT_PUT(buf, off, max_len, int, ap);
+            }
+        }
+        p--;
+
+        switch (type) {
+        case LOG_FMT_ARG_NONE:
+            break;
+        case LOG_FMT_ARG_INT:
+            LOG_FMT_PUT(buf, off, max_len, int, ap);
+            break;
+        case LOG_FMT_ARG_LONG:
+            LOG_FMT_PUT(buf, off, max_len, long, ap);
+            break;
+        case LOG_FMT_ARG_LLONG:
+            LOG_FMT_PUT(buf, off, max_len, long long, ap);
+            break;
+        case LOG_FMT_ARG_INTMAX:
+            LOG_FMT_PUT(buf, off, max_len, intmax_t, ap);
+            break;
+        case LOG_FMT_ARG_SIZE:
+            LOG_FMT_PUT(buf, off, max_len, size_t, ap);
+            break;
+        case LOG_FMT_ARG_PTRDIFF:
+            LOG_FMT_PUT(buf, off, max_len, ptrdiff_t, ap);
+            break;
+        case LOG_FMT_ARG_PTR:
+            LOG_FMT_PUT(buf, off, max_len, void *, ap);
+            break;
+        case LOG_FMT_ARG_DOUBLE:
+            LOG_FMT_PUT(buf, off, max_len, double, ap);
+            break;
+        case LOG_FMT_ARG_STR:
+            s = va_arg(ap, const char *);
+            if (s == NULL) {
+                s = "(null)";
+            }
+            len = strlen(s);
+            if (len > max_len - off - 1) {
+                len = max_len - off - 1;
+            }
+            if (len < 0 || len > UINT8_MAX) {
+                goto full;
+            }
+            buf[off++] = len;
+            memcpy(buf + off, s, len);
+            off += len;
+            break;
+        default:
+            goto full;
+        }
+    }
+
+full:
+    return off;
+}
+
+#define LOG_FMT_GET(_data, _off, _len, _ctype, _v)                      \
+    do {                                                                \
+        if ((_off) + sizeof(_ctype) > (_len)) {                         \
+            goto done;                                                  \
+        }                                                               \
+        memcpy(&(_v), (_data) + (_off), sizeof(_ctype));                \
+        (_off) += sizeof(_ctype);                                       \
+    } while (0)
+
+#define LOG_FMT_PRINT(_buf, _o, _buf_len, _spec, _ctype, _data, _off,   \
+                      _len)                                             \
+    do {                                                                \
+        _ctype _v;                                                      \
+        LOG_FMT_GET(_data, _off, _len, _ctype, _v);                     \
+        _o += snprintf((_buf) + (_o), (_buf_len) - (_o), _spec, _v);    \
+    } while (0)
+
+/*
+ * Builds the text of a deferred format entry.  data and len describe the
+ * entry body, following the log entry header.  Returns the length of the
+ * text written to buf, which is always NUL terminated.
+ */
+static int
+log_fmt_decode(const uint8_t *data, int len, char *buf, int buf_len)
+{
+    char spec[LOG_FMT_SPEC_MAX + 1];
+    char str[LOG_PRINTF_MAX_ENTRY_LEN];
+    struct log_fmt_hdr hdr;
+    const char *fmt;
+    const char *end;
+    const char *p;
+    int star;
+    int off;
+    int type;
+    int slen;
+    int o;
+    int i;
+
+    o = 0;
+    buf[0] = '\0';
+    if (len < sizeof(hdr)) {
+        goto done;
+    }
+    memcpy(&hdr, data, sizeof(hdr));
+    off = sizeof(hdr);
+
+    fmt = log_fmt_lookup(hdr.lfh_id);
+    if (fmt == NULL || log_fmt_hash(fmt) != hdr.lfh_hash) {
+        o = snprintf(buf, buf_len, "<unknown format %u/%04x>",
+                     hdr.lfh_id, hdr.lfh_hash);
+        goto done;
+    }
+
+    for (p = fmt; *p != '\0' && o < buf_len - 1; p++) {
+        if (*p != '%') {
+            buf[o++] = *p;
+            continue;
+        }
+
+        type = log_fmt_spec(p + 1, &end);
+        if (type == LOG_FMT_ARG_BAD) {
+            break;
+        }
+
+        /* Copy the specification, with the stored '*' values filled in. */
+        for (i = 0; p < end && i < LOG_FMT_SPEC_MAX; p++) {
+            if (*p == '*') {
+                LOG_FMT_GET(data, off, len, int, star);
+                i += snprintf(spec + i, sizeof(spec) - i, "%d", star);
+            } else {
+                spec[i++] = *p;
+            }
+        }
+        if (p < end || i > LOG_FMT_SPEC_MAX) {
+            break;
+        }
+        spec[i] = '\0';
+        p--;
+
+        switch (type) {
+        case LOG_FMT_ARG_NONE:
+            buf[o++] = '%';
+            break;
+        case LOG_FMT_ARG_INT:
+            LOG_FMT_PRINT(buf, o, buf_len, spec, int, data, off, len);
+            break;
+        case LOG_FMT_ARG_LONG:
+            LOG_FMT_PRINT(buf, o, buf_len, spec, long, data, off, len);
+            break;
+        case LOG_FMT_ARG_LLONG:
+            LOG_FMT_PRINT(buf, o, buf_len, spec, long long, data, off, len);
+            break;
+        case LOG_FMT_ARG_INTMAX:
+            LOG_FMT_PRINT(buf, o, buf_len, spec, intmax_t, data, off, len);
+            break;
+        case LOG_FMT_ARG_SIZE:
+            LOG_FMT_PRINT(buf, o, buf_len, spec, size_t, data, off, len);
+            break;
+        case LOG_FMT_ARG_PTRDIFF:
+            LOG_FMT_PRINT(buf, o, buf_len, spec, ptrdiff_t, data, off, len);
+            break;
+        case LOG_FMT_ARG_PTR:
+            LOG_FMT_PRINT(buf, o, buf_len, spec, void *, data, off, len);
+            break;
+        case LOG_FMT_ARG_DOUBLE:
+            LOG_FMT_PRINT(buf, o, buf_len, spec, double, data, off, len);
+            break;
+        case LOG_FMT_ARG_STR:
+            if (off >= len) {
+                goto done;
+            }
+            slen = data[off++];
+            if (off + slen > len) {
+                goto done;
+            }
+            memcpy(str, data + off, slen);
+            str[slen] = '\0';
+            off += slen;
+            o += snprintf(buf + o, buf_len - o, spec, str);
+            break;
+        }
+    }
+
+done:
+    if (o > buf_len - 1) {
+        o = buf_len - 1;
+    }
+    buf[o] = '\0';
+    return o;
+}
+
+/**
+ * Writes a log entry with deferred formatting: only the format string's ID
+ * and the argument values are stored, and the text is produced when the
+ * entry is read (see log_fmt_read()).  fmt must be in the log_fmt section;
+ * use log_printf_deferred(), which puts it there.
+ */
+void
+log_fmt_printf(struct log *log, uint16_t module, uint16_t level,
+               const char *fmt, ...)
+{
+    uint8_t buf[LOG_ENTRY_HDR_SIZE + LOG_PRINTF_MAX_ENTRY_LEN];
+    va_list args;
+    int len;
+    int id;
+
+    if (level < log->l_level) {
+        return;
+    }
+
+    if (log->l_log->log_type == LOG_TYPE_STREAM) {
+        /* Nothing reads a stream back. */
+        id = -1;
+    } else {
+        id = log_fmt_id(fmt);
+    }
+
+    va_start(args, fmt);
+    if (id < 0) {
+        /* Format it now. */
+        len = vsnprintf((char *)&buf[LOG_ENTRY_HDR_SIZE],
+                        LOG_PRINTF_MAX_ENTRY_LEN, fmt, args);
+        if (len >= LOG_PRINTF_MAX_ENTRY_LEN) {
+            len = LOG_PRINTF_MAX_ENTRY_LEN - 1;
+        }
+        va_end(args);
+        log_append(log, module, level, buf, len);
+        return;
+    }
+    len = log_fmt_encode(&buf[LOG_ENTRY_HDR_SIZE], LOG_PRINTF_MAX_ENTRY_LEN,
+                         id, fmt, args);
+    va_end(args);
+
+    log_append_typed(log, module, level, LOG_ETYPE_FMT, buf, len);
+}
+
+/**
+ * Reads the text of a LOG_ETYPE_FMT entry.
+ *
+ * @param log                   The log to read from.
+ * @param dptr                  The entry, as passed to the walk function.
+ * @param len                   The entry length, header included.
+ * @param buf                   The text gets written here, NUL terminated.
+ * @param buf_len               Size of buf.
+ *
+ * @return                      The length of the text.
+ */
+int
+log_fmt_read(struct log *log, void *dptr, uint16_t len, char *buf,
+             int buf_len)
+{
+    uint8_t data[LOG_PRINTF_MAX_ENTRY_LEN];
+    int rc;
+
+    rc = 0;
+    if (len > LOG_ENTRY_HDR_SIZE) {
+        rc = log_read(log, dptr, data, LOG_ENTRY_HDR_SIZE,
+                      min(len - LOG_ENTRY_HDR_SIZE, sizeof(data)));
+    }
+
+    return log_fmt_decode(data, rc, buf, buf_len);
+}
+
+#endif
@@ -38,14 +38,24 @@ static int log_nmgr_clear(struct mgmt_cbuf *njb);
 static int log_nmgr_module_list(struct mgmt_cbuf *njb);
 static int log_nmgr_level_list(struct mgmt_cbuf *njb);
 static int log_nmgr_logs_list(struct mgmt_cbuf *njb);
+#if MYNEWT_VAL(MGMT_STREAM)
+static int log_nmgr_stream(struct mgmt_cbuf *njb, struct mgmt_stream *ms);
+#endif
 static struct mgmt_group log_nmgr_group;
 
+/* Size of a non-streamed read response, beyond which no entries are added. */
+#define LOG_NMGR_MAX_RSP_LEN    (400)
+
 
 /* ORDER MATTERS HERE.
  * Each element represents the command ID, referenced from newtmgr.
  */
 static struct mgmt_handler log_nmgr_group_handlers[] = {
-    [LOGS_NMGR_OP_READ] = {log_nmgr_read, log_nmgr_read},
+    [LOGS_NMGR_OP_READ] = {log_nmgr_read, log_nmgr_read,
+#if MYNEWT_VAL(MGMT_STREAM)
+                           log_nmgr_stream
+#endif
+    },
     [LOGS_NMGR_OP_CLEAR] = {log_nmgr_clear, log_nmgr_clear},
     [LOGS_NMGR_OP_MODULE_LIST] = {log_nmgr_module_list, NULL},
     [LOGS_NMGR_OP_LEVEL_LIST] = {log_nmgr_level_list, NULL},
@@ -55,8 +65,67 @@ static struct mgmt_handler log_nmgr_group_handlers[] = {
 struct log_encode_data {
     uint32_t counter;
     CborEncoder *enc;
+    /* Response size beyond which no more entries are added. */
+    int max_len;
+    /* Entries with a lower index are skipped; resumes a streamed read. */
+    uint32_t min_index;
+    /* Encode at least one entry, even if the response is already full. */
+    uint8_t force;
+    /* Set if an entry was left out because the response was full. */
+    uint8_t full;
+    /* Index of the last entry encoded. */
+    uint32_t last_index;
 };
 
+#if MYNEWT_VAL(LOG_VERSION) > 2
+/**
+ * Encodes the data of a log entry.
+ * @param encoder, log structure, dataptr, len, entry type
+ * @return CborNoError on success
+ */
+static CborError
+log_nmgr_encode_msg(CborEncoder *rsp, struct log *log, void *dptr,
+                    uint16_t len, uint8_t etype)
+{
+    CborEncoder str_encoder;
+    CborError g_err = CborNoError;
+    uint8_t data[128];
+    int off;
+    int rc;
+
+    /*
+     * Write entry data as byte string. Since this may not fit into single
+     * chunk of data we will write as indefinite-length byte string which is
+     * basically a indefinite-length container with definite-length strings
+     * inside.
+     */
+    g_err |= cbor_encoder_create_indef_byte_string(rsp, &str_encoder);
+#if MYNEWT_VAL(LOG_DEFERRED_FMT)
+    if (etype == LOG_ETYPE_FMT) {
+        /* Deferred format entries are sent as the formatted text. */
+        rc = log_fmt_read(log, dptr, len, (char *)data, sizeof(data));
+        g_err |= cbor_encode_byte_string(&str_encoder, data, rc);
+        goto done;
+    }
+#endif
+    for (off = sizeof(struct log_entry_hdr); (off < len) && !g_err; ) {
+        rc = log_read(log, dptr, data, off, sizeof(data));
+        if (rc < 0) {
+            g_err |= 1;
+            break;
+        }
+        g_err |= cbor_encode_byte_string(&str_encoder, data, rc);
+        off += rc;
+    }
+#if MYNEWT_VAL(LOG_DEFERRED_FMT)
+done:
+#endif
+    g_err |= cbor_encoder_close_container(rsp, &str_encoder);
+
+    return g_err;
+}
+#endif
+
 /**
  * Log encode entry
  * @param log structure, log_offset, dataptr, len
@@ -67,7 +136,9 @@ log_nmgr_encode_entry(struct log *log, struct log_offset *log_offset,
                       void *dptr, uint16_t len)
 {
     struct log_entry_hdr ueh;
+#if MYNEWT_VAL(LOG_VERSION) < 3
     uint8_t data[128];
+#endif
     int rc;
     int rsp_len;
     CborError g_err = CborNoError;
@@ -75,10 +146,11 @@ log_nmgr_encode_entry(struct log *log, struct log_offset *log_offset,
     CborEncoder rsp;
     struct CborCntWriter cnt_writer;
     CborEncoder cnt_encoder;
-#if MYNEWT_VAL(LOG_VERSION) > 2
-    CborEncoder str_encoder;
-    int off;
-#endif
+
+    /* Once an entry has been left out, the ones after it must be too. */
+    if (ed->full) {
+        return OS_ENOMEM;
+    }
 
     rc = log_read(log, dptr, &ueh, 0, sizeof(ueh));
     if (rc != sizeof(ueh)) {
@@ -106,6 +178,9 @@ log_nmgr_encode_entry(struct log *log, struct log_offset *log_offset,
                 ueh.ue_index < log_offset->lo_index)) {
         goto err;
     }
+    if (ueh.ue_index < ed->min_index) {
+        goto err;
+    }
 
 #if MYNEWT_VAL(LOG_VERSION) < 3
     rc = log_read(log, dptr, data, sizeof(ueh), min(len - sizeof(ueh), 128));
@@ -134,6 +209,9 @@ log_nmgr_encode_entry(struct log *log, struct log_offset *log_offset,
         g_err |= cbor_encode_text_stringz(&rsp, "type");
         g_err |= cbor_encode_text_stringz(&rsp, "bin");
         break;
+#if MYNEWT_VAL(LOG_DEFERRED_FMT)
+    case LOG_ETYPE_FMT:
+#endif
     case LOG_ETYPE_STRING:
     default:
         /* no need for type here */
@@ -143,24 +221,7 @@ log_nmgr_encode_entry(struct log *log, struct log_offset *log_offset,
     }
 
     g_err |= cbor_encode_text_stringz(&rsp, "msg");
-
-    /*
-     * Write entry data as byte string. Since this may not fit into single
-     * chunk of data we will write as indefinite-length byte string which is
-     * basically a indefinite-length container with definite-length strings
-     * inside.
-     */
-    g_err |= cbor_encoder_create_indef_byte_string(&rsp, &str_encoder);
-    for (off = sizeof(ueh); (off < len) && !g_err; ) {
-        rc = log_read(log, dptr, data, off, sizeof(data));
-        if (rc < 0) {
-            g_err |= 1;
-            break;
-        }
-        g_err |= cbor_encode_byte_string(&str_encoder, data, rc);
-        off += rc;
-    }
-    g_err |= cbor_encoder_close_container(&rsp, &str_encoder);
+    g_err |= log_nmgr_encode_msg(&rsp, log, dptr, len, ueh.ue_etype);
 #else
     g_err |= cbor_encode_text_stringz(&rsp, "msg");
     g_err |= cbor_encode_text_stringz(&rsp, (char *)data);
@@ -180,7 +241,8 @@ log_nmgr_encode_entry(struct log *log, struct log_offset *log_offset,
      * exceeds this magic value. This is to make sure we can read long log
      * entries, even if they have to be read one by one.
      */
-    if ((rsp_len > 400) && (ed->counter > 0)) {
+    if ((rsp_len > ed->max_len) && (ed->counter > 0)) {
+        ed->full = 1;
         rc = OS_ENOMEM;
         goto err;
     }
@@ -197,6 +259,9 @@ log_nmgr_encode_entry(struct log *log, struct log_offset *log_offset,
         g_err |= cbor_encode_text_stringz(&rsp, "type");
         g_err |= cbor_encode_text_stringz(&rsp, "bin");
         break;
+#if MYNEWT_VAL(LOG_DEFERRED_FMT)
+    case LOG_ETYPE_FMT:
+#endif
     case LOG_ETYPE_STRING:
     default:
         /* no need for type here */
@@ -206,24 +271,7 @@ log_nmgr_encode_entry(struct log *log, struct log_offset *log_offset,
     }
 
     g_err |= cbor_encode_text_stringz(&rsp, "msg");
-
-    /*
-     * Write entry data as byte string. Since this may not fit into single
-     * chunk of data we will write as indefinite-length byte string which is
-     * basically a indefinite-length container with definite-length strings
-     * inside.
-     */
-    g_err |= cbor_encoder_create_indef_byte_string(&rsp, &str_encoder);
-    for (off = sizeof(ueh); (off < len) && !g_err; ) {
-        rc = log_read(log, dptr, data, off, sizeof(data));
-        if (rc < 0) {
-            g_err |= 1;
-            break;
-        }
-        g_err |= cbor_encode_byte_string(&str_encoder, data, rc);
-        off += rc;
-    }
-    g_err |= cbor_encoder_close_container(&rsp, &str_encoder);
+    g_err |= log_nmgr_encode_msg(&rsp, log, dptr, len, ueh.ue_etype);
 #else
     g_err |= cbor_encode_text_stringz(&rsp, "msg");
     g_err |= cbor_encode_text_stringz(&rsp, (char *)data);
@@ -239,6 +287,7 @@ log_nmgr_encode_entry(struct log *log, struct log_offset *log_offset,
     g_err |= cbor_encoder_close_container(ed->enc, &rsp);
 
     ed->counter++;
+    ed->last_index = ueh.ue_index;
 
     if (g_err) {
         return MGMT_ERR_ENOMEM;
@@ -255,7 +304,7 @@ err:
  */
 static int
 log_encode_entries(struct log *log, CborEncoder *cb,
-                   int64_t ts, uint32_t index)
+                   int64_t ts, uint32_t index, struct log_encode_data *ed)
 {
     int rc;
     struct log_offset log_offset;
@@ -264,7 +313,6 @@ log_encode_entries(struct log *log, CborEncoder *cb,
     CborError g_err = CborNoError;
     struct CborCntWriter cnt_writer;
     CborEncoder cnt_encoder;
-    struct log_encode_data ed;
 
     memset(&log_offset, 0, sizeof(log_offset));
 
@@ -278,7 +326,8 @@ log_encode_entries(struct log *log, CborEncoder *cb,
     g_err |= cbor_encoder_close_container(&cnt_encoder, &entries);
     rsp_len = cbor_encode_bytes_written(cb) +
               cbor_encode_bytes_written(&cnt_encoder);
-    if (rsp_len > 400) {
+    if (rsp_len > ed->max_len && !ed->force) {
+        ed->full = 1;
         rc = OS_ENOMEM;
         goto err;
     }
@@ -286,10 +335,10 @@ log_encode_entries(struct log *log, CborEncoder *cb,
     g_err |= cbor_encode_text_stringz(cb, "entries");
     g_err |= cbor_encoder_create_array(cb, &entries, CborIndefiniteLength);
 
-    ed.counter = 0;
-    ed.enc = &entries;
+    ed->counter = 0;
+    ed->enc = &entries;
 
-    log_offset.lo_arg       = &ed;
+    log_offset.lo_arg       = ed;
     log_offset.lo_index     = index;
     log_offset.lo_ts        = ts;
     log_offset.lo_data_len  = rsp_len;
@@ -310,7 +359,7 @@ err:
  */
 static int
 log_encode(struct log *log, CborEncoder *cb,
-            int64_t ts, uint32_t index)
+            int64_t ts, uint32_t index, struct log_encode_data *ed)
 {
     int rc;
     CborEncoder logs;
@@ -323,7 +372,7 @@ log_encode(struct log *log, CborEncoder *cb,
     g_err |= cbor_encode_text_stringz(&logs, "type");
     g_err |= cbor_encode_uint(&logs, log->l_log->log_type);
 
-    rc = log_encode_entries(log, &logs, ts, index);
+    rc = log_encode_entries(log, &logs, ts, index, ed);
     g_err |= cbor_encoder_close_container(cb, &logs);
     if (g_err) {
         return MGMT_ERR_ENOMEM;
@@ -332,45 +381,58 @@ log_encode(struct log *log, CborEncoder *cb,
 }
 
 /**
- * Newtmgr Log read handler
- * @param cbor buffer
+ * Parses the arguments of a log read request.
+ * @param cbor buffer, log name, timestamp, index
  * @return 0 on success; non-zero on failure
  */
 static int
-log_nmgr_read(struct mgmt_cbuf *cb)
+log_nmgr_read_args(struct mgmt_cbuf *cb, char *name, int64_t *ts,
+                   uint64_t *index)
 {
-    struct log *log;
-    int rc;
-    char name[LOG_NAME_MAX_LEN] = {0};
-    int name_len;
-    int64_t ts;
-    uint64_t index;
-    CborError g_err = CborNoError;
-    CborEncoder logs;
-
     const struct cbor_attr_t attr[4] = {
         [0] = {
             .attribute = "log_name",
             .type = CborAttrTextStringType,
             .addr.string = name,
-            .len = sizeof(name)
+            .len = LOG_NAME_MAX_LEN
         },
         [1] = {
             .attribute = "ts",
             .type = CborAttrIntegerType,
-            .addr.integer = &ts
+            .addr.integer = ts
         },
         [2] = {
             .attribute = "index",
             .type = CborAttrUnsignedIntegerType,
-            .addr.uinteger = &index
+            .addr.uinteger = index
         },
         [3] = {
             .attribute = NULL
         }
     };
 
-    rc = cbor_read_object(&cb->it, attr);
+    return cbor_read_object(&cb->it, attr);
+}
+
+/**
+ * Newtmgr Log read handler
+ * @param cbor buffer
+ * @return 0 on success; non-zero on failure
+ */
+static int
+log_nmgr_read(struct mgmt_cbuf *cb)
+{
+    struct log *log;
+    int rc;
+    char name[LOG_NAME_MAX_LEN] = {0};
+    int name_len;
+    int64_t ts;
+    uint64_t index;
+    CborError g_err = CborNoError;
+    CborEncoder logs;
+    struct log_encode_data ed;
+
+    rc = log_nmgr_read_args(cb, name, &ts, &index);
     if (rc) {
         return rc;
     }
@@ -399,7 +461,9 @@ log_nmgr_read(struct mgmt_cbuf *cb)
             continue;
         }
 
-        rc = log_encode(log, &logs, ts, index);
+        memset(&ed, 0, sizeof(ed));
+        ed.max_len = LOG_NMGR_MAX_RSP_LEN;
+        rc = log_encode(log, &logs, ts, index, &ed);
         if (rc) {
             goto err;
         }
@@ -428,6 +492,116 @@ err:
     return (rc);
 }
 
+#if MYNEWT_VAL(MGMT_STREAM)
+/**
+ * Returns the n'th log a read request for the given log name applies to.
+ */
+static struct log *
+log_nmgr_nth_log(const char *name, uint32_t n)
+{
+    struct log *log;
+
+    log = NULL;
+    while (1) {
+        log = log_list_get_next(log);
+        if (!log) {
+            break;
+        }
+
+        if (log->l_log->log_type == LOG_TYPE_STREAM) {
+            continue;
+        }
+
+        if (name[0] != '\0' && strcmp(name, log->l_name)) {
+            continue;
+        }
+
+        if (n-- == 0) {
+            break;
+        }
+    }
+
+    return log;
+}
+
+/**
+ * Newtmgr Log read handler for streamed responses.  Takes the same request
+ * as log_nmgr_read(), and each part has the same layout as its response.
+ * A part holds entries of a single log, as many as fit the part's budget.
+ * Cursor 0 is the position of that log among the ones the request matches,
+ * cursor 1 the index to resume from within it.
+ *
+ * @param cbor buffer, stream state
+ * @return 0 on success; non-zero on failure
+ */
+static int
+log_nmgr_stream(struct mgmt_cbuf *cb, struct mgmt_stream *ms)
+{
+    struct log *log;
+    int rc;
+    char name[LOG_NAME_MAX_LEN] = {0};
+    int64_t ts;
+    uint64_t index;
+    CborError g_err = CborNoError;
+    CborEncoder logs;
+    struct log_encode_data ed;
+
+    rc = log_nmgr_read_args(cb, name, &ts, &index);
+    if (rc) {
+        return rc;
+    }
+
+    g_err |= cbor_encode_text_stringz(&cb->encoder, "next_index");
+    g_err |= cbor_encode_int(&cb->encoder, g_log_info.li_next_index);
+
+    g_err |= cbor_encode_text_stringz(&cb->encoder, "logs");
+    g_err |= cbor_encoder_create_array(&cb->encoder, &logs,
+                                       CborIndefiniteLength);
+
+    log = log_nmgr_nth_log(name, ms->ms_cursor[0]);
+    if (!log) {
+        if (name[0] != '\0') {
+            rc = OS_EINVAL;
+        }
+        goto err;
+    }
+
+    /*
+     * Leave room for the breaks closing the log map and the logs array, and
+     * for the rc that follows them.
+     */
+    memset(&ed, 0, sizeof(ed));
+    ed.max_len = ms->ms_budget - 6;
+    ed.force = 1;
+    ed.min_index = ms->ms_cursor[1];
+    /* Lets the walk skip ahead when entries are selected by index only. */
+    if (ts == 0 && index < ed.min_index) {
+        index = ed.min_index;
+    }
+
+    rc = log_encode(log, &logs, ts, index, &ed);
+    if (ed.full) {
+        ms->ms_cursor[1] = ed.last_index + 1;
+        ms->ms_more = 1;
+        rc = 0;
+    } else if (rc == 0) {
+        ms->ms_cursor[0]++;
+        ms->ms_cursor[1] = 0;
+        ms->ms_more = log_nmgr_nth_log(name, ms->ms_cursor[0]) != NULL;
+    }
+
+err:
+    g_err |= cbor_encoder_close_container(&cb->encoder, &logs);
+    g_err |= cbor_encode_text_stringz(&cb->encoder, "rc");
+    g_err |= cbor_encode_int(&cb->encoder, rc);
+
+    if (g_err) {
+        return MGMT_ERR_ENOMEM;
+    }
+    return 0;
+}
+#endif
+
 /**
  * Newtmgr Module list handler
  * @param nmgr json buffer
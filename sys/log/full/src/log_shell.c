@@ -50,6 +50,14 @@ shell_log_dump_entry(struct log *log, struct log_offset *log_offset,
         goto err;
     }
 
+#if MYNEWT_VAL(LOG_DEFERRED_FMT)
+    if (ueh.ue_etype == LOG_ETYPE_FMT) {
+        log_fmt_read(log, dptr, len, data, sizeof(data));
+        console_printf("[%llu] %s\n", ueh.ue_ts, data);
+        return (0);
+    }
+#endif
+
     dlen = min(len-sizeof(ueh), 128);
 
     rc = log_read(log, dptr, data, sizeof(ueh), dlen);
@@ -0,0 +1,151 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include <string.h>
+
+#include "os/mynewt.h"
+#include "testutil/testutil.h"
+#include "fcb/fcb.h"
+#include "log/log.h"
+#include "log_test.h"
+
+struct flash_area fcb_areas[] = {
+    [0] = {
+        .fa_off = 0x00000000,
+        .fa_size = 16 * 1024
+    },
+    [1] = {
+        .fa_off = 0x00004000,
+        .fa_size = 16 * 1024
+    }
+};
+struct fcb_log log_fcb;
+struct log my_log;
+
+struct log_test_read_arg {
+    struct log_test_entry *entries;
+    int cnt;
+};
+
+static int
+log_test_read_walk(struct log *log, struct log_offset *log_offset,
+                   void *dptr, uint16_t len)
+{
+    struct log_test_read_arg *arg;
+    struct log_test_entry *entry;
+    struct log_entry_hdr ueh;
+    int dlen;
+    int rc;
+
+    arg = log_offset->lo_arg;
+    TEST_ASSERT_FATAL(arg->cnt < LOG_TEST_ENTRIES_MAX);
+    entry = &arg->entries[arg->cnt++];
+
+    rc = log_read(log, dptr, &ueh, 0, sizeof(ueh));
+    TEST_ASSERT_FATAL(rc == sizeof(ueh));
+    entry->etype = ueh.ue_etype;
+
+    if (ueh.ue_etype == LOG_ETYPE_FMT) {
+        rc = log_fmt_read(log, dptr, len, entry->text, sizeof(entry->text));
+        TEST_ASSERT(rc == strlen(entry->text));
+    } else {
+        dlen = len - sizeof(ueh);
+        TEST_ASSERT_FATAL(dlen < sizeof(entry->text));
+        rc = log_read(log, dptr, entry->text, sizeof(ueh), dlen);
+        TEST_ASSERT_FATAL(rc == dlen);
+        entry->text[dlen] = '\0';
+    }
+
+    return 0;
+}
+
+/*
+ * The hash log_fmt.c stores with the format ID.
+ */
+uint16_t
+log_test_fmt_hash(const char *fmt)
+{
+    uint32_t hash;
+
+    hash = 2166136261UL;
+    for (; *fmt != '\0'; fmt++) {
+        hash = (hash ^ (uint8_t)*fmt) * 16777619;
+    }
+    return (hash >> 16) ^ (hash & 0xffff);
+}
+
+/*
+ * Appends a LOG_ETYPE_FMT entry with format ID id, the given hash and
+ * argument bytes, the way an earlier boot or another image would have.
+ */
+void
+log_test_fmt_append(uint16_t id, uint16_t hash, const void *args, int len)
+{
+    uint8_t buf[LOG_ENTRY_HDR_SIZE + 4 + 16];
+    int rc;
+
+    TEST_ASSERT_FATAL(len <= 16);
+    memcpy(&buf[LOG_ENTRY_HDR_SIZE], &id, 2);
+    memcpy(&buf[LOG_ENTRY_HDR_SIZE + 2], &hash, 2);
+    memcpy(&buf[LOG_ENTRY_HDR_SIZE + 4], args, len);
+    rc = log_append_typed(&my_log, 0, 0, LOG_ETYPE_FMT, buf, 4 + len);
+    TEST_ASSERT(rc == 0);
+}
+
+/*
+ * Reads all entries in my_log. Returns the number of entries.
+ */
+int
+log_test_read_all(struct log_test_entry *entries)
+{
+    struct log_test_read_arg arg = { .entries = entries };
+    struct log_offset log_offset = { .lo_arg = &arg };
+    int rc;
+
+    rc = log_walk(&my_log, log_test_read_walk, &log_offset);
+    TEST_ASSERT(rc == 0);
+
+    return arg.cnt;
+}
+
+TEST_CASE_DECL(log_setup_fcb)
+TEST_CASE_DECL(log_deferred_fcb)
+TEST_CASE_DECL(log_deferred_unknown)
+TEST_CASE_DECL(log_deferred_reboot)
+
+TEST_SUITE(log_test_deferred)
+{
+    log_setup_fcb();
+    log_deferred_fcb();
+    log_deferred_unknown();
+    log_deferred_reboot();
+}
+
+#if MYNEWT_VAL(SELFTEST)
+
+int
+main(int argc, char **argv)
+{
+    sysinit();
+
+    log_test_deferred();
+
+    return tu_any_failed;
+}
+
+#endif
@@ -0,0 +1,56 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#ifndef _LOG_TEST_H
+#define _LOG_TEST_H
+#include <string.h>
+
+#include "os/mynewt.h"
+#include "testutil/testutil.h"
+#include "fcb/fcb.h"
+#include "log/log.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define FCB_FLASH_AREAS 2
+
+extern struct flash_area fcb_areas[FCB_FLASH_AREAS];
+
+extern struct fcb_log log_fcb;
+extern struct log my_log;
+
+#define LOG_TEST_ENTRIES_MAX 16
+
+/* An entry read back from my_log, as text. */
+struct log_test_entry {
+    uint8_t etype;
+    char text[LOG_PRINTF_MAX_ENTRY_LEN];
+};
+
+int log_test_read_all(struct log_test_entry *entries);
+uint16_t log_test_fmt_hash(const char *fmt);
+void log_test_fmt_append(uint16_t id, uint16_t hash, const void *args,
+                         int len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _LOG_TEST_H */
@@ -0,0 +1,59 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include <stdio.h>
+#include "log_test.h"
+
+#define LOG_DEFERRED_CNT        4
+
+TEST_CASE(log_deferred_fcb)
+{
+    struct log_test_entry entries[LOG_TEST_ENTRIES_MAX];
+    char exp[LOG_DEFERRED_CNT][LOG_PRINTF_MAX_ENTRY_LEN];
+    int cnt;
+    int rc;
+    int i;
+
+    rc = log_flush(&my_log);
+    TEST_ASSERT(rc == 0);
+
+    log_printf_deferred(&my_log, 0, 0, "no arguments");
+    snprintf(exp[0], sizeof(exp[0]), "no arguments");
+
+    log_printf_deferred(&my_log, 0, 0, "%d %u %x %ld %lld %zu %hd",
+                        -5, 7u, 0xbeef, -100000L, 1LL << 40, (size_t)12, 3);
+    snprintf(exp[1], sizeof(exp[1]), "%d %u %x %ld %lld %zu %hd",
+             -5, 7u, 0xbeef, -100000L, 1LL << 40, (size_t)12, 3);
+
+    log_printf_deferred(&my_log, 0, 0, "%s|%-6s|%.2s|%c|%%|%p",
+                        "abc", "de", "fgh", 'x', (void *)&my_log);
+    snprintf(exp[2], sizeof(exp[2]), "%s|%-6s|%.2s|%c|%%|%p",
+             "abc", "de", "fgh", 'x', (void *)&my_log);
+
+    log_printf_deferred(&my_log, 0, 0, "%*d|%-*.*f|", 5, 42, 8, 3, 3.14159);
+    snprintf(exp[3], sizeof(exp[3]), "%*d|%-*.*f|",
+             5, 42, 8, 3, 3.14159);
+
+    cnt = log_test_read_all(entries);
+    TEST_ASSERT_FATAL(cnt == LOG_DEFERRED_CNT);
+    for (i = 0; i < cnt; i++) {
+        TEST_ASSERT(entries[i].etype == LOG_ETYPE_FMT);
+        TEST_ASSERT(strcmp(entries[i].text, exp[i]) == 0,
+                    "\"%s\" != \"%s\"", entries[i].text, exp[i]);
+    }
+}
@@ -0,0 +1,57 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "log_test.h"
+
+/* Not logged by this test; as if only an earlier boot had used it. */
+static const char log_deferred_boot[]
+    __attribute__((section(LOG_FMT_SECTION))) = "boot %d %s";
+
+/*
+ * Format IDs do not depend on which format strings have been used since
+ * boot, so entries from before a reboot read back as they were written.
+ */
+TEST_CASE(log_deferred_reboot)
+{
+    struct log_test_entry entries[LOG_TEST_ENTRIES_MAX];
+    uint8_t args[sizeof(int) + 3];
+    int cnt;
+    int rc;
+    int v;
+
+    rc = log_flush(&my_log);
+    TEST_ASSERT(rc == 0);
+
+    v = 7;
+    memcpy(args, &v, sizeof(v));
+    args[sizeof(v)] = 2;
+    memcpy(&args[sizeof(v) + 1], "ok", 2);
+    log_test_fmt_append(log_deferred_boot - log_fmt_start,
+                        log_test_fmt_hash(log_deferred_boot),
+                        args, sizeof(args));
+
+    log_printf_deferred(&my_log, 0, 0, "after %d", 8);
+
+    cnt = log_test_read_all(entries);
+    TEST_ASSERT_FATAL(cnt == 2);
+    TEST_ASSERT(entries[0].etype == LOG_ETYPE_FMT);
+    TEST_ASSERT(strcmp(entries[0].text, "boot 7 ok") == 0,
+                "%s", entries[0].text);
+    TEST_ASSERT(strcmp(entries[1].text, "after 8") == 0,
+                "%s", entries[1].text);
+}
@@ -0,0 +1,76 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include <stdio.h>
+#include "log_test.h"
+
+static const char log_deferred_other[]
+    __attribute__((section(LOG_FMT_SECTION))) = "other %d";
+
+/*
+ * Entries whose format ID is outside the log_fmt section, or whose hash
+ * does not match the string there, e.g. ones written by another image,
+ * read back as unknown.
+ */
+TEST_CASE(log_deferred_unknown)
+{
+    struct log_test_entry entries[LOG_TEST_ENTRIES_MAX];
+    uint8_t buf[LOG_ENTRY_HDR_SIZE + 4];
+    char exp[LOG_PRINTF_MAX_ENTRY_LEN];
+    uint16_t hash;
+    int end;
+    int id;
+    int cnt;
+    int rc;
+
+    end = log_fmt_end - log_fmt_start;
+    id = log_deferred_other - log_fmt_start;
+    hash = log_test_fmt_hash(log_deferred_other);
+    TEST_ASSERT_FATAL(end <= UINT16_MAX);
+    TEST_ASSERT_FATAL(id >= 0 && id < end);
+
+    rc = log_flush(&my_log);
+    TEST_ASSERT(rc == 0);
+
+    log_printf_deferred(&my_log, 0, 0, "known %d", 1);
+
+    /* Past the end of the section. */
+    log_test_fmt_append(end, 0x1234, NULL, 0);
+
+    /* Some other format string's hash. */
+    log_test_fmt_append(id, hash ^ 1, NULL, 0);
+
+    /* Into the middle of a format string. */
+    log_test_fmt_append(id + 1, hash, NULL, 0);
+
+    /* Too short to hold a header. */
+    memset(buf, 0, sizeof(buf));
+    rc = log_append_typed(&my_log, 0, 0, LOG_ETYPE_FMT, buf, 1);
+    TEST_ASSERT(rc == 0);
+
+    cnt = log_test_read_all(entries);
+    TEST_ASSERT_FATAL(cnt == 5);
+    TEST_ASSERT(strcmp(entries[0].text, "known 1") == 0);
+    snprintf(exp, sizeof(exp), "<unknown format %u/1234>", end);
+    TEST_ASSERT(strcmp(entries[1].text, exp) == 0, "%s", entries[1].text);
+    snprintf(exp, sizeof(exp), "<unknown format %u/%04x>", id, hash ^ 1);
+    TEST_ASSERT(strcmp(entries[2].text, exp) == 0, "%s", entries[2].text);
+    snprintf(exp, sizeof(exp), "<unknown format %u/%04x>", id + 1, hash);
+    TEST_ASSERT(strcmp(entries[3].text, exp) == 0, "%s", entries[3].text);
+    TEST_ASSERT(entries[4].text[0] == '\0');
+}
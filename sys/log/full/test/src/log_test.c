@@ -33,7 +33,7 @@ struct flash_area fcb_areas[] = {
         .fa_size = 16 * 1024
     }
 };
-struct fcb log_fcb;
+struct fcb_log log_fcb;
 struct log my_log;
 
 char *str_logs[] = {
@@ -85,6 +85,7 @@ TEST_CASE_DECL(log_setup_fcb)
 TEST_CASE_DECL(log_append_fcb)
 TEST_CASE_DECL(log_walk_fcb)
 TEST_CASE_DECL(log_flush_fcb)
+TEST_CASE_DECL(log_walk_reverse_fcb)
 
 TEST_SUITE(log_test_all)
 {
@@ -92,6 +93,7 @@ TEST_SUITE(log_test_all)
     log_append_fcb();
     log_walk_fcb();
     log_flush_fcb();
+    log_walk_reverse_fcb();
 }
 
 #if MYNEWT_VAL(SELFTEST)
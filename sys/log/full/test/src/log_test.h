@@ -33,7 +33,7 @@ extern "C" {
 
 extern struct flash_area fcb_areas[FCB_FLASH_AREAS];
 
-extern struct fcb log_fcb;
+extern struct fcb_log log_fcb;
 extern struct log my_log;
 
 #define FCB_STR_LOGS_CNT 3
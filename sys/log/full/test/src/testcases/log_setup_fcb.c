@@ -20,19 +20,21 @@
 
 TEST_CASE(log_setup_fcb)
 {
+    struct fcb *fcb;
     int rc;
     int i;
 
-    log_fcb.f_sectors = fcb_areas;
-    log_fcb.f_sector_cnt = sizeof(fcb_areas) / sizeof(fcb_areas[0]);
-    log_fcb.f_magic = 0x7EADBADF;
-    log_fcb.f_version = 0;
+    fcb = &log_fcb.fl_fcb;
+    fcb->f_sectors = fcb_areas;
+    fcb->f_sector_cnt = sizeof(fcb_areas) / sizeof(fcb_areas[0]);
+    fcb->f_magic = 0x7EADBADF;
+    fcb->f_version = 0;
 
-    for (i = 0; i < log_fcb.f_sector_cnt; i++) {
+    for (i = 0; i < fcb->f_sector_cnt; i++) {
         rc = flash_area_erase(&fcb_areas[i], 0, fcb_areas[i].fa_size);
         TEST_ASSERT(rc == 0);
     }
-    rc = fcb_init(&log_fcb);
+    rc = fcb_init(fcb);
     TEST_ASSERT(rc == 0);
 
     log_register("log", &my_log, &log_fcb_handler, &log_fcb, LOG_SYSLEVEL);
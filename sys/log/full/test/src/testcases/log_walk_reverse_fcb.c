@@ -0,0 +1,111 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "log_test.h"
+
+#define LOG_REVERSE_ENTRY_CNT   400
+
+struct log_reverse_arg {
+    uint32_t first;
+    uint32_t last;
+    int visited;
+    int matched;
+    int step;
+};
+
+static int
+log_test_walk_index(struct log *log, struct log_offset *log_offset,
+                    void *dptr, uint16_t len)
+{
+    struct log_reverse_arg *arg;
+    struct log_entry_hdr ueh;
+    int rc;
+
+    arg = log_offset->lo_arg;
+
+    rc = log_read(log, dptr, &ueh, 0, sizeof(ueh));
+    TEST_ASSERT(rc == sizeof(ueh));
+
+    if (arg->visited == 0) {
+        arg->first = ueh.ue_index;
+    } else {
+        TEST_ASSERT(ueh.ue_index == arg->last + arg->step);
+    }
+    arg->last = ueh.ue_index;
+    arg->visited++;
+    if (ueh.ue_index >= log_offset->lo_index) {
+        arg->matched++;
+    }
+
+    return 0;
+}
+
+static void
+log_test_walk_index_run(int reverse, uint32_t lo_index,
+                        struct log_reverse_arg *arg)
+{
+    struct log_offset log_offset = { 0 };
+    int rc;
+
+    memset(arg, 0, sizeof(*arg));
+    arg->step = reverse ? -1 : 1;
+    log_offset.lo_arg = arg;
+    log_offset.lo_index = lo_index;
+
+    if (reverse) {
+        rc = log_walk_reverse(&my_log, log_test_walk_index, &log_offset);
+    } else {
+        rc = log_walk(&my_log, log_test_walk_index, &log_offset);
+    }
+    TEST_ASSERT(rc == 0);
+}
+
+TEST_CASE(log_walk_reverse_fcb)
+{
+    struct log_reverse_arg fwd;
+    struct log_reverse_arg rev;
+    uint32_t lo_index;
+    int i;
+
+    /* Enough entries to fill both sectors and rotate a couple of times. */
+    for (i = 0; i < LOG_REVERSE_ENTRY_CNT; i++) {
+        log_printf(&my_log, 0, 0, "%d %0100d", i, i);
+    }
+
+    log_test_walk_index_run(0, 0, &fwd);
+    TEST_ASSERT(fwd.visited > 0 && fwd.visited < LOG_REVERSE_ENTRY_CNT);
+
+    log_test_walk_index_run(1, 0, &rev);
+    TEST_ASSERT(rev.visited == fwd.visited);
+    TEST_ASSERT(rev.first == fwd.last);
+    TEST_ASSERT(rev.last == fwd.first);
+
+    /* Only the newest few entries requested. */
+    lo_index = fwd.last - 4;
+
+    log_test_walk_index_run(1, lo_index, &rev);
+    TEST_ASSERT(rev.matched == 5);
+    TEST_ASSERT(rev.visited < fwd.visited);
+
+    log_test_walk_index_run(0, lo_index, &rev);
+    TEST_ASSERT(rev.matched == 5);
+    TEST_ASSERT(rev.last == fwd.last);
+#if MYNEWT_VAL(FCB_LOG_SECTOR_INDEX) >= FCB_FLASH_AREAS
+    TEST_ASSERT(rev.visited < fwd.visited);
+#endif
+}
@@ -86,6 +86,9 @@ STATS_SECT_DECL(__name) {                   \
 #define STATS_CLEAR(__sectvarname, __var)        \
     (STATS_GET(__sectvarname, __var) = 0)
 
+#define STATS_SET(__sectvarname, __var, __n)   \
+    (STATS_GET(__sectvarname, __var) = (__n))
+
 #if MYNEWT_VAL(STATS_NAMES)
 
 #define STATS_NAME_MAP_NAME(__sectname) g_stats_map_ ## __sectname
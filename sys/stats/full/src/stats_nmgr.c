@@ -26,6 +26,7 @@
 
 #include "mgmt/mgmt.h"
 #include "cborattr/cborattr.h"
+#include "tinycbor/cbor_cnt_writer.h"
 #include "stats/stats.h"
 
 /* Source code is only included if the newtmgr library is enabled.  Otherwise
@@ -33,6 +34,9 @@
  */
 static int stats_nmgr_read(struct mgmt_cbuf *cb);
 static int stats_nmgr_list(struct mgmt_cbuf *cb);
+#if MYNEWT_VAL(MGMT_STREAM)
+static int stats_nmgr_stream(struct mgmt_cbuf *cb, struct mgmt_stream *ms);
+#endif
 
 static struct mgmt_group shell_nmgr_group;
 
@@ -43,7 +47,11 @@ static struct mgmt_group shell_nmgr_group;
  * Each element represents the command ID, referenced from newtmgr.
  */
 static struct mgmt_handler shell_nmgr_group_handlers[] = {
-    [STATS_NMGR_ID_READ] = {stats_nmgr_read, stats_nmgr_read},
+    [STATS_NMGR_ID_READ] = {stats_nmgr_read, stats_nmgr_read,
+#if MYNEWT_VAL(MGMT_STREAM)
+                            stats_nmgr_stream
+#endif
+    },
     [STATS_NMGR_ID_LIST] = {stats_nmgr_list, stats_nmgr_list}
 };
 
@@ -82,11 +90,16 @@ stats_nmgr_encode_name(struct stats_hdr *hdr, void *arg)
     return cbor_encode_text_stringz(penc, hdr->s_name);
 }
 
+#define STATS_NMGR_NAME_LEN (32)
+
+/*
+ * Parses a read request, and encodes the fields preceding the stats values
+ * in its response.
+ */
 static int
-stats_nmgr_read(struct mgmt_cbuf *cb)
+stats_nmgr_read_hdr(struct mgmt_cbuf *cb, struct stats_hdr **out_hdr)
 {
     struct stats_hdr *hdr;
-#define STATS_NMGR_NAME_LEN (32)
     char stats_name[STATS_NMGR_NAME_LEN];
     struct cbor_attr_t attrs[] = {
         { "name", CborAttrTextStringType, .addr.string = &stats_name[0],
@@ -94,7 +107,6 @@ stats_nmgr_read(struct mgmt_cbuf *cb)
         { NULL },
     };
     CborError g_err = CborNoError;
-    CborEncoder stats;
 
     g_err = cbor_read_object(&cb->it, attrs);
     if (g_err != 0) {
@@ -117,6 +129,27 @@ stats_nmgr_read(struct mgmt_cbuf *cb)
 
     g_err |= cbor_encode_text_stringz(&cb->encoder, "fields");
 
+    if (g_err) {
+        return MGMT_ERR_ENOMEM;
+    }
+
+    *out_hdr = hdr;
+    return (0);
+}
+
+static int
+stats_nmgr_read(struct mgmt_cbuf *cb)
+{
+    struct stats_hdr *hdr;
+    CborError g_err = CborNoError;
+    CborEncoder stats;
+    int rc;
+
+    rc = stats_nmgr_read_hdr(cb, &hdr);
+    if (rc != 0) {
+        return rc;
+    }
+
     g_err |= cbor_encoder_create_map(&cb->encoder, &stats,
                                      CborIndefiniteLength);
 
@@ -131,6 +164,89 @@ stats_nmgr_read(struct mgmt_cbuf *cb)
     return (0);
 }
 
+#if MYNEWT_VAL(MGMT_STREAM)
+struct stats_nmgr_stream_arg {
+    CborEncoder *enc;
+    struct mgmt_stream *ms;
+    uint32_t pos;
+    uint8_t full;
+};
+
+static int
+stats_nmgr_stream_walk_func(struct stats_hdr *hdr, void *arg, char *sname,
+        uint16_t stat_off)
+{
+    struct stats_nmgr_stream_arg *sa = arg;
+    struct CborCntWriter cnt_writer;
+    CborEncoder cnt_encoder;
+    int len;
+
+    if (sa->pos < sa->ms->ms_cursor[0]) {
+        sa->pos++;
+        return (0);
+    }
+
+    /*
+     * Leave the field to the next part if it does not fit, along with the
+     * break closing the fields map.  Every part carries at least one field.
+     */
+    cbor_cnt_writer_init(&cnt_writer);
+    cbor_encoder_init(&cnt_encoder, &cnt_writer.enc, 0);
+    stats_nmgr_walk_func(hdr, &cnt_encoder, sname, stat_off);
+    len = cbor_encode_bytes_written(sa->enc) +
+          cbor_encode_bytes_written(&cnt_encoder) + 1;
+    if (len > sa->ms->ms_budget && sa->pos > sa->ms->ms_cursor[0]) {
+        sa->full = 1;
+        return (1);
+    }
+
+    sa->pos++;
+    return stats_nmgr_walk_func(hdr, sa->enc, sname, stat_off);
+}
+
+/**
+ * Stats read handler for streamed responses.  Each part has the layout of a
+ * regular read response, with as many of the group's values as fit.  Cursor
+ * 0 counts the values already sent.
+ */
+static int
+stats_nmgr_stream(struct mgmt_cbuf *cb, struct mgmt_stream *ms)
+{
+    struct stats_nmgr_stream_arg sa;
+    struct stats_hdr *hdr;
+    CborError g_err = CborNoError;
+    CborEncoder stats;
+    int rc;
+
+    rc = stats_nmgr_read_hdr(cb, &hdr);
+    if (rc != 0) {
+        return rc;
+    }
+
+    g_err |= cbor_encoder_create_map(&cb->encoder, &stats,
+                                     CborIndefiniteLength);
+
+    memset(&sa, 0, sizeof(sa));
+    sa.enc = &stats;
+    sa.ms = ms;
+    rc = stats_walk(hdr, stats_nmgr_stream_walk_func, &sa);
+    if (sa.full) {
+        ms->ms_cursor[0] = sa.pos;
+        ms->ms_more = 1;
+    } else if (rc != 0) {
+        g_err |= rc;
+    }
+
+    g_err |= cbor_encoder_close_container(&cb->encoder, &stats);
+
+    if (g_err) {
+        return MGMT_ERR_ENOMEM;
+    }
+
+    return (0);
+}
+#endif
+
 static int
 stats_nmgr_list(struct mgmt_cbuf *cb)
 {
@@ -65,6 +65,7 @@ struct stats_hdr {
 #define STATS_INC(__sectvarname, __var)
 #define STATS_INCN(__sectvarname, __var, __n)
 #define STATS_CLEAR(__sectvarname, __var)
+#define STATS_SET(__sectvarname, __var, __n)
 
 #define STATS_NAME_START(__name)
 #define STATS_NAME(__name, __entry)
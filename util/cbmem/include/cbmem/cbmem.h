@@ -28,8 +28,16 @@ extern "C" {
 struct cbmem_entry_hdr {
     uint16_t ceh_len;
     uint16_t ceh_flags;
+#if MYNEWT_VAL(CBMEM_LOCKLESS)
+    uint32_t ceh_seq;
+#endif
 } __attribute__((packed));
 
+/* Entry has been reserved, but not committed yet. */
+#define CBMEM_ENTRY_F_BUSY      0x0001
+/* Next entry is at the start of the buffer. */
+#define CBMEM_ENTRY_F_WRAP      0x0002
+
 struct cbmem {
     struct os_mutex c_lock;
 
@@ -38,18 +46,28 @@ struct cbmem {
     uint8_t *c_buf;
     uint8_t *c_buf_end;
     uint8_t *c_buf_cur_end;
+#if MYNEWT_VAL(CBMEM_LOCKLESS)
+    uint32_t c_seq;         /* Sequence number of the next entry. */
+    uint16_t c_busy_cnt;    /* Number of entries not committed yet. */
+#endif
 };
 
 struct cbmem_iter {
     struct cbmem_entry_hdr *ci_start;
     struct cbmem_entry_hdr *ci_cur;
     struct cbmem_entry_hdr *ci_end;
+#if MYNEWT_VAL(CBMEM_LOCKLESS)
+    uint32_t ci_seq;        /* Sequence number of ci_cur. */
+    uint32_t ci_end_seq;    /* Sequence number following ci_end. */
+#endif
 };
 
 #define CBMEM_ENTRY_SIZE(__p) (sizeof(struct cbmem_entry_hdr) \
         + ((struct cbmem_entry_hdr *) (__p))->ceh_len)
 #define CBMEM_ENTRY_NEXT(__p) ((struct cbmem_entry_hdr *) \
         ((uint8_t *) (__p) + CBMEM_ENTRY_SIZE(__p)))
+#define CBMEM_ENTRY_DATA(__p) ((uint8_t *) (__p) + \
+        sizeof(struct cbmem_entry_hdr))
 
 typedef int (*cbmem_walk_func_t)(struct cbmem *, struct cbmem_entry_hdr *, 
         void *arg);
@@ -68,6 +86,19 @@ int cbmem_read_mbuf(struct cbmem *cbmem, struct cbmem_entry_hdr *hdr,
                     struct os_mbuf *om, uint16_t off, uint16_t len);
 int cbmem_walk(struct cbmem *cbmem, cbmem_walk_func_t walk_func, void *arg);
 
+#if MYNEWT_VAL(CBMEM_LOCKLESS)
+/*
+ * With CBMEM_LOCKLESS, appends can be done from interrupt context.  Space
+ * for an entry is reserved with interrupts disabled, the data is copied in
+ * with interrupts enabled, and the entry is then committed.  Readers do not
+ * lock; entries carry sequence numbers, and reads fail if the entry got
+ * overwritten in the meantime.  cbmem_lock_acquire()/release() do nothing.
+ */
+int cbmem_reserve(struct cbmem *cbmem, uint16_t len,
+                  struct cbmem_entry_hdr **out_hdr);
+void cbmem_commit(struct cbmem *cbmem, struct cbmem_entry_hdr *hdr);
+#endif
+
 int cbmem_flush(struct cbmem *);
 
 #ifdef __cplusplus
@@ -17,6 +17,7 @@
  * under the License.
  */
 
+#include <assert.h>
 #include <string.h>
 #include "os/mynewt.h"
 #include "cbmem/cbmem.h"
@@ -40,7 +41,7 @@ cbmem_lock_acquire(struct cbmem *cbmem)
 {
     int rc;
 
-    if (!os_started()) {
+    if (MYNEWT_VAL(CBMEM_LOCKLESS) || !os_started()) {
         return (0);
     }
 
@@ -59,7 +60,7 @@ cbmem_lock_release(struct cbmem *cbmem)
 {
     int rc;
 
-    if (!os_started()) {
+    if (MYNEWT_VAL(CBMEM_LOCKLESS) || !os_started()) {
         return (0);
     }
 
@@ -73,6 +74,218 @@ err:
     return (rc);
 }
 
+#if MYNEWT_VAL(CBMEM_LOCKLESS)
+
+/*
+ * Entries are laid out in sequence number order.  The position of an entry's
+ * successor only depends on the entry's own header, so it can be found
+ * without looking at any other state.
+ *
+ * All of the functions below which touch entry headers or the cbmem
+ * pointers must be called with interrupts disabled.
+ */
+static struct cbmem_entry_hdr *
+cbmem_entry_next(struct cbmem *cbmem, struct cbmem_entry_hdr *hdr)
+{
+    if (hdr->ceh_flags & CBMEM_ENTRY_F_WRAP) {
+        return (struct cbmem_entry_hdr *) cbmem->c_buf;
+    }
+    return CBMEM_ENTRY_NEXT(hdr);
+}
+
+static uint32_t
+cbmem_oldest_seq(struct cbmem *cbmem)
+{
+    if (cbmem->c_entry_start == NULL) {
+        return cbmem->c_seq;
+    }
+    return cbmem->c_entry_start->ceh_seq;
+}
+
+/*
+ * Whether an entry with the given sequence number is still in the buffer.
+ */
+static int
+cbmem_seq_is_live(struct cbmem *cbmem, uint32_t seq)
+{
+    return (int32_t)(seq - cbmem_oldest_seq(cbmem)) >= 0 &&
+           (int32_t)(seq - cbmem->c_seq) < 0;
+}
+
+/*
+ * Evict the oldest entry.  Returns the new oldest entry, or NULL if the
+ * buffer is now empty.
+ */
+static struct cbmem_entry_hdr *
+cbmem_evict(struct cbmem *cbmem, struct cbmem_entry_hdr *start)
+{
+    if (start == cbmem->c_entry_end) {
+        return NULL;
+    }
+    return cbmem_entry_next(cbmem, start);
+}
+
+/**
+ * Reserves space for an entry at the end of the buffer, evicting old
+ * entries as needed.  The entry data should be copied in with
+ * CBMEM_ENTRY_DATA(), and the entry then committed with cbmem_commit().
+ * Until then, readers skip the entry.  Can be called from interrupt context.
+ *
+ * @return 0 on success; -1 if the entry does not fit in the buffer, or if
+ *         room for it could only be made by evicting an entry which has not
+ *         been committed yet.
+ */
+int
+cbmem_reserve(struct cbmem *cbmem, uint16_t len,
+              struct cbmem_entry_hdr **out_hdr)
+{
+    struct cbmem_entry_hdr *start;
+    struct cbmem_entry_hdr *dst;
+    uint8_t *wrap;
+    uint8_t *end;
+    os_sr_t sr;
+
+    if (cbmem->c_buf + sizeof(*dst) + len > cbmem->c_buf_end) {
+        return (-1);
+    }
+
+    OS_ENTER_CRITICAL(sr);
+
+    start = cbmem->c_entry_start;
+    if (cbmem->c_entry_end) {
+        dst = CBMEM_ENTRY_NEXT(cbmem->c_entry_end);
+    } else {
+        dst = (struct cbmem_entry_hdr *) cbmem->c_buf;
+    }
+    end = (uint8_t *) dst + sizeof(*dst) + len;
+
+    /* If this item would take us past the end of this buffer, move it to the
+     * beginning, and drop the entries from the previous lap which are past
+     * the wrap point.
+     */
+    wrap = NULL;
+    if (end > cbmem->c_buf_end) {
+        wrap = (uint8_t *) dst;
+        dst = (struct cbmem_entry_hdr *) cbmem->c_buf;
+        end = (uint8_t *) dst + sizeof(*dst) + len;
+
+        while (start != NULL && (uint8_t *) start >= wrap) {
+            if (start->ceh_flags & CBMEM_ENTRY_F_BUSY) {
+                goto err;
+            }
+            start = cbmem_evict(cbmem, start);
+        }
+    }
+
+    /* Evict the entries which the new one overlaps. */
+    while (start != NULL && start >= dst && (uint8_t *) start < end) {
+        if (start->ceh_flags & CBMEM_ENTRY_F_BUSY) {
+            goto err;
+        }
+        start = cbmem_evict(cbmem, start);
+    }
+
+    if (wrap != NULL) {
+        if (cbmem->c_entry_end != NULL) {
+            cbmem->c_entry_end->ceh_flags |= CBMEM_ENTRY_F_WRAP;
+        }
+        cbmem->c_buf_cur_end = wrap;
+    }
+
+    dst->ceh_len = len;
+    dst->ceh_flags = CBMEM_ENTRY_F_BUSY;
+    dst->ceh_seq = cbmem->c_seq++;
+    cbmem->c_busy_cnt++;
+
+    cbmem->c_entry_end = dst;
+    if (start != NULL) {
+        cbmem->c_entry_start = start;
+    } else {
+        cbmem->c_entry_start = dst;
+    }
+
+    OS_EXIT_CRITICAL(sr);
+
+    *out_hdr = dst;
+    return (0);
+err:
+    OS_EXIT_CRITICAL(sr);
+    return (-1);
+}
+
+/**
+ * Makes an entry reserved with cbmem_reserve() visible to readers.
+ */
+void
+cbmem_commit(struct cbmem *cbmem, struct cbmem_entry_hdr *hdr)
+{
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+    assert(hdr->ceh_flags & CBMEM_ENTRY_F_BUSY);
+    hdr->ceh_flags &= ~CBMEM_ENTRY_F_BUSY;
+    cbmem->c_busy_cnt--;
+    OS_EXIT_CRITICAL(sr);
+}
+
+/*
+ * Checks that an entry can be read, and returns its sequence number and
+ * length.  After reading the entry data, the caller checks that it was not
+ * overwritten in the meantime with cbmem_read_done().
+ */
+static int
+cbmem_read_start(struct cbmem *cbmem, struct cbmem_entry_hdr *hdr,
+                 uint32_t *out_seq, uint16_t *out_len)
+{
+    os_sr_t sr;
+    int rc;
+
+    OS_ENTER_CRITICAL(sr);
+    *out_seq = hdr->ceh_seq;
+    *out_len = hdr->ceh_len;
+    if (!cbmem_seq_is_live(cbmem, *out_seq) ||
+        (hdr->ceh_flags & CBMEM_ENTRY_F_BUSY)) {
+        rc = -1;
+    } else {
+        rc = 0;
+    }
+    OS_EXIT_CRITICAL(sr);
+
+    return (rc);
+}
+
+static int
+cbmem_read_done(struct cbmem *cbmem, uint32_t seq)
+{
+    os_sr_t sr;
+    int rc;
+
+    OS_ENTER_CRITICAL(sr);
+    rc = cbmem_seq_is_live(cbmem, seq) ? 0 : -1;
+    OS_EXIT_CRITICAL(sr);
+
+    return (rc);
+}
+
+static int
+cbmem_append_internal(struct cbmem *cbmem, void *data, uint16_t len,
+                      copy_data_func_t *copy_func)
+{
+    struct cbmem_entry_hdr *dst;
+    int rc;
+
+    rc = cbmem_reserve(cbmem, len, &dst);
+    if (rc != 0) {
+        return (rc);
+    }
+
+    copy_func(CBMEM_ENTRY_DATA(dst), data, len);
+    cbmem_commit(cbmem, dst);
+
+    return (0);
+}
+
+#else
 
 static int
 cbmem_append_internal(struct cbmem *cbmem, void *data, uint16_t len,
@@ -144,6 +357,8 @@ err:
     return (-1);
 }
 
+#endif
+
 static void
 copy_data_from_flat(void *dst, void *data, uint16_t len)
 {
@@ -179,6 +394,69 @@ cbmem_append_mbuf(struct cbmem *cbmem, struct os_mbuf *om)
     return cbmem_append_internal(cbmem, om, len, copy_data_from_mbuf);
 }
 
+#if MYNEWT_VAL(CBMEM_LOCKLESS)
+
+void
+cbmem_iter_start(struct cbmem *cbmem, struct cbmem_iter *iter)
+{
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+    iter->ci_start = cbmem->c_entry_start;
+    iter->ci_cur = cbmem->c_entry_start;
+    iter->ci_end = cbmem->c_entry_end;
+    iter->ci_seq = cbmem_oldest_seq(cbmem);
+    iter->ci_end_seq = cbmem->c_seq;
+    OS_EXIT_CRITICAL(sr);
+}
+
+/*
+ * Returns the entries which were in the buffer when the iteration started.
+ * If the iterator falls behind the writers, it skips ahead to the oldest
+ * entry still in the buffer.  Entries which are not committed yet are
+ * skipped.
+ */
+struct cbmem_entry_hdr *
+cbmem_iter_next(struct cbmem *cbmem, struct cbmem_iter *iter)
+{
+    struct cbmem_entry_hdr *hdr;
+    uint16_t flags;
+    os_sr_t sr;
+
+    while (1) {
+        if ((int32_t)(iter->ci_seq - iter->ci_end_seq) >= 0) {
+            return (NULL);
+        }
+
+        OS_ENTER_CRITICAL(sr);
+
+        if ((int32_t)(iter->ci_seq - cbmem_oldest_seq(cbmem)) < 0) {
+            iter->ci_cur = cbmem->c_entry_start;
+            iter->ci_seq = cbmem_oldest_seq(cbmem);
+            if (iter->ci_cur == NULL ||
+                (int32_t)(iter->ci_seq - iter->ci_end_seq) >= 0) {
+
+                OS_EXIT_CRITICAL(sr);
+                return (NULL);
+            }
+        }
+
+        hdr = iter->ci_cur;
+        assert(hdr->ceh_seq == iter->ci_seq);
+        flags = hdr->ceh_flags;
+        iter->ci_cur = cbmem_entry_next(cbmem, hdr);
+        iter->ci_seq++;
+
+        OS_EXIT_CRITICAL(sr);
+
+        if (!(flags & CBMEM_ENTRY_F_BUSY)) {
+            return (hdr);
+        }
+    }
+}
+
+#else
+
 void
 cbmem_iter_start(struct cbmem *cbmem, struct cbmem_iter *iter)
 {
@@ -217,9 +495,14 @@ err:
     return (hdr);
 }
 
+#endif
+
 int
 cbmem_flush(struct cbmem *cbmem)
 {
+#if MYNEWT_VAL(CBMEM_LOCKLESS)
+    os_sr_t sr;
+#endif
     int rc;
 
     rc = cbmem_lock_acquire(cbmem);
@@ -227,9 +510,22 @@ cbmem_flush(struct cbmem *cbmem)
         goto err;
     }
 
+#if MYNEWT_VAL(CBMEM_LOCKLESS)
+    /* Entries which are being written to can't be thrown away. */
+    OS_ENTER_CRITICAL(sr);
+    if (cbmem->c_busy_cnt != 0) {
+        OS_EXIT_CRITICAL(sr);
+        return (-1);
+    }
+    cbmem->c_entry_start = NULL;
+    cbmem->c_entry_end = NULL;
+    cbmem->c_buf_cur_end = NULL;
+    OS_EXIT_CRITICAL(sr);
+#else
     cbmem->c_entry_start = NULL;
     cbmem->c_entry_end = NULL;
     cbmem->c_buf_cur_end = NULL;
+#endif
 
     rc = cbmem_lock_release(cbmem);
     if (rc != 0) {
@@ -241,6 +537,75 @@ err:
     return (rc);
 }
 
+#if MYNEWT_VAL(CBMEM_LOCKLESS)
+
+int
+cbmem_read(struct cbmem *cbmem, struct cbmem_entry_hdr *hdr, void *buf,
+        uint16_t off, uint16_t len)
+{
+    uint16_t hdr_len;
+    uint32_t seq;
+    int rc;
+
+    rc = cbmem_read_start(cbmem, hdr, &seq, &hdr_len);
+    if (rc != 0) {
+        return (-1);
+    }
+
+    if (off > hdr_len) {
+        return (-1);
+    }
+    if (off + len > hdr_len) {
+        len = hdr_len - off;
+    }
+
+    memcpy(buf, CBMEM_ENTRY_DATA(hdr) + off, len);
+
+    /* The entry may have been overwritten while it was being copied. */
+    rc = cbmem_read_done(cbmem, seq);
+    if (rc != 0) {
+        return (-1);
+    }
+
+    return (len);
+}
+
+int
+cbmem_read_mbuf(struct cbmem *cbmem, struct cbmem_entry_hdr *hdr,
+                struct os_mbuf *om, uint16_t off, uint16_t len)
+{
+    uint16_t hdr_len;
+    uint32_t seq;
+    int rc;
+
+    rc = cbmem_read_start(cbmem, hdr, &seq, &hdr_len);
+    if (rc != 0) {
+        return (-1);
+    }
+
+    if (off > hdr_len) {
+        return (-1);
+    }
+    if (off + len > hdr_len) {
+        len = hdr_len - off;
+    }
+
+    rc = os_mbuf_append(om, CBMEM_ENTRY_DATA(hdr) + off, len);
+    if (rc != 0) {
+        return (-1);
+    }
+
+    rc = cbmem_read_done(cbmem, seq);
+    if (rc != 0) {
+        os_mbuf_adj(om, -(int)len);
+        return (-1);
+    }
+
+    return (len);
+}
+
+#else
+
 int
 cbmem_read(struct cbmem *cbmem, struct cbmem_entry_hdr *hdr, void *buf,
         uint16_t off, uint16_t len)
@@ -314,6 +679,8 @@ err:
 
 }
 
+#endif
+
 int
 cbmem_walk(struct cbmem *cbmem, cbmem_walk_func_t walk_func, void *arg)
 {
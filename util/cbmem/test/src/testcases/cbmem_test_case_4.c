@@ -0,0 +1,119 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "cbmem_test.h"
+
+#if MYNEWT_VAL(CBMEM_LOCKLESS)
+
+static struct cbmem cbmem4;
+static uint8_t cbmem4_buf[256];
+
+static struct cbmem_entry_hdr *
+cbmem_test_case_4_append(uint8_t val, uint16_t len)
+{
+    struct cbmem_entry_hdr *hdr;
+    int rc;
+
+    rc = cbmem_reserve(&cbmem4, len, &hdr);
+    TEST_ASSERT_FATAL(rc == 0, "Could not reserve %d bytes", len);
+    memset(CBMEM_ENTRY_DATA(hdr), 0xff, len);
+    CBMEM_ENTRY_DATA(hdr)[0] = val;
+    cbmem_commit(&cbmem4, hdr);
+
+    return hdr;
+}
+
+static int
+cbmem_test_case_4_count(void)
+{
+    struct cbmem_iter iter;
+    int cnt;
+
+    cnt = 0;
+    cbmem_iter_start(&cbmem4, &iter);
+    while (cbmem_iter_next(&cbmem4, &iter) != NULL) {
+        cnt++;
+    }
+
+    return cnt;
+}
+
+#endif
+
+TEST_CASE(cbmem_test_case_4)
+{
+#if MYNEWT_VAL(CBMEM_LOCKLESS)
+    struct cbmem_entry_hdr *busy;
+    struct cbmem_entry_hdr *hdr;
+    struct cbmem_iter iter;
+    uint8_t val;
+    int rc;
+
+    rc = cbmem_init(&cbmem4, cbmem4_buf, sizeof(cbmem4_buf));
+    TEST_ASSERT_FATAL(rc == 0);
+
+    /* Entries which are not committed yet are not visible to readers. */
+    rc = cbmem_reserve(&cbmem4, 100, &busy);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(cbmem_test_case_4_count() == 0);
+
+    cbmem_test_case_4_append(1, 100);
+    TEST_ASSERT(cbmem_test_case_4_count() == 1);
+
+    /* ... and can't be overwritten or flushed. */
+    rc = cbmem_reserve(&cbmem4, 100, &hdr);
+    TEST_ASSERT(rc != 0);
+    rc = cbmem_flush(&cbmem4);
+    TEST_ASSERT(rc != 0);
+
+    memset(CBMEM_ENTRY_DATA(busy), 0xff, 100);
+    CBMEM_ENTRY_DATA(busy)[0] = 0;
+    cbmem_commit(&cbmem4, busy);
+    TEST_ASSERT(cbmem_test_case_4_count() == 2);
+
+    /* Reading an entry which got overwritten fails. */
+    cbmem_iter_start(&cbmem4, &iter);
+    hdr = cbmem_iter_next(&cbmem4, &iter);
+    TEST_ASSERT_FATAL(hdr == busy);
+    hdr = cbmem_iter_next(&cbmem4, &iter);
+    TEST_ASSERT_FATAL(hdr != NULL);
+    rc = cbmem_read(&cbmem4, hdr, &val, 0, 1);
+    TEST_ASSERT(rc == 1 && val == 1);
+
+    cbmem_test_case_4_append(2, 50);
+    cbmem_test_case_4_append(3, 50);
+    rc = cbmem_read(&cbmem4, hdr, &val, 0, 1);
+    TEST_ASSERT(rc == -1);
+
+    /* An iterator which fell behind skips to the oldest entry left. */
+    TEST_ASSERT(cbmem_iter_next(&cbmem4, &iter) == NULL);
+    cbmem_iter_start(&cbmem4, &iter);
+    cbmem_test_case_4_append(4, 50);
+    cbmem_test_case_4_append(5, 50);
+    cbmem_test_case_4_append(6, 50);
+    hdr = cbmem_iter_next(&cbmem4, &iter);
+    TEST_ASSERT_FATAL(hdr != NULL);
+    rc = cbmem_read(&cbmem4, hdr, &val, 0, 1);
+    TEST_ASSERT(rc == 1 && val == 3);
+    TEST_ASSERT(cbmem_iter_next(&cbmem4, &iter) == NULL);
+
+    rc = cbmem_flush(&cbmem4);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(cbmem_test_case_4_count() == 0);
+#endif
+}
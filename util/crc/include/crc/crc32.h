@@ -0,0 +1,44 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * CRC-32 and CRC-32C.  Both take care of the initial value and final xor,
+ * so a CRC can be computed in pieces by passing in the previous result,
+ * starting with CRC32_INITIAL_CRC.
+ */
+
+#ifndef _UTIL_CRC32_H_
+#define _UTIL_CRC32_H_
+
+#include <inttypes.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CRC32_INITIAL_CRC       0       /* what to seed crc32 with */
+
+uint32_t crc32_calc(uint32_t crc, const void *buf, int len);
+uint32_t crc32c_calc(uint32_t crc, const void *buf, int len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
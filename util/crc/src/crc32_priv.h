@@ -0,0 +1,81 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef _CRC32_PRIV_H_
+#define _CRC32_PRIV_H_
+
+#include <inttypes.h>
+#include "syscfg/syscfg.h"
+
+#if MYNEWT_VAL(CRC32_SLICE) != 1 && MYNEWT_VAL(CRC32_SLICE) != 4 && \
+    MYNEWT_VAL(CRC32_SLICE) != 8
+#error "CRC32_SLICE must be 1, 4 or 8"
+#endif
+
+/*
+ * Little endian load; compilers turn this into a single load where the
+ * CPU allows.
+ */
+static inline uint32_t
+crc32_get_le32(const uint8_t *p)
+{
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/*
+ * Table driven reflected CRC-32, without the pre and post inversion.
+ * tab[k][n] is the CRC of byte n followed by k zero bytes, so with
+ * CRC32_SLICE tables, CRC32_SLICE bytes can be folded in per step.
+ */
+static inline uint32_t
+crc32_slice(const uint32_t tab[][256], uint32_t crc, const uint8_t *p,
+            int len)
+{
+#if MYNEWT_VAL(CRC32_SLICE) >= 4
+    uint32_t one;
+#endif
+#if MYNEWT_VAL(CRC32_SLICE) == 8
+    uint32_t two;
+
+    while (len >= 8) {
+        one = crc32_get_le32(p) ^ crc;
+        two = crc32_get_le32(p + 4);
+        crc = tab[7][one & 0xff] ^ tab[6][(one >> 8) & 0xff] ^
+              tab[5][(one >> 16) & 0xff] ^ tab[4][one >> 24] ^
+              tab[3][two & 0xff] ^ tab[2][(two >> 8) & 0xff] ^
+              tab[1][(two >> 16) & 0xff] ^ tab[0][two >> 24];
+        p += 8;
+        len -= 8;
+    }
+#elif MYNEWT_VAL(CRC32_SLICE) == 4
+    while (len >= 4) {
+        one = crc32_get_le32(p) ^ crc;
+        crc = tab[3][one & 0xff] ^ tab[2][(one >> 8) & 0xff] ^
+              tab[1][(one >> 16) & 0xff] ^ tab[0][one >> 24];
+        p += 4;
+        len -= 4;
+    }
+#endif
+    while (len-- > 0) {
+        crc = tab[0][(crc ^ *p++) & 0xff] ^ (crc >> 8);
+    }
+    return crc;
+}
+
+#endif
@@ -0,0 +1,105 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "crc_test.h"
+
+uint8_t crc_test_buf[CRC_TEST_BUF_SIZE];
+
+uint8_t
+crc_test_ref8(uint8_t crc, const uint8_t *p, int len)
+{
+    int i;
+
+    while (len-- > 0) {
+        crc ^= *p++;
+        for (i = 0; i < 8; i++) {
+            crc = (crc & 0x80) ? (crc << 1) ^ 0x07 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+uint16_t
+crc_test_ref16(uint16_t crc, const uint8_t *p, int len)
+{
+    int i;
+
+    while (len-- > 0) {
+        crc ^= *p++ << 8;
+        for (i = 0; i < 8; i++) {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+uint32_t
+crc_test_ref32(uint32_t poly, uint32_t crc, const uint8_t *p, int len)
+{
+    int i;
+
+    crc = ~crc;
+    while (len-- > 0) {
+        crc ^= *p++;
+        for (i = 0; i < 8; i++) {
+            crc = (crc & 1) ? (crc >> 1) ^ poly : crc >> 1;
+        }
+    }
+    return ~crc;
+}
+
+void
+crc_test_setup(void *arg)
+{
+    uint32_t seed;
+    int i;
+
+    /* Pseudo random data, same every run. */
+    seed = 1;
+    for (i = 0; i < CRC_TEST_BUF_SIZE; i++) {
+        seed = seed * 1103515245 + 12345;
+        crc_test_buf[i] = seed >> 16;
+    }
+}
+
+TEST_CASE_DECL(crc_test_vectors)
+TEST_CASE_DECL(crc_test_reference)
+TEST_CASE_DECL(crc_test_chained)
+
+TEST_SUITE(crc_test_suite)
+{
+    crc_test_vectors();
+    crc_test_reference();
+    crc_test_chained();
+}
+
+#if MYNEWT_VAL(SELFTEST)
+
+int
+main(int argc, char **argv)
+{
+    sysinit();
+
+    tu_suite_set_init_cb(crc_test_setup, NULL);
+    crc_test_suite();
+
+    return tu_any_failed;
+}
+
+#endif
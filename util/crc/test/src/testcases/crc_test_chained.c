@@ -0,0 +1,51 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "crc_test.h"
+
+/*
+ * Computing the CRC in pieces gives the same result as doing it in one go.
+ */
+TEST_CASE(crc_test_chained)
+{
+    uint32_t c32;
+    uint32_t c32c;
+    uint16_t c16;
+    uint8_t c8;
+    int split;
+    int len;
+
+    len = CRC_TEST_BUF_SIZE;
+    for (split = 0; split <= 19; split++) {
+        c8 = crc8_calc(crc8_init(), crc_test_buf, split);
+        c8 = crc8_calc(c8, crc_test_buf + split, len - split);
+        TEST_ASSERT(c8 == crc8_calc(crc8_init(), crc_test_buf, len));
+
+        c16 = crc16_ccitt(CRC16_INITIAL_CRC, crc_test_buf, split);
+        c16 = crc16_ccitt(c16, crc_test_buf + split, len - split);
+        TEST_ASSERT(c16 == crc16_ccitt(CRC16_INITIAL_CRC, crc_test_buf, len));
+
+        c32 = crc32_calc(CRC32_INITIAL_CRC, crc_test_buf, split);
+        c32 = crc32_calc(c32, crc_test_buf + split, len - split);
+        TEST_ASSERT(c32 == crc32_calc(CRC32_INITIAL_CRC, crc_test_buf, len));
+
+        c32c = crc32c_calc(CRC32_INITIAL_CRC, crc_test_buf, split);
+        c32c = crc32c_calc(c32c, crc_test_buf + split, len - split);
+        TEST_ASSERT(c32c == crc32c_calc(CRC32_INITIAL_CRC, crc_test_buf, len));
+    }
+}
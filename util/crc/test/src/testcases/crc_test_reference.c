@@ -0,0 +1,49 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "crc_test.h"
+
+/*
+ * Compare against the bitwise implementations at every alignment, and
+ * lengths covering the sliced loop and the byte tail.
+ */
+TEST_CASE(crc_test_reference)
+{
+    const uint8_t *p;
+    int off;
+    int len;
+
+    for (off = 0; off < 8; off++) {
+        for (len = 0; len < CRC_TEST_BUF_SIZE - 8;
+             len += (len < 64) ? 1 : 37) {
+            p = crc_test_buf + off;
+            TEST_ASSERT_FATAL(crc8_calc(0xff, (void *)p, len) ==
+                              crc_test_ref8(0xff, p, len),
+                              "crc8 off %d len %d", off, len);
+            TEST_ASSERT_FATAL(crc16_ccitt(0x1d0f, p, len) ==
+                              crc_test_ref16(0x1d0f, p, len),
+                              "crc16 off %d len %d", off, len);
+            TEST_ASSERT_FATAL(crc32_calc(0, p, len) ==
+                              crc_test_ref32(0xedb88320, 0, p, len),
+                              "crc32 off %d len %d", off, len);
+            TEST_ASSERT_FATAL(crc32c_calc(0, p, len) ==
+                              crc_test_ref32(0x82f63b78, 0, p, len),
+                              "crc32c off %d len %d", off, len);
+        }
+    }
+}
@@ -0,0 +1,48 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "crc_test.h"
+
+/*
+ * Check values from the CRC catalogue, CRC of "123456789".
+ */
+TEST_CASE(crc_test_vectors)
+{
+    static const char check[] = "123456789";
+    static const uint8_t zeros[32];
+
+    /* CRC-8 (poly 0x07, init 0) */
+    TEST_ASSERT(crc8_calc(0, (void *)check, 9) == 0xf4);
+
+    /* CRC-16/XMODEM (CCITT poly, init 0) */
+    TEST_ASSERT(crc16_ccitt(CRC16_INITIAL_CRC, check, 9) == 0x31c3);
+
+    /* CRC-32 and CRC-32C */
+    TEST_ASSERT(crc32_calc(CRC32_INITIAL_CRC, check, 9) == 0xcbf43926);
+    TEST_ASSERT(crc32c_calc(CRC32_INITIAL_CRC, check, 9) == 0xe3069283);
+
+    /* RFC 3720, 32 bytes of zeros */
+    TEST_ASSERT(crc32c_calc(CRC32_INITIAL_CRC, zeros, sizeof(zeros)) ==
+                0x8a9136aa);
+
+    /* Empty buffer leaves the CRC as is. */
+    TEST_ASSERT(crc8_calc(0x5a, (void *)check, 0) == 0x5a);
+    TEST_ASSERT(crc16_ccitt(0x1234, check, 0) == 0x1234);
+    TEST_ASSERT(crc32_calc(0x12345678, check, 0) == 0x12345678);
+    TEST_ASSERT(crc32c_calc(0x12345678, check, 0) == 0x12345678);
+}